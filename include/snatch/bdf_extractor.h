@@ -0,0 +1,29 @@
+/// \file
+/// \brief X11 BDF and PCF bitmap font extraction interface.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <filesystem>
+#include <string>
+
+#include "snatch/extracted_font.h"
+
+struct bdf_extract_options {
+    std::filesystem::path input_file;
+    int first_ascii{-1}; // <0: from the first glyph of the font
+    int last_ascii{-1};  // <0: to the last
+};
+
+// Reads the glyphs of a BDF (text) or PCF (binary) font as drawn, with the
+// font's own bearings and advances. Codepoints are the font's encodings, which
+// are Unicode for ISO10646 and Latin-1 fonts. Glyphs come out in codepoint
+// order, their rows in out.pixels; codepoints the font lacks are left out.
+class bdf_extractor {
+public:
+    bool extract(const bdf_extract_options& opt, extracted_font& out, std::string& err) const;
+};
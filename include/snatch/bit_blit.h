@@ -0,0 +1,52 @@
+/// \file
+/// \brief 1bpp bitmap blitting with clipping and raster operations.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "snatch/plugin.h"
+
+// how a source pixel combines with the destination pixel under it
+enum class raster_op {
+    copy,
+    bit_or,
+    bit_and,
+    bit_xor,
+};
+
+// 1bpp rows, MSB first, `stride` bytes apart
+struct bitmap_1bpp {
+    std::uint8_t* data{nullptr};
+    int width{0};
+    int height{0};
+    std::size_t stride{0};
+};
+
+struct const_bitmap_1bpp {
+    const std::uint8_t* data{nullptr};
+    int width{0};
+    int height{0};
+    std::size_t stride{0};
+};
+
+/// \brief glyph_view_1bpp.
+inline const_bitmap_1bpp glyph_view_1bpp(const snatch_glyph_bitmap& glyph) {
+    if (!glyph.data || glyph.width <= 0 || glyph.height <= 0 || glyph.stride_bytes <= 0) return {};
+    return {glyph.data, glyph.width, glyph.height, static_cast<std::size_t>(glyph.stride_bytes)};
+}
+
+// Combines `width` pixels of `src` starting at pixel src_x into `dst`
+// starting at pixel dst_x. Pixels landing outside 0..dst_width are clipped;
+// source bytes outside the copied span are never read.
+void blit_row_1bpp(std::uint8_t* dst, int dst_width, int dst_x, const std::uint8_t* src, int src_x, int width, raster_op op);
+
+// Combines all of `src` into `dst` with its top left pixel at (x, y), clipped
+// to `dst`.
+void blit_1bpp(const bitmap_1bpp& dst, int x, int y, const const_bitmap_1bpp& src, raster_op op);
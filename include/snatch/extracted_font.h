@@ -27,6 +27,9 @@ struct extracted_font {
     int pixel_size{0};
 
     std::vector<extracted_glyph> glyphs;
+    // rows of all glyphs in one block, for extractors that fill glyph_views
+    // straight away instead of glyphs
+    std::vector<unsigned char> pixels;
     std::vector<snatch_glyph_bitmap> glyph_views;
     snatch_bitmap_font bitmap_view{};
 
@@ -8,6 +8,9 @@
 
 #pragma once
 
+#include <array>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -48,6 +51,8 @@ public:
     bool same_color(const glyph_pixel& a, const glyph_pixel& b) const;
     int transition_cost(const glyph_pixel& a, const glyph_pixel& b, int& dx, int& dy) const;
     int total_cost(const std::vector<glyph_pixel>& route) const;
+    // the constructor arguments, e.g. to key cached routes
+    std::array<int, 4> parameters() const;
 
 private:
     int color_threshold_{0};
@@ -61,9 +66,85 @@ public:
     explicit glyph_route_optimizer(glyph_route_cost_model model = glyph_route_cost_model{});
 
     std::vector<glyph_pixel> tsp_2opt(const std::vector<glyph_pixel>& route) const;
+    // Exact up to glyph_stroke_planner::k_exact_dots points, otherwise local
+    // search refined for up to `budget` by perturbing the best route.
+    std::vector<glyph_pixel> shortest(const std::vector<glyph_pixel>& route, std::chrono::milliseconds budget = {}) const;
 
 private:
     static std::vector<glyph_pixel> two_opt_swap(const std::vector<glyph_pixel>& route, int i, int k);
 
     glyph_route_cost_model cost_model_;
 };
+
+// A straight run of foreground pixels, `from` and `to` inclusive, along a row,
+// a column or a diagonal. A single pixel has from == to.
+struct glyph_stroke {
+    glyph_pixel from;
+    glyph_pixel to;
+};
+
+class glyph_stroke_planner {
+public:
+    explicit glyph_stroke_planner(glyph_route_cost_model model = glyph_route_cost_model{});
+
+    // Covers every foreground pixel with strokes that touch foreground only,
+    // longest first; what no line covers comes back as single pixels.
+    static std::vector<glyph_stroke> cover(const snatch_glyph_bitmap& glyph, std::uint8_t color = 1);
+    // Orders strokes and picks the direction each is drawn in to keep travel cheap.
+    // Small sets are solved exactly; larger ones get 2-opt and Or-opt, then
+    // iterated local search for up to `budget`.
+    std::vector<glyph_stroke> route(std::vector<glyph_stroke> strokes, std::chrono::milliseconds budget = {}) const;
+    int travel_cost(const std::vector<glyph_stroke>& strokes) const;
+
+    static constexpr std::size_t k_exact_dots = 16;
+    static constexpr std::size_t k_exact_strokes = 12;
+
+private:
+    int hop_cost(const glyph_pixel& a, const glyph_pixel& b) const;
+    std::vector<glyph_stroke> exact(const std::vector<glyph_stroke>& strokes) const;
+    std::vector<glyph_stroke> nearest_neighbour(const std::vector<glyph_stroke>& strokes) const;
+    bool two_opt_pass(std::vector<glyph_stroke>& order) const;
+    bool or_opt_pass(std::vector<glyph_stroke>& order) const;
+    void local_search(std::vector<glyph_stroke>& order) const;
+
+    glyph_route_cost_model cost_model_;
+};
+
+// Where a packed box landed; width and height are the size asked for.
+struct atlas_rect {
+    int x{0};
+    int y{0};
+    int width{0};
+    int height{0};
+};
+
+// Skyline bottom-left packing into a strip of fixed width that grows down.
+// Each placement only walks the skyline, so the cost per box grows with the
+// strip width rather than with the number of boxes already placed.
+class glyph_atlas_packer {
+public:
+    // Boxes keep `spacing` pixels apart and start on multiples of `align_x`.
+    explicit glyph_atlas_packer(int width, int align_x = 1, int spacing = 0);
+
+    // Places every box, tallest first, writing x and y in place; empty boxes
+    // stay at 0,0. False if a box is wider than the strip.
+    bool pack(std::vector<atlas_rect>& boxes);
+    // rows used so far
+    int height() const { return height_; }
+
+private:
+    struct skyline_node {
+        int x;
+        int y;
+        int width;
+    };
+
+    // `width` includes spacing and alignment, `box_width` is what must fit
+    bool place(int width, int box_width, int height, int& x, int& y);
+
+    int width_{0};
+    int align_x_{1};
+    int spacing_{0};
+    int height_{0};
+    std::vector<skyline_node> skyline_;
+};
@@ -0,0 +1,68 @@
+/// \file
+/// \brief Content hashing and persistent per-glyph result cache.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <unordered_map>
+#include <vector>
+
+#include "snatch/plugin.h"
+
+constexpr std::uint64_t k_glyph_hash_seed = 14695981039346656037ull; // FNV-1a offset basis
+
+// FNV-1a over raw bytes; chain calls by passing the previous result as seed.
+std::uint64_t glyph_hash_bytes(const void* data, std::size_t size, std::uint64_t seed = k_glyph_hash_seed);
+// metrics plus every row of the bitmap (stride padding excluded)
+std::uint64_t glyph_bitmap_hash(const snatch_glyph_bitmap& glyph, std::uint64_t seed = k_glyph_hash_seed);
+// width, height and every row only: equal for the same pixels in any font
+std::uint64_t glyph_pixels_hash(const snatch_glyph_bitmap& glyph, std::uint64_t seed = k_glyph_hash_seed);
+
+// $XDG_CACHE_HOME/snatch, else ~/.cache/snatch; empty when neither is known
+std::filesystem::path snatch_user_cache_dir();
+
+// Content-hash -> result bytes, saved next to a stage's output so the next
+// run only recomputes glyphs whose content changed. The tag identifies the
+// settings the results depend on; loading a file with another tag yields an
+// empty cache. save() keeps only entries looked up or stored since the last
+// load, reset or prune, so the file tracks the current glyph set.
+class glyph_cache {
+public:
+    bool load(const std::filesystem::path& path, std::uint64_t tag);
+    bool save(const std::filesystem::path& path) const;
+    // discards entries and adopts a new tag (e.g. settings changed)
+    void reset(std::uint64_t tag);
+
+    std::uint64_t tag() const { return tag_; }
+    const std::vector<std::uint8_t>* find(std::uint64_t key);
+    void put(std::uint64_t key, std::vector<std::uint8_t> value);
+    // forgets entries unused since the last prune, load or reset
+    void prune();
+    // Adds what was put() since the last load or reset to the file at `path`,
+    // keeping whatever other processes wrote there meanwhile. Writers are
+    // serialized through `path`.lock; past `max_entries` the file's own
+    // entries make room first. Merged entries no longer count as fresh.
+    bool merge_into(const std::filesystem::path& path, std::size_t max_entries);
+    // entries put() since the last load or reset
+    std::size_t fresh() const;
+
+    std::size_t size() const { return entries_.size(); }
+    std::size_t hits() const { return hits_; }
+
+private:
+    struct entry {
+        std::vector<std::uint8_t> value;
+        bool used{false};
+        bool fresh{false};
+    };
+    std::unordered_map<std::uint64_t, entry> entries_;
+    std::uint64_t tag_{0};
+    std::size_t hits_{0};
+};
@@ -0,0 +1,42 @@
+/// \file
+/// \brief Run-length and LZ compression of glyph rows for 8-bit decoders.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// Both codes are byte aligned and need no tables, so a Z80 or 6502 decodes
+// them in a few dozen instructions; plugins/compressed_bin/snatch_unpack.c is
+// the reference decoder. The decoder is told the unpacked size.
+//
+// When `cost` is given it receives one entry per input byte: the packed bytes
+// charged to it, which add up to the packed size.
+
+// PackBits-style: a control byte c < 128 is followed by c + 1 literal bytes,
+// c >= 128 by one byte repeated c - 125 times (3..130).
+std::vector<std::uint8_t> rle_pack(const std::uint8_t* data, std::size_t size, std::vector<std::uint32_t>* cost = nullptr);
+
+// LZ77 in sequences: a token byte whose high nibble counts literals and low
+// nibble counts match bytes past 3, either nibble at 15 continuing in bytes
+// added while they are 255; the literals; then, unless the output is
+// complete, a 16-bit little-endian offset back into the output (1..65535).
+// Literals and matches are chosen by a shortest-path parse over the packed
+// size, not greedily. With threads > 1 the match search runs in bands of at
+// least 64 KiB; the output does not depend on `threads`.
+std::vector<std::uint8_t> lz_pack(const std::uint8_t* data, std::size_t size, unsigned threads = 1, std::vector<std::uint32_t>* cost = nullptr);
+
+// lz_pack of one glyph among many: matches may also reach back into
+// `dictionary`, which the decoder holds as if it preceded the output.
+std::vector<std::uint8_t> lz_pack(const std::uint8_t* data, std::size_t size, std::span<const std::uint8_t> dictionary, std::vector<std::uint32_t>* cost = nullptr);
+
+// A dictionary of at most `capacity` bytes (up to 65535) for lz_pack, built
+// from the segments recurring across the most samples.
+std::vector<std::uint8_t> lz_train_dictionary(std::span<const std::span<const std::uint8_t>> samples, std::size_t capacity);
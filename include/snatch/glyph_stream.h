@@ -0,0 +1,141 @@
+/// \file
+/// \brief Host-side glyph stream sinks: collector, fan-out and bounded queue.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "snatch/extracted_font.h"
+#include "snatch/plugin.h"
+
+// owned copy of a stream header or summary
+struct glyph_stream_header {
+    std::string name;
+    snatch_font font{};
+
+    void assign(const snatch_font& from);
+    const snatch_font* get();
+};
+
+// Sink that materializes a stream into a whole font, so streaming plugins
+// can feed whole-font ones.
+class glyph_collector {
+public:
+    glyph_collector();
+    glyph_collector(const glyph_collector&) = delete;
+    glyph_collector& operator=(const glyph_collector&) = delete;
+
+    const snatch_glyph_sink& sink() const { return sink_; }
+    // the collected font; valid while the collector lives
+    snatch_font font() const;
+    // keeps the owner of the header's user_data alive with the result
+    void keep(std::shared_ptr<const void> owner) { keep_ = std::move(owner); }
+
+private:
+    static int on_begin(void* ctx, const snatch_font* header);
+    static int on_glyph(void* ctx, const snatch_glyph_bitmap* glyph);
+    static int on_end(void* ctx, const snatch_font* summary);
+
+    extracted_font font_;
+    const void* user_data_{nullptr};
+    std::shared_ptr<const void> keep_;
+    snatch_glyph_sink sink_{};
+};
+
+// drives a sink with a whole font: begin, every glyph, end (not close).
+// With `source` the glyphs are fetched from it instead of bitmap_font, and
+// the summary gets the glyph cell they span when the header had none.
+int feed_font(const snatch_font& font, const snatch_glyph_sink& sink, const snatch_glyph_source* source = nullptr);
+
+// Fans one stream out to several sinks. A branch that fails is dropped and
+// the others continue; the tee itself fails only when no branch is left.
+class glyph_tee {
+public:
+    struct branch {
+        snatch_glyph_sink sink{};
+        const glyph_tee* own_tee{nullptr}; // the branch's own fan-out, if it has one
+        int rc{0};
+        bool dead{false};
+        bool failed{false}; // dead because of its own error, not its consumers'
+    };
+
+    glyph_tee();
+    glyph_tee(const glyph_tee&) = delete;
+    glyph_tee& operator=(const glyph_tee&) = delete;
+
+    void add(const snatch_glyph_sink& sink, const glyph_tee* own_tee = nullptr);
+    const snatch_glyph_sink& sink() const { return sink_; }
+    const std::vector<branch>& branches() const { return branches_; }
+    bool all_dead() const;
+
+private:
+    template <typename Call>
+    int each(Call&& call);
+    static int on_begin(void* ctx, const snatch_font* header);
+    static int on_glyph(void* ctx, const snatch_glyph_bitmap* glyph);
+    static int on_end(void* ctx, const snatch_font* summary);
+
+    std::vector<branch> branches_;
+    snatch_glyph_sink sink_{};
+};
+
+// Bounded hand-off between a producer thread (the extractor) and a consumer
+// that drives downstream, so both stages run at the same time while at most
+// `capacity` glyphs and, beyond the first of them, `max_bytes` of bitmap
+// data are in flight.
+class glyph_queue {
+public:
+    glyph_queue(const snatch_glyph_sink& downstream, std::size_t capacity, std::size_t max_bytes = SIZE_MAX);
+    glyph_queue(const glyph_queue&) = delete;
+    glyph_queue& operator=(const glyph_queue&) = delete;
+
+    // producer side
+    const snatch_glyph_sink& sink() const { return sink_; }
+    // producer is done (after end, or on failure); pump() returns once drained
+    void finish();
+    // consumer side: forwards items until finish() or a downstream failure
+    void pump();
+
+    bool downstream_failed() const { return downstream_rc_ != 0; }
+    // producer-side counters; read them once the producer returned
+    int glyphs() const { return glyphs_; }
+    int pixel_size() const { return pixel_size_; }
+
+private:
+    enum class item_kind { begin, glyph, end };
+    struct item {
+        item_kind kind{item_kind::glyph};
+        glyph_stream_header header;
+        extracted_glyph glyph;
+    };
+
+    int push(item it);
+    static int on_begin(void* ctx, const snatch_font* header);
+    static int on_glyph(void* ctx, const snatch_glyph_bitmap* glyph);
+    static int on_end(void* ctx, const snatch_font* summary);
+
+    snatch_glyph_sink downstream_;
+    std::size_t capacity_;
+    std::size_t max_bytes_;
+    std::size_t bytes_{0};
+    std::mutex mu_;
+    std::condition_variable cv_;
+    std::deque<item> items_;
+    bool finished_{false};
+    int downstream_rc_{0};
+    int glyphs_{0};
+    int pixel_size_{0};
+    snatch_glyph_sink sink_{};
+};
@@ -37,9 +37,18 @@ struct image_extract_options {
     int first_ascii{-1};
     int last_ascii{-1};
     bool proportional{false};
+
+    // per-cell hash -> glyph sidecar; unchanged cells skip binarization
+    std::filesystem::path cache_file;
+};
+
+struct image_extract_stats {
+    int cells{0};
+    int reused_cells{0}; // taken from cache_file
 };
 
 class img_extractor {
 public:
-    bool extract(const image_extract_options& opt, extracted_font& out, std::string& err) const;
+    bool extract(const image_extract_options& opt, extracted_font& out, std::string& err,
+                 image_extract_stats* stats = nullptr) const;
 };
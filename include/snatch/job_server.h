@@ -0,0 +1,63 @@
+/// \file
+/// \brief Resident pipeline job server and client over a Unix domain socket.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <chrono>
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <string_view>
+
+class plugin_manager;
+
+// Wire protocol, one job per connection. The client writes a request and
+// shuts down its sending side; the server answers and closes.
+//
+//   request:  "snatch-job 1\n" "cwd <dir>\n" "\n" <pipeline text>
+//             "snatch-shutdown 1\n"
+//   response: "snatch-result 1 <exit> <out-bytes> <err-bytes>\n" <out> <err>
+//
+// Relative paths in the pipeline are resolved against the client's cwd.
+class job_server {
+public:
+    // plugins stay loaded for the lifetime of the server
+    job_server(const plugin_manager& plugins, int jobs);
+    ~job_server();
+
+    job_server(const job_server&) = delete;
+    job_server& operator=(const job_server&) = delete;
+
+    // binds and listens; replaces a stale socket file left by a dead server
+    bool open(const std::filesystem::path& socket_path, std::string& err);
+    // a client that has not sent its whole request within this time gets
+    // exit code 3, so one silent client cannot block the server
+    void set_client_timeout(std::chrono::milliseconds timeout) { client_timeout_ = timeout; }
+    // serves jobs one at a time until a shutdown request, SIGINT or SIGTERM,
+    // then closes and removes the socket
+    void run(std::ostream* log = nullptr);
+
+    // executes one request and returns the response bytes
+    std::string handle(std::string_view request, bool& shutdown) const;
+
+private:
+    void close_socket();
+
+    const plugin_manager& plugins_;
+    int jobs_{0};
+    int fd_{-1};
+    std::chrono::milliseconds client_timeout_{10000};
+    std::filesystem::path socket_path_;
+};
+
+// sends pipeline text to a server; copies its output to out/err and
+// returns the job's exit code (3 when the server cannot be reached)
+int submit_pipeline_job(const std::filesystem::path& socket_path, std::string_view pipeline_text,
+                        std::ostream& out, std::ostream& err);
+// asks a server to exit after the job it is running
+int request_server_shutdown(const std::filesystem::path& socket_path, std::ostream& err);
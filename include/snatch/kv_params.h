@@ -0,0 +1,46 @@
+/// \file
+/// \brief Stage parameter string parsing into plugin key/value options.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <array>
+#include <deque>
+#include <initializer_list>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "snatch/plugin.h"
+
+// parses "k=v,k2=v2,flag" into trimmed pairs; a bare token has an empty value.
+std::vector<std::array<std::string, 2>> parse_kv_pairs(const std::string& raw);
+// value of the first pair named key, if any.
+std::optional<std::string> find_kv_value(const std::string& raw, std::string_view key);
+
+// owns the strings behind a snatch_kv array handed to a plugin callback.
+// storage is a deque so snatch_kv pointers stay valid while pairs are added.
+class kv_options {
+public:
+    kv_options() = default;
+    explicit kv_options(const std::string& raw, std::initializer_list<std::string_view> skip_keys = {});
+
+    kv_options(const kv_options&) = delete;
+    kv_options& operator=(const kv_options&) = delete;
+    kv_options(kv_options&&) = default;
+    kv_options& operator=(kv_options&&) = default;
+
+    void add(std::string key, std::string value);
+
+    const snatch_kv* data() const { return items_.empty() ? nullptr : items_.data(); }
+    unsigned size() const { return static_cast<unsigned>(items_.size()); }
+
+private:
+    std::deque<std::array<std::string, 2>> storage_;
+    std::vector<snatch_kv> items_;
+};
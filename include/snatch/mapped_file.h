@@ -0,0 +1,38 @@
+/// \file
+/// \brief Read-only memory mapping of a whole input file.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The bytes of a file, mapped where the platform has mmap and read into
+// memory elsewhere, so parsers can walk them in place.
+class mapped_file {
+public:
+    mapped_file() = default;
+    ~mapped_file();
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+
+    bool open(const std::filesystem::path& path, std::string& err);
+    void close();
+
+    std::span<const unsigned char> bytes() const { return {data_, size_}; }
+    std::string_view text() const { return {reinterpret_cast<const char*>(data_), size_}; }
+
+private:
+    const unsigned char* data_{nullptr};
+    std::size_t size_{0};
+    bool mapped_{false};
+    std::vector<unsigned char> copy_; // without mmap
+};
@@ -9,14 +9,40 @@
 #pragma once
 #include <filesystem>
 #include <string>
+#include <vector>
+
+// one --exporter/--exporter-parameters pair
+struct snatch_exporter_options {
+    std::string exporter;
+    std::string exporter_parameters;
+};
 
 struct snatch_options {
     std::filesystem::path plugin_dir;
 
     std::string extractor;
     std::string extractor_parameters;
-    std::string exporter;
-    std::string exporter_parameters;
+    std::string exporter;             // first exporter (same as exporters.front())
+    std::string exporter_parameters;  // first exporter parameters
     std::string transformer;
     std::string transformer_parameters;
+
+    // all exporter pairs in command line order; each one consumes the
+    // same extracted and transformed font.
+    std::vector<snatch_exporter_options> exporters;
+    int jobs{0}; // max concurrently running pipeline nodes; <=0 means hardware concurrency
+
+    // declarative pipeline file; replaces the per-stage options above
+    std::filesystem::path pipeline_file;
+
+    // resident mode: serve pipeline jobs on a Unix socket, or submit one to it
+    std::filesystem::path serve_socket;
+    std::filesystem::path client_socket;
+    bool shutdown_server{false}; // with client_socket: stop the server
+
+    // keep running and re-run the stages affected by input changes
+    bool watch{false};
+
+    // write plugin_dir's plugin index into plugin_dir, then exit
+    bool index_plugins{false};
 };
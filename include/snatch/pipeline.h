@@ -0,0 +1,131 @@
+/// \file
+/// \brief Declarative pipeline graph and parallel DAG executor interface.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "snatch/plugin.h"
+
+class plugin_manager;
+struct loaded_plugin;
+
+enum class pipeline_stage {
+    extractor,
+    transformer,
+    exporter
+};
+
+// one step of a pipeline. extractors read input=... from their parameters,
+// exporters write output=...; every other node consumes exactly one input node.
+struct pipeline_node {
+    std::string id;
+    pipeline_stage stage{pipeline_stage::extractor};
+    std::string plugin;
+    std::string input;       // upstream node id, empty for extractors
+    std::string parameters;  // k=v,... handed to the plugin
+};
+
+// Text form, one node per line ('#' starts a comment):
+//
+//   <stage> <id> <plugin> <input|-> [parameters]
+//
+// e.g.
+//   extractor   font  ttf_extractor           -     input=Retro.ttf,font_size=16
+//   transformer tiny  partner_tiny_transform  font
+//   exporter    asm   partner_sdcc_asm_tiny   tiny  output=out/tiny.s
+class pipeline_graph {
+public:
+    static bool parse(std::string_view text, pipeline_graph& out, std::string& err);
+    static bool load(const std::filesystem::path& path, pipeline_graph& out, std::string& err);
+
+    bool add(pipeline_node node, std::string& err);
+    // checks node references, stage wiring and plugin reuse rules
+    bool validate(std::string& err) const;
+    std::string to_text() const;
+
+    const std::vector<pipeline_node>& nodes() const { return nodes_; }
+    const pipeline_node* find(std::string_view id) const;
+    // distinct plugin names in node order
+    std::vector<std::string> plugin_names() const;
+
+private:
+    std::vector<pipeline_node> nodes_;
+};
+
+// Results carried between runs of the same graph (watch mode). A node is
+// reused when its plugin, parameters and upstream result are unchanged and,
+// for extractors, the input file has the same mtime and size. Extractor and
+// transformer outputs live in plugin state, so they stay reusable only until
+// that plugin runs again; exporters are reused while their output exists.
+struct pipeline_cache {
+    struct entry {
+        std::string signature;
+        std::uint64_t plugin_run{0}; // plugin run count when the output was made
+        snatch_font font{};
+        std::shared_ptr<const void> owner; // host-side storage behind font, if any
+    };
+    std::map<std::string, entry> nodes;                      // by node id
+    std::map<const loaded_plugin*, std::uint64_t> plugin_runs;
+};
+
+struct pipeline_run_options {
+    int jobs{0};                 // worker threads; <=0 means hardware concurrency
+    std::ostream* log{nullptr};  // progress messages
+    std::ostream* err{nullptr};  // failure messages
+    pipeline_cache* cache{nullptr}; // reuse results of a previous run
+};
+
+struct pipeline_node_result {
+    std::string id;
+    pipeline_stage stage{pipeline_stage::extractor};
+    bool ran{false};     // false when skipped because an upstream node failed
+    int rc{0};
+    std::string error;
+    bool cached{false};  // result reused from pipeline_run_options::cache
+};
+
+struct pipeline_report {
+    std::vector<pipeline_node_result> nodes; // same order as graph nodes
+    bool ok() const;
+    // 0 on success, 4 when an extractor failed, 5 for transformer/exporter failures
+    int exit_code() const;
+};
+
+// Runs a validated graph on a thread pool. Each node runs once; siblings run in
+// parallel. Extractor and transformer plugins keep their output in plugin-owned
+// state, so a node holds its plugin until the last consumer finished, and only
+// then may the plugin run again for another node. Host-side copies are dropped
+// at that point too, which bounds memory to one live output per plugin.
+//
+// Without a cache, an extractor with a streaming entry point whose every
+// descendant streams too runs as one group: glyphs flow through a bounded
+// queue, so exporters write while the extractor still rasterizes. Plugins with
+// only one of the two interfaces are adapted to the other.
+class pipeline_executor {
+public:
+    explicit pipeline_executor(const plugin_manager& plugins);
+
+    pipeline_report run(const pipeline_graph& graph, const pipeline_run_options& options) const;
+
+private:
+    const plugin_manager& plugins_;
+};
+
+const char* pipeline_stage_name(pipeline_stage stage);
+// SNATCH_PLUGIN_KIND_* a node of this stage needs
+int pipeline_plugin_kind(pipeline_stage stage);
+// every node names a loaded plugin of the matching kind
+bool pipeline_plugins_available(const pipeline_graph& graph, const plugin_manager& plugins, std::string& err);
@@ -0,0 +1,59 @@
+/// \file
+/// \brief File watching and incremental pipeline re-runs.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <filesystem>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "snatch/pipeline.h"
+
+class plugin_manager;
+
+// inotify on the parent directories of a set of files. Editors often save by
+// writing a temporary file and renaming it over the original, so directories
+// are watched and events are filtered by file name.
+class file_watcher {
+public:
+    file_watcher();
+    ~file_watcher();
+
+    file_watcher(const file_watcher&) = delete;
+    file_watcher& operator=(const file_watcher&) = delete;
+
+    // replaces the watched set; paths are made absolute against the cwd
+    bool watch(const std::vector<std::filesystem::path>& files, std::string& err);
+    // blocks until a watched file changes, then keeps collecting until no
+    // event arrived for debounce_ms. Returns the changed files; empty when
+    // interrupted by a signal or when timeout_ms (if >= 0) passed first.
+    std::vector<std::filesystem::path> wait(int debounce_ms, int timeout_ms = -1);
+
+private:
+    int fd_{-1};
+    std::vector<int> watches_;
+    std::vector<std::filesystem::path> dirs_;   // parallel to watches_
+    std::vector<std::filesystem::path> files_;
+};
+
+struct pipeline_watch_options {
+    int jobs{0};
+    int debounce_ms{100};
+    std::filesystem::path manifest; // pipeline file, reloaded when it changes
+    std::ostream* log{nullptr};
+    std::ostream* err{nullptr};
+};
+
+// files a graph reads: every extractor input=...
+std::vector<std::filesystem::path> pipeline_inputs(const pipeline_graph& graph);
+
+// Runs the graph, then re-runs it whenever an input or the manifest changes,
+// until SIGINT or SIGTERM. Results are cached between runs, so only nodes
+// downstream of a change execute again. Returns 0 when stopped by a signal.
+int watch_pipeline(const plugin_manager& plugins, pipeline_graph graph, const pipeline_watch_options& options);
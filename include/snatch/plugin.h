@@ -14,7 +14,9 @@ extern "C" {
 #endif
 
 // ABI versioning
-#define SNATCH_PLUGIN_ABI_VERSION 5
+#define SNATCH_PLUGIN_ABI_VERSION 8
+// oldest ABI the host still loads; fields added later read as absent
+#define SNATCH_PLUGIN_ABI_MIN_VERSION 5
 
 // symbol visibility (gcc/clang)
 #if defined(__GNUC__) || defined(__clang__)
@@ -35,9 +37,13 @@ typedef struct snatch_glyph_bitmap {
     const unsigned char* data;  // packed bits (MSB first per byte)
 } snatch_glyph_bitmap;
 
+typedef struct snatch_glyph_source snatch_glyph_source;
+
 typedef struct snatch_bitmap_font {
     int glyph_count;
     const snatch_glyph_bitmap* glyphs;
+    // ABI 8: when glyphs is null, glyph_count glyphs are produced on demand
+    const snatch_glyph_source* source;
 } snatch_bitmap_font;
 
 typedef struct snatch_font {
@@ -93,6 +99,101 @@ typedef int (*snatch_transform_fn)(
     unsigned errbuf_len
 );
 
+// ---- streaming (ABI 6, optional) -------------------------------------------
+//
+// Glyphs flow one at a time through sinks, so an exporter can write glyph N
+// while the extractor rasterizes N+1 and memory stays bounded. Whoever is
+// handed a sink drives it: begin() once, glyph() per glyph, end() once; a
+// nonzero return stops the stream. Whoever opened a sink (the host, for the
+// out_sink of stream_transform/stream_export) closes it exactly once, also
+// after a failure. A transformer never closes its downstream.
+// Stream state lives in ctx: a plugin may have several streams open at once,
+// and streams never touch the output of its whole-font entry points.
+// The host adapts between whole-font and streaming plugins in both directions.
+typedef struct snatch_glyph_sink {
+    void* ctx;
+    // header has no bitmap_font; glyph_width/height may still be 0. Its
+    // user_data must stay valid as long as whole-font output would.
+    int (*begin)(void* ctx, const snatch_font* header);
+    // glyph->data is only valid during the call
+    int (*glyph)(void* ctx, const snatch_glyph_bitmap* glyph);
+    // summary carries the final glyph_width/glyph_height
+    int (*end)(void* ctx, const snatch_font* summary);
+    void (*close)(void* ctx);
+} snatch_glyph_sink;
+
+// streaming extractor: pushes its glyphs into sink (begin..end, not close)
+typedef int (*snatch_stream_extract_fn)(
+    const char* input_path,
+    const snatch_kv* options,
+    unsigned options_count,
+    const snatch_glyph_sink* sink,
+    char* errbuf,
+    unsigned errbuf_len
+);
+
+// streaming transformer: opens *out_sink, which transforms each glyph and
+// forwards it to downstream. errbuf stays valid until out_sink->close returns.
+typedef int (*snatch_stream_transform_fn)(
+    const snatch_kv* options,
+    unsigned options_count,
+    const snatch_glyph_sink* downstream,
+    snatch_glyph_sink* out_sink,
+    char* errbuf,
+    unsigned errbuf_len
+);
+
+// streaming exporter: opens *out_sink, which writes glyphs as they arrive.
+// errbuf stays valid until out_sink->close returns.
+typedef int (*snatch_stream_export_fn)(
+    const char* output_path,
+    const snatch_kv* options,
+    unsigned options_count,
+    snatch_glyph_sink* out_sink,
+    char* errbuf,
+    unsigned errbuf_len
+);
+
+// ---- payload types and capabilities (ABI 7, optional) ---------------------
+//
+// A font carries payloads between stages: glyphs in bitmap_font and at most
+// one typed user_data block. Plugins declare what they accept and produce as
+// masks of these bits, so the host rejects a miswired pipeline before anything
+// runs. 0 means undeclared, which the host never rejects.
+#define SNATCH_PAYLOAD_BITMAP           (1u << 0) // bitmap_font glyphs
+#define SNATCH_PAYLOAD_IMAGE            (1u << 1) // user_data: snatch_image_passthrough_data
+#define SNATCH_PAYLOAD_PARTNER_BITMAP   (1u << 2) // user_data: snatch_partner_bitmap_data
+#define SNATCH_PAYLOAD_PARTNER_TINY     (1u << 3) // user_data: snatch_partner_tiny_data
+#define SNATCH_PAYLOAD_PARTNER_TINY_BIN (1u << 4) // user_data: snatch_partner_tiny_bin_data
+#define SNATCH_PAYLOAD_FZX              (1u << 5) // user_data: snatch_fzx_transform_data
+// in produces: the input's payloads are passed on too (user_data left alone)
+#define SNATCH_PAYLOAD_KEEPS_INPUT      (1u << 31)
+
+#define SNATCH_CAP_THREAD_SAFE (1u << 0) // entry points may run concurrently
+#define SNATCH_CAP_STREAMING   (1u << 1) // has stream_* entry points (the host infers this)
+#define SNATCH_CAP_IN_PLACE    (1u << 2) // transformer only rewrites the font it is handed,
+                                         // keeping no output of its own
+#define SNATCH_CAP_SIMD        (1u << 3) // vectorized hot loops; preferred when choosing
+
+// ---- lazy glyphs (ABI 8, optional) ----------------------------------------
+//
+// An extractor may leave bitmap_font->glyphs null and set source instead, so a
+// stage that looks at a few glyphs of a huge font pays only for those. Each
+// glyph is made on first use. Only stages with SNATCH_CAP_LAZY_GLYPHS see such
+// a font; the host fetches every glyph for the others, and hands lazy-capable
+// stages a bitmap_font whose source field is always present.
+struct snatch_glyph_source {
+    void* ctx;
+    // Fills *out with glyph `index` (0..glyph_count-1) and copies its rows
+    // (stride_bytes * height bytes) into buf when they fit buf_size; otherwise
+    // only the metrics are set and out->data is null. Returns the size of the
+    // rows, or -1 when the glyph cannot be made. Safe to call from several
+    // threads; valid as long as the font is.
+    long (*glyph)(void* ctx, int index, snatch_glyph_bitmap* out, unsigned char* buf, unsigned long buf_size);
+};
+
+#define SNATCH_CAP_LAZY_GLYPHS (1u << 4) // reads bitmap_font->source when glyphs is null
+
 // constant plugin metadata (owned by the plugin; do not free)
 typedef struct snatch_plugin_info {
     const char* name;              // short id, e.g., "txt"
@@ -102,15 +203,35 @@ typedef struct snatch_plugin_info {
     const char* standard;          // exporter standard/profile, e.g. "partner-f","zx-fzx"
     unsigned    abi_version;       // must be SNATCH_PLUGIN_ABI_VERSION
     snatch_plugin_kind kind;       // exporter, transformer or extractor
-    snatch_transform_fn transform_font; // required for transformers
-    snatch_export_fn export_font;  // required for exporters
-    snatch_extract_fn extract_font; // required for extractors
+    snatch_transform_fn transform_font; // transformers: this or stream_transform
+    snatch_export_fn export_font;  // exporters: this or stream_export
+    snatch_extract_fn extract_font; // extractors: this or stream_extract
+    // ABI 6
+    snatch_stream_transform_fn stream_transform;
+    snatch_stream_export_fn stream_export;
+    snatch_stream_extract_fn stream_extract;
+    // ABI 7
+    unsigned accepts;      // SNATCH_PAYLOAD_* consumed (transformers, exporters)
+    unsigned produces;     // SNATCH_PAYLOAD_* output (extractors, transformers)
+    unsigned capabilities; // SNATCH_CAP_*
 } snatch_plugin_info;
 
+// hosts read stream_* only from plugins built against ABI 6 or later
+#define SNATCH_PLUGIN_HAS_STREAMS(info) ((info)->abi_version >= 6)
+// and accepts/produces/capabilities from ABI 7 or later
+#define SNATCH_PLUGIN_HAS_TYPES(info) ((info)->abi_version >= 7)
+// and a bitmap_font with a source field only from ABI 8 or later
+#define SNATCH_PLUGIN_HAS_LAZY_GLYPHS(info) ((info)->abi_version >= 8)
+
 // REQUIRED entry point symbol that snatch looks up with dlsym():
 //   int snatch_plugin_get(const snatch_plugin_info** out);
 // Returns 0 on success, nonzero on failure. *out must point to a static object.
-SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out);
+// Define it as SNATCH_PLUGIN_ENTRY: a SNATCH_STATIC_PLUGINS build links every
+// plugin into the executable and gives each entry point a unique name.
+#ifndef SNATCH_PLUGIN_ENTRY
+#define SNATCH_PLUGIN_ENTRY snatch_plugin_get
+#endif
+SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -10,22 +10,67 @@
 #include <string>
 #include <vector>
 #include <memory>
+#include <mutex>
+#include <cstddef>
 #include <filesystem>
+#include <string_view>
+#include <unordered_map>
 
 struct snatch_plugin_info; // from the C header
 
+// entry point of a plugin compiled into the executable (SNATCH_STATIC_PLUGINS)
+struct builtin_plugin {
+    const char* target;
+    int (*get)(const snatch_plugin_info** out);
+};
+
 struct loaded_plugin {
-    void* handle = nullptr;                 // dlopen handle
-    const snatch_plugin_info* info = nullptr;
+    // metadata; read from the directory's plugin index when it is current,
+    // so listing and lookup do not need to load the plugin
+    std::string name;
+    int kind = 0;
+    unsigned abi_version = 0;  // the ABI the plugin was built against
+    std::string format;
+    std::string standard;
+    unsigned accepts = 0;      // SNATCH_PAYLOAD_*; 0 when undeclared
+    unsigned produces = 0;
+    unsigned capabilities = 0; // SNATCH_CAP_*, including what the host infers
     std::filesystem::path path;
+
+    // filled in when the plugin is opened: find_* open plugins on demand
+    mutable void* handle = nullptr;                 // dlopen handle
+    mutable const snatch_plugin_info* info = nullptr;
 };
 
+// payload `plugin` passes on when fed `input` (0: unknown)
+unsigned plugin_output_payload(const loaded_plugin& plugin, unsigned input);
+// whether `plugin` can consume `payload`; unknown on either side is accepted
+bool plugin_accepts_payload(const loaded_plugin& plugin, unsigned payload);
+// "bitmap|partner-tiny" style names for messages
+std::string plugin_payload_names(unsigned payload);
+
+// Every scanned directory keeps an index of its plugins' metadata, keyed by
+// file size and mtime, under $XDG_CACHE_HOME/snatch. A ".snatch-plugin-index"
+// written into the directory at install time is used until the cache has
+// one. Only plugins the index does not describe yet are loaded during a scan.
 class plugin_manager {
 public:
+    plugin_manager() = default;
     ~plugin_manager();
 
+    plugin_manager(const plugin_manager&) = delete;
+    plugin_manager& operator=(const plugin_manager&) = delete;
+
+    // Registers the plugins linked into the executable, once at startup.
+    // The *_in_order lookups consult them before any directory: names
+    // that are built in are never searched for on disk.
+    static void set_builtin_plugins(const builtin_plugin* table, std::size_t count);
+
     // scan a directory for *.so and load plugins
     void load_from_dir(const std::filesystem::path& dir);
+    // Scans dir like load_from_dir and writes its index into dir itself, for
+    // an install step. False when nothing was found or it cannot be written.
+    bool write_installed_index(const std::filesystem::path& dir);
     // load specific plugin file names from a directory (name -> name.so)
     void load_named_from_dir(const std::filesystem::path& dir, const std::vector<std::string>& names);
     // scan directories in order and stop at the first directory
@@ -38,12 +83,35 @@ public:
         const std::vector<std::string>& names
     );
 
+    // every known plugin; info is null for plugins not opened yet
     const std::vector<loaded_plugin>& plugins() const { return plugins_; }
+    // lookups return opened plugins only (info set), opening them on first use
     const loaded_plugin* find_by_name(const std::string& name) const;
     const loaded_plugin* find_by_name_and_kind(const std::string& name, int kind) const;
     const loaded_plugin* find_first_by_kind(int kind) const;
+    // Best plugin of a kind that accepts `input` (SNATCH_PAYLOAD_*, 0 for
+    // any) and, unless empty, has this format. SIMD beats streaming beats
+    // thread-safe; ties go to discovery order. Only the winner is opened.
+    const loaded_plugin* find_best(int kind, unsigned input, std::string_view format = {}) const;
 
 private:
-    bool load_plugin_file(const std::filesystem::path& path);
+    // false when the index could not be brought up to date
+    bool scan_dir(const std::filesystem::path& dir, const std::vector<std::string>* names, bool install_index = false);
+    bool open_plugin(const loaded_plugin& plugin) const;
+    void add_builtins(const std::vector<std::string>* names);
+    void unload_all();
+    void reindex();
+
+    static constexpr std::size_t k_none = static_cast<std::size_t>(-1);
+    static constexpr int k_kind_slots = 4; // snatch_plugin_kind values are 1..3
+    // positions in plugins_ of the first plugin with a name (of each kind)
+    struct name_slots {
+        std::size_t any{k_none};
+        std::size_t by_kind[k_kind_slots]{k_none, k_none, k_none, k_none};
+    };
+
     std::vector<loaded_plugin> plugins_;
+    std::unordered_map<std::string, name_slots> by_name_;
+    std::vector<std::size_t> by_kind_[k_kind_slots];
+    mutable std::mutex open_mutex_;
 };
@@ -0,0 +1,107 @@
+/// \file
+/// \brief Incremental PNG decoding, one row at a time.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Pull-driven inflate over a byte source: produces as many bytes as asked and
+// keeps only the 32 KiB window between calls.
+class inflate_stream {
+public:
+    // returns the next compressed byte, or -1 at the end of the input
+    using byte_source = int (*)(void* ctx);
+
+    inflate_stream(byte_source source, void* ctx);
+
+    // reads the two byte zlib header; false if it is not deflate
+    bool read_zlib_header();
+    // fills `dst` completely; false on corrupt or truncated data
+    bool read(std::uint8_t* dst, std::size_t n);
+    const std::string& error() const { return error_; }
+
+private:
+    struct huffman {
+        static constexpr int fast_bits = 9;
+        std::array<std::uint16_t, 1u << fast_bits> fast{}; // symbol << 4 | length, 0 if longer
+        std::array<std::uint16_t, 16> count{};
+        std::vector<std::uint16_t> symbols;
+        bool build(const std::uint8_t* lengths, int n);
+    };
+
+    bool need(int bits);
+    std::uint32_t bits(int n);
+    int decode(const huffman& h);
+    bool start_block();
+    bool read_dynamic_tables();
+    bool fail(const char* what);
+    void put(std::uint8_t b);
+
+    byte_source source_;
+    void* ctx_;
+    std::uint64_t bitbuf_{0};
+    int bitcnt_{0};
+    int overrun_{0}; // zero bytes invented past the end of the input
+
+    std::vector<std::uint8_t> window_;
+    std::size_t pos_{0};
+    bool final_{false};
+    int block_{-1}; // -1 between blocks, else BTYPE
+    std::uint32_t stored_left_{0};
+    int copy_left_{0};
+    std::uint32_t copy_dist_{0};
+    huffman lit_;
+    huffman dist_;
+    std::string error_;
+};
+
+// Decodes a non-interlaced PNG a row at a time, converted to 8-bit gray the
+// way stb_image does, so memory stays at two rows whatever the image size.
+class png_row_reader {
+public:
+    png_row_reader();
+
+    // larger images are refused before anything is allocated; callers that
+    // keep the whole image stay within a few hundred MiB
+    static constexpr std::uint32_t k_max_side = 65535;
+    static constexpr std::uint64_t k_max_pixels = std::uint64_t{1} << 28;
+
+    // false if the file is not a PNG this reader handles (e.g. interlaced)
+    bool open(const std::filesystem::path& path);
+    int width() const { return width_; }
+    int height() const { return height_; }
+    // next row, width() bytes; false on corrupt data or past the last row
+    bool read_gray_row(std::uint8_t* dst);
+    const std::string& error() const;
+
+private:
+    static int next_idat_byte(void* ctx);
+
+    std::ifstream in_;
+    std::uint32_t chunk_left_{0};
+    bool idat_done_{false};
+    inflate_stream inflate_;
+    int width_{0};
+    int height_{0};
+    int depth_{0};
+    int color_{0};
+    int channels_{0};
+    std::size_t bpp_{1};       // bytes per complete pixel, at least 1, for filtering
+    std::size_t row_bytes_{0};
+    int row_{0};
+    std::vector<std::uint8_t> palette_;
+    std::vector<std::uint8_t> prev_;
+    std::vector<std::uint8_t> cur_;
+    std::string error_;
+};
@@ -0,0 +1,41 @@
+/// \file
+/// \brief Deflate compression and PNG encoding, including 1-, 2- and 4-bit palettes.
+///
+/// This header declares types and contracts used by snatch core and plugin stages. It is part of the extractor-transformer-exporter architecture and is consumed by build-time and runtime plugin integration.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// zlib stream of `data`; level 0 only stores, 1 searches least, 9 hardest.
+// With threads > 1, blocks of at least 256 KiB are deflated concurrently and
+// joined into the one stream, which costs a little compression per block.
+std::vector<std::uint8_t> zlib_compress(const std::uint8_t* data, std::size_t size, int level = 6, unsigned threads = 1);
+
+struct png_rgb {
+    std::uint8_t r{0};
+    std::uint8_t g{0};
+    std::uint8_t b{0};
+};
+
+// An image as PNG stores it: `height` rows of `stride` bytes, each already
+// packed for bit_depth and color_type (MSB-first below 8 bits).
+struct png_image_view {
+    int width{0};
+    int height{0};
+    int bit_depth{8};
+    int color_type{2}; // 0 gray, 2 RGB, 3 palette
+    const std::uint8_t* rows{nullptr};
+    std::size_t stride{0};
+    std::vector<png_rgb> palette; // color_type 3, at most 2^bit_depth entries
+};
+
+// Rows are stored unfiltered, which is what palette and sub-byte images want.
+bool png_write(const std::filesystem::path& path, const png_image_view& image, int level, unsigned threads, std::string& error);
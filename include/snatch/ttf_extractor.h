@@ -8,8 +8,13 @@
 
 #pragma once
 
+#include <cstddef>
 #include <filesystem>
+#include <functional>
+#include <list>
+#include <mutex>
 #include <string>
+#include <unordered_map>
 
 #include "snatch/extracted_font.h"
 
@@ -24,7 +29,48 @@ struct ttf_extract_options {
 class ttf_extractor {
 public:
     bool extract(const ttf_extract_options& opt, extracted_font& out, std::string& err) const;
+    // Rasterizes one glyph at a time without keeping them: on_begin sees the
+    // font header, on_glyph each glyph in codepoint order. Either callback may
+    // stop extraction by returning false. `header` ends with the final glyph
+    // cell size.
+    bool extract_each(const ttf_extract_options& opt, extracted_font& header,
+                      const std::function<bool(const extracted_font&)>& on_begin,
+                      const std::function<bool(extracted_glyph&)>& on_glyph, std::string& err) const;
 
 private:
+    friend class ttf_lazy_font;
+
+    // opens the face under the caller's lock and fills the header (no glyphs)
+    static void* open_face(const ttf_extract_options& opt, extracted_font& header, std::string& err);
     static int choose_natural_size(void* ft_face);
 };
+
+// Glyph i of first..last rasterized only when asked for, the most recently
+// used kept in an LRU of `capacity` glyphs. glyph() may be called from
+// several threads; rasterization itself is serialized with all extraction.
+class ttf_lazy_font {
+public:
+    explicit ttf_lazy_font(std::size_t capacity = 1024);
+    ttf_lazy_font(const ttf_lazy_font&) = delete;
+    ttf_lazy_font& operator=(const ttf_lazy_font&) = delete;
+
+    // `header` gets the name, range and size; its glyph cell stays 0x0
+    bool open(const ttf_extract_options& opt, extracted_font& header, std::string& err);
+    int glyph_count() const { return last_ - first_ + 1; }
+    bool glyph(int index, extracted_glyph& out, std::string& err);
+    // glyphs rasterized so far, counting those rasterized again after eviction
+    std::size_t rasterized() const;
+
+private:
+    using lru_list = std::list<std::pair<int, extracted_glyph>>;
+
+    ttf_extract_options opt_;
+    int first_{0};
+    int last_{-1};
+    int size_{0};
+    std::size_t capacity_;
+    mutable std::mutex mu_;
+    lru_list used_; // most recent first
+    std::unordered_map<int, lru_list::iterator> index_;
+    std::size_t rasterized_{0};
+};
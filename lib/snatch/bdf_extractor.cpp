@@ -0,0 +1,583 @@
+/// \file
+/// \brief Parsing of X11 BDF and PCF bitmap fonts from a memory-mapped file.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/bdf_extractor.h"
+#include "snatch/mapped_file.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+// BBX and metrics larger than this are taken for a damaged file
+constexpr int k_max_glyph_side = 4096;
+
+// Glyphs of the requested range, their rows appended to out.pixels. Rows are
+// addressed by offset until finish(), as the block may move while it grows.
+class glyph_builder {
+public:
+    glyph_builder(const bdf_extract_options& opt, extracted_font& out) : opt_(opt), out_(out) {
+        out_.pixels.clear();
+        out_.glyph_views.clear();
+    }
+
+    /// \brief glyph_builder::wanted.
+    bool wanted(long codepoint) const {
+        if (codepoint < 0 || codepoint > 0x10FFFF) return false;
+        if (opt_.first_ascii >= 0 && codepoint < opt_.first_ascii) return false;
+        return opt_.last_ascii < 0 || codepoint <= opt_.last_ascii;
+    }
+
+    /// \brief glyph_builder::reserve.
+    void reserve(std::size_t glyphs) { recs_.reserve(glyphs); }
+
+    /// \brief glyph_builder::add.
+    // zeroed rows at (width + 7) / 8 bytes, valid until the next add
+    unsigned char* add(int codepoint, int width, int height, int bearing_x, int bearing_y, int advance_x) {
+        rec r;
+        r.view.codepoint = codepoint;
+        r.view.width = width;
+        r.view.height = height;
+        r.view.bearing_x = bearing_x;
+        r.view.bearing_y = bearing_y;
+        r.view.advance_x = advance_x;
+        r.view.stride_bytes = (width + 7) / 8;
+        r.offset = out_.pixels.size();
+        recs_.push_back(r);
+        out_.pixels.resize(r.offset + static_cast<std::size_t>(r.view.stride_bytes) * static_cast<std::size_t>(height), 0);
+        return out_.pixels.data() + r.offset;
+    }
+
+    /// \brief glyph_builder::finish.
+    // codepoint order, the first glyph of a codepoint kept
+    bool finish(std::string& err) {
+        std::stable_sort(recs_.begin(), recs_.end(), [](const rec& a, const rec& b) { return a.view.codepoint < b.view.codepoint; });
+        recs_.erase(std::unique(recs_.begin(), recs_.end(), [](const rec& a, const rec& b) { return a.view.codepoint == b.view.codepoint; }),
+                    recs_.end());
+        if (recs_.empty()) {
+            err = "no glyphs in the requested range";
+            return false;
+        }
+        out_.glyph_views.reserve(recs_.size());
+        for (rec& r : recs_) {
+            const bool empty = r.view.width == 0 || r.view.height == 0;
+            r.view.data = empty ? nullptr : out_.pixels.data() + r.offset;
+            out_.glyph_width = std::max(out_.glyph_width, r.view.width);
+            out_.glyph_height = std::max(out_.glyph_height, r.view.height);
+            out_.glyph_views.push_back(r.view);
+        }
+        out_.first_codepoint = recs_.front().view.codepoint;
+        out_.last_codepoint = recs_.back().view.codepoint;
+        out_.bitmap_view = {};
+        out_.bitmap_view.glyph_count = static_cast<int>(out_.glyph_views.size());
+        out_.bitmap_view.glyphs = out_.glyph_views.data();
+        return true;
+    }
+
+private:
+    struct rec {
+        snatch_glyph_bitmap view{};
+        std::size_t offset{0};
+    };
+
+    const bdf_extract_options& opt_;
+    extracted_font& out_;
+    std::vector<rec> recs_;
+};
+
+/// \brief font_name.
+std::string font_name(std::string_view family, std::string_view weight, std::string_view fallback) {
+    if (family.empty()) return std::string(fallback);
+    std::string name(family);
+    if (!weight.empty()) {
+        name += ' ';
+        name += weight;
+    }
+    return name;
+}
+
+/// \brief clear_tail.
+// bits past the width of a row are not part of the glyph
+void clear_tail(unsigned char* row, int width) {
+    if (width % 8 != 0) row[(width - 1) / 8] &= static_cast<unsigned char>(0xFFu << (8 - width % 8));
+}
+
+// ---- BDF ----------------------------------------------------------------
+
+/// \brief next_line.
+// the line starting at `at`, without its line break; moves `at` past it
+std::string_view next_line(std::string_view text, std::size_t& at) {
+    const std::size_t start = at;
+    std::size_t end = text.find('\n', start);
+    if (end == std::string_view::npos) end = text.size();
+    at = end + 1;
+    std::string_view line = text.substr(start, end - start);
+    if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+    return line;
+}
+
+/// \brief take_token.
+// the first blank-separated word of `s`, which keeps the rest
+std::string_view take_token(std::string_view& s) {
+    const std::size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) {
+        s = {};
+        return {};
+    }
+    std::size_t end = s.find_first_of(" \t", begin);
+    if (end == std::string_view::npos) end = s.size();
+    const std::string_view token = s.substr(begin, end - begin);
+    s.remove_prefix(end);
+    return token;
+}
+
+/// \brief take_int.
+bool take_int(std::string_view& s, int& value) {
+    const std::string_view token = take_token(s);
+    const char* end = token.data() + token.size();
+    const auto res = std::from_chars(token.data(), end, value);
+    return !token.empty() && res.ec == std::errc() && res.ptr == end;
+}
+
+/// \brief unquote.
+// a property value: trimmed, without its surrounding quotes
+std::string_view unquote(std::string_view s) {
+    const std::size_t begin = s.find_first_not_of(" \t");
+    if (begin == std::string_view::npos) return {};
+    s.remove_prefix(begin);
+    while (!s.empty() && (s.back() == ' ' || s.back() == '\t')) s.remove_suffix(1);
+    if (s.size() >= 2 && s.front() == '"' && s.back() == '"') s = s.substr(1, s.size() - 2);
+    return s;
+}
+
+/// \brief hex_value.
+inline int hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+/// \brief parse_bdf.
+// one pass over the mapped text; lines and words are views into it
+bool parse_bdf(std::string_view text, glyph_builder& glyphs, extracted_font& out, std::string& err) {
+    std::string_view family;
+    std::string_view weight;
+    std::string_view font;
+    int pixel_size = 0;
+    int box_height = 0;
+    int font_advance = 0;
+
+    bool in_char = false;
+    bool in_bitmap = false;
+    bool added = false;
+    int codepoint = -1;
+    int w = 0, h = 0, bx = 0, by = 0, advance = 0;
+    int row = 0;
+    unsigned char* rows = nullptr;
+
+    std::size_t at = 0;
+    int line_no = 0;
+    const auto fail = [&](const char* what) {
+        err = std::string("malformed BDF at line ") + std::to_string(line_no) + ": " + what;
+        return false;
+    };
+    bool started = false;
+    while (at < text.size()) {
+        std::string_view rest = next_line(text, at);
+        ++line_no;
+
+        if (in_bitmap) {
+            if (rest.substr(0, 7) == "ENDCHAR") {
+                in_bitmap = in_char = false;
+                continue;
+            }
+            if (!rows || row >= h) {
+                ++row;
+                continue;
+            }
+            // rows may carry more digits than the width needs, or fewer
+            unsigned char* dst = rows + static_cast<std::size_t>(row) * static_cast<std::size_t>((w + 7) / 8);
+            for (int b = 0; b < (w + 7) / 8 && static_cast<std::size_t>(2 * b + 1) < rest.size(); ++b) {
+                const int hi = hex_value(rest[static_cast<std::size_t>(2 * b)]);
+                const int lo = hex_value(rest[static_cast<std::size_t>(2 * b + 1)]);
+                if (hi < 0 || lo < 0) return fail("bad bitmap row");
+                dst[b] = static_cast<unsigned char>(hi << 4 | lo);
+            }
+            clear_tail(dst, w);
+            ++row;
+            continue;
+        }
+
+        const std::string_view key = take_token(rest);
+        if (!started) {
+            if (key.empty() || key == "COMMENT") continue;
+            if (key != "STARTFONT") {
+                err = "not a BDF or PCF font";
+                return false;
+            }
+            started = true;
+        } else if (key == "FONT") {
+            font = unquote(rest);
+        } else if (key == "FAMILY_NAME") {
+            family = unquote(rest);
+        } else if (key == "WEIGHT_NAME") {
+            weight = unquote(rest);
+        } else if (key == "PIXEL_SIZE") {
+            if (!take_int(rest, pixel_size)) return fail("bad PIXEL_SIZE");
+        } else if (key == "FONTBOUNDINGBOX") {
+            int box_width = 0;
+            if (!take_int(rest, box_width) || !take_int(rest, box_height)) return fail("bad FONTBOUNDINGBOX");
+        } else if (key == "CHARS") {
+            int count = 0;
+            if (take_int(rest, count) && count > 0) glyphs.reserve(static_cast<std::size_t>(count));
+        } else if (key == "STARTCHAR") {
+            in_char = true;
+            added = false;
+            codepoint = -1;
+            w = h = bx = by = 0;
+            advance = font_advance;
+        } else if (key == "ENCODING") {
+            // -1 is an unencoded glyph, which no codepoint reaches
+            if (!take_int(rest, codepoint)) return fail("bad ENCODING");
+        } else if (key == "DWIDTH") {
+            int& target = in_char ? advance : font_advance;
+            if (!take_int(rest, target)) return fail("bad DWIDTH");
+        } else if (key == "BBX") {
+            if (!take_int(rest, w) || !take_int(rest, h) || !take_int(rest, bx) || !take_int(rest, by)) return fail("bad BBX");
+            if (w < 0 || h < 0 || w > k_max_glyph_side || h > k_max_glyph_side) return fail("BBX out of range");
+        } else if (key == "BITMAP") {
+            if (!in_char) return fail("BITMAP outside a glyph");
+            in_bitmap = true;
+            row = 0;
+            rows = nullptr;
+            if (glyphs.wanted(codepoint)) {
+                // BBX gives the offset of the bottom row; glyphs carry the top one
+                rows = glyphs.add(codepoint, w, h, bx, by + h, advance);
+                added = true;
+            }
+        } else if (key == "ENDCHAR") {
+            if (in_char && !added && glyphs.wanted(codepoint)) glyphs.add(codepoint, 0, 0, 0, 0, advance);
+            in_char = false;
+        } else if (key == "ENDFONT") {
+            break;
+        }
+    }
+    if (!started) {
+        err = "not a BDF or PCF font";
+        return false;
+    }
+    if (in_char) return fail("glyph not closed by ENDCHAR");
+    if (!glyphs.finish(err)) return false;
+
+    out.name = font_name(family, weight, font);
+    out.pixel_size = pixel_size > 0 ? pixel_size : box_height > 0 ? box_height : out.glyph_height;
+    return true;
+}
+
+// ---- PCF ----------------------------------------------------------------
+
+constexpr std::uint32_t k_pcf_properties = 1u << 0;
+constexpr std::uint32_t k_pcf_metrics = 1u << 2;
+constexpr std::uint32_t k_pcf_bitmaps = 1u << 3;
+constexpr std::uint32_t k_pcf_bdf_encodings = 1u << 5;
+
+constexpr std::uint32_t k_pcf_format_mask = 0xFFFFFF00u;
+constexpr std::uint32_t k_pcf_compressed_metrics = 0x100u;
+constexpr std::uint32_t k_pcf_byte_msb = 1u << 2;
+constexpr std::uint32_t k_pcf_bit_msb = 1u << 3;
+
+constexpr std::uint16_t k_pcf_no_glyph = 0xFFFF;
+
+// A PCF table: a little-endian format word, then values in the byte order
+// the format names. Reads past the end yield 0 and clear ok().
+class pcf_table {
+public:
+    explicit pcf_table(std::span<const unsigned char> bytes) : bytes_(bytes) {
+        for (int i = 0; i < 4; ++i) format_ |= static_cast<std::uint32_t>(u8()) << (8 * i);
+    }
+
+    std::uint32_t format() const { return format_; }
+    bool ok() const { return ok_; }
+    std::size_t at() const { return at_; }
+
+    /// \brief pcf_table::u8.
+    std::uint8_t u8() {
+        if (at_ >= bytes_.size()) {
+            ok_ = false;
+            return 0;
+        }
+        return bytes_[at_++];
+    }
+
+    /// \brief pcf_table::u16.
+    std::uint16_t u16() {
+        const std::uint16_t a = u8();
+        const std::uint16_t b = u8();
+        return static_cast<std::uint16_t>((format_ & k_pcf_byte_msb) ? (a << 8 | b) : (b << 8 | a));
+    }
+
+    /// \brief pcf_table::i32.
+    std::int32_t i32() {
+        const std::uint32_t a = u16();
+        const std::uint32_t b = u16();
+        return static_cast<std::int32_t>((format_ & k_pcf_byte_msb) ? (a << 16 | b) : (b << 16 | a));
+    }
+
+    std::int16_t i16() { return static_cast<std::int16_t>(u16()); }
+
+    /// \brief pcf_table::skip.
+    void skip(std::size_t n) {
+        if (n > bytes_.size() - std::min(at_, bytes_.size())) ok_ = false;
+        at_ = std::min(bytes_.size(), at_ + n);
+    }
+
+    /// \brief pcf_table::rest.
+    std::span<const unsigned char> rest() const { return bytes_.subspan(std::min(at_, bytes_.size())); }
+
+private:
+    std::span<const unsigned char> bytes_;
+    std::uint32_t format_{0};
+    std::size_t at_{0};
+    bool ok_{true};
+};
+
+/// \brief get_le32.
+std::uint32_t get_le32(const unsigned char* p) {
+    return static_cast<std::uint32_t>(p[0]) | static_cast<std::uint32_t>(p[1]) << 8 | static_cast<std::uint32_t>(p[2]) << 16 |
+           static_cast<std::uint32_t>(p[3]) << 24;
+}
+
+/// \brief find_table.
+// the bytes of the first table of `type`, empty when the font has none
+std::span<const unsigned char> find_table(std::span<const unsigned char> file, std::uint32_t type) {
+    const std::uint32_t count = get_le32(file.data() + 4);
+    for (std::uint32_t i = 0; i < count && 8 + (i + 1) * 16ull <= file.size(); ++i) {
+        const unsigned char* e = file.data() + 8 + i * 16;
+        if (get_le32(e) != type) continue;
+        const std::uint64_t size = get_le32(e + 8);
+        const std::uint64_t offset = get_le32(e + 12);
+        if (offset + size > file.size()) return {};
+        return file.subspan(static_cast<std::size_t>(offset), static_cast<std::size_t>(size));
+    }
+    return {};
+}
+
+struct pcf_metric {
+    int left{0};
+    int right{0};
+    int advance{0};
+    int ascent{0};
+    int descent{0};
+};
+
+/// \brief read_pcf_metrics.
+bool read_pcf_metrics(pcf_table& t, std::vector<pcf_metric>& out) {
+    if ((t.format() & k_pcf_format_mask) == k_pcf_compressed_metrics) {
+        const int count = static_cast<std::uint16_t>(t.i16());
+        out.resize(static_cast<std::size_t>(count));
+        for (pcf_metric& m : out) {
+            m.left = t.u8() - 0x80;
+            m.right = t.u8() - 0x80;
+            m.advance = t.u8() - 0x80;
+            m.ascent = t.u8() - 0x80;
+            m.descent = t.u8() - 0x80;
+        }
+    } else {
+        const std::int32_t count = t.i32();
+        if (count < 0 || static_cast<std::size_t>(count) > t.rest().size() / 12) return false;
+        out.resize(static_cast<std::size_t>(count));
+        for (pcf_metric& m : out) {
+            m.left = t.i16();
+            m.right = t.i16();
+            m.advance = t.i16();
+            m.ascent = t.i16();
+            m.descent = t.i16();
+            t.u16(); // attributes
+        }
+    }
+    return t.ok();
+}
+
+/// \brief read_pcf_properties.
+// the few properties snatch uses: FAMILY_NAME, WEIGHT_NAME and PIXEL_SIZE
+void read_pcf_properties(pcf_table t, std::string_view& family, std::string_view& weight, int& pixel_size) {
+    const std::int32_t count = t.i32();
+    if (count <= 0 || static_cast<std::size_t>(count) > t.rest().size() / 9) return;
+    // entries of name offset, string flag and value (a string offset when
+    // flagged), padded to 4 bytes, then the strings they point into
+    pcf_table entries = t;
+    t.skip(static_cast<std::size_t>(count) * 9);
+    if (count % 4 != 0) t.skip(static_cast<std::size_t>(4 - count % 4));
+    const std::int32_t strings_size = t.i32();
+    const std::span<const unsigned char> rest = t.rest();
+    if (!t.ok() || strings_size < 0 || static_cast<std::size_t>(strings_size) > rest.size()) return;
+    const std::string_view strings(reinterpret_cast<const char*>(rest.data()), static_cast<std::size_t>(strings_size));
+    const auto string_at = [&](std::int32_t offset) -> std::string_view {
+        if (offset < 0 || static_cast<std::size_t>(offset) >= strings.size()) return {};
+        const std::string_view s = strings.substr(static_cast<std::size_t>(offset));
+        return s.substr(0, s.find('\0'));
+    };
+
+    for (std::int32_t i = 0; i < count; ++i) {
+        const std::string_view name = string_at(entries.i32());
+        const bool is_string = entries.u8() != 0;
+        const std::int32_t value = entries.i32();
+        if (name == "FAMILY_NAME" && is_string) family = string_at(value);
+        else if (name == "WEIGHT_NAME" && is_string) weight = string_at(value);
+        else if (name == "PIXEL_SIZE" && !is_string) pixel_size = value;
+    }
+}
+
+/// \brief pcf_row_bytes.
+// the rows of a PCF bitmap are padded to 1, 2, 4 or 8 bytes
+std::size_t pcf_row_bytes(int width, std::uint32_t format) {
+    const std::size_t pad = std::size_t{1} << (format & 3);
+    return ((static_cast<std::size_t>(width) + 7) / 8 + pad - 1) / pad * pad;
+}
+
+/// \brief to_msb_row.
+// a PCF row as snatch keeps it: bits MSB first, bytes left to right
+void to_msb_row(unsigned char* row, std::size_t size, std::uint32_t format) {
+    if (!(format & k_pcf_bit_msb)) {
+        for (std::size_t i = 0; i < size; ++i) {
+            unsigned char b = row[i];
+            b = static_cast<unsigned char>((b & 0xF0) >> 4 | (b & 0x0F) << 4);
+            b = static_cast<unsigned char>((b & 0xCC) >> 2 | (b & 0x33) << 2);
+            row[i] = static_cast<unsigned char>((b & 0xAA) >> 1 | (b & 0x55) << 1);
+        }
+    }
+    // bytes are stored in scan units, in the byte order when it differs
+    // from the bit order
+    const std::size_t unit = std::size_t{1} << ((format >> 4) & 3);
+    if (unit > 1 && !(format & k_pcf_byte_msb) != !(format & k_pcf_bit_msb)) {
+        for (std::size_t i = 0; i + unit <= size; i += unit) std::reverse(row + i, row + i + unit);
+    }
+}
+
+/// \brief parse_pcf.
+bool parse_pcf(std::span<const unsigned char> file, glyph_builder& glyphs, extracted_font& out, std::string& err) {
+    const std::span<const unsigned char> metrics_bytes = find_table(file, k_pcf_metrics);
+    const std::span<const unsigned char> bitmaps_bytes = find_table(file, k_pcf_bitmaps);
+    const std::span<const unsigned char> encodings_bytes = find_table(file, k_pcf_bdf_encodings);
+    if (metrics_bytes.size() < 4 || bitmaps_bytes.size() < 4 || encodings_bytes.size() < 4) {
+        err = "malformed PCF: metrics, bitmap or encoding table missing";
+        return false;
+    }
+
+    std::vector<pcf_metric> metrics;
+    pcf_table metrics_table(metrics_bytes);
+    if (!read_pcf_metrics(metrics_table, metrics)) {
+        err = "malformed PCF: bad metrics table";
+        return false;
+    }
+
+    // the offset of every glyph's rows into the bitmap data
+    pcf_table bitmaps(bitmaps_bytes);
+    const std::int32_t bitmap_count = bitmaps.i32();
+    if (bitmap_count < 0 || static_cast<std::size_t>(bitmap_count) > bitmaps.rest().size() / 4) {
+        err = "malformed PCF: bad bitmap table";
+        return false;
+    }
+    std::vector<std::uint32_t> offsets(static_cast<std::size_t>(bitmap_count));
+    for (std::uint32_t& o : offsets) o = static_cast<std::uint32_t>(bitmaps.i32());
+    std::int32_t sizes[4];
+    for (std::int32_t& size : sizes) size = bitmaps.i32();
+    const std::uint32_t format = bitmaps.format();
+    const std::span<const unsigned char> data = bitmaps.rest().first(std::min<std::size_t>(bitmaps.rest().size(), static_cast<std::uint32_t>(sizes[format & 3])));
+    if (!bitmaps.ok()) {
+        err = "malformed PCF: bad bitmap table";
+        return false;
+    }
+
+    pcf_table encodings(encodings_bytes);
+    const int min_byte2 = encodings.i16();
+    const int max_byte2 = encodings.i16();
+    const int min_byte1 = encodings.i16();
+    const int max_byte1 = encodings.i16();
+    encodings.i16(); // default char
+    if (!encodings.ok() || min_byte2 < 0 || max_byte2 > 255 || min_byte1 < 0 || max_byte1 > 255) {
+        err = "malformed PCF: bad encoding table";
+        return false;
+    }
+
+    const std::size_t glyph_count = std::min(metrics.size(), offsets.size());
+    std::vector<unsigned char> row;
+    for (int byte1 = min_byte1; byte1 <= max_byte1; ++byte1) {
+        for (int byte2 = min_byte2; byte2 <= max_byte2; ++byte2) {
+            const std::uint16_t index = encodings.u16();
+            if (!encodings.ok()) break;
+            const int codepoint = byte1 << 8 | byte2;
+            if (index == k_pcf_no_glyph || index >= glyph_count || !glyphs.wanted(codepoint)) continue;
+
+            const pcf_metric& m = metrics[index];
+            const int w = m.right - m.left;
+            const int h = m.ascent + m.descent;
+            if (w < 0 || h < 0 || w > k_max_glyph_side || h > k_max_glyph_side) {
+                err = "malformed PCF: glyph metrics out of range";
+                return false;
+            }
+            const std::size_t src_stride = pcf_row_bytes(w, format);
+            if (offsets[index] > data.size() || src_stride * static_cast<std::size_t>(h) > data.size() - offsets[index]) {
+                err = "malformed PCF: glyph rows past the bitmap data";
+                return false;
+            }
+
+            unsigned char* rows = glyphs.add(codepoint, w, h, m.left, m.ascent, m.advance);
+            const std::size_t stride = static_cast<std::size_t>((w + 7) / 8);
+            row.resize(src_stride);
+            for (int y = 0; y < h && stride > 0; ++y) {
+                const unsigned char* src = data.data() + offsets[index] + src_stride * static_cast<std::size_t>(y);
+                std::copy(src, src + src_stride, row.begin());
+                to_msb_row(row.data(), row.size(), format);
+                std::copy(row.begin(), row.begin() + static_cast<std::ptrdiff_t>(stride), rows + stride * static_cast<std::size_t>(y));
+                clear_tail(rows + stride * static_cast<std::size_t>(y), w);
+            }
+        }
+    }
+    if (!glyphs.finish(err)) return false;
+
+    std::string_view family;
+    std::string_view weight;
+    int pixel_size = 0;
+    const std::span<const unsigned char> properties = find_table(file, k_pcf_properties);
+    if (properties.size() >= 4) read_pcf_properties(pcf_table(properties), family, weight, pixel_size);
+    out.name = font_name(family, weight, {});
+    out.pixel_size = pixel_size > 0 ? pixel_size : out.glyph_height;
+    return true;
+}
+
+} // namespace
+
+/// \brief bdf_extractor::extract.
+bool bdf_extractor::extract(const bdf_extract_options& opt, extracted_font& out, std::string& err) const {
+    mapped_file file;
+    if (!file.open(opt.input_file, err)) return false;
+    const std::span<const unsigned char> bytes = file.bytes();
+
+    out = extracted_font{};
+    glyph_builder glyphs(opt, out);
+    bool ok = false;
+    if (bytes.size() >= 2 && bytes[0] == 0x1F && bytes[1] == 0x8B) {
+        err = "gzip-compressed font; decompress it first";
+    } else if (bytes.size() >= 8 && bytes[0] == 1 && bytes[1] == 'f' && bytes[2] == 'c' && bytes[3] == 'p') {
+        ok = parse_pcf(bytes, glyphs, out, err);
+    } else {
+        ok = parse_bdf(file.text(), glyphs, out, err);
+    }
+    if (!ok) {
+        out = extracted_font{};
+        return false;
+    }
+    if (out.name.empty()) out.name = opt.input_file.stem().string();
+    return true;
+}
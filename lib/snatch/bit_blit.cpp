@@ -0,0 +1,135 @@
+/// \file
+/// \brief Implementation of 1bpp bitmap blitting.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/bit_blit.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+/// \brief combine.
+template <raster_op Op, typename T>
+inline T combine(T d, T s) {
+    if constexpr (Op == raster_op::copy) return s;
+    else if constexpr (Op == raster_op::bit_or) return static_cast<T>(d | s);
+    else if constexpr (Op == raster_op::bit_and) return static_cast<T>(d & s);
+    else return static_cast<T>(d ^ s);
+}
+
+/// \brief combine_masked.
+// only the pixels under `mask` change
+inline std::uint8_t combine_masked(std::uint8_t d, std::uint8_t s, std::uint8_t mask, raster_op op) {
+    switch (op) {
+    case raster_op::copy: return static_cast<std::uint8_t>((d & ~mask) | (s & mask));
+    case raster_op::bit_or: return static_cast<std::uint8_t>(d | (s & mask));
+    case raster_op::bit_and: return static_cast<std::uint8_t>(d & (s | ~mask));
+    case raster_op::bit_xor: return static_cast<std::uint8_t>(d ^ (s & mask));
+    }
+    return d;
+}
+
+/// \brief fetch_clamped.
+// the 8 source bits from `bit` on (which may be negative), reading only the
+// bytes lo..hi; bits from any other byte come back as zero
+inline std::uint8_t fetch_clamped(const std::uint8_t* src, std::ptrdiff_t bit, std::ptrdiff_t lo, std::ptrdiff_t hi) {
+    const std::ptrdiff_t byte = bit >= 0 ? bit / 8 : (bit - 7) / 8;
+    const int shift = static_cast<int>(bit - byte * 8);
+    const unsigned a = byte >= lo && byte <= hi ? src[byte] : 0u;
+    const unsigned b = byte + 1 >= lo && byte + 1 <= hi ? src[byte + 1] : 0u;
+    return static_cast<std::uint8_t>((((a << 8) | b) << shift) >> 8);
+}
+
+/// \brief whole_bytes.
+// `n` destination bytes fully covered by the source, which starts `shift`
+// bits into s[0]
+template <raster_op Op>
+void whole_bytes(std::uint8_t* d, const std::uint8_t* s, int shift, std::ptrdiff_t n) {
+    std::ptrdiff_t i = 0;
+    if (shift == 0) {
+        if constexpr (Op == raster_op::copy) {
+            std::memcpy(d, s, static_cast<std::size_t>(n));
+            return;
+        }
+        for (; i + 8 <= n; i += 8) {
+            std::uint64_t dw = 0;
+            std::uint64_t sw = 0;
+            std::memcpy(&dw, d + i, 8);
+            std::memcpy(&sw, s + i, 8);
+            dw = combine<Op>(dw, sw);
+            std::memcpy(d + i, &dw, 8);
+        }
+        for (; i < n; ++i) d[i] = combine<Op>(d[i], s[i]);
+        return;
+    }
+    for (; i < n; ++i) {
+        const auto v = static_cast<std::uint8_t>((s[i] << shift) | (s[i + 1] >> (8 - shift)));
+        d[i] = combine<Op>(d[i], v);
+    }
+}
+
+} // namespace
+
+/// \brief blit_row_1bpp.
+void blit_row_1bpp(std::uint8_t* dst, int dst_width, int dst_x, const std::uint8_t* src, int src_x, int width, raster_op op) {
+    if (!dst || !src || width <= 0 || src_x < 0) return;
+    if (dst_x < 0) {
+        src_x -= dst_x;
+        width += dst_x;
+        dst_x = 0;
+    }
+    width = std::min(width, dst_width - dst_x);
+    if (width <= 0) return;
+
+    const std::ptrdiff_t first = dst_x / 8;
+    const std::ptrdiff_t last = (dst_x + width - 1) / 8;
+    const std::ptrdiff_t src_lo = src_x / 8;
+    const std::ptrdiff_t src_hi = (src_x + width - 1) / 8;
+    // source bit that lands on the first bit of dst[first]
+    const std::ptrdiff_t s0 = src_x - dst_x % 8;
+    const auto head = static_cast<std::uint8_t>(0xFFu >> (dst_x % 8));
+    const auto tail = static_cast<std::uint8_t>(0xFFu << (7 - (dst_x + width - 1) % 8));
+
+    if (first == last) {
+        dst[first] = combine_masked(dst[first], fetch_clamped(src, s0, src_lo, src_hi), head & tail, op);
+        return;
+    }
+    dst[first] = combine_masked(dst[first], fetch_clamped(src, s0, src_lo, src_hi), head, op);
+    dst[last] = combine_masked(dst[last], fetch_clamped(src, s0 + (last - first) * 8, src_lo, src_hi), tail, op);
+
+    const std::ptrdiff_t n = last - first - 1;
+    if (n <= 0) return;
+    const std::ptrdiff_t bit = s0 + 8;
+    std::uint8_t* d = dst + first + 1;
+    const std::uint8_t* s = src + bit / 8;
+    const int shift = static_cast<int>(bit % 8);
+    switch (op) {
+    case raster_op::copy: whole_bytes<raster_op::copy>(d, s, shift, n); break;
+    case raster_op::bit_or: whole_bytes<raster_op::bit_or>(d, s, shift, n); break;
+    case raster_op::bit_and: whole_bytes<raster_op::bit_and>(d, s, shift, n); break;
+    case raster_op::bit_xor: whole_bytes<raster_op::bit_xor>(d, s, shift, n); break;
+    }
+}
+
+/// \brief blit_1bpp.
+void blit_1bpp(const bitmap_1bpp& dst, int x, int y, const const_bitmap_1bpp& src, raster_op op) {
+    if (!dst.data || !src.data) return;
+    const int top = std::max(0, -y);
+    const int bottom = std::min(src.height, dst.height - y);
+    for (int row = top; row < bottom; ++row) {
+        blit_row_1bpp(
+            dst.data + static_cast<std::size_t>(y + row) * dst.stride,
+            dst.width,
+            x,
+            src.data + static_cast<std::size_t>(row) * src.stride,
+            0,
+            src.width,
+            op
+        );
+    }
+}
@@ -7,6 +7,7 @@
 /// SPDX-License-Identifier: GPL-2.0-only
 
 #include "snatch/cli_parser.h"
+#include <cstdint>
 #include <iostream>
 #include <string>
 #include <vector>
@@ -17,6 +18,46 @@ extern "C" {
 #include <argparse.h>
 }
 
+namespace {
+
+// collects repeated --exporter/--exporter-parameters into ordered pairs.
+struct exporter_pairs {
+    const char* exporter_str = nullptr;
+    const char* exporter_params_str = nullptr;
+    std::vector<snatch_exporter_options> pairs;
+    std::vector<bool> has_exporter;
+    std::vector<bool> has_params;
+};
+
+/// \brief on_exporter.
+int on_exporter(struct argparse* /*self*/, const struct argparse_option* option) {
+    auto* ctx = reinterpret_cast<exporter_pairs*>(option->data);
+    // an exporter opens a new pair unless parameters were given first
+    if (ctx->pairs.empty() || ctx->has_exporter.back()) {
+        ctx->pairs.emplace_back();
+        ctx->has_exporter.push_back(false);
+        ctx->has_params.push_back(false);
+    }
+    ctx->pairs.back().exporter = ctx->exporter_str ? ctx->exporter_str : "";
+    ctx->has_exporter.back() = true;
+    return 0;
+}
+
+/// \brief on_exporter_parameters.
+int on_exporter_parameters(struct argparse* /*self*/, const struct argparse_option* option) {
+    auto* ctx = reinterpret_cast<exporter_pairs*>(option->data);
+    if (ctx->pairs.empty() || ctx->has_params.back()) {
+        ctx->pairs.emplace_back();
+        ctx->has_exporter.push_back(false);
+        ctx->has_params.push_back(false);
+    }
+    ctx->pairs.back().exporter_parameters = ctx->exporter_params_str ? ctx->exporter_params_str : "";
+    ctx->has_params.back() = true;
+    return 0;
+}
+
+} // namespace
+
 // ---- parse ---------------------------------------------------------------
 
 /// \brief cli_parser::parse.
@@ -37,11 +78,17 @@ int cli_parser::parse(int argc, const char** argv, snatch_options& out) const {
     // argparse target variables
     const char* extractor_str = nullptr;
     const char* extractor_params_str = nullptr;
-    const char* exporter_str = nullptr;
-    const char* exporter_params_str = nullptr;
+    exporter_pairs exporters;
     const char* transformer_str = nullptr;
     const char* transformer_params_str = nullptr;
     const char* plugin_dir_str = nullptr;
+    const char* pipeline_str = nullptr;
+    const char* serve_str = nullptr;
+    const char* client_str = nullptr;
+    int shutdown_server = 0;
+    int watch = 0;
+    int index_plugins = 0;
+    int jobs = 0;
     const char* const usage[] = {
         "snatch [options]",
         nullptr
@@ -57,10 +104,19 @@ int cli_parser::parse(int argc, const char** argv, snatch_options& out) const {
         OPT_STRING('d', "plugin-dir", &plugin_dir_str, "plugin directory override"),
 
         // exporter and parameters
-        OPT_STRING('e', "exporter",             &exporter_str,        "exporter name (plugin/tool)"),
-        OPT_STRING('x', "exporter-parameters",  &exporter_params_str, "parameters for exporter (quoted ok)"),
+        OPT_STRING('e', "exporter",             &exporters.exporter_str,        "exporter name (plugin/tool); repeat for more outputs",
+                   on_exporter, reinterpret_cast<intptr_t>(&exporters)),
+        OPT_STRING('x', "exporter-parameters",  &exporters.exporter_params_str, "parameters for the preceding exporter (quoted ok)",
+                   on_exporter_parameters, reinterpret_cast<intptr_t>(&exporters)),
         OPT_STRING('w', "transformer",          &transformer_str,        "transformer name (plugin/tool)"),
         OPT_STRING('y', "transformer-parameters", &transformer_params_str, "parameters for transformer (quoted ok)"),
+        OPT_INTEGER('j', "jobs",                &jobs,                "max pipeline nodes run concurrently (default: cpu count)"),
+        OPT_STRING('p', "pipeline",             &pipeline_str,        "pipeline graph file (replaces stage options)"),
+        OPT_STRING('s', "serve",                &serve_str,           "stay resident and run pipeline jobs sent to this socket"),
+        OPT_STRING('c', "client",               &client_str,          "send --pipeline to the server on this socket"),
+        OPT_BOOLEAN(0, "shutdown",              &shutdown_server,     "with --client: stop the server"),
+        OPT_BOOLEAN(0, "watch",                 &watch,               "re-run affected stages when inputs or --pipeline change"),
+        OPT_BOOLEAN(0, "index-plugins",         &index_plugins,       "write the plugin index into --plugin-dir (install step)"),
 
         OPT_HELP(),
         OPT_END()
@@ -71,20 +127,64 @@ int cli_parser::parse(int argc, const char** argv, snatch_options& out) const {
     struct argparse ap{};
     argparse_init(&ap, options, usage, 0);
     argparse_describe(&ap, "snatch font processor",
-                           "example: snatch --extractor ttf_extractor --extractor-parameters \"input=MyFont.ttf\" --exporter raw_bin --exporter-parameters \"output=out.bin\"");
+                           "example: snatch --extractor ttf_extractor --extractor-parameters \"input=MyFont.ttf\" --exporter raw_bin --exporter-parameters \"output=out.bin\" --exporter png --exporter-parameters \"output=out.png\"");
     int nargs = argparse_parse(&ap, argc, normalized_argv.data());
 
+    if (jobs < 0) {
+        std::cerr << "error: --jobs must not be negative\n";
+        return 1;
+    }
+
     if (nargs != 0) {
         std::cerr << "error: unexpected positional arguments; pass input via --extractor-parameters input=...\n";
         return 1;
     }
 
+    const bool has_stage_options = extractor_str || extractor_params_str || transformer_str || transformer_params_str ||
+                                   !exporters.pairs.empty();
+    if (serve_str && (client_str || pipeline_str || has_stage_options)) {
+        std::cerr << "error: --serve takes its jobs from the socket; drop pipeline and stage options\n";
+        return 1;
+    }
+    if (client_str && (has_stage_options || (!pipeline_str && !shutdown_server))) {
+        std::cerr << "error: --client needs --pipeline or --shutdown\n";
+        return 1;
+    }
+    if (watch && (serve_str || client_str)) {
+        std::cerr << "error: --watch runs locally; it cannot be combined with --serve or --client\n";
+        return 1;
+    }
+    if (shutdown_server && !client_str) {
+        std::cerr << "error: --shutdown needs --client\n";
+        return 1;
+    }
+
+    if (index_plugins && (!plugin_dir_str || has_stage_options || pipeline_str || serve_str || client_str || watch)) {
+        std::cerr << "error: --index-plugins takes only --plugin-dir\n";
+        return 1;
+    }
+
+    if (pipeline_str && has_stage_options) {
+        std::cerr << "error: --pipeline cannot be combined with extractor/transformer/exporter options\n";
+        return 1;
+    }
+
     // fill output struct
+    if (pipeline_str) out.pipeline_file = pipeline_str;
+    if (serve_str) out.serve_socket = serve_str;
+    if (client_str) out.client_socket = client_str;
+    out.shutdown_server = shutdown_server != 0;
+    out.watch = watch != 0;
+    out.index_plugins = index_plugins != 0;
     if (plugin_dir_str) out.plugin_dir = plugin_dir_str;
     if (extractor_str) out.extractor = extractor_str;
     if (extractor_params_str) out.extractor_parameters = extractor_params_str;
-    if (exporter_str) out.exporter = exporter_str;
-    if (exporter_params_str) out.exporter_parameters = exporter_params_str;
+    out.exporters = std::move(exporters.pairs);
+    if (!out.exporters.empty()) {
+        out.exporter = out.exporters.front().exporter;
+        out.exporter_parameters = out.exporters.front().exporter_parameters;
+    }
+    out.jobs = jobs;
     if (transformer_str) out.transformer = transformer_str;
     if (transformer_params_str) out.transformer_parameters = transformer_params_str;
     return 0;
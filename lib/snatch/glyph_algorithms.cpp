@@ -9,7 +9,12 @@
 #include "snatch/glyph_algorithms.h"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
+#include <limits>
+#include <queue>
+#include <random>
+#include <utility>
 
 namespace {
 
@@ -20,6 +25,11 @@ inline bool bit_is_set(const unsigned char* row, int x) {
     return (row[byte_index] & (1u << bit_index)) != 0;
 }
 
+/// \brief flip.
+glyph_stroke flip(const glyph_stroke& s) {
+    return {s.to, s.from};
+}
+
 } // namespace
 
 /// \brief glyph_bitmap_analyzer::rightmost_set_bit.
@@ -85,6 +95,11 @@ glyph_route_cost_model::glyph_route_cost_model(
     color_change_cost_(std::max(0, color_change_cost)),
     max_free_line_run_(std::max(1, max_free_line_run)) {}
 
+/// \brief glyph_route_cost_model::parameters.
+std::array<int, 4> glyph_route_cost_model::parameters() const {
+    return {color_threshold_, pen_lift_cost_, color_change_cost_, max_free_line_run_};
+}
+
 /// \brief glyph_route_cost_model::same_color.
 bool glyph_route_cost_model::same_color(const glyph_pixel& a, const glyph_pixel& b) const {
     return std::abs(static_cast<int>(a.color) - static_cast<int>(b.color)) <= color_threshold_;
@@ -168,3 +183,407 @@ restart_scan:
     }
     return best;
 }
+
+/// \brief glyph_route_optimizer::shortest.
+std::vector<glyph_pixel> glyph_route_optimizer::shortest(const std::vector<glyph_pixel>& route, std::chrono::milliseconds budget) const {
+    std::vector<glyph_stroke> dots;
+    dots.reserve(route.size());
+    for (const auto& p : route) dots.push_back({p, p});
+    dots = glyph_stroke_planner{cost_model_}.route(std::move(dots), budget);
+    std::vector<glyph_pixel> out;
+    out.reserve(dots.size());
+    for (const auto& d : dots) out.push_back(d.from);
+    return out;
+}
+
+glyph_stroke_planner::glyph_stroke_planner(glyph_route_cost_model model) : cost_model_(std::move(model)) {}
+
+/// \brief glyph_stroke_planner::cover.
+std::vector<glyph_stroke> glyph_stroke_planner::cover(const snatch_glyph_bitmap& glyph, std::uint8_t color) {
+    std::vector<glyph_stroke> out;
+    if (!glyph.data || glyph.width <= 0 || glyph.height <= 0 || glyph.stride_bytes <= 0) return out;
+    const int w = glyph.width;
+    const int h = glyph.height;
+    std::vector<char> fg(static_cast<size_t>(w * h), 0);
+    for (int y = 0; y < h; ++y) {
+        const unsigned char* row = glyph.data + static_cast<size_t>(y * glyph.stride_bytes);
+        for (int x = 0; x < w; ++x) fg[static_cast<size_t>(y * w + x)] = bit_is_set(row, x) ? 1 : 0;
+    }
+    const auto is_fg = [&](int x, int y) { return x >= 0 && y >= 0 && x < w && y < h && fg[static_cast<size_t>(y * w + x)]; };
+
+    // every maximal run along each of the four directions; each pixel sits in one run per direction
+    struct run {
+        int x, y, dx, dy, len;
+    };
+    static constexpr int k_dirs[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+    std::vector<run> runs;
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            if (!is_fg(x, y)) continue;
+            for (const auto& d : k_dirs) {
+                if (is_fg(x - d[0], y - d[1])) continue;
+                int len = 1;
+                while (is_fg(x + d[0] * len, y + d[1] * len)) ++len;
+                if (len > 1) runs.push_back({x, y, d[0], d[1], len});
+            }
+        }
+    }
+
+    // greedy set cover: a run's uncovered count only drops, so stale heap entries are re-scored lazily
+    std::vector<char> covered(fg.size(), 0);
+    const auto uncovered = [&](const run& r) {
+        int n = 0;
+        for (int i = 0; i < r.len; ++i) n += covered[static_cast<size_t>((r.y + r.dy * i) * w + r.x + r.dx * i)] ? 0 : 1;
+        return n;
+    };
+    std::priority_queue<std::pair<int, int>> best; // (uncovered, -index) keeps scan order among ties
+    for (std::size_t i = 0; i < runs.size(); ++i) best.push({runs[i].len, -static_cast<int>(i)});
+    while (!best.empty()) {
+        const auto [score, neg_index] = best.top();
+        best.pop();
+        run r = runs[static_cast<size_t>(-neg_index)];
+        const int now = uncovered(r);
+        if (now != score) {
+            if (now > 1) best.push({now, neg_index});
+            continue;
+        }
+        if (now < 2) break;
+        // drop pixels another stroke already draws from either end
+        const auto done = [&](int i) { return covered[static_cast<size_t>((r.y + r.dy * i) * w + r.x + r.dx * i)] != 0; };
+        int lo = 0;
+        int hi = r.len - 1;
+        while (done(lo)) ++lo;
+        while (done(hi)) --hi;
+        for (int i = lo; i <= hi; ++i) covered[static_cast<size_t>((r.y + r.dy * i) * w + r.x + r.dx * i)] = 1;
+        out.push_back({{r.x + r.dx * lo, r.y + r.dy * lo, color, false}, {r.x + r.dx * hi, r.y + r.dy * hi, color, false}});
+    }
+
+    for (int y = 0; y < h; ++y) {
+        for (int x = 0; x < w; ++x) {
+            if (!is_fg(x, y) || covered[static_cast<size_t>(y * w + x)]) continue;
+            const glyph_pixel p{x, y, color, false};
+            out.push_back({p, p});
+        }
+    }
+    return out;
+}
+
+/// \brief glyph_stroke_planner::hop_cost.
+int glyph_stroke_planner::hop_cost(const glyph_pixel& a, const glyph_pixel& b) const {
+    int dx = 0;
+    int dy = 0;
+    return cost_model_.transition_cost(a, b, dx, dy);
+}
+
+/// \brief glyph_stroke_planner::travel_cost.
+int glyph_stroke_planner::travel_cost(const std::vector<glyph_stroke>& strokes) const {
+    int sum = 0;
+    for (std::size_t i = 1; i < strokes.size(); ++i) sum += hop_cost(strokes[i - 1].to, strokes[i].from);
+    return sum;
+}
+
+/// \brief glyph_stroke_planner::nearest_neighbour.
+std::vector<glyph_stroke> glyph_stroke_planner::nearest_neighbour(const std::vector<glyph_stroke>& strokes) const {
+    // start at the top-left end, then always draw the cheapest stroke next from its nearer end
+    const auto top_left = [](const glyph_pixel& p) { return std::make_pair(p.y, p.x); };
+    std::size_t start = 0;
+    bool start_flipped = false;
+    for (std::size_t i = 0; i < strokes.size(); ++i) {
+        const bool reversed = top_left(strokes[i].to) < top_left(strokes[i].from);
+        const auto key = top_left(reversed ? strokes[i].to : strokes[i].from);
+        if (key < top_left(start_flipped ? strokes[start].to : strokes[start].from)) {
+            start = i;
+            start_flipped = reversed;
+        }
+    }
+
+    std::vector<glyph_stroke> ordered;
+    ordered.reserve(strokes.size());
+    std::vector<char> used(strokes.size(), 0);
+    ordered.push_back(start_flipped ? flip(strokes[start]) : strokes[start]);
+    used[start] = 1;
+    while (ordered.size() < strokes.size()) {
+        const glyph_pixel& at = ordered.back().to;
+        std::size_t pick = 0;
+        bool pick_flipped = false;
+        int pick_cost = -1;
+        for (std::size_t i = 0; i < strokes.size(); ++i) {
+            if (used[i]) continue;
+            const int fwd = hop_cost(at, strokes[i].from);
+            const int rev = hop_cost(at, strokes[i].to);
+            if (pick_cost < 0 || std::min(fwd, rev) < pick_cost) {
+                pick = i;
+                pick_flipped = rev < fwd;
+                pick_cost = std::min(fwd, rev);
+            }
+        }
+        ordered.push_back(pick_flipped ? flip(strokes[pick]) : strokes[pick]);
+        used[pick] = 1;
+    }
+    return ordered;
+}
+
+/// \brief glyph_stroke_planner::two_opt_pass.
+// reversing [i, k] also flips every stroke inside it
+bool glyph_stroke_planner::two_opt_pass(std::vector<glyph_stroke>& order) const {
+    const int n = static_cast<int>(order.size());
+    const auto at = [&](int i) -> const glyph_stroke& { return order[static_cast<size_t>(i)]; };
+    bool improved = false;
+    for (int i = 0; i < n - 1; ++i) {
+        for (int k = i + 1; k < n; ++k) {
+            const int old_cost = (i > 0 ? hop_cost(at(i - 1).to, at(i).from) : 0) +
+                                 (k + 1 < n ? hop_cost(at(k).to, at(k + 1).from) : 0);
+            const int new_cost = (i > 0 ? hop_cost(at(i - 1).to, at(k).to) : 0) +
+                                 (k + 1 < n ? hop_cost(at(i).from, at(k + 1).from) : 0);
+            if (new_cost >= old_cost) continue;
+            std::reverse(order.begin() + i, order.begin() + k + 1);
+            for (int j = i; j <= k; ++j) order[static_cast<size_t>(j)] = flip(order[static_cast<size_t>(j)]);
+            improved = true;
+        }
+    }
+    return improved;
+}
+
+/// \brief glyph_stroke_planner::or_opt_pass.
+// moves a run of up to three strokes elsewhere, either way round
+bool glyph_stroke_planner::or_opt_pass(std::vector<glyph_stroke>& order) const {
+    bool improved = false;
+    for (int len = 1; len <= 3; ++len) {
+        for (int i = 0; i + len <= static_cast<int>(order.size()); ++i) {
+            const int n = static_cast<int>(order.size());
+            if (n - len < 1) return improved;
+            const glyph_stroke& first = order[static_cast<size_t>(i)];
+            const glyph_stroke& last = order[static_cast<size_t>(i + len - 1)];
+            const glyph_stroke* prev = i > 0 ? &order[static_cast<size_t>(i - 1)] : nullptr;
+            const glyph_stroke* next = i + len < n ? &order[static_cast<size_t>(i + len)] : nullptr;
+            int removed = (prev ? hop_cost(prev->to, first.from) : 0) + (next ? hop_cost(last.to, next->from) : 0);
+            if (prev && next) removed -= hop_cost(prev->to, next->from);
+
+            std::vector<glyph_stroke> rest;
+            rest.reserve(order.size() - static_cast<size_t>(len));
+            rest.insert(rest.end(), order.begin(), order.begin() + i);
+            rest.insert(rest.end(), order.begin() + i + len, order.end());
+
+            // insert before rest[p]; p == rest.size() appends
+            int best_gain = 0;
+            int best_p = -1;
+            bool best_reversed = false;
+            for (int p = 0; p <= static_cast<int>(rest.size()); ++p) {
+                const glyph_stroke* a = p > 0 ? &rest[static_cast<size_t>(p - 1)] : nullptr;
+                const glyph_stroke* b = p < static_cast<int>(rest.size()) ? &rest[static_cast<size_t>(p)] : nullptr;
+                const int base = (a && b) ? hop_cost(a->to, b->from) : 0;
+                const int fwd = (a ? hop_cost(a->to, first.from) : 0) + (b ? hop_cost(last.to, b->from) : 0) - base;
+                const int rev = (a ? hop_cost(a->to, last.to) : 0) + (b ? hop_cost(first.from, b->from) : 0) - base;
+                if (p != i && removed - fwd > best_gain) { // p == i is where it came from
+                    best_gain = removed - fwd;
+                    best_p = p;
+                    best_reversed = false;
+                }
+                if (removed - rev > best_gain) {
+                    best_gain = removed - rev;
+                    best_p = p;
+                    best_reversed = true;
+                }
+            }
+            if (best_p < 0) continue;
+
+            std::vector<glyph_stroke> segment(order.begin() + i, order.begin() + i + len);
+            if (best_reversed) {
+                std::reverse(segment.begin(), segment.end());
+                for (auto& st : segment) st = flip(st);
+            }
+            rest.insert(rest.begin() + best_p, segment.begin(), segment.end());
+            order = std::move(rest);
+            improved = true;
+        }
+    }
+    return improved;
+}
+
+/// \brief glyph_stroke_planner::local_search.
+void glyph_stroke_planner::local_search(std::vector<glyph_stroke>& order) const {
+    for (int pass = 0; pass < 64; ++pass) {
+        const bool reversed = two_opt_pass(order);
+        const bool moved = or_opt_pass(order);
+        if (!reversed && !moved) break;
+    }
+}
+
+/// \brief glyph_stroke_planner::exact.
+// Held-Karp over (visited set, last stroke as drawn); a dot is drawn one way
+// only, so it adds one state where a line adds two
+std::vector<glyph_stroke> glyph_stroke_planner::exact(const std::vector<glyph_stroke>& strokes) const {
+    const int n = static_cast<int>(strokes.size());
+    std::vector<glyph_stroke> drawn;
+    std::vector<int> stroke_of;
+    drawn.reserve(strokes.size() * 2);
+    stroke_of.reserve(strokes.size() * 2);
+    for (int i = 0; i < n; ++i) {
+        const glyph_stroke& st = strokes[static_cast<size_t>(i)];
+        drawn.push_back(st);
+        stroke_of.push_back(i);
+        if (st.from.x == st.to.x && st.from.y == st.to.y) continue;
+        drawn.push_back(flip(st));
+        stroke_of.push_back(i);
+    }
+    const int ends = static_cast<int>(drawn.size());
+    const auto bit = [&](int e) { return std::size_t{1} << stroke_of[static_cast<size_t>(e)]; };
+
+    std::vector<int> hop(static_cast<size_t>(ends * ends), 0);
+    for (int a = 0; a < ends; ++a) {
+        for (int b = 0; b < ends; ++b) hop[static_cast<size_t>(a * ends + b)] = hop_cost(drawn[static_cast<size_t>(a)].to, drawn[static_cast<size_t>(b)].from);
+    }
+
+    constexpr int k_unset = std::numeric_limits<int>::max();
+    const std::size_t masks = std::size_t{1} << n;
+    std::vector<int> cost(masks * static_cast<size_t>(ends), k_unset);
+    std::vector<std::int8_t> parent(masks * static_cast<size_t>(ends), -1);
+    const auto cell = [&](std::size_t mask, int e) { return mask * static_cast<size_t>(ends) + static_cast<size_t>(e); };
+    for (int e = 0; e < ends; ++e) cost[cell(bit(e), e)] = 0;
+    for (std::size_t mask = 1; mask < masks; ++mask) {
+        for (int e = 0; e < ends; ++e) {
+            const int here = cost[cell(mask, e)];
+            if (here == k_unset) continue;
+            for (int t = 0; t < ends; ++t) {
+                if (mask & bit(t)) continue;
+                const std::size_t next = mask | bit(t);
+                const int c = here + hop[static_cast<size_t>(e * ends + t)];
+                if (c < cost[cell(next, t)]) {
+                    cost[cell(next, t)] = c;
+                    parent[cell(next, t)] = static_cast<std::int8_t>(e);
+                }
+            }
+        }
+    }
+
+    std::size_t mask = masks - 1;
+    int e = 0;
+    for (int c = 1; c < ends; ++c) {
+        if (cost[cell(mask, c)] < cost[cell(mask, e)]) e = c;
+    }
+    std::vector<glyph_stroke> order;
+    order.reserve(strokes.size());
+    while (e >= 0) {
+        order.push_back(drawn[static_cast<size_t>(e)]);
+        const int prev = parent[cell(mask, e)];
+        mask &= ~bit(e);
+        e = prev;
+    }
+    std::reverse(order.begin(), order.end());
+    return order;
+}
+
+/// \brief glyph_stroke_planner::route.
+std::vector<glyph_stroke> glyph_stroke_planner::route(std::vector<glyph_stroke> strokes, std::chrono::milliseconds budget) const {
+    if (strokes.size() < 2) return strokes;
+    const bool dots = std::all_of(strokes.begin(), strokes.end(), [](const glyph_stroke& st) {
+        return st.from.x == st.to.x && st.from.y == st.to.y;
+    });
+    if (strokes.size() <= (dots ? k_exact_dots : k_exact_strokes)) return exact(strokes);
+
+    std::vector<glyph_stroke> best = nearest_neighbour(strokes);
+    local_search(best);
+    if (budget.count() <= 0 || best.size() < 8) return best;
+
+    // iterated local search: kick the best route with a double bridge, polish, keep if shorter
+    const auto deadline = std::chrono::steady_clock::now() + budget;
+    int best_cost = travel_cost(best);
+    std::mt19937 rng(static_cast<std::uint32_t>(best.size()));
+    while (std::chrono::steady_clock::now() < deadline) {
+        std::array<std::size_t, 3> cut{};
+        for (auto& c : cut) c = 1 + rng() % (best.size() - 1);
+        std::sort(cut.begin(), cut.end());
+        if (cut[0] == cut[1] || cut[1] == cut[2]) continue;
+
+        std::vector<glyph_stroke> candidate;
+        candidate.reserve(best.size());
+        candidate.insert(candidate.end(), best.begin(), best.begin() + static_cast<std::ptrdiff_t>(cut[0]));
+        candidate.insert(candidate.end(), best.begin() + static_cast<std::ptrdiff_t>(cut[1]), best.begin() + static_cast<std::ptrdiff_t>(cut[2]));
+        candidate.insert(candidate.end(), best.begin() + static_cast<std::ptrdiff_t>(cut[0]), best.begin() + static_cast<std::ptrdiff_t>(cut[1]));
+        candidate.insert(candidate.end(), best.begin() + static_cast<std::ptrdiff_t>(cut[2]), best.end());
+        local_search(candidate);
+        if (const int c = travel_cost(candidate); c < best_cost) {
+            best = std::move(candidate);
+            best_cost = c;
+        }
+    }
+    return best;
+}
+
+/// \brief glyph_atlas_packer::glyph_atlas_packer.
+glyph_atlas_packer::glyph_atlas_packer(int width, int align_x, int spacing)
+    : width_(std::max(width, 0)), align_x_(std::max(align_x, 1)), spacing_(std::max(spacing, 0)) {
+    // boxes are padded right to the spacing and the next aligned column; the
+    // padding of the rightmost box may hang past the strip
+    const int padded = (width_ + spacing_ + align_x_ - 1) / align_x_ * align_x_;
+    skyline_.push_back({0, 0, padded});
+}
+
+/// \brief glyph_atlas_packer::place.
+// Lowest top edge wins, then the leftmost. The box then raises the skyline
+// over its span and neighbours at the same level merge again.
+bool glyph_atlas_packer::place(int width, int box_width, int height, int& x, int& y) {
+    int best = -1;
+    int best_y = 0;
+    for (size_t i = 0; i < skyline_.size(); ++i) {
+        if (skyline_[i].x + box_width > width_) break;
+        int top = 0;
+        int covered = 0;
+        for (size_t j = i; covered < width; ++j) {
+            top = std::max(top, skyline_[j].y);
+            covered += skyline_[j].width;
+        }
+        if (best < 0 || top < best_y) {
+            best = static_cast<int>(i);
+            best_y = top;
+        }
+    }
+    if (best < 0) return false;
+    x = skyline_[static_cast<size_t>(best)].x;
+    y = best_y;
+
+    const auto at = skyline_.begin() + best;
+    skyline_.insert(at, skyline_node{x, y + height, width});
+    // trim the nodes the box now covers
+    size_t i = static_cast<size_t>(best) + 1;
+    while (i < skyline_.size() && skyline_[i].x < x + width) {
+        const int overlap = x + width - skyline_[i].x;
+        if (overlap >= skyline_[i].width) {
+            skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(i));
+        } else {
+            skyline_[i].x += overlap;
+            skyline_[i].width -= overlap;
+            break;
+        }
+    }
+    for (size_t k = 0; k + 1 < skyline_.size();) {
+        if (skyline_[k].y == skyline_[k + 1].y) {
+            skyline_[k].width += skyline_[k + 1].width;
+            skyline_.erase(skyline_.begin() + static_cast<std::ptrdiff_t>(k) + 1);
+        } else {
+            ++k;
+        }
+    }
+    return true;
+}
+
+/// \brief glyph_atlas_packer::pack.
+bool glyph_atlas_packer::pack(std::vector<atlas_rect>& boxes) {
+    std::vector<size_t> order;
+    order.reserve(boxes.size());
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        if (boxes[i].width > 0 && boxes[i].height > 0) order.push_back(i);
+        else boxes[i].x = boxes[i].y = 0;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if (boxes[a].height != boxes[b].height) return boxes[a].height > boxes[b].height;
+        return boxes[a].width > boxes[b].width;
+    });
+    for (const size_t i : order) {
+        const int padded_w = (boxes[i].width + spacing_ + align_x_ - 1) / align_x_ * align_x_;
+        const int padded_h = boxes[i].height + spacing_;
+        if (!place(padded_w, boxes[i].width, padded_h, boxes[i].x, boxes[i].y)) return false;
+        height_ = std::max(height_, boxes[i].y + boxes[i].height);
+    }
+    return true;
+}
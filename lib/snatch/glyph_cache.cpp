@@ -0,0 +1,234 @@
+/// \file
+/// \brief Implementation of glyph content hashing and the persistent glyph cache.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/glyph_cache.h"
+
+#include <cstdlib>
+#include <fstream>
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr char k_magic[4] = {'S', 'N', 'G', 'C'};
+constexpr std::uint32_t k_version = 1;
+
+/// \brief put_u32.
+void put_u32(std::ostream& out, std::uint32_t v) {
+    const unsigned char b[4] = {
+        static_cast<unsigned char>(v), static_cast<unsigned char>(v >> 8),
+        static_cast<unsigned char>(v >> 16), static_cast<unsigned char>(v >> 24)
+    };
+    out.write(reinterpret_cast<const char*>(b), 4);
+}
+
+/// \brief put_u64.
+void put_u64(std::ostream& out, std::uint64_t v) {
+    put_u32(out, static_cast<std::uint32_t>(v));
+    put_u32(out, static_cast<std::uint32_t>(v >> 32));
+}
+
+/// \brief get_u32.
+bool get_u32(std::istream& in, std::uint32_t& v) {
+    unsigned char b[4];
+    if (!in.read(reinterpret_cast<char*>(b), 4)) return false;
+    v = static_cast<std::uint32_t>(b[0]) | (static_cast<std::uint32_t>(b[1]) << 8) |
+        (static_cast<std::uint32_t>(b[2]) << 16) | (static_cast<std::uint32_t>(b[3]) << 24);
+    return true;
+}
+
+/// \brief get_u64.
+bool get_u64(std::istream& in, std::uint64_t& v) {
+    std::uint32_t lo = 0, hi = 0;
+    if (!get_u32(in, lo) || !get_u32(in, hi)) return false;
+    v = static_cast<std::uint64_t>(lo) | (static_cast<std::uint64_t>(hi) << 32);
+    return true;
+}
+
+/// \brief hash_rows.
+std::uint64_t hash_rows(const snatch_glyph_bitmap& glyph, std::uint64_t h) {
+    if (!glyph.data || glyph.width <= 0) return h;
+    const std::size_t full_bytes = static_cast<std::size_t>(glyph.width / 8);
+    const int tail_bits = glyph.width % 8;
+    // bits past the width are not part of the glyph, whatever they hold
+    const unsigned char tail_mask = static_cast<unsigned char>(0xFFu << (8 - tail_bits));
+    for (int y = 0; y < glyph.height; ++y) {
+        const unsigned char* row = glyph.data + static_cast<std::size_t>(y * glyph.stride_bytes);
+        h = glyph_hash_bytes(row, full_bytes, h);
+        if (tail_bits != 0) {
+            const unsigned char tail = static_cast<unsigned char>(row[full_bytes] & tail_mask);
+            h = glyph_hash_bytes(&tail, 1, h);
+        }
+    }
+    return h;
+}
+
+} // namespace
+
+/// \brief glyph_hash_bytes.
+std::uint64_t glyph_hash_bytes(const void* data, std::size_t size, std::uint64_t seed) {
+    const auto* p = static_cast<const unsigned char*>(data);
+    std::uint64_t h = seed;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= p[i];
+        h *= 1099511628211ull;
+    }
+    return h;
+}
+
+/// \brief glyph_bitmap_hash.
+std::uint64_t glyph_bitmap_hash(const snatch_glyph_bitmap& glyph, std::uint64_t seed) {
+    const int metrics[5] = {glyph.width, glyph.height, glyph.bearing_x, glyph.bearing_y, glyph.advance_x};
+    return hash_rows(glyph, glyph_hash_bytes(metrics, sizeof(metrics), seed));
+}
+
+/// \brief glyph_pixels_hash.
+std::uint64_t glyph_pixels_hash(const snatch_glyph_bitmap& glyph, std::uint64_t seed) {
+    const int size[2] = {glyph.width, glyph.height};
+    return hash_rows(glyph, glyph_hash_bytes(size, sizeof(size), seed));
+}
+
+/// \brief snatch_user_cache_dir.
+std::filesystem::path snatch_user_cache_dir() {
+    if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && xdg[0] != '\0') return std::filesystem::path(xdg) / "snatch";
+    if (const char* home = std::getenv("HOME"); home && home[0] != '\0') return std::filesystem::path(home) / ".cache" / "snatch";
+    return {};
+}
+
+/// \brief glyph_cache::load.
+bool glyph_cache::load(const std::filesystem::path& path, std::uint64_t tag) {
+    reset(tag);
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) return false;
+
+    char magic[4];
+    std::uint32_t version = 0, count = 0;
+    std::uint64_t file_tag = 0;
+    if (!in.read(magic, 4) || std::char_traits<char>::compare(magic, k_magic, 4) != 0 ||
+        !get_u32(in, version) || version != k_version || !get_u64(in, file_tag) || file_tag != tag ||
+        !get_u32(in, count)) {
+        return false;
+    }
+    for (std::uint32_t i = 0; i < count; ++i) {
+        std::uint64_t key = 0;
+        std::uint32_t size = 0;
+        if (!get_u64(in, key) || !get_u32(in, size)) break;
+        std::vector<std::uint8_t> value(size);
+        if (size != 0 && !in.read(reinterpret_cast<char*>(value.data()), size)) break;
+        entries_[key] = {std::move(value), false};
+    }
+    return true;
+}
+
+/// \brief glyph_cache::save.
+bool glyph_cache::save(const std::filesystem::path& path) const {
+    // write aside and rename, so a concurrent reader never sees half a file
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        out.write(k_magic, 4);
+        put_u32(out, k_version);
+        put_u64(out, tag_);
+        std::uint32_t count = 0;
+        for (const auto& [key, e] : entries_) count += e.used ? 1u : 0u;
+        put_u32(out, count);
+        for (const auto& [key, e] : entries_) {
+            if (!e.used) continue;
+            put_u64(out, key);
+            put_u32(out, static_cast<std::uint32_t>(e.value.size()));
+            out.write(reinterpret_cast<const char*>(e.value.data()), static_cast<std::streamsize>(e.value.size()));
+        }
+        if (!out) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+/// \brief glyph_cache::reset.
+void glyph_cache::reset(std::uint64_t tag) {
+    entries_.clear();
+    tag_ = tag;
+    hits_ = 0;
+}
+
+/// \brief glyph_cache::find.
+const std::vector<std::uint8_t>* glyph_cache::find(std::uint64_t key) {
+    const auto it = entries_.find(key);
+    if (it == entries_.end()) return nullptr;
+    it->second.used = true;
+    ++hits_;
+    return &it->second.value;
+}
+
+/// \brief glyph_cache::put.
+void glyph_cache::put(std::uint64_t key, std::vector<std::uint8_t> value) {
+    entries_[key] = {std::move(value), true, true};
+}
+
+/// \brief glyph_cache::fresh.
+std::size_t glyph_cache::fresh() const {
+    std::size_t n = 0;
+    for (const auto& [key, e] : entries_) n += e.fresh ? 1u : 0u;
+    return n;
+}
+
+/// \brief glyph_cache::merge_into.
+bool glyph_cache::merge_into(const std::filesystem::path& path, std::size_t max_entries) {
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+    std::filesystem::path lock_path = path;
+    lock_path += ".lock";
+    const int fd = ::open(lock_path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return false;
+    if (::flock(fd, LOCK_EX) != 0) {
+        ::close(fd);
+        return false;
+    }
+
+    glyph_cache merged;
+    merged.load(path, tag_);
+    const std::size_t ours = fresh();
+    const std::size_t room = max_entries > ours ? max_entries - ours : 0;
+    for (auto it = merged.entries_.begin(); it != merged.entries_.end();) {
+        if (merged.entries_.size() > room && entries_.count(it->first) == 0) {
+            it = merged.entries_.erase(it);
+            continue;
+        }
+        it->second.used = true;
+        ++it;
+    }
+    for (const auto& [key, e] : entries_) {
+        if (e.fresh) merged.entries_[key] = {e.value, true, false};
+    }
+    const bool ok = merged.save(path);
+
+    ::flock(fd, LOCK_UN);
+    ::close(fd);
+    if (ok) {
+        for (auto& [key, e] : entries_) e.fresh = false;
+    }
+    return ok;
+}
+
+/// \brief glyph_cache::prune.
+void glyph_cache::prune() {
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (!it->second.used) {
+            it = entries_.erase(it);
+        } else {
+            it->second.used = false;
+            ++it;
+        }
+    }
+    hits_ = 0;
+}
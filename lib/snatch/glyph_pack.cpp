@@ -0,0 +1,328 @@
+/// \file
+/// \brief Implementation of run-length and LZ compression of glyph rows.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/glyph_pack.h"
+
+#include <algorithm>
+#include <limits>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+constexpr std::size_t k_rle_max_literals = 128;
+constexpr std::size_t k_rle_min_run = 3;
+constexpr std::size_t k_rle_max_run = 130;
+
+constexpr std::size_t k_lz_window = 65535;
+constexpr std::size_t k_lz_min_match = 3;
+constexpr int k_lz_hash_bits = 16;
+constexpr int k_lz_chain = 64;
+// past 18 bytes a match already pays an extension byte; a longer one stops the
+// search and the next positions reuse it shortened by one
+constexpr std::size_t k_lz_nice = 273;
+// reuse never crosses these boundaries, so bands aligned to them find the
+// same matches as one pass
+constexpr std::size_t k_lz_block = 4096;
+// each band re-hashes up to a window of history first
+constexpr std::size_t k_lz_min_band = std::size_t{64} << 10;
+// match lengths tried by the parse besides the longest one
+constexpr std::size_t k_lz_parse_lengths = 32;
+
+constexpr std::uint64_t k_unreachable = std::numeric_limits<std::uint64_t>::max() / 4;
+
+/// \brief charge.
+inline void charge(std::vector<std::uint32_t>* cost, std::size_t at, std::size_t bytes) {
+    if (cost) (*cost)[at] += static_cast<std::uint32_t>(bytes);
+}
+
+/// \brief extension_bytes.
+// bytes following a nibble that holds `n` (capped at 15)
+inline std::size_t extension_bytes(std::size_t n) {
+    return n < 15 ? 0 : 1 + (n - 15) / 255;
+}
+
+/// \brief put_extension.
+void put_extension(std::vector<std::uint8_t>& out, std::size_t n) {
+    if (n < 15) return;
+    n -= 15;
+    for (; n >= 255; n -= 255) out.push_back(255);
+    out.push_back(static_cast<std::uint8_t>(n));
+}
+
+struct lz_match {
+    std::uint32_t length{0};
+    std::uint16_t offset{0};
+};
+
+/// \brief find_matches.
+// the longest match found for every position in begin..end; blocks of the
+// reuse shortcut are counted from `origin`
+void find_matches(const std::uint8_t* data, std::size_t size, std::size_t origin, std::size_t begin, std::size_t end, lz_match* out) {
+    const std::size_t base = begin > k_lz_window ? begin - k_lz_window : 0;
+    std::vector<std::int32_t> head(std::size_t{1} << k_lz_hash_bits, -1);
+    std::vector<std::int32_t> prev(end - base, -1);
+    const auto hash = [&](std::size_t p) {
+        const std::uint32_t v = static_cast<std::uint32_t>(data[p]) << 16 | static_cast<std::uint32_t>(data[p + 1]) << 8 | data[p + 2];
+        return (v * 2654435761u) >> (32 - k_lz_hash_bits);
+    };
+    const auto insert = [&](std::size_t p) {
+        if (p + k_lz_min_match > size) return;
+        auto& h = head[hash(p)];
+        prev[p - base] = h;
+        h = static_cast<std::int32_t>(p - base);
+    };
+    for (std::size_t p = base; p < begin; ++p) insert(p);
+
+    lz_match carry;
+    for (std::size_t p = begin; p < end; ++p) {
+        lz_match& m = out[p - begin];
+        if ((p - origin) % k_lz_block == 0) carry = {};
+        if (carry.length > k_lz_nice) {
+            --carry.length;
+            m = carry;
+            insert(p);
+            continue;
+        }
+        carry = {};
+        if (p + k_lz_min_match <= size) {
+            const std::size_t limit = size - p;
+            std::size_t best = k_lz_min_match - 1;
+            std::int32_t cand = head[hash(p)];
+            for (int depth = 0; cand >= 0 && depth < k_lz_chain && best < limit; ++depth) {
+                const std::size_t q = base + static_cast<std::size_t>(cand);
+                if (p - q > k_lz_window) break;
+                if (data[q + best] == data[p + best]) {
+                    std::size_t len = 0;
+                    while (len < limit && data[q + len] == data[p + len]) ++len;
+                    if (len > best) {
+                        best = len;
+                        m.length = static_cast<std::uint32_t>(len);
+                        m.offset = static_cast<std::uint16_t>(p - q);
+                        if (len >= k_lz_nice) break;
+                    }
+                }
+                cand = prev[static_cast<std::size_t>(cand)];
+            }
+            insert(p);
+        }
+        carry = m;
+    }
+}
+
+/// \brief lz_encode.
+// packs buffer[prefix..total]; matches may also reach back into the prefix
+std::vector<std::uint8_t> lz_encode(const std::uint8_t* buffer, std::size_t prefix, std::size_t total, unsigned threads, std::vector<std::uint32_t>* cost) {
+    std::vector<std::uint8_t> out;
+    const std::uint8_t* data = buffer + prefix;
+    const std::size_t size = total - prefix;
+    if (cost) cost->assign(size, 0);
+    if (size == 0) return out;
+
+    std::vector<lz_match> matches(size);
+    const std::size_t blocks = (size + k_lz_block - 1) / k_lz_block;
+    const std::size_t bands = std::clamp<std::size_t>(std::min<std::size_t>(threads, size / k_lz_min_band), 1, blocks);
+    const auto band = [&](std::size_t t) {
+        const std::size_t b0 = blocks * t / bands * k_lz_block;
+        const std::size_t b1 = std::min(size, blocks * (t + 1) / bands * k_lz_block);
+        find_matches(buffer, total, prefix, prefix + b0, prefix + b1, matches.data() + b0);
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < bands; ++t) workers.emplace_back(band, t);
+    band(0);
+    for (auto& w : workers) w.join();
+
+    // best[i]: fewest bytes for data[i..] starting with a token. A token
+    // carries r literals and then the match at i + r, whose cheapest length
+    // ends in match_cost[i + r]; match_cost[size] is the literal tail.
+    // tail_min[k] is the least j + match_cost[j] over j >= k, which prices
+    // runs of 15 literals and more by their first extension byte only.
+    std::vector<std::uint64_t> best(size + 1, 0);
+    std::vector<std::uint64_t> match_cost(size + 1, k_unreachable);
+    std::vector<std::uint32_t> match_len(size + 1, 0);
+    std::vector<std::uint64_t> tail_min(size + 1);
+    std::vector<std::size_t> tail_at(size + 1);
+    std::vector<std::size_t> next(size, size);
+    match_cost[size] = 0;
+    tail_min[size] = size;
+    tail_at[size] = size;
+    for (std::size_t i = size; i-- > 0;) {
+        if (const std::size_t longest = matches[i].length; longest >= k_lz_min_match) {
+            const auto try_length = [&](std::size_t l) {
+                const std::uint64_t c = 2 + extension_bytes(l - k_lz_min_match) + best[i + l];
+                if (c < match_cost[i]) {
+                    match_cost[i] = c;
+                    match_len[i] = static_cast<std::uint32_t>(l);
+                }
+            };
+            for (std::size_t l = k_lz_min_match; l < std::min(longest, k_lz_min_match + k_lz_parse_lengths); ++l) try_length(l);
+            try_length(longest);
+        }
+        tail_min[i] = tail_min[i + 1];
+        tail_at[i] = tail_at[i + 1];
+        if (i + match_cost[i] < tail_min[i]) {
+            tail_min[i] = i + match_cost[i];
+            tail_at[i] = i;
+        }
+
+        std::uint64_t least = k_unreachable;
+        for (std::size_t r = 0; r < 15 && i + r <= size; ++r) {
+            if (r + match_cost[i + r] < least) {
+                least = r + match_cost[i + r];
+                next[i] = i + r;
+            }
+        }
+        if (i + 15 <= size && tail_min[i + 15] - i + 1 < least) {
+            least = tail_min[i + 15] - i + 1;
+            next[i] = tail_at[i + 15];
+        }
+        best[i] = 1 + least;
+    }
+
+    out.reserve(static_cast<std::size_t>(best[0]));
+    for (std::size_t i = 0; i < size;) {
+        const std::size_t j = next[i];
+        const std::size_t literals = j - i;
+        const std::size_t length = j < size ? match_len[j] : 0;
+        const std::size_t extra = length > 0 ? length - k_lz_min_match : 0;
+        out.push_back(static_cast<std::uint8_t>(std::min<std::size_t>(literals, 15) << 4 | std::min<std::size_t>(extra, 15)));
+        put_extension(out, literals);
+        out.insert(out.end(), data + i, data + j);
+        charge(cost, i, 1 + extension_bytes(literals));
+        for (std::size_t k = i; k < j; ++k) charge(cost, k, 1);
+        if (j == size) break;
+
+        const std::uint16_t offset = matches[j].offset;
+        out.push_back(static_cast<std::uint8_t>(offset & 0xFFu));
+        out.push_back(static_cast<std::uint8_t>(offset >> 8));
+        put_extension(out, extra);
+        charge(cost, j, 2 + extension_bytes(extra));
+        i = j + length;
+    }
+    return out;
+}
+
+} // namespace
+
+/// \brief rle_pack.
+std::vector<std::uint8_t> rle_pack(const std::uint8_t* data, std::size_t size, std::vector<std::uint32_t>* cost) {
+    std::vector<std::uint8_t> out;
+    if (cost) cost->assign(size, 0);
+    if (!data || size == 0) return out;
+    out.reserve(size + size / k_rle_max_literals + 1);
+
+    std::size_t literals = 0; // pending, ending just before i
+    const auto flush = [&](std::size_t i) {
+        for (std::size_t start = i - literals; start < i; start += k_rle_max_literals) {
+            const std::size_t n = std::min(k_rle_max_literals, i - start);
+            out.push_back(static_cast<std::uint8_t>(n - 1));
+            out.insert(out.end(), data + start, data + start + n);
+            charge(cost, start, 1);
+            for (std::size_t k = start; k < start + n; ++k) charge(cost, k, 1);
+        }
+        literals = 0;
+    };
+
+    for (std::size_t i = 0; i < size;) {
+        std::size_t run = 1;
+        while (i + run < size && run < k_rle_max_run && data[i + run] == data[i]) ++run;
+        if (run < k_rle_min_run) {
+            literals += run;
+            i += run;
+            continue;
+        }
+        flush(i);
+        out.push_back(static_cast<std::uint8_t>(run + 125));
+        out.push_back(data[i]);
+        charge(cost, i, 2);
+        i += run;
+    }
+    flush(size);
+    return out;
+}
+
+/// \brief lz_pack.
+std::vector<std::uint8_t> lz_pack(const std::uint8_t* data, std::size_t size, unsigned threads, std::vector<std::uint32_t>* cost) {
+    if (!data || size == 0) {
+        if (cost) cost->clear();
+        return {};
+    }
+    return lz_encode(data, 0, size, threads, cost);
+}
+
+/// \brief lz_pack.
+std::vector<std::uint8_t> lz_pack(const std::uint8_t* data, std::size_t size, std::span<const std::uint8_t> dictionary, std::vector<std::uint32_t>* cost) {
+    if (dictionary.empty()) return lz_pack(data, size, 1, cost);
+    std::vector<std::uint8_t> buffer(dictionary.begin(), dictionary.end());
+    if (data) buffer.insert(buffer.end(), data, data + size);
+    return lz_encode(buffer.data(), dictionary.size(), buffer.size(), 1, cost);
+}
+
+/// \brief lz_train_dictionary.
+// Segments of 4, 8 and 16 bytes are scored by the samples they recur in
+// times the bytes a match on them saves, and the best are concatenated.
+std::vector<std::uint8_t> lz_train_dictionary(std::span<const std::span<const std::uint8_t>> samples, std::size_t capacity) {
+    struct candidate {
+        std::uint64_t score{0};
+        std::size_t sample{0};
+        std::size_t at{0};
+        std::size_t length{0};
+    };
+    // samples a segment recurs in, and where it was first seen
+    struct tally {
+        std::size_t samples{0};
+        std::size_t last{0};
+        std::size_t first{0};
+        std::size_t at{0};
+    };
+
+    std::vector<std::uint8_t> dictionary;
+    capacity = std::min(capacity, k_lz_window);
+    if (capacity == 0) return dictionary;
+
+    std::vector<candidate> candidates;
+    for (const std::size_t length : {std::size_t{16}, std::size_t{8}, std::size_t{4}}) {
+        std::unordered_map<std::string_view, tally> seen;
+        for (std::size_t s = 0; s < samples.size(); ++s) {
+            const auto& sample = samples[s];
+            for (std::size_t at = 0; at + length <= sample.size(); ++at) {
+                tally& t = seen[std::string_view(reinterpret_cast<const char*>(sample.data() + at), length)];
+                if (t.samples == 0) {
+                    t.first = s;
+                    t.at = at;
+                } else if (t.last == s) {
+                    continue;
+                }
+                ++t.samples;
+                t.last = s;
+            }
+        }
+        for (const auto& entry : seen) {
+            const tally& t = entry.second;
+            if (t.samples >= 2) candidates.push_back({static_cast<std::uint64_t>(t.samples - 1) * (length - 2), t.first, t.at, length});
+        }
+    }
+    // at 4 bytes or more each, this many fill the dictionary many times over
+    const std::size_t considered = std::min(candidates.size(), capacity);
+    std::partial_sort(candidates.begin(), candidates.begin() + static_cast<std::ptrdiff_t>(considered), candidates.end(), [](const candidate& a, const candidate& b) {
+        if (a.score != b.score) return a.score > b.score;
+        if (a.length != b.length) return a.length > b.length;
+        return a.sample != b.sample ? a.sample < b.sample : a.at < b.at;
+    });
+    candidates.resize(considered);
+
+    for (const candidate& c : candidates) {
+        if (dictionary.size() + c.length > capacity) continue;
+        const auto* segment = samples[c.sample].data() + c.at;
+        if (std::search(dictionary.begin(), dictionary.end(), segment, segment + c.length) != dictionary.end()) continue;
+        dictionary.insert(dictionary.end(), segment, segment + c.length);
+        if (dictionary.size() + 4 > capacity) break;
+    }
+    return dictionary;
+}
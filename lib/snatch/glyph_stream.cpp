@@ -0,0 +1,273 @@
+/// \file
+/// \brief Host-side glyph stream sinks: collector, fan-out and bounded queue.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/glyph_stream.h"
+
+#include <algorithm>
+
+namespace {
+
+/// \brief copy_glyph.
+extracted_glyph copy_glyph(const snatch_glyph_bitmap& view) {
+    extracted_glyph g;
+    g.view = view;
+    if (view.data && view.stride_bytes > 0 && view.height > 0) {
+        g.bitmap.assign(view.data, view.data + static_cast<std::size_t>(view.stride_bytes * view.height));
+    }
+    g.view.data = g.bitmap.empty() ? nullptr : g.bitmap.data();
+    return g;
+}
+
+} // namespace
+
+/// \brief glyph_stream_header::assign.
+void glyph_stream_header::assign(const snatch_font& from) {
+    font = from;
+    font.bitmap_font = nullptr;
+    name = from.name ? from.name : "";
+}
+
+/// \brief glyph_stream_header::get.
+const snatch_font* glyph_stream_header::get() {
+    font.name = name.c_str();
+    return &font;
+}
+
+glyph_collector::glyph_collector() {
+    sink_.ctx = this;
+    sink_.begin = &on_begin;
+    sink_.glyph = &on_glyph;
+    sink_.end = &on_end;
+    sink_.close = nullptr;
+}
+
+/// \brief glyph_collector::font.
+snatch_font glyph_collector::font() const {
+    snatch_font out = font_.as_plugin_font();
+    out.user_data = user_data_;
+    return out;
+}
+
+/// \brief glyph_collector::on_begin.
+int glyph_collector::on_begin(void* ctx, const snatch_font* header) {
+    auto& self = *static_cast<glyph_collector*>(ctx);
+    self.font_ = {};
+    self.font_.name = header->name ? header->name : "";
+    self.font_.first_codepoint = header->first_codepoint;
+    self.font_.last_codepoint = header->last_codepoint;
+    self.font_.pixel_size = header->pixel_size;
+    self.font_.glyph_width = header->glyph_width;
+    self.font_.glyph_height = header->glyph_height;
+    self.user_data_ = header->user_data;
+    return 0;
+}
+
+/// \brief glyph_collector::on_glyph.
+int glyph_collector::on_glyph(void* ctx, const snatch_glyph_bitmap* glyph) {
+    auto& self = *static_cast<glyph_collector*>(ctx);
+    self.font_.glyphs.push_back(copy_glyph(*glyph));
+    return 0;
+}
+
+/// \brief glyph_collector::on_end.
+int glyph_collector::on_end(void* ctx, const snatch_font* summary) {
+    auto& self = *static_cast<glyph_collector*>(ctx);
+    extracted_font& f = self.font_;
+    f.glyph_width = summary->glyph_width;
+    f.glyph_height = summary->glyph_height;
+    // glyphs may have moved while the vector grew
+    f.glyph_views.clear();
+    f.glyph_views.reserve(f.glyphs.size());
+    for (auto& g : f.glyphs) {
+        g.view.data = g.bitmap.empty() ? nullptr : g.bitmap.data();
+        f.glyph_views.push_back(g.view);
+    }
+    f.bitmap_view.glyph_count = static_cast<int>(f.glyph_views.size());
+    f.bitmap_view.glyphs = f.glyph_views.empty() ? nullptr : f.glyph_views.data();
+    return 0;
+}
+
+/// \brief feed_font.
+int feed_font(const snatch_font& font, const snatch_glyph_sink& sink, const snatch_glyph_source* source) {
+    snatch_font header = font;
+    header.bitmap_font = nullptr;
+    if (const int rc = sink.begin(sink.ctx, &header); rc != 0) return rc;
+    if (source && font.bitmap_font) {
+        const bool measure = header.glyph_width <= 0 && header.glyph_height <= 0;
+        std::vector<unsigned char> rows;
+        for (int i = 0; i < font.bitmap_font->glyph_count; ++i) {
+            snatch_glyph_bitmap g{};
+            long size = source->glyph(source->ctx, i, &g, rows.data(), rows.size());
+            if (size > static_cast<long>(rows.size())) {
+                rows.resize(static_cast<std::size_t>(size));
+                size = source->glyph(source->ctx, i, &g, rows.data(), rows.size());
+            }
+            if (size < 0) return -1;
+            if (measure) {
+                header.glyph_width = std::max(header.glyph_width, g.width);
+                header.glyph_height = std::max(header.glyph_height, g.height);
+            }
+            if (const int rc = sink.glyph(sink.ctx, &g); rc != 0) return rc;
+        }
+    } else if (font.bitmap_font && font.bitmap_font->glyphs) {
+        for (int i = 0; i < font.bitmap_font->glyph_count; ++i) {
+            if (const int rc = sink.glyph(sink.ctx, &font.bitmap_font->glyphs[i]); rc != 0) return rc;
+        }
+    }
+    return sink.end(sink.ctx, &header);
+}
+
+glyph_tee::glyph_tee() {
+    sink_.ctx = this;
+    sink_.begin = &on_begin;
+    sink_.glyph = &on_glyph;
+    sink_.end = &on_end;
+    sink_.close = nullptr;
+}
+
+/// \brief glyph_tee::add.
+void glyph_tee::add(const snatch_glyph_sink& sink, const glyph_tee* own_tee) {
+    branch b;
+    b.sink = sink;
+    b.own_tee = own_tee;
+    branches_.push_back(b);
+}
+
+/// \brief glyph_tee::all_dead.
+bool glyph_tee::all_dead() const {
+    return std::all_of(branches_.begin(), branches_.end(), [](const branch& b) { return b.dead; });
+}
+
+/// \brief glyph_tee::each.
+template <typename Call>
+int glyph_tee::each(Call&& call) {
+    for (auto& b : branches_) {
+        if (b.dead) continue;
+        const int rc = call(b.sink);
+        if (rc == 0) continue;
+        b.dead = true;
+        b.rc = rc;
+        // a transformer whose consumers all failed stops without failing itself
+        b.failed = !(b.own_tee && b.own_tee->all_dead());
+    }
+    return all_dead() ? 1 : 0;
+}
+
+/// \brief glyph_tee::on_begin.
+int glyph_tee::on_begin(void* ctx, const snatch_font* header) {
+    return static_cast<glyph_tee*>(ctx)->each([&](const snatch_glyph_sink& s) { return s.begin(s.ctx, header); });
+}
+
+/// \brief glyph_tee::on_glyph.
+int glyph_tee::on_glyph(void* ctx, const snatch_glyph_bitmap* glyph) {
+    return static_cast<glyph_tee*>(ctx)->each([&](const snatch_glyph_sink& s) { return s.glyph(s.ctx, glyph); });
+}
+
+/// \brief glyph_tee::on_end.
+int glyph_tee::on_end(void* ctx, const snatch_font* summary) {
+    return static_cast<glyph_tee*>(ctx)->each([&](const snatch_glyph_sink& s) { return s.end(s.ctx, summary); });
+}
+
+glyph_queue::glyph_queue(const snatch_glyph_sink& downstream, std::size_t capacity, std::size_t max_bytes)
+    : downstream_(downstream), capacity_(std::max<std::size_t>(1, capacity)), max_bytes_(max_bytes) {
+    sink_.ctx = this;
+    sink_.begin = &on_begin;
+    sink_.glyph = &on_glyph;
+    sink_.end = &on_end;
+    sink_.close = nullptr;
+}
+
+/// \brief glyph_queue::push.
+int glyph_queue::push(item it) {
+    const std::size_t size = it.glyph.bitmap.size();
+    std::unique_lock lock(mu_);
+    // one item always fits, however big, so a huge glyph cannot stall the stream
+    cv_.wait(lock, [&]() {
+        return (items_.size() < capacity_ && (items_.empty() || bytes_ + size <= max_bytes_)) || downstream_rc_ != 0;
+    });
+    if (downstream_rc_ != 0) return downstream_rc_;
+    bytes_ += size;
+    items_.push_back(std::move(it));
+    cv_.notify_all();
+    return 0;
+}
+
+/// \brief glyph_queue::finish.
+void glyph_queue::finish() {
+    const std::lock_guard lock(mu_);
+    finished_ = true;
+    cv_.notify_all();
+}
+
+/// \brief glyph_queue::pump.
+void glyph_queue::pump() {
+    for (;;) {
+        item it;
+        {
+            std::unique_lock lock(mu_);
+            cv_.wait(lock, [&]() { return !items_.empty() || finished_; });
+            if (items_.empty()) return;
+            it = std::move(items_.front());
+            items_.pop_front();
+            bytes_ -= it.glyph.bitmap.size();
+            cv_.notify_all();
+        }
+
+        int rc = 0;
+        switch (it.kind) {
+        case item_kind::begin:
+            rc = downstream_.begin(downstream_.ctx, it.header.get());
+            break;
+        case item_kind::glyph:
+            it.glyph.view.data = it.glyph.bitmap.empty() ? nullptr : it.glyph.bitmap.data();
+            rc = downstream_.glyph(downstream_.ctx, &it.glyph.view);
+            break;
+        case item_kind::end:
+            rc = downstream_.end(downstream_.ctx, it.header.get());
+            break;
+        }
+        if (rc != 0) {
+            // tell the producer to stop; whatever it still queued is dropped
+            const std::lock_guard lock(mu_);
+            downstream_rc_ = rc;
+            items_.clear();
+            bytes_ = 0;
+            cv_.notify_all();
+            return;
+        }
+    }
+}
+
+/// \brief glyph_queue::on_begin.
+int glyph_queue::on_begin(void* ctx, const snatch_font* header) {
+    auto& self = *static_cast<glyph_queue*>(ctx);
+    self.pixel_size_ = header->pixel_size;
+    item it;
+    it.kind = item_kind::begin;
+    it.header.assign(*header);
+    return self.push(std::move(it));
+}
+
+/// \brief glyph_queue::on_glyph.
+int glyph_queue::on_glyph(void* ctx, const snatch_glyph_bitmap* glyph) {
+    auto& self = *static_cast<glyph_queue*>(ctx);
+    item it;
+    it.kind = item_kind::glyph;
+    it.glyph = copy_glyph(*glyph);
+    const int rc = self.push(std::move(it));
+    if (rc == 0) ++self.glyphs_;
+    return rc;
+}
+
+/// \brief glyph_queue::on_end.
+int glyph_queue::on_end(void* ctx, const snatch_font* summary) {
+    item it;
+    it.kind = item_kind::end;
+    it.header.assign(*summary);
+    return static_cast<glyph_queue*>(ctx)->push(std::move(it));
+}
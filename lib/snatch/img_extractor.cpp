@@ -7,7 +7,9 @@
 /// SPDX-License-Identifier: GPL-2.0-only
 
 #include "snatch/img_extractor.h"
+#include "snatch/bit_blit.h"
 #include "snatch/glyph_algorithms.h"
+#include "snatch/glyph_cache.h"
 
 #include <algorithm>
 #include <cstdint>
@@ -66,10 +68,66 @@ bool pixel_is_foreground(const rgba& px, const image_extract_options& opt) {
     return on;
 }
 
+/// \brief cache_tag.
+// everything besides the cell pixels that decides a cell's glyph
+std::uint64_t cache_tag(const image_extract_options& opt, int draw_w, int draw_h) {
+    const int settings[] = {
+        1, // bump when the binarization or the entry layout changes
+        draw_w, draw_h, opt.inverse ? 1 : 0, opt.proportional ? 1 : 0,
+        opt.fore_color.r, opt.fore_color.g, opt.fore_color.b,
+        opt.back_color.r, opt.back_color.g, opt.back_color.b,
+        opt.has_transparent ? 1 : 0, opt.transparent_color.r, opt.transparent_color.g, opt.transparent_color.b
+    };
+    return glyph_hash_bytes(settings, sizeof(settings));
+}
+
+/// \brief hash_cell.
+std::uint64_t hash_cell(const unsigned char* image, int img_w, int img_h, int x0, int y0, int w, int h) {
+    const int clip_x0 = std::clamp(x0, 0, img_w);
+    const int clip_x1 = std::clamp(x0 + w, 0, img_w);
+    const int span[2] = {clip_x0 - x0, clip_x1 - clip_x0};
+    std::uint64_t hash = glyph_hash_bytes(span, sizeof(span));
+    for (int y = y0; y < y0 + h; ++y) {
+        if (y < 0 || y >= img_h || span[1] <= 0) {
+            const unsigned char outside = 0xFF;
+            hash = glyph_hash_bytes(&outside, 1, hash);
+            continue;
+        }
+        hash = glyph_hash_bytes(image + static_cast<size_t>((y * img_w + clip_x0) * 4), static_cast<size_t>(span[1]) * 4, hash);
+    }
+    return hash;
+}
+
+/// \brief encode_cached_glyph.
+std::vector<std::uint8_t> encode_cached_glyph(const extracted_glyph& g) {
+    std::vector<std::uint8_t> v;
+    v.reserve(4 + g.bitmap.size());
+    v.push_back(static_cast<std::uint8_t>(g.view.width & 0xFF));
+    v.push_back(static_cast<std::uint8_t>((g.view.width >> 8) & 0xFF));
+    v.push_back(static_cast<std::uint8_t>(g.view.stride_bytes & 0xFF));
+    v.push_back(static_cast<std::uint8_t>((g.view.stride_bytes >> 8) & 0xFF));
+    v.insert(v.end(), g.bitmap.begin(), g.bitmap.end());
+    return v;
+}
+
+/// \brief decode_cached_glyph.
+bool decode_cached_glyph(const std::vector<std::uint8_t>& v, int draw_h, extracted_glyph& g) {
+    if (v.size() < 4) return false;
+    const int width = v[0] | (v[1] << 8);
+    const int stride = v[2] | (v[3] << 8);
+    if (stride != stride_for_bits(width) || v.size() != 4 + static_cast<size_t>(stride * draw_h)) return false;
+    g.view.width = width;
+    g.view.advance_x = width;
+    g.view.stride_bytes = stride;
+    g.bitmap.assign(v.begin() + 4, v.end());
+    return true;
+}
+
 } // namespace
 
 /// \brief img_extractor::extract.
-bool img_extractor::extract(const image_extract_options& opt, extracted_font& out, std::string& err) const {
+bool img_extractor::extract(const image_extract_options& opt, extracted_font& out, std::string& err,
+                            image_extract_stats* stats) const {
     int img_w = 0;
     int img_h = 0;
     unsigned char* image = stbi_load(opt.input_file.string().c_str(), &img_w, &img_h, nullptr, 4);
@@ -143,6 +201,11 @@ bool img_extractor::extract(const image_extract_options& opt, extracted_font& ou
 
     const int full_stride = stride_for_bits(draw_w);
 
+    const bool use_cache = !opt.cache_file.empty();
+    glyph_cache cache;
+    if (use_cache) cache.load(opt.cache_file, cache_tag(opt, draw_w, draw_h));
+    int reused = 0;
+
     for (int i = 0; i < glyph_count; ++i) {
         const int codepoint = first + i;
         const int row = i / opt.columns;
@@ -160,8 +223,21 @@ bool img_extractor::extract(const image_extract_options& opt, extracted_font& ou
         g.view.bearing_y = draw_h;
         g.view.advance_x = draw_w;
         g.view.stride_bytes = full_stride;
-        g.bitmap.assign(static_cast<size_t>(full_stride * draw_h), 0);
 
+        std::uint64_t cell_key = 0;
+        if (use_cache) {
+            cell_key = hash_cell(image, img_w, img_h, start_x, start_y, draw_w, draw_h);
+            if (const auto* hit = cache.find(cell_key); hit && decode_cached_glyph(*hit, draw_h, g)) {
+                ++reused;
+                g.view.data = g.bitmap.empty() ? nullptr : g.bitmap.data();
+                out.glyph_width = std::max(out.glyph_width, g.view.width);
+                out.glyph_height = std::max(out.glyph_height, g.view.height);
+                out.glyphs.push_back(std::move(g));
+                continue;
+            }
+        }
+
+        g.bitmap.assign(static_cast<size_t>(full_stride * draw_h), 0);
         for (int y = 0; y < draw_h; ++y) {
             unsigned char* bits_row = g.bitmap.data() + static_cast<size_t>(y * full_stride);
             const int sy = start_y + y;
@@ -187,24 +263,21 @@ bool img_extractor::extract(const image_extract_options& opt, extracted_font& ou
             g.view.stride_bytes = stride_for_bits(g.view.width);
             if (g.view.stride_bytes != full_stride) {
                 std::vector<unsigned char> packed(static_cast<size_t>(g.view.stride_bytes * draw_h), 0);
-                for (int y = 0; y < draw_h; ++y) {
-                    const unsigned char* src = g.bitmap.data() + static_cast<size_t>(y * full_stride);
-                    unsigned char* dst = packed.data() + static_cast<size_t>(y * g.view.stride_bytes);
-                    for (int x = 0; x < g.view.width; ++x) {
-                        const int src_byte = x / 8;
-                        const int src_bit = 7 - (x % 8);
-                        if ((src[src_byte] & (1u << src_bit)) != 0) set_bit(dst, x);
-                    }
-                }
+                const bitmap_1bpp dst{packed.data(), g.view.width, draw_h, static_cast<size_t>(g.view.stride_bytes)};
+                blit_1bpp(dst, 0, 0, {g.bitmap.data(), g.view.width, draw_h, static_cast<size_t>(full_stride)}, raster_op::copy);
                 g.bitmap.swap(packed);
             }
         }
 
+        if (use_cache) cache.put(cell_key, encode_cached_glyph(g));
         g.view.data = g.bitmap.empty() ? nullptr : g.bitmap.data();
         out.glyph_width = std::max(out.glyph_width, g.view.width);
         out.glyph_height = std::max(out.glyph_height, g.view.height);
         out.glyphs.push_back(std::move(g));
     }
+    // a cache that cannot be written only costs the next run its reuse
+    if (use_cache && reused != glyph_count) cache.save(opt.cache_file);
+    if (stats) *stats = {glyph_count, reused};
 
     for (auto& g : out.glyphs) {
         g.view.data = g.bitmap.empty() ? nullptr : g.bitmap.data();
@@ -0,0 +1,312 @@
+/// \file
+/// \brief Resident pipeline job server and socket client implementation.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/job_server.h"
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <optional>
+#include <sstream>
+
+#include "snatch/pipeline.h"
+#include "snatch/plugin_manager.h"
+
+namespace {
+
+constexpr std::string_view k_job_header = "snatch-job 1";
+constexpr std::string_view k_shutdown_header = "snatch-shutdown 1";
+constexpr std::string_view k_result_header = "snatch-result 1";
+constexpr std::size_t k_max_request_bytes = 1u << 20;
+
+volatile std::sig_atomic_t g_stop = 0;
+
+/// \brief on_stop_signal.
+void on_stop_signal(int) {
+    g_stop = 1;
+}
+
+/// \brief make_address.
+bool make_address(const std::filesystem::path& path, sockaddr_un& addr, std::string& err) {
+    const std::string s = path.string();
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (s.empty() || s.size() >= sizeof(addr.sun_path)) {
+        err = "socket path is empty or too long: " + s;
+        return false;
+    }
+    std::memcpy(addr.sun_path, s.c_str(), s.size() + 1);
+    return true;
+}
+
+/// \brief connect_to.
+int connect_to(const std::filesystem::path& path, std::string& err) {
+    sockaddr_un addr{};
+    if (!make_address(path, addr, err)) return -1;
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        err = std::string("socket: ") + std::strerror(errno);
+        return -1;
+    }
+    if (::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        err = "cannot connect to " + path.string() + ": " + std::strerror(errno);
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/// \brief write_all.
+bool write_all(int fd, std::string_view data) {
+    while (!data.empty()) {
+        const ssize_t n = ::send(fd, data.data(), data.size(), MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR && !g_stop) continue;
+        if (n <= 0) return false;
+        data.remove_prefix(static_cast<std::size_t>(n));
+    }
+    return true;
+}
+
+/// \brief read_all.
+// without a deadline it waits as long as the peer keeps the connection open;
+// either way a stop signal ends the read
+bool read_all(int fd, std::string& out, std::size_t limit,
+              std::optional<std::chrono::steady_clock::time_point> deadline = std::nullopt) {
+    char buf[4096];
+    for (;;) {
+        if (deadline) {
+            const auto left = std::chrono::ceil<std::chrono::milliseconds>(*deadline - std::chrono::steady_clock::now());
+            pollfd p{fd, POLLIN, 0};
+            const int ready = left.count() > 0 ? ::poll(&p, 1, static_cast<int>(left.count())) : 0;
+            if (ready < 0 && errno == EINTR && !g_stop) continue;
+            if (ready <= 0) return false;
+        }
+        const ssize_t n = ::recv(fd, buf, sizeof(buf), 0);
+        if (n < 0 && errno == EINTR && !g_stop) continue;
+        if (n < 0) return false;
+        if (n == 0) return true;
+        if (out.size() + static_cast<std::size_t>(n) > limit) return false;
+        out.append(buf, static_cast<std::size_t>(n));
+    }
+}
+
+/// \brief next_line.
+std::string_view next_line(std::string_view& s) {
+    const std::size_t eol = s.find('\n');
+    const std::string_view line = s.substr(0, eol);
+    s.remove_prefix(eol == std::string_view::npos ? s.size() : eol + 1);
+    return line;
+}
+
+/// \brief make_response.
+std::string make_response(int exit_code, const std::string& out, const std::string& err) {
+    std::ostringstream r;
+    r << k_result_header << ' ' << exit_code << ' ' << out.size() << ' ' << err.size() << '\n' << out << err;
+    return r.str();
+}
+
+/// \brief exchange.
+// one request/response round trip; returns the exit code carried by the response
+int exchange(const std::filesystem::path& socket_path, std::string_view request, std::ostream& out, std::ostream& err) {
+    std::string conn_err;
+    const int fd = connect_to(socket_path, conn_err);
+    if (fd < 0) {
+        err << "error: " << conn_err << "\n";
+        return 3;
+    }
+    std::string response;
+    const bool ok = write_all(fd, request) && ::shutdown(fd, SHUT_WR) == 0 && read_all(fd, response, SIZE_MAX);
+    ::close(fd);
+    if (!ok) {
+        err << "error: connection to " << socket_path.string() << " failed\n";
+        return 3;
+    }
+
+    std::string_view rest = response;
+    std::istringstream header{std::string(next_line(rest))};
+    std::string magic, version;
+    int exit_code = 3;
+    std::size_t out_len = 0, err_len = 0;
+    if (!(header >> magic >> version >> exit_code >> out_len >> err_len) ||
+        magic + " " + version != k_result_header || out_len + err_len != rest.size()) {
+        err << "error: malformed response from " << socket_path.string() << "\n";
+        return 3;
+    }
+    out << rest.substr(0, out_len);
+    err << rest.substr(out_len);
+    return exit_code;
+}
+
+} // namespace
+
+job_server::job_server(const plugin_manager& plugins, int jobs) : plugins_(plugins), jobs_(jobs) {}
+
+/// \brief job_server::~job_server.
+job_server::~job_server() {
+    close_socket();
+}
+
+/// \brief job_server::close_socket.
+void job_server::close_socket() {
+    if (fd_ < 0) return;
+    ::close(fd_);
+    fd_ = -1;
+    std::error_code ec;
+    std::filesystem::remove(socket_path_, ec);
+}
+
+/// \brief job_server::open.
+bool job_server::open(const std::filesystem::path& socket_path, std::string& err) {
+    sockaddr_un addr{};
+    if (!make_address(socket_path, addr, err)) return false;
+
+    struct stat st{};
+    if (::lstat(socket_path.c_str(), &st) == 0) {
+        if (!S_ISSOCK(st.st_mode)) {
+            err = "refusing to replace non-socket file: " + socket_path.string();
+            return false;
+        }
+        std::string probe_err;
+        const int probe = connect_to(socket_path, probe_err);
+        if (probe >= 0) {
+            ::close(probe);
+            err = "a server is already listening on " + socket_path.string();
+            return false;
+        }
+        ::unlink(socket_path.c_str());
+    }
+
+    fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0) {
+        err = std::string("socket: ") + std::strerror(errno);
+        return false;
+    }
+    if (::bind(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(fd_, 16) != 0) {
+        err = "cannot listen on " + socket_path.string() + ": " + std::strerror(errno);
+        ::close(fd_);
+        fd_ = -1;
+        return false;
+    }
+    socket_path_ = socket_path;
+    return true;
+}
+
+/// \brief job_server::run.
+void job_server::run(std::ostream* log) {
+    // no SA_RESTART: a signal has to interrupt accept() so the loop sees g_stop
+    struct sigaction sa{};
+    sa.sa_handler = on_stop_signal;
+    sigemptyset(&sa.sa_mask);
+    struct sigaction old_int{}, old_term{};
+    ::sigaction(SIGINT, &sa, &old_int);
+    ::sigaction(SIGTERM, &sa, &old_term);
+    g_stop = 0;
+
+    unsigned long job_no = 0;
+    bool shutdown = false;
+    while (!shutdown && !g_stop) {
+        const int client = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (log) *log << "error: accept: " << std::strerror(errno) << "\n";
+            break;
+        }
+
+        // a client that stops reading the response cannot hold the server either
+        const auto timeout_us = std::chrono::duration_cast<std::chrono::microseconds>(client_timeout_).count();
+        const timeval send_timeout{static_cast<time_t>(timeout_us / 1000000), static_cast<suseconds_t>(timeout_us % 1000000)};
+        ::setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &send_timeout, sizeof(send_timeout));
+
+        std::string request;
+        std::string response;
+        const auto start = std::chrono::steady_clock::now();
+        if (read_all(client, request, k_max_request_bytes, start + client_timeout_)) {
+            response = handle(request, shutdown);
+        } else if (g_stop) {
+            response = make_response(3, "", "error: server is shutting down\n");
+        } else {
+            response = make_response(3, "", "error: request too large, timed out or connection failed\n");
+        }
+        write_all(client, response);
+        ::close(client);
+
+        if (log) {
+            const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+            *log << "job " << ++job_no << ": " << response.substr(0, response.find('\n')) << " (" << ms << " ms)\n";
+            log->flush();
+        }
+    }
+
+    ::sigaction(SIGINT, &old_int, nullptr);
+    ::sigaction(SIGTERM, &old_term, nullptr);
+    // late clients must fail to connect instead of waiting in the backlog
+    close_socket();
+}
+
+/// \brief job_server::handle.
+std::string job_server::handle(std::string_view request, bool& shutdown) const {
+    const std::string_view header = next_line(request);
+    if (header == k_shutdown_header) {
+        shutdown = true;
+        return make_response(0, "server shutting down\n", "");
+    }
+    if (header != k_job_header) {
+        return make_response(3, "", "error: unsupported request\n");
+    }
+
+    std::filesystem::path cwd;
+    for (std::string_view line = next_line(request); !line.empty(); line = next_line(request)) {
+        if (line.substr(0, 4) == "cwd ") cwd = std::string(line.substr(4));
+    }
+
+    std::ostringstream out;
+    std::ostringstream err;
+    pipeline_graph graph;
+    std::string graph_err;
+    if (!pipeline_graph::parse(request, graph, graph_err) || !graph.validate(graph_err)) {
+        return make_response(3, "", "error: " + graph_err + "\n");
+    }
+    if (!pipeline_plugins_available(graph, plugins_, graph_err)) {
+        return make_response(3, "", "error: " + graph_err + "\n");
+    }
+
+    // jobs run one at a time, so switching the process cwd per job is safe
+    std::error_code ec;
+    const std::filesystem::path saved = std::filesystem::current_path(ec);
+    if (!cwd.empty()) {
+        std::filesystem::current_path(cwd, ec);
+        if (ec) return make_response(3, "", "error: cannot enter client directory " + cwd.string() + "\n");
+    }
+    const int code = pipeline_executor{plugins_}.run(graph, {jobs_, &out, &err}).exit_code();
+    if (!saved.empty()) std::filesystem::current_path(saved, ec);
+    return make_response(code, out.str(), err.str());
+}
+
+/// \brief submit_pipeline_job.
+int submit_pipeline_job(const std::filesystem::path& socket_path, std::string_view pipeline_text,
+                        std::ostream& out, std::ostream& err) {
+    std::error_code ec;
+    std::string request{k_job_header};
+    request += "\ncwd " + std::filesystem::current_path(ec).string() + "\n\n";
+    request += pipeline_text;
+    return exchange(socket_path, request, out, err);
+}
+
+/// \brief request_server_shutdown.
+int request_server_shutdown(const std::filesystem::path& socket_path, std::ostream& err) {
+    std::ostringstream ignored;
+    return exchange(socket_path, std::string(k_shutdown_header) + "\n", ignored, err);
+}
@@ -0,0 +1,71 @@
+/// \file
+/// \brief Implementation of stage parameter parsing.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/kv_params.h"
+
+#include <cctype>
+#include <sstream>
+
+namespace {
+
+/// \brief trim_copy.
+std::string trim_copy(std::string s) {
+    const auto is_space = [](unsigned char c) { return std::isspace(c) != 0; };
+    while (!s.empty() && is_space(static_cast<unsigned char>(s.front()))) s.erase(s.begin());
+    while (!s.empty() && is_space(static_cast<unsigned char>(s.back()))) s.pop_back();
+    return s;
+}
+
+} // namespace
+
+/// \brief parse_kv_pairs.
+std::vector<std::array<std::string, 2>> parse_kv_pairs(const std::string& raw) {
+    std::vector<std::array<std::string, 2>> pairs;
+    if (raw.empty()) return pairs;
+
+    std::stringstream ss(raw);
+    std::string token;
+    while (std::getline(ss, token, ',')) {
+        token = trim_copy(token);
+        if (token.empty()) continue;
+        const auto eq = token.find('=');
+        if (eq == std::string::npos) {
+            pairs.push_back({token, ""});
+        } else {
+            pairs.push_back({trim_copy(token.substr(0, eq)), trim_copy(token.substr(eq + 1))});
+        }
+    }
+    return pairs;
+}
+
+/// \brief find_kv_value.
+std::optional<std::string> find_kv_value(const std::string& raw, std::string_view key) {
+    for (const auto& pair : parse_kv_pairs(raw)) {
+        if (pair[0] == key) return pair[1];
+    }
+    return std::nullopt;
+}
+
+/// \brief kv_options::kv_options.
+kv_options::kv_options(const std::string& raw, std::initializer_list<std::string_view> skip_keys) {
+    for (auto& pair : parse_kv_pairs(raw)) {
+        bool skip = false;
+        for (const auto& k : skip_keys) {
+            if (pair[0] == k) { skip = true; break; }
+        }
+        if (skip) continue;
+        add(std::move(pair[0]), std::move(pair[1]));
+    }
+}
+
+/// \brief kv_options::add.
+void kv_options::add(std::string key, std::string value) {
+    storage_.push_back({std::move(key), std::move(value)});
+    auto& pair = storage_.back();
+    items_.push_back({pair[0].c_str(), pair[1].c_str()});
+}
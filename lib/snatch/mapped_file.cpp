@@ -0,0 +1,74 @@
+/// \file
+/// \brief Implementation of read-only file mapping.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/mapped_file.h"
+
+#include <fstream>
+#include <iterator>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+mapped_file::~mapped_file() {
+    close();
+}
+
+/// \brief mapped_file::open.
+bool mapped_file::open(const std::filesystem::path& path, std::string& err) {
+    close();
+#ifndef _WIN32
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        err = "cannot open " + path.string();
+        return false;
+    }
+    struct stat st {};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        err = "cannot read " + path.string();
+        return false;
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ > 0) {
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p != MAP_FAILED) {
+            // parsers read front to back
+            ::madvise(p, size_, MADV_SEQUENTIAL);
+            data_ = static_cast<const unsigned char*>(p);
+            mapped_ = true;
+        }
+    }
+    ::close(fd);
+    if (mapped_ || size_ == 0) return true;
+#endif
+    // no mmap here, or it failed (e.g. a pipe): read the file instead
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open()) {
+        err = "cannot open " + path.string();
+        return false;
+    }
+    copy_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    data_ = copy_.data();
+    size_ = copy_.size();
+    return true;
+}
+
+/// \brief mapped_file::close.
+void mapped_file::close() {
+#ifndef _WIN32
+    if (mapped_) ::munmap(const_cast<unsigned char*>(data_), size_);
+#endif
+    mapped_ = false;
+    data_ = nullptr;
+    size_ = 0;
+    copy_.clear();
+}
@@ -0,0 +1,862 @@
+/// \file
+/// \brief Pipeline graph parsing, validation, and parallel DAG execution.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/pipeline.h"
+
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include "snatch/glyph_stream.h"
+#include "snatch/kv_params.h"
+#include "snatch/plugin.h"
+#include "snatch/plugin_manager.h"
+
+namespace {
+
+/// \brief is_space.
+bool is_space(char c) {
+    return std::isspace(static_cast<unsigned char>(c)) != 0;
+}
+
+/// \brief trim_view.
+std::string_view trim_view(std::string_view s) {
+    while (!s.empty() && is_space(s.front())) s.remove_prefix(1);
+    while (!s.empty() && is_space(s.back())) s.remove_suffix(1);
+    return s;
+}
+
+/// \brief next_token.
+std::string_view next_token(std::string_view& s) {
+    s = trim_view(s);
+    std::size_t n = 0;
+    while (n < s.size() && !is_space(s[n])) ++n;
+    const std::string_view token = s.substr(0, n);
+    s.remove_prefix(n);
+    return token;
+}
+
+/// \brief parse_stage.
+bool parse_stage(std::string_view token, pipeline_stage& out) {
+    if (token == "extractor" || token == "extract") { out = pipeline_stage::extractor; return true; }
+    if (token == "transformer" || token == "transform") { out = pipeline_stage::transformer; return true; }
+    if (token == "exporter" || token == "export") { out = pipeline_stage::exporter; return true; }
+    return false;
+}
+
+/// \brief plugin_display_name.
+const char* plugin_display_name(const loaded_plugin* p) {
+    return (p && p->info && p->info->name) ? p->info->name : "(unknown)";
+}
+
+} // namespace
+
+/// \brief pipeline_stage_name.
+const char* pipeline_stage_name(pipeline_stage stage) {
+    switch (stage) {
+    case pipeline_stage::extractor: return "extractor";
+    case pipeline_stage::transformer: return "transformer";
+    case pipeline_stage::exporter: return "exporter";
+    }
+    return "(unknown)";
+}
+
+/// \brief pipeline_plugin_kind.
+int pipeline_plugin_kind(pipeline_stage stage) {
+    switch (stage) {
+    case pipeline_stage::extractor: return SNATCH_PLUGIN_KIND_EXTRACTOR;
+    case pipeline_stage::transformer: return SNATCH_PLUGIN_KIND_TRANSFORMER;
+    case pipeline_stage::exporter: return SNATCH_PLUGIN_KIND_EXPORTER;
+    }
+    return 0;
+}
+
+/// \brief pipeline_plugins_available.
+bool pipeline_plugins_available(const pipeline_graph& graph, const plugin_manager& plugins, std::string& err) {
+    std::map<std::string, const loaded_plugin*> resolved;
+    for (const auto& node : graph.nodes()) {
+        const loaded_plugin* p = plugins.find_by_name_and_kind(node.plugin, pipeline_plugin_kind(node.stage));
+        if (!p) {
+            err = std::string(pipeline_stage_name(node.stage)) + " plugin not found: " + node.plugin;
+            return false;
+        }
+        resolved[node.id] = p;
+    }
+
+    // declared payloads are matched along every edge, before anything runs
+    std::map<std::string, unsigned> produced;
+    std::function<unsigned(const pipeline_node&)> payload_of = [&](const pipeline_node& n) {
+        if (const auto it = produced.find(n.id); it != produced.end()) return it->second;
+        produced[n.id] = 0; // unknown while visiting, in case of a cycle
+        const pipeline_node* src = n.input.empty() ? nullptr : graph.find(n.input);
+        const unsigned out = plugin_output_payload(*resolved[n.id], src ? payload_of(*src) : 0);
+        produced[n.id] = out;
+        return out;
+    };
+    for (const auto& node : graph.nodes()) {
+        const pipeline_node* src = node.input.empty() ? nullptr : graph.find(node.input);
+        if (!src) continue;
+        const unsigned input = payload_of(*src);
+        const loaded_plugin& p = *resolved[node.id];
+        if (plugin_accepts_payload(p, input)) continue;
+        err = std::string(pipeline_stage_name(node.stage)) + " '" + node.id + "' (" + node.plugin + ") accepts " +
+              plugin_payload_names(p.accepts) + " but '" + src->id + "' (" + src->plugin + ") produces " +
+              plugin_payload_names(input);
+        return false;
+    }
+    return true;
+}
+
+// ---- graph ---------------------------------------------------------------
+
+/// \brief pipeline_graph::parse.
+bool pipeline_graph::parse(std::string_view text, pipeline_graph& out, std::string& err) {
+    out = {};
+    int line_no = 0;
+    while (!text.empty()) {
+        const std::size_t eol = text.find('\n');
+        std::string_view line = text.substr(0, eol);
+        text.remove_prefix(eol == std::string_view::npos ? text.size() : eol + 1);
+        ++line_no;
+
+        // '#' is a comment only at line start; parameters may contain colors like #000000
+        line = trim_view(line);
+        if (line.empty() || line.front() == '#') continue;
+
+        const auto where = [&]() { return "pipeline line " + std::to_string(line_no) + ": "; };
+        pipeline_node node;
+        const std::string_view stage = next_token(line);
+        if (!parse_stage(stage, node.stage)) {
+            err = where() + "unknown stage '" + std::string(stage) + "' (expected extractor|transformer|exporter)";
+            return false;
+        }
+        node.id = std::string(next_token(line));
+        node.plugin = std::string(next_token(line));
+        const std::string_view input = next_token(line);
+        if (node.id.empty() || node.plugin.empty() || input.empty()) {
+            err = where() + "expected '<stage> <id> <plugin> <input|-> [parameters]'";
+            return false;
+        }
+        if (input != "-") node.input = std::string(input);
+        node.parameters = std::string(trim_view(line));
+
+        std::string add_err;
+        if (!out.add(std::move(node), add_err)) {
+            err = where() + add_err;
+            return false;
+        }
+    }
+    return true;
+}
+
+/// \brief pipeline_graph::load.
+bool pipeline_graph::load(const std::filesystem::path& path, pipeline_graph& out, std::string& err) {
+    std::ifstream in{path};
+    if (!in.is_open()) {
+        err = "cannot open pipeline file: " + path.string();
+        return false;
+    }
+    std::ostringstream text;
+    text << in.rdbuf();
+    return parse(text.str(), out, err);
+}
+
+/// \brief pipeline_graph::add.
+bool pipeline_graph::add(pipeline_node node, std::string& err) {
+    if (node.id.empty()) {
+        err = "node id is empty";
+        return false;
+    }
+    if (find(node.id)) {
+        err = "duplicate node id '" + node.id + "'";
+        return false;
+    }
+    nodes_.push_back(std::move(node));
+    return true;
+}
+
+/// \brief pipeline_graph::find.
+const pipeline_node* pipeline_graph::find(std::string_view id) const {
+    for (const auto& n : nodes_) {
+        if (n.id == id) return &n;
+    }
+    return nullptr;
+}
+
+/// \brief pipeline_graph::plugin_names.
+std::vector<std::string> pipeline_graph::plugin_names() const {
+    std::vector<std::string> names;
+    for (const auto& n : nodes_) {
+        if (n.plugin.empty()) continue;
+        if (std::find(names.begin(), names.end(), n.plugin) == names.end()) names.push_back(n.plugin);
+    }
+    return names;
+}
+
+/// \brief pipeline_graph::validate.
+bool pipeline_graph::validate(std::string& err) const {
+    if (nodes_.empty()) {
+        err = "pipeline has no nodes";
+        return false;
+    }
+
+    std::set<std::string> outputs;
+    for (const auto& n : nodes_) {
+        const std::string who = std::string(pipeline_stage_name(n.stage)) + " '" + n.id + "'";
+        if (n.plugin.empty()) {
+            err = who + " has no plugin";
+            return false;
+        }
+        if (n.stage == pipeline_stage::extractor) {
+            if (!n.input.empty()) {
+                err = who + " must not have an input node";
+                return false;
+            }
+            const auto input = find_kv_value(n.parameters, "input");
+            if (!input || input->empty()) {
+                err = who + " requires input=... in its parameters";
+                return false;
+            }
+            continue;
+        }
+
+        const pipeline_node* src = find(n.input);
+        if (!src) {
+            err = who + " reads unknown node '" + n.input + "'";
+            return false;
+        }
+        if (src->stage == pipeline_stage::exporter) {
+            err = who + " cannot read exporter '" + src->id + "'";
+            return false;
+        }
+        if (n.stage == pipeline_stage::exporter) {
+            const auto output = find_kv_value(n.parameters, "output");
+            if (!output || output->empty()) {
+                err = who + " requires output=... in its parameters";
+                return false;
+            }
+            if (!outputs.insert(*output).second) {
+                err = who + " writes '" + *output + "' which another exporter also writes";
+                return false;
+            }
+        }
+    }
+
+    for (const auto& n : nodes_) {
+        const pipeline_node* cur = &n;
+        for (std::size_t steps = 0; cur && !cur->input.empty(); ++steps) {
+            if (steps > nodes_.size()) {
+                err = "pipeline has a cycle through node '" + n.id + "'";
+                return false;
+            }
+            cur = find(cur->input);
+        }
+    }
+
+    // Walk every transformer's ancestry: a plugin feeding itself would
+    // overwrite the data its second run is reading.
+    std::map<std::string, std::set<std::string>> plugin_after;
+    for (const auto& n : nodes_) {
+        if (n.stage != pipeline_stage::transformer) continue;
+        for (const pipeline_node* cur = find(n.input); cur; cur = cur->input.empty() ? nullptr : find(cur->input)) {
+            if (cur->plugin == n.plugin) {
+                err = "plugin '" + n.plugin + "' is used twice on one branch (node '" + cur->id + "' feeds '" + n.id + "')";
+                return false;
+            }
+            plugin_after[cur->plugin].insert(n.plugin);
+        }
+    }
+
+    // Plugins hold their output until its consumers are done, so two branches
+    // using the same plugins in opposite order could wait on each other.
+    std::map<std::string, int> mark; // 0 new, 1 on stack, 2 done
+    std::function<bool(const std::string&)> visit = [&](const std::string& p) {
+        mark[p] = 1;
+        for (const auto& q : plugin_after[p]) {
+            if (mark[q] == 1) {
+                err = "plugins '" + p + "' and '" + q + "' are chained in opposite orders on different branches";
+                return false;
+            }
+            if (mark[q] == 0 && !visit(q)) return false;
+        }
+        mark[p] = 2;
+        return true;
+    };
+    for (const auto& [p, _] : plugin_after) {
+        if (mark[p] == 0 && !visit(p)) return false;
+    }
+    return true;
+}
+
+/// \brief pipeline_graph::to_text.
+std::string pipeline_graph::to_text() const {
+    std::ostringstream out;
+    for (const auto& n : nodes_) {
+        out << pipeline_stage_name(n.stage) << ' ' << n.id << ' ' << n.plugin << ' '
+            << (n.input.empty() ? "-" : n.input);
+        if (!n.parameters.empty()) out << ' ' << n.parameters;
+        out << '\n';
+    }
+    return out.str();
+}
+
+// ---- report --------------------------------------------------------------
+
+/// \brief pipeline_report::ok.
+bool pipeline_report::ok() const {
+    return std::all_of(nodes.begin(), nodes.end(), [](const pipeline_node_result& r) { return r.ran && r.rc == 0; });
+}
+
+/// \brief pipeline_report::exit_code.
+int pipeline_report::exit_code() const {
+    int code = 0;
+    for (const auto& r : nodes) {
+        if (!r.ran || r.rc == 0) continue;
+        if (r.stage == pipeline_stage::extractor) return 4;
+        code = 5;
+    }
+    return code;
+}
+
+// ---- executor ------------------------------------------------------------
+
+namespace {
+
+enum class node_status { waiting, running, done, failed, skipped };
+
+struct node_state {
+    const pipeline_node* node{nullptr};
+    const loaded_plugin* plugin{nullptr};
+    int input{-1};
+    std::vector<int> consumers;
+    node_status status{node_status::waiting};
+    std::size_t pending_consumers{0};
+    snatch_font font{}; // output of extractors/transformers while consumers run
+    std::shared_ptr<const void> owner; // host-side storage behind font, if any
+    std::string signature; // cache key, set when the node starts
+    bool streamed{false};  // runs inside its extractor's stream group
+    int streamed_glyphs{-1};
+};
+
+struct run_state {
+    std::mutex mu;
+    std::condition_variable cv;
+    std::vector<node_state> nodes;
+    std::set<const loaded_plugin*> leased; // plugins whose output is still in use
+    std::set<const loaded_plugin*> busy;   // exporters that must not run concurrently
+    std::size_t running{0};
+    std::size_t remaining{0};
+    pipeline_report report;
+    const pipeline_run_options* options{nullptr};
+    pipeline_cache* cache{nullptr};
+};
+
+/// \brief holds_lease.
+bool holds_lease(const node_state& n) {
+    // streams keep their state per stream, never in the plugin's output
+    if (n.node->stage == pipeline_stage::exporter || n.streamed) return false;
+    return n.node->stage != pipeline_stage::transformer || (n.plugin->capabilities & SNATCH_CAP_IN_PLACE) == 0;
+}
+
+/// \brief runs_alone.
+// exporters keep no output, but one that is not thread-safe runs one node at a time
+bool runs_alone(const node_state& n) {
+    return n.node->stage == pipeline_stage::exporter && !n.streamed && (n.plugin->capabilities & SNATCH_CAP_THREAD_SAFE) == 0;
+}
+
+/// \brief lazy_source.
+// where a node's glyphs come from when they are made on demand; only an ABI 8
+// producer's bitmap_font has the field
+const snatch_glyph_source* lazy_source(const node_state& n) {
+    const snatch_bitmap_font* bf = n.font.bitmap_font;
+    if (!bf || bf->glyphs || bf->glyph_count <= 0 || !n.plugin || !SNATCH_PLUGIN_HAS_LAZY_GLYPHS(n.plugin->info)) return nullptr;
+    return bf->source;
+}
+
+/// \brief is_ready.
+bool is_ready(const run_state& st, const node_state& n) {
+    if (n.status != node_status::waiting) return false;
+    if (n.input >= 0 && st.nodes[static_cast<std::size_t>(n.input)].status != node_status::done) return false;
+    if (holds_lease(n) && st.leased.count(n.plugin) != 0) return false;
+    if (runs_alone(n) && st.busy.count(n.plugin) != 0) return false;
+    return true;
+}
+
+/// \brief release_output.
+// drop a node's output once nothing reads it any more; frees its plugin for reuse
+void release_output(run_state& st, node_state& n) {
+    n.font = {};
+    n.owner.reset();
+    if (holds_lease(n)) st.leased.erase(n.plugin);
+}
+
+/// \brief consumer_finished.
+void consumer_finished(run_state& st, const node_state& consumer) {
+    if (consumer.input < 0) return;
+    auto& src = st.nodes[static_cast<std::size_t>(consumer.input)];
+    if (src.pending_consumers > 0 && --src.pending_consumers == 0) release_output(st, src);
+}
+
+/// \brief skip_descendants.
+void skip_descendants(run_state& st, const node_state& n) {
+    for (const int c : n.consumers) {
+        auto& child = st.nodes[static_cast<std::size_t>(c)];
+        if (child.status != node_status::waiting) continue;
+        child.status = node_status::skipped;
+        --st.remaining;
+        skip_descendants(st, child);
+    }
+}
+
+/// \brief finish_node.
+void finish_node(run_state& st, std::size_t index, int rc, const std::string& error) {
+    auto& n = st.nodes[index];
+    auto& result = st.report.nodes[index];
+    result.ran = true;
+    result.rc = rc;
+    result.error = error;
+    --st.running;
+    --st.remaining;
+
+    std::ostream* log = st.options->log;
+    std::ostream* err = st.options->err;
+    if (rc == 0 && result.cached) {
+        n.status = node_status::done;
+        if (log) *log << "  reused " << pipeline_stage_name(n.node->stage) << " '" << n.node->id << "' from cache\n";
+        n.pending_consumers = n.consumers.size();
+        if (n.pending_consumers == 0) release_output(st, n);
+    } else if (rc != 0) {
+        n.status = node_status::failed;
+        if (err) {
+            *err << "error: " << pipeline_stage_name(n.node->stage) << " '" << n.node->id << "' failed (" << rc << ")";
+            if (!error.empty()) *err << ": " << error;
+            *err << "\n";
+        }
+        release_output(st, n);
+        skip_descendants(st, n);
+    } else {
+        n.status = node_status::done;
+        const char* name = plugin_display_name(n.plugin);
+        if (log) {
+            switch (n.node->stage) {
+            case pipeline_stage::extractor: {
+                *log << "  extracted with plugin: " << name << "\n";
+                int glyphs = (n.font.bitmap_font && (n.font.bitmap_font->glyphs || lazy_source(n))) ? n.font.bitmap_font->glyph_count : 0;
+                if (n.streamed_glyphs >= 0) glyphs = n.streamed_glyphs;
+                *log << "  extracted glyphs: " << glyphs << " at " << n.font.pixel_size << "ppem\n";
+                break;
+            }
+            case pipeline_stage::transformer:
+                *log << "  transformed with plugin: " << name << "\n";
+                break;
+            case pipeline_stage::exporter:
+                *log << "  exported with plugin: " << name << " -> "
+                     << find_kv_value(n.node->parameters, "output").value_or("") << "\n";
+                break;
+            }
+        }
+        n.pending_consumers = n.consumers.size();
+        if (n.pending_consumers == 0) release_output(st, n);
+    }
+    consumer_finished(st, n);
+}
+
+/// \brief node_signature.
+// everything a node's result depends on; extractors add their input file stamp
+std::string node_signature(const run_state& st, const node_state& n) {
+    std::string sig = std::string(pipeline_stage_name(n.node->stage)) + '\x1f' + n.node->plugin + '\x1f' + n.node->parameters;
+    if (n.input >= 0) {
+        const std::string& parent = st.nodes[static_cast<std::size_t>(n.input)].signature;
+        if (parent.empty()) return {};
+        sig += '\x1f' + parent;
+    }
+    if (n.node->stage == pipeline_stage::extractor) {
+        const std::filesystem::path input = find_kv_value(n.node->parameters, "input").value_or("");
+        std::error_code ec;
+        const auto mtime = std::filesystem::last_write_time(input, ec);
+        const auto size = ec ? 0 : std::filesystem::file_size(input, ec);
+        if (ec) return {}; // unreadable input: never reuse
+        sig += '\x1f' + std::to_string(mtime.time_since_epoch().count()) + ':' + std::to_string(size);
+    }
+    return sig;
+}
+
+/// \brief try_reuse.
+bool try_reuse(const run_state& st, const node_state& n, snatch_font& font, std::shared_ptr<const void>& owner) {
+    if (n.signature.empty()) return false;
+    const auto it = st.cache->nodes.find(n.node->id);
+    if (it == st.cache->nodes.end() || it->second.signature != n.signature) return false;
+    if (n.node->stage == pipeline_stage::exporter) {
+        std::error_code ec;
+        return std::filesystem::exists(find_kv_value(n.node->parameters, "output").value_or(""), ec);
+    }
+    // the plugin still holds this output only if it has not run since
+    const auto runs = st.cache->plugin_runs.find(n.plugin);
+    if (runs == st.cache->plugin_runs.end() || runs->second != it->second.plugin_run) return false;
+    font = it->second.font;
+    owner = it->second.owner;
+    return true;
+}
+
+/// \brief run_node.
+// a plugin without the whole-font entry point for its stage runs through its
+// stream; `source` is the input's lazy glyph source, if any
+int run_node(const node_state& n, snatch_font& font, std::shared_ptr<const void>& owner, const snatch_glyph_source* source,
+             std::string& error) {
+    char errbuf[512] = {0};
+    int rc = 0;
+    const pipeline_node& node = *n.node;
+    const snatch_plugin_info& info = *n.plugin->info;
+
+    // a whole-font entry point gets every glyph made up front unless it reads
+    // the source itself, in which case it sees a bitmap_font that has the field
+    const snatch_bitmap_font* input_glyphs = font.bitmap_font;
+    snatch_bitmap_font lazy_view{};
+    const bool whole_font = node.stage == pipeline_stage::transformer ? info.transform_font != nullptr
+                          : node.stage == pipeline_stage::exporter && info.export_font != nullptr;
+    if (whole_font && (n.plugin->capabilities & SNATCH_CAP_LAZY_GLYPHS) != 0 && input_glyphs) {
+        lazy_view = {input_glyphs->glyph_count, input_glyphs->glyphs, source};
+        font.bitmap_font = &lazy_view;
+    } else if (whole_font && source) {
+        auto collected = std::make_shared<glyph_collector>();
+        if (feed_font(font, collected->sink(), source) != 0) {
+            error = "cannot make the glyphs of the input font";
+            return 3;
+        }
+        collected->keep(std::move(owner));
+        font = collected->font();
+        owner = std::move(collected);
+        source = nullptr;
+    }
+
+    switch (node.stage) {
+    case pipeline_stage::extractor: {
+        const std::string input = find_kv_value(node.parameters, "input").value_or("");
+        const kv_options options{node.parameters, {"input"}};
+        font = {};
+        if (info.extract_font) {
+            rc = info.extract_font(input.c_str(), options.data(), options.size(), &font,
+                                   errbuf, static_cast<unsigned>(sizeof(errbuf)));
+            break;
+        }
+        auto collected = std::make_shared<glyph_collector>();
+        rc = info.stream_extract(input.c_str(), options.data(), options.size(), &collected->sink(),
+                                 errbuf, static_cast<unsigned>(sizeof(errbuf)));
+        if (rc == 0) {
+            font = collected->font();
+            owner = std::move(collected);
+        }
+        break;
+    }
+    case pipeline_stage::transformer: {
+        const kv_options options{node.parameters};
+        if (info.transform_font) {
+            rc = info.transform_font(&font, options.data(), options.size(),
+                                     errbuf, static_cast<unsigned>(sizeof(errbuf)));
+            break;
+        }
+        auto collected = std::make_shared<glyph_collector>();
+        snatch_glyph_sink sink{};
+        rc = info.stream_transform(options.data(), options.size(), &collected->sink(), &sink,
+                                   errbuf, static_cast<unsigned>(sizeof(errbuf)));
+        if (rc != 0) break;
+        rc = feed_font(font, sink, source);
+        if (sink.close) sink.close(sink.ctx);
+        if (rc == 0) {
+            // the output may still point at input data, e.g. a passed-through user_data
+            collected->keep(std::move(owner));
+            font = collected->font();
+            owner = std::move(collected);
+        }
+        break;
+    }
+    case pipeline_stage::exporter: {
+        const std::string output = find_kv_value(node.parameters, "output").value_or("");
+        const kv_options options{node.parameters, {"output"}};
+        if (info.export_font) {
+            rc = info.export_font(&font, output.c_str(), options.data(), options.size(),
+                                  errbuf, static_cast<unsigned>(sizeof(errbuf)));
+            break;
+        }
+        snatch_glyph_sink sink{};
+        rc = info.stream_export(output.c_str(), options.data(), options.size(), &sink,
+                                errbuf, static_cast<unsigned>(sizeof(errbuf)));
+        if (rc != 0) break;
+        rc = feed_font(font, sink, source);
+        if (sink.close) sink.close(sink.ctx);
+        break;
+    }
+    }
+    // an in-place transformer hands back the glyphs it was given
+    if (font.bitmap_font == &lazy_view) font.bitmap_font = input_glyphs;
+    if (rc != 0) error = errbuf[0] == '\0' && source ? "cannot make the glyphs of the input font" : errbuf;
+    return rc;
+}
+
+/// \brief streams_stage.
+// the node's plugin has a streaming entry point for the node's stage
+bool streams_stage(const node_state& n) {
+    if (!n.plugin || !n.plugin->info || !SNATCH_PLUGIN_HAS_STREAMS(n.plugin->info)) return false;
+    const snatch_plugin_info& info = *n.plugin->info;
+    switch (n.node->stage) {
+    case pipeline_stage::extractor: return info.stream_extract != nullptr;
+    case pipeline_stage::transformer: return info.stream_transform != nullptr;
+    case pipeline_stage::exporter: return info.stream_export != nullptr;
+    }
+    return false;
+}
+
+/// \brief streams_subtree.
+bool streams_subtree(const run_state& st, const node_state& n) {
+    if (n.status != node_status::waiting || !streams_stage(n)) return false;
+    return std::all_of(n.consumers.begin(), n.consumers.end(), [&](int c) {
+        return streams_subtree(st, st.nodes[static_cast<std::size_t>(c)]);
+    });
+}
+
+/// \brief mark_streamed.
+void mark_streamed(run_state& st, node_state& n) {
+    n.streamed = true;
+    for (const int c : n.consumers) mark_streamed(st, st.nodes[static_cast<std::size_t>(c)]);
+}
+
+// glyphs buffered between a streaming extractor and its consumers
+constexpr std::size_t k_stream_queue_glyphs = 64;
+// and at most this much bitmap data, for streams of big glyphs such as image bands
+constexpr std::size_t k_stream_queue_bytes = std::size_t{4} << 20;
+
+// one node of a stream group while it runs
+struct stream_stage {
+    snatch_glyph_sink sink{}; // opened by transformers and exporters
+    glyph_tee tee;            // fan-out to the node's consumers
+    kv_options options;
+    std::string output;
+    char errbuf[512] = {0};
+    int rc{0};
+    bool opened{false};
+    std::size_t branch{0};    // index in the input node's tee
+};
+
+/// \brief run_stream_group.
+// Runs a streamed extractor and all of its descendants at once. The extractor
+// produces into a bounded queue on this thread; a second thread drains it into
+// the sinks, so consumers work while extraction goes on.
+void run_stream_group(run_state& st, std::size_t root, std::unique_lock<std::mutex>& lock) {
+    std::vector<int> order{static_cast<int>(root)}; // breadth first
+    for (std::size_t i = 0; i < order.size(); ++i) {
+        for (const int c : st.nodes[static_cast<std::size_t>(order[i])].consumers) order.push_back(c);
+    }
+    for (const int i : order) {
+        st.nodes[static_cast<std::size_t>(i)].status = node_status::running;
+        ++st.running;
+    }
+    lock.unlock();
+
+    std::map<int, std::unique_ptr<stream_stage>> stages;
+    for (const int i : order) stages[i] = std::make_unique<stream_stage>();
+
+    // open bottom-up: a transformer's sink needs its consumers' fan-out
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        const node_state& n = st.nodes[static_cast<std::size_t>(*it)];
+        stream_stage& s = *stages[*it];
+        const snatch_plugin_info& info = *n.plugin->info;
+        const auto errbuf_len = static_cast<unsigned>(sizeof(s.errbuf));
+        if (n.node->stage == pipeline_stage::transformer) {
+            s.options = kv_options{n.node->parameters};
+            s.rc = info.stream_transform(s.options.data(), s.options.size(), &s.tee.sink(), &s.sink, s.errbuf, errbuf_len);
+        } else if (n.node->stage == pipeline_stage::exporter) {
+            s.output = find_kv_value(n.node->parameters, "output").value_or("");
+            s.options = kv_options{n.node->parameters, {"output"}};
+            s.rc = info.stream_export(s.output.c_str(), s.options.data(), s.options.size(), &s.sink, s.errbuf, errbuf_len);
+        } else {
+            continue;
+        }
+        s.opened = s.rc == 0;
+        if (!s.opened) continue;
+        glyph_tee& parent = stages[n.input]->tee;
+        s.branch = parent.branches().size();
+        parent.add(s.sink, n.node->stage == pipeline_stage::transformer ? &s.tee : nullptr);
+    }
+
+    const node_state& r = st.nodes[root];
+    stream_stage& top = *stages[static_cast<int>(root)];
+    glyph_queue queue{top.tee.sink(), k_stream_queue_glyphs, k_stream_queue_bytes};
+    std::thread consumer([&queue]() { queue.pump(); });
+    {
+        const std::string input = find_kv_value(r.node->parameters, "input").value_or("");
+        const kv_options options{r.node->parameters, {"input"}};
+        top.rc = r.plugin->info->stream_extract(input.c_str(), options.data(), options.size(), &queue.sink(),
+                                                top.errbuf, static_cast<unsigned>(sizeof(top.errbuf)));
+    }
+    queue.finish();
+    consumer.join();
+    // stopping because every consumer failed is not the extractor's failure
+    if (queue.downstream_failed()) top.rc = 0;
+    for (const int i : order) {
+        const stream_stage& s = *stages[i];
+        if (s.opened && s.sink.close) s.sink.close(s.sink.ctx);
+    }
+
+    lock.lock();
+    for (std::size_t k = 1; k < order.size(); ++k) st.nodes[static_cast<std::size_t>(order[k])].status = node_status::waiting;
+    st.running -= order.size() - 1;
+
+    auto& rn = st.nodes[root];
+    rn.streamed_glyphs = queue.glyphs();
+    rn.font.pixel_size = queue.pixel_size();
+    finish_node(st, root, top.rc, top.rc != 0 ? top.errbuf : "");
+    for (std::size_t k = 1; k < order.size(); ++k) {
+        const auto index = static_cast<std::size_t>(order[k]);
+        if (st.nodes[index].status != node_status::waiting) continue; // skipped below a failed node
+        const stream_stage& s = *stages[order[k]];
+        int rc = s.rc;
+        if (rc == 0) {
+            const auto& b = stages[st.nodes[index].input]->tee.branches()[s.branch];
+            if (b.failed) rc = b.rc;
+        }
+        ++st.running;
+        finish_node(st, index, rc, rc != 0 ? s.errbuf : "");
+    }
+}
+
+/// \brief worker_loop.
+void worker_loop(run_state& st) {
+    std::unique_lock lock(st.mu);
+    for (;;) {
+        std::size_t pick = st.nodes.size();
+        st.cv.wait(lock, [&]() {
+            if (st.remaining == 0) return true;
+            for (std::size_t i = 0; i < st.nodes.size(); ++i) {
+                if (is_ready(st, st.nodes[i])) { pick = i; return true; }
+            }
+            // nothing runnable and nothing in flight: validation should prevent this
+            return st.running == 0;
+        });
+        if (st.remaining == 0) return;
+        if (pick == st.nodes.size()) {
+            for (std::size_t i = 0; i < st.nodes.size(); ++i) {
+                if (st.nodes[i].status != node_status::waiting) continue;
+                ++st.running;
+                finish_node(st, i, 3, "pipeline cannot be scheduled (plugin wait cycle)");
+            }
+            st.cv.notify_all();
+            return;
+        }
+
+        auto& n = st.nodes[pick];
+        if (n.streamed) {
+            run_stream_group(st, pick, lock);
+            st.cv.notify_all();
+            continue;
+        }
+        n.status = node_status::running;
+        ++st.running;
+        if (holds_lease(n)) st.leased.insert(n.plugin);
+        if (runs_alone(n)) st.busy.insert(n.plugin);
+        // consumers work on their own copy; the input stays untouched for siblings
+        snatch_font font = n.input >= 0 ? st.nodes[static_cast<std::size_t>(n.input)].font : snatch_font{};
+        std::shared_ptr<const void> owner = n.input >= 0 ? st.nodes[static_cast<std::size_t>(n.input)].owner : nullptr;
+        const snatch_glyph_source* source = n.input >= 0 ? lazy_source(st.nodes[static_cast<std::size_t>(n.input)]) : nullptr;
+
+        bool reused = false;
+        if (st.cache) {
+            n.signature = node_signature(st, n);
+            reused = try_reuse(st, n, font, owner);
+            if (!reused) {
+                st.cache->nodes.erase(n.node->id);
+                if (holds_lease(n)) ++st.cache->plugin_runs[n.plugin];
+            }
+        }
+
+        int rc = 0;
+        std::string error;
+        if (!reused) {
+            lock.unlock();
+            rc = run_node(n, font, owner, source, error);
+            lock.lock();
+            if (rc == 0 && st.cache) {
+                st.cache->nodes[n.node->id] = {n.signature, holds_lease(n) ? st.cache->plugin_runs[n.plugin] : 0, font, owner};
+            }
+        }
+
+        if (rc == 0 && n.node->stage != pipeline_stage::exporter) {
+            n.font = font;
+            n.owner = std::move(owner);
+        }
+        st.report.nodes[pick].cached = reused;
+        if (runs_alone(n)) st.busy.erase(n.plugin);
+        finish_node(st, pick, rc, error);
+        st.cv.notify_all();
+    }
+}
+
+} // namespace
+
+pipeline_executor::pipeline_executor(const plugin_manager& plugins) : plugins_(plugins) {}
+
+/// \brief pipeline_executor::run.
+pipeline_report pipeline_executor::run(const pipeline_graph& graph, const pipeline_run_options& options) const {
+    run_state st;
+    st.options = &options;
+    st.cache = options.cache;
+    const auto& nodes = graph.nodes();
+    st.nodes.resize(nodes.size());
+    st.report.nodes.resize(nodes.size());
+    st.remaining = nodes.size();
+
+    for (std::size_t i = 0; i < nodes.size(); ++i) {
+        auto& n = st.nodes[i];
+        n.node = &nodes[i];
+        st.report.nodes[i].id = nodes[i].id;
+        st.report.nodes[i].stage = nodes[i].stage;
+        n.plugin = plugins_.find_by_name_and_kind(nodes[i].plugin, pipeline_plugin_kind(nodes[i].stage));
+        if (nodes[i].input.empty()) continue;
+        for (std::size_t j = 0; j < nodes.size(); ++j) {
+            if (nodes[j].id == nodes[i].input) {
+                n.input = static_cast<int>(j);
+                st.nodes[j].consumers.push_back(static_cast<int>(i));
+                break;
+            }
+        }
+    }
+
+    // a node without its plugin fails up front and takes its branch with it
+    for (std::size_t i = 0; i < st.nodes.size(); ++i) {
+        auto& n = st.nodes[i];
+        if (n.plugin || n.status != node_status::waiting) continue;
+        ++st.running;
+        finish_node(st, i, 3, std::string(pipeline_stage_name(n.node->stage)) + " plugin not found: " + n.node->plugin);
+    }
+
+    // cached runs go node by node, so each result can be kept
+    if (!st.cache) {
+        for (auto& n : st.nodes) {
+            if (n.node->stage == pipeline_stage::extractor && !n.consumers.empty() && streams_subtree(st, n)) mark_streamed(st, n);
+        }
+    }
+
+    std::size_t workers = options.jobs > 0 ? static_cast<std::size_t>(options.jobs) : std::thread::hardware_concurrency();
+    workers = std::clamp<std::size_t>(workers, 1, std::max<std::size_t>(1, st.nodes.size()));
+    if (workers == 1) {
+        worker_loop(st);
+    } else {
+        std::vector<std::thread> pool;
+        pool.reserve(workers);
+        for (std::size_t w = 0; w < workers; ++w) pool.emplace_back([&st]() { worker_loop(st); });
+        for (auto& t : pool) t.join();
+    }
+    return std::move(st.report);
+}
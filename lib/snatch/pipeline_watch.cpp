@@ -0,0 +1,195 @@
+/// \file
+/// \brief inotify file watcher and incremental pipeline watch loop.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/pipeline_watch.h"
+
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+
+#include "snatch/kv_params.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+volatile std::sig_atomic_t g_stop = 0;
+
+/// \brief on_stop_signal.
+void on_stop_signal(int) {
+    g_stop = 1;
+}
+
+/// \brief absolute_path.
+fs::path absolute_path(const fs::path& p) {
+    std::error_code ec;
+    fs::path abs = fs::absolute(p, ec);
+    return ec ? p.lexically_normal() : abs.lexically_normal();
+}
+
+/// \brief load_manifest.
+bool load_manifest(const plugin_manager& plugins, const fs::path& path, pipeline_graph& out, std::string& err) {
+    pipeline_graph graph;
+    if (!pipeline_graph::load(path, graph, err) || !graph.validate(err) ||
+        !pipeline_plugins_available(graph, plugins, err)) {
+        return false;
+    }
+    out = std::move(graph);
+    return true;
+}
+
+} // namespace
+
+file_watcher::file_watcher() : fd_(::inotify_init1(IN_NONBLOCK | IN_CLOEXEC)) {}
+
+/// \brief file_watcher::~file_watcher.
+file_watcher::~file_watcher() {
+    if (fd_ >= 0) ::close(fd_);
+}
+
+/// \brief file_watcher::watch.
+bool file_watcher::watch(const std::vector<fs::path>& files, std::string& err) {
+    if (fd_ < 0) {
+        err = std::string("inotify: ") + std::strerror(errno);
+        return false;
+    }
+    for (const int wd : watches_) ::inotify_rm_watch(fd_, wd);
+    watches_.clear();
+    dirs_.clear();
+    files_.clear();
+
+    for (const auto& f : files) {
+        const fs::path abs = absolute_path(f);
+        files_.push_back(abs);
+        const fs::path dir = abs.parent_path();
+        if (std::find(dirs_.begin(), dirs_.end(), dir) != dirs_.end()) continue;
+        const int wd = ::inotify_add_watch(fd_, dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB);
+        if (wd < 0) {
+            err = "cannot watch " + dir.string() + ": " + std::strerror(errno);
+            return false;
+        }
+        watches_.push_back(wd);
+        dirs_.push_back(dir);
+    }
+    return true;
+}
+
+/// \brief file_watcher::wait.
+std::vector<fs::path> file_watcher::wait(int debounce_ms, int timeout_ms) {
+    std::vector<fs::path> changed;
+    alignas(inotify_event) char buf[4096];
+    int wait_ms = timeout_ms;
+    for (;;) {
+        pollfd pfd{fd_, POLLIN, 0};
+        const int ready = ::poll(&pfd, 1, wait_ms);
+        if (ready < 0) return {};       // interrupted: caller checks its stop flag
+        if (ready == 0) return changed; // timeout, or quiet for debounce_ms
+
+        for (;;) {
+            const ssize_t len = ::read(fd_, buf, sizeof(buf));
+            if (len <= 0) break;
+            for (ssize_t off = 0; off < len;) {
+                const auto* ev = reinterpret_cast<const inotify_event*>(buf + off);
+                off += static_cast<ssize_t>(sizeof(inotify_event) + ev->len);
+                if (ev->len == 0) continue;
+                const auto wd = std::find(watches_.begin(), watches_.end(), ev->wd);
+                if (wd == watches_.end()) continue;
+                const fs::path file = dirs_[static_cast<std::size_t>(wd - watches_.begin())] / ev->name;
+                if (std::find(files_.begin(), files_.end(), file) == files_.end()) continue;
+                if (std::find(changed.begin(), changed.end(), file) == changed.end()) changed.push_back(file);
+            }
+        }
+        // after the first relevant event, only wait out the burst
+        if (!changed.empty()) wait_ms = debounce_ms;
+    }
+}
+
+/// \brief pipeline_inputs.
+std::vector<fs::path> pipeline_inputs(const pipeline_graph& graph) {
+    std::vector<fs::path> inputs;
+    for (const auto& node : graph.nodes()) {
+        if (node.stage != pipeline_stage::extractor) continue;
+        if (const auto input = find_kv_value(node.parameters, "input"); input && !input->empty()) inputs.emplace_back(*input);
+    }
+    return inputs;
+}
+
+/// \brief watch_pipeline.
+int watch_pipeline(const plugin_manager& plugins, pipeline_graph graph, const pipeline_watch_options& options) {
+    // no SA_RESTART: a signal has to interrupt poll() so the loop sees g_stop
+    struct sigaction sa{};
+    sa.sa_handler = on_stop_signal;
+    sigemptyset(&sa.sa_mask);
+    struct sigaction old_int{}, old_term{};
+    ::sigaction(SIGINT, &sa, &old_int);
+    ::sigaction(SIGTERM, &sa, &old_term);
+    g_stop = 0;
+
+    pipeline_cache cache;
+    const pipeline_executor executor{plugins};
+    const fs::path manifest = options.manifest.empty() ? fs::path{} : absolute_path(options.manifest);
+    file_watcher watcher;
+    std::vector<fs::path> watched;
+    int rc = 0;
+    bool rerun = true;
+
+    while (!g_stop) {
+        if (rerun) {
+            const pipeline_report report = executor.run(graph, {options.jobs, options.log, options.err, &cache});
+            const auto cached = std::count_if(report.nodes.begin(), report.nodes.end(),
+                                              [](const pipeline_node_result& r) { return r.cached; });
+            if (options.log) {
+                *options.log << (report.ok() ? "  pipeline ok" : "  pipeline failed") << " (" << report.nodes.size() - static_cast<std::size_t>(cached)
+                             << " ran, " << cached << " reused)\n";
+            }
+        }
+
+        std::vector<fs::path> files = pipeline_inputs(graph);
+        if (!manifest.empty()) files.push_back(manifest);
+        std::string err;
+        if (files != watched) {
+            if (!watcher.watch(files, err)) {
+                if (options.err) *options.err << "error: " << err << "\n";
+                rc = 3;
+                break;
+            }
+            watched = files;
+        }
+        if (rerun && options.log) {
+            *options.log << "watching " << files.size() << " file(s); Ctrl+C to stop\n";
+            options.log->flush();
+        }
+
+        const std::vector<fs::path> changed = watcher.wait(options.debounce_ms);
+        if (changed.empty()) {
+            rerun = false;
+            continue;
+        }
+        for (const auto& f : changed) {
+            if (options.log) *options.log << "changed: " << f.string() << "\n";
+        }
+
+        rerun = true;
+        if (!manifest.empty() && std::find(changed.begin(), changed.end(), manifest) != changed.end()) {
+            // a broken edit keeps the previous graph until the next save
+            if (!load_manifest(plugins, manifest, graph, err)) {
+                if (options.err) *options.err << "error: " << err << "\n";
+                rerun = false;
+            }
+        }
+    }
+
+    ::sigaction(SIGINT, &old_int, nullptr);
+    ::sigaction(SIGTERM, &old_term, nullptr);
+    return rc;
+}
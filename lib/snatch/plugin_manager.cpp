@@ -8,12 +8,25 @@
 
 #include "snatch/plugin_manager.h"
 
+#include <dirent.h>
 #include <dlfcn.h>
+#include <sys/stat.h>
 
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
 #include <cstdlib>
 #include <filesystem>
+#include <fstream>
+#include <functional>
 #include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string_view>
+#include <utility>
 
+#include "snatch/glyph_cache.h"
 #include "snatch/plugin.h"
 
 namespace fs = std::filesystem;
@@ -24,38 +37,82 @@ bool debug_plugins_enabled() {
     const char* v = std::getenv("SNATCH_DEBUG_PLUGINS");
     return v && v[0] != '\0' && v[0] != '0';
 }
-}
 
-/// \brief plugin_manager::~plugin_manager.
-plugin_manager::~plugin_manager() {
-    for (auto& p : plugins_) {
-        if (p.handle) dlclose(p.handle);
+constexpr const char* k_index_name = ".snatch-plugin-index";
+constexpr const char* k_index_header = "snatch-plugin-index";
+// 2: mtime is st_mtim in nanoseconds, 3: payloads and capabilities, 4: plugin ABI version
+constexpr int k_index_version = 4;
+constexpr std::size_t k_index_fields = 11;
+
+struct index_entry {
+    std::uintmax_t size{0};
+    long long mtime{0};
+    int kind{0};
+    unsigned abi_version{0};
+    std::string name;
+    std::string format;
+    std::string standard;
+    unsigned accepts{0};
+    unsigned produces{0};
+    unsigned capabilities{0};
+};
+
+// plugin file name -> metadata
+using plugin_index = std::map<std::string, index_entry>;
+
+// plugins linked into the executable, see plugin_manager::set_builtin_plugins
+std::vector<loaded_plugin> g_builtins;
+
+/// \brief valid_info.
+bool valid_info(const snatch_plugin_info* info, const fs::path& path) {
+    if (info->abi_version < SNATCH_PLUGIN_ABI_MIN_VERSION || info->abi_version > SNATCH_PLUGIN_ABI_VERSION) {
+        std::cerr << "ABI/version mismatch in " << path << "\n";
+        return false;
     }
-}
 
-/// \brief plugin_manager::load_plugin_file.
-bool plugin_manager::load_plugin_file(const fs::path& path) {
-    if (debug_plugins_enabled()) {
-        std::cerr << "[plugin] try " << path << "\n";
+    const bool valid_kind =
+        info->kind == SNATCH_PLUGIN_KIND_EXPORTER ||
+        info->kind == SNATCH_PLUGIN_KIND_TRANSFORMER ||
+        info->kind == SNATCH_PLUGIN_KIND_EXTRACTOR;
+    if (!valid_kind) {
+        std::cerr << "invalid plugin kind in " << path << "\n";
+        return false;
     }
-    std::error_code ec;
-    if (!fs::exists(path, ec) || !fs::is_regular_file(path, ec)) {
-        if (debug_plugins_enabled()) {
-            std::cerr << "[plugin] skip (missing/not regular): " << path << "\n";
-        }
+
+    const bool streams = SNATCH_PLUGIN_HAS_STREAMS(info);
+    if (info->kind == SNATCH_PLUGIN_KIND_EXPORTER && !info->export_font && !(streams && info->stream_export)) {
+        std::cerr << "missing exporter callback in " << path << "\n";
         return false;
     }
-    if (path.extension() != ".so") {
-        if (debug_plugins_enabled()) {
-            std::cerr << "[plugin] skip (not .so): " << path << "\n";
+
+    if (info->kind == SNATCH_PLUGIN_KIND_EXPORTER) {
+        const bool has_format = info->format && info->format[0] != '\0';
+        const bool has_standard = info->standard && info->standard[0] != '\0';
+        if (!has_format || !has_standard) {
+            std::cerr << "missing exporter format/standard metadata in " << path << "\n";
+            return false;
         }
+    }
+
+    if (info->kind == SNATCH_PLUGIN_KIND_TRANSFORMER && !info->transform_font && !(streams && info->stream_transform)) {
+        std::cerr << "missing transformer callback in " << path << "\n";
         return false;
     }
 
-    void* h = dlopen(path.c_str(), RTLD_NOW);
+    if (info->kind == SNATCH_PLUGIN_KIND_EXTRACTOR && !info->extract_font && !(streams && info->stream_extract)) {
+        std::cerr << "missing extractor callback in " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+/// \brief open_and_validate.
+// dlopens a plugin and checks its info; the handle is closed on failure
+const snatch_plugin_info* open_and_validate(const fs::path& path, void*& handle, int bind) {
+    void* h = dlopen(path.c_str(), bind | RTLD_LOCAL);
     if (!h) {
         std::cerr << "dlopen failed: " << dlerror() << " (" << path << ")\n";
-        return false;
+        return nullptr;
     }
 
     using get_fn_t = int (*)(const snatch_plugin_info**);
@@ -65,110 +122,353 @@ bool plugin_manager::load_plugin_file(const fs::path& path) {
     if (dler || !sym) {
         std::cerr << "dlsym snatch_plugin_get failed: " << (dler ? dler : "null") << "\n";
         dlclose(h);
-        return false;
+        return nullptr;
     }
 
     const snatch_plugin_info* info = nullptr;
     if (sym(&info) != 0 || !info) {
         std::cerr << "plugin get() failed: " << path << "\n";
         dlclose(h);
-        return false;
+        return nullptr;
     }
 
-    if (info->abi_version != SNATCH_PLUGIN_ABI_VERSION) {
-        std::cerr << "ABI/version mismatch in " << path << "\n";
+    if (!valid_info(info, path)) {
         dlclose(h);
-        return false;
+        return nullptr;
     }
+    handle = h;
+    return info;
+}
 
-    const bool valid_kind =
-        info->kind == SNATCH_PLUGIN_KIND_EXPORTER ||
-        info->kind == SNATCH_PLUGIN_KIND_TRANSFORMER ||
-        info->kind == SNATCH_PLUGIN_KIND_EXTRACTOR;
-    if (!valid_kind) {
-        std::cerr << "invalid plugin kind in " << path << "\n";
-        dlclose(h);
-        return false;
+/// \brief describe.
+void describe(loaded_plugin& lp, const snatch_plugin_info* info) {
+    lp.info = info;
+    lp.name = info->name ? info->name : "";
+    lp.kind = info->kind;
+    lp.abi_version = info->abi_version;
+    lp.format = info->format ? info->format : "";
+    lp.standard = info->standard ? info->standard : "";
+    lp.accepts = 0;
+    lp.produces = 0;
+    lp.capabilities = 0;
+    if (SNATCH_PLUGIN_HAS_TYPES(info)) {
+        lp.accepts = info->accepts;
+        lp.produces = info->produces;
+        lp.capabilities = info->capabilities & ~SNATCH_CAP_STREAMING;
+    }
+    // older plugins declare nothing: an exporter from before ABI 7 was only
+    // ever run once per process and may keep its output in statics, so it
+    // is not taken for thread-safe
+    if (SNATCH_PLUGIN_HAS_STREAMS(info) && (info->stream_extract || info->stream_transform || info->stream_export)) {
+        lp.capabilities |= SNATCH_CAP_STREAMING;
     }
+}
 
-    if (info->kind == SNATCH_PLUGIN_KIND_EXPORTER && !info->export_font) {
-        std::cerr << "missing exporter callback in " << path << "\n";
-        dlclose(h);
-        return false;
+/// \brief is_builtin.
+bool is_builtin(const std::string& name) {
+    return std::any_of(g_builtins.begin(), g_builtins.end(), [&](const loaded_plugin& p) { return p.name == name; });
+}
+
+/// \brief index_path.
+// Scans keep their index in the user cache, so a plugin directory is only
+// written to by an explicit write_installed_index().
+fs::path index_path(const fs::path& dir) {
+    const fs::path cache = snatch_user_cache_dir();
+    if (cache.empty()) return {};
+    std::error_code ec;
+    const fs::path abs = fs::absolute(dir, ec).lexically_normal();
+    std::ostringstream name;
+    name << "plugin-index-" << std::hex << std::hash<std::string>{}(abs.string());
+    return cache / name.str();
+}
+
+/// \brief indexable.
+// the index is tab separated, one plugin per line
+bool indexable(const std::string& s) {
+    return s.find_first_of("\t\n\r") == std::string::npos;
+}
+
+/// \brief read_index.
+plugin_index read_index(const fs::path& path) {
+    plugin_index index;
+    std::ifstream in(path);
+    if (!in.is_open()) return index;
+
+    std::string header;
+    int version = 0;
+    int abi = 0;
+    // a different host ABI makes every entry suspect
+    if (!(in >> header >> version >> abi) || header != k_index_header || version != k_index_version ||
+        abi != SNATCH_PLUGIN_ABI_VERSION) {
+        return index;
     }
+    std::string line;
+    std::getline(in, line);
+    while (std::getline(in, line)) {
+        std::vector<std::string> fields;
+        std::size_t start = 0;
+        for (std::size_t tab; (tab = line.find('\t', start)) != std::string::npos; start = tab + 1) {
+            fields.push_back(line.substr(start, tab - start));
+        }
+        fields.push_back(line.substr(start));
+        if (fields.size() != k_index_fields) continue;
 
-    if (info->kind == SNATCH_PLUGIN_KIND_EXPORTER) {
-        const bool has_format = info->format && info->format[0] != '\0';
-        const bool has_standard = info->standard && info->standard[0] != '\0';
-        if (!has_format || !has_standard) {
-            std::cerr << "missing exporter format/standard metadata in " << path << "\n";
-            dlclose(h);
+        index_entry e;
+        try {
+            e.size = std::stoull(fields[1]);
+            e.mtime = std::stoll(fields[2]);
+            e.kind = std::stoi(fields[3]);
+            e.abi_version = static_cast<unsigned>(std::stoul(fields[4]));
+            e.accepts = static_cast<unsigned>(std::stoul(fields[8]));
+            e.produces = static_cast<unsigned>(std::stoul(fields[9]));
+            e.capabilities = static_cast<unsigned>(std::stoul(fields[10]));
+        } catch (const std::exception&) {
+            continue;
+        }
+        e.name = fields[5];
+        e.format = fields[6];
+        e.standard = fields[7];
+        index[fields[0]] = std::move(e);
+    }
+    return index;
+}
+
+/// \brief write_index.
+bool write_index(const fs::path& path, const plugin_index& index) {
+    std::error_code ec;
+    fs::create_directories(path.parent_path(), ec);
+    fs::path tmp = path;
+    tmp += ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        if (!out.is_open()) return false;
+        out << k_index_header << " " << k_index_version << " " << SNATCH_PLUGIN_ABI_VERSION << "\n";
+        for (const auto& [file, e] : index) {
+            out << file << '\t' << e.size << '\t' << e.mtime << '\t' << e.kind << '\t' << e.abi_version << '\t' << e.name
+                << '\t' << e.format << '\t' << e.standard << '\t' << e.accepts << '\t' << e.produces << '\t'
+                << e.capabilities << '\n';
+        }
+        if (!out) {
+            out.close();
+            fs::remove(tmp, ec);
             return false;
         }
     }
+    // a failed rename only means the next scan loads the plugins again
+    fs::rename(tmp, path, ec);
+    if (ec) fs::remove(tmp, ec);
+    return !ec;
+}
+}
 
-    if (info->kind == SNATCH_PLUGIN_KIND_TRANSFORMER && !info->transform_font) {
-        std::cerr << "missing transformer callback in " << path << "\n";
-        dlclose(h);
-        return false;
+/// \brief plugin_manager::set_builtin_plugins.
+void plugin_manager::set_builtin_plugins(const builtin_plugin* table, std::size_t count) {
+    g_builtins.clear();
+    for (std::size_t i = 0; i < count; ++i) {
+        const fs::path path = std::string("<builtin:") + table[i].target + ">";
+        const snatch_plugin_info* info = nullptr;
+        if (table[i].get(&info) != 0 || !info) {
+            std::cerr << "plugin get() failed: " << path << "\n";
+            continue;
+        }
+        if (!valid_info(info, path)) continue;
+        loaded_plugin lp;
+        lp.path = path;
+        describe(lp, info);
+        g_builtins.push_back(std::move(lp));
     }
+}
 
-    if (info->kind == SNATCH_PLUGIN_KIND_EXTRACTOR && !info->extract_font) {
-        std::cerr << "missing extractor callback in " << path << "\n";
+/// \brief plugin_manager::~plugin_manager.
+plugin_manager::~plugin_manager() {
+    unload_all();
+}
+
+/// \brief plugin_manager::unload_all.
+void plugin_manager::unload_all() {
+    for (auto& p : plugins_) {
+        if (p.handle) dlclose(p.handle);
+    }
+    plugins_.clear();
+    reindex();
+}
+
+/// \brief plugin_manager::scan_dir.
+bool plugin_manager::scan_dir(const fs::path& dir, const std::vector<std::string>* names, bool install_index) {
+    unload_all();
+
+    // one stat per candidate: directory entries are filtered by name first
+    struct candidate {
+        std::string file;
+        struct stat st;
+    };
+    std::vector<candidate> files;
+    std::set<std::string> present;
+    if (names) {
+        for (const auto& name : *names) {
+            if (name.empty()) continue;
+            candidate c{name + ".so", {}};
+            if (::stat((dir / c.file).c_str(), &c.st) != 0 || !S_ISREG(c.st.st_mode)) {
+                if (debug_plugins_enabled()) {
+                    std::cerr << "[plugin] skip (missing/not regular): " << dir / c.file << "\n";
+                }
+                continue;
+            }
+            files.push_back(std::move(c));
+        }
+    } else {
+        DIR* d = ::opendir(dir.c_str());
+        if (!d) {
+            if (debug_plugins_enabled()) {
+                std::cerr << "[plugin] dir not found/invalid: " << dir << "\n";
+            }
+            return false;
+        }
+        while (const dirent* e = ::readdir(d)) {
+            const std::string_view file = e->d_name;
+            if (file.size() <= 3 || file.substr(file.size() - 3) != ".so") continue;
+            if (e->d_type != DT_REG && e->d_type != DT_LNK && e->d_type != DT_UNKNOWN) continue;
+            candidate c{std::string(file), {}};
+            if (::fstatat(::dirfd(d), e->d_name, &c.st, 0) != 0 || !S_ISREG(c.st.st_mode)) continue;
+            present.insert(c.file);
+            files.push_back(std::move(c));
+        }
+        ::closedir(d);
+    }
+
+    // an index generated at install time serves until the user cache has one
+    const fs::path installed_index = dir / k_index_name;
+    const fs::path index_file = install_index ? installed_index : index_path(dir);
+    plugin_index index = index_file.empty() ? plugin_index{} : read_index(index_file);
+    if (index.empty() && !install_index) index = read_index(installed_index);
+    bool dirty = install_index;
+
+    for (const auto& [file, st] : files) {
+        const fs::path path = dir / file;
+        if (debug_plugins_enabled()) {
+            std::cerr << "[plugin] try " << path << "\n";
+        }
+        const auto size = static_cast<std::uintmax_t>(st.st_size);
+        const long long mtime = static_cast<long long>(st.st_mtim.tv_sec) * 1000000000LL + st.st_mtim.tv_nsec;
+
+        loaded_plugin lp;
+        lp.path = path;
+        if (const auto it = index.find(file); it != index.end() && it->second.size == size && it->second.mtime == mtime) {
+            lp.name = it->second.name;
+            lp.kind = it->second.kind;
+            lp.abi_version = it->second.abi_version;
+            lp.format = it->second.format;
+            lp.standard = it->second.standard;
+            lp.accepts = it->second.accepts;
+            lp.produces = it->second.produces;
+            lp.capabilities = it->second.capabilities;
+            plugins_.push_back(std::move(lp));
+            continue;
+        }
+
+        // first sight of this build: bind everything now so a missing symbol
+        // is reported here and the plugin is never indexed
+        void* h = nullptr;
+        const snatch_plugin_info* info = open_and_validate(path, h, RTLD_NOW);
+        if (!info) continue;
+        lp.handle = h;
+        describe(lp, info);
+        if (debug_plugins_enabled()) {
+            std::cerr << "[plugin] indexed " << lp.name << " from " << path << "\n";
+        }
+        if (indexable(file) && indexable(lp.name) && indexable(lp.format) && indexable(lp.standard)) {
+            index[file] = {size, mtime, lp.kind, lp.abi_version, lp.name, lp.format, lp.standard,
+                           lp.accepts, lp.produces, lp.capabilities};
+            dirty = true;
+        }
+        plugins_.push_back(std::move(lp));
+    }
+
+    // a full scan also forgets plugins that were removed
+    if (!names) {
+        dirty |= std::erase_if(index, [&](const auto& entry) { return !present.contains(entry.first); }) != 0;
+    }
+    if (!dirty) return true;
+    return !index_file.empty() && write_index(index_file, index);
+}
+
+/// \brief plugin_manager::reindex.
+void plugin_manager::reindex() {
+    by_name_.clear();
+    for (auto& kind : by_kind_) kind.clear();
+    for (std::size_t i = 0; i < plugins_.size(); ++i) {
+        const loaded_plugin& p = plugins_[i];
+        name_slots& slots = by_name_[p.name];
+        if (slots.any == k_none) slots.any = i;
+        if (p.kind > 0 && p.kind < k_kind_slots) {
+            if (slots.by_kind[p.kind] == k_none) slots.by_kind[p.kind] = i;
+            by_kind_[p.kind].push_back(i);
+        }
+    }
+}
+
+/// \brief plugin_manager::open_plugin.
+bool plugin_manager::open_plugin(const loaded_plugin& plugin) const {
+    const std::lock_guard<std::mutex> lock(open_mutex_);
+    if (plugin.info) return true;
+
+    // indexed plugins were fully bound once when their entry was written,
+    // so resolve symbols on first call (LD_BIND_NOW=1 turns this off)
+    void* h = nullptr;
+    const snatch_plugin_info* info = open_and_validate(plugin.path, h, RTLD_LAZY);
+    if (!info) return false;
+    if (!info->name || plugin.name != info->name || plugin.kind != info->kind || plugin.abi_version != info->abi_version) {
+        std::cerr << "plugin changed since it was indexed: " << plugin.path << "\n";
         dlclose(h);
         return false;
     }
-
-    loaded_plugin lp;
-    lp.handle = h;
-    lp.info = info;
-    lp.path = path;
-    plugins_.push_back(lp);
+    plugin.handle = h;
+    plugin.info = info;
     return true;
 }
 
+/// \brief plugin_manager::add_builtins.
+void plugin_manager::add_builtins(const std::vector<std::string>* names) {
+    for (const auto& p : g_builtins) {
+        if (names && std::find(names->begin(), names->end(), p.name) == names->end()) continue;
+        plugins_.push_back(p);
+    }
+}
+
 /// \brief plugin_manager::load_from_dir.
 void plugin_manager::load_from_dir(const fs::path& dir) {
-    plugins_.clear();
-    std::error_code ec;
     if (debug_plugins_enabled()) {
         std::cerr << "[plugin] scan dir " << dir << "\n";
     }
-    if (!fs::exists(dir, ec) || !fs::is_directory(dir, ec)) {
-        if (debug_plugins_enabled()) {
-            std::cerr << "[plugin] dir not found/invalid: " << dir << "\n";
-        }
-        return;
-    }
+    scan_dir(dir, nullptr);
+    reindex();
+}
 
-    for (auto& entry : fs::directory_iterator(dir)) {
-        if (!entry.is_regular_file()) continue;
-        load_plugin_file(entry.path());
-    }
+/// \brief plugin_manager::write_installed_index.
+bool plugin_manager::write_installed_index(const fs::path& dir) {
+    const bool written = scan_dir(dir, nullptr, true);
+    reindex();
+    return written && !plugins_.empty();
 }
 
 /// \brief plugin_manager::load_named_from_dir.
 void plugin_manager::load_named_from_dir(const fs::path& dir, const std::vector<std::string>& names) {
-    plugins_.clear();
-    std::error_code ec;
     if (debug_plugins_enabled()) {
         std::cerr << "[plugin] load named from dir " << dir << "\n";
     }
-    if (!fs::exists(dir, ec) || !fs::is_directory(dir, ec)) {
-        if (debug_plugins_enabled()) {
-            std::cerr << "[plugin] dir not found/invalid: " << dir << "\n";
-        }
-        return;
-    }
-
-    for (const auto& name : names) {
-        if (name.empty()) continue;
-        load_plugin_file(dir / (name + ".so"));
-    }
+    scan_dir(dir, &names);
+    reindex();
 }
 
 /// \brief plugin_manager::load_from_dirs_in_order.
 void plugin_manager::load_from_dirs_in_order(const std::vector<fs::path>& dirs) {
+    // a static build is self-contained
+    if (!g_builtins.empty()) {
+        unload_all();
+        add_builtins(nullptr);
+        reindex();
+        return;
+    }
     for (const auto& dir : dirs) {
         load_from_dir(dir);
         if (!plugins_.empty()) {
@@ -182,48 +482,115 @@ void plugin_manager::load_named_from_dirs_in_order(
     const std::vector<fs::path>& dirs,
     const std::vector<std::string>& names
 ) {
-    for (const auto& dir : dirs) {
-        load_named_from_dir(dir, names);
+    std::vector<std::string> external;
+    for (const auto& name : names) {
+        if (!name.empty() && !is_builtin(name)) external.push_back(name);
+    }
+
+    unload_all();
+    for (const auto& dir : external.empty() ? std::vector<fs::path>{} : dirs) {
+        load_named_from_dir(dir, external);
 
         bool all_found = true;
-        for (const auto& name : names) {
-            if (name.empty()) continue;
-            if (!find_by_name(name)) {
+        for (const auto& name : external) {
+            if (!by_name_.contains(name)) {
                 all_found = false;
                 break;
             }
         }
 
         if (all_found && !plugins_.empty()) {
-            return;
+            break;
         }
     }
+    add_builtins(&names);
+    reindex();
 }
 
 /// \brief plugin_manager::find_by_name.
 const loaded_plugin* plugin_manager::find_by_name(const std::string& name) const {
-    for (const auto& p : plugins_) {
-        if (!p.info || !p.info->name) continue;
-        if (name == p.info->name) return &p;
-    }
-    return nullptr;
+    const auto it = by_name_.find(name);
+    if (it == by_name_.end() || it->second.any == k_none) return nullptr;
+    const loaded_plugin& p = plugins_[it->second.any];
+    return open_plugin(p) ? &p : nullptr;
 }
 
 /// \brief plugin_manager::find_by_name_and_kind.
 const loaded_plugin* plugin_manager::find_by_name_and_kind(const std::string& name, int kind) const {
-    for (const auto& p : plugins_) {
-        if (!p.info || !p.info->name) continue;
-        if (p.info->kind != kind) continue;
-        if (name == p.info->name) return &p;
-    }
-    return nullptr;
+    if (kind <= 0 || kind >= k_kind_slots) return nullptr;
+    const auto it = by_name_.find(name);
+    if (it == by_name_.end() || it->second.by_kind[kind] == k_none) return nullptr;
+    const loaded_plugin& p = plugins_[it->second.by_kind[kind]];
+    return open_plugin(p) ? &p : nullptr;
 }
 
 /// \brief plugin_manager::find_first_by_kind.
 const loaded_plugin* plugin_manager::find_first_by_kind(int kind) const {
-    for (const auto& p : plugins_) {
-        if (!p.info) continue;
-        if (p.info->kind == kind) return &p;
+    if (kind <= 0 || kind >= k_kind_slots) return nullptr;
+    for (const std::size_t i : by_kind_[kind]) {
+        if (open_plugin(plugins_[i])) return &plugins_[i];
+    }
+    return nullptr;
+}
+
+/// \brief plugin_manager::find_best.
+const loaded_plugin* plugin_manager::find_best(int kind, unsigned input, std::string_view format) const {
+    if (kind <= 0 || kind >= k_kind_slots) return nullptr;
+    const auto same_format = [&](const std::string& f) {
+        return std::equal(f.begin(), f.end(), format.begin(), format.end(), [](char a, char b) {
+            return std::tolower(static_cast<unsigned char>(a)) == std::tolower(static_cast<unsigned char>(b));
+        });
+    };
+    const auto rank = [](const loaded_plugin& p) {
+        return ((p.capabilities & SNATCH_CAP_SIMD) ? 4 : 0) + ((p.capabilities & SNATCH_CAP_STREAMING) ? 2 : 0) +
+               ((p.capabilities & SNATCH_CAP_THREAD_SAFE) ? 1 : 0);
+    };
+
+    std::vector<std::size_t> candidates;
+    for (const std::size_t i : by_kind_[kind]) {
+        const loaded_plugin& p = plugins_[i];
+        if (!format.empty() && !same_format(p.format)) continue;
+        if (plugin_accepts_payload(p, input)) candidates.push_back(i);
+    }
+    std::stable_sort(candidates.begin(), candidates.end(),
+                     [&](std::size_t a, std::size_t b) { return rank(plugins_[a]) > rank(plugins_[b]); });
+    for (const std::size_t i : candidates) {
+        if (open_plugin(plugins_[i])) return &plugins_[i];
     }
     return nullptr;
 }
+
+/// \brief plugin_output_payload.
+unsigned plugin_output_payload(const loaded_plugin& plugin, unsigned input) {
+    if (plugin.kind == SNATCH_PLUGIN_KIND_EXPORTER) return 0;
+    unsigned out = plugin.produces & ~SNATCH_PAYLOAD_KEEPS_INPUT;
+    if ((plugin.produces & SNATCH_PAYLOAD_KEEPS_INPUT) != 0) {
+        if (input == 0) return 0;
+        out |= input;
+    }
+    return out;
+}
+
+/// \brief plugin_accepts_payload.
+bool plugin_accepts_payload(const loaded_plugin& plugin, unsigned payload) {
+    return payload == 0 || plugin.accepts == 0 || (payload & plugin.accepts) != 0;
+}
+
+/// \brief plugin_payload_names.
+std::string plugin_payload_names(unsigned payload) {
+    static constexpr std::pair<unsigned, const char*> k_names[] = {
+        {SNATCH_PAYLOAD_BITMAP, "bitmap"},
+        {SNATCH_PAYLOAD_IMAGE, "image"},
+        {SNATCH_PAYLOAD_PARTNER_BITMAP, "partner-bitmap"},
+        {SNATCH_PAYLOAD_PARTNER_TINY, "partner-tiny"},
+        {SNATCH_PAYLOAD_PARTNER_TINY_BIN, "partner-tiny-bin"},
+        {SNATCH_PAYLOAD_FZX, "fzx"},
+    };
+    std::string names;
+    for (const auto& [bit, name] : k_names) {
+        if ((payload & bit) == 0) continue;
+        if (!names.empty()) names += '|';
+        names += name;
+    }
+    return names.empty() ? "unknown" : names;
+}
@@ -0,0 +1,512 @@
+/// \file
+/// \brief Implementation of incremental inflate and row-by-row PNG decoding.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/png_reader.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+constexpr std::size_t k_window = 32768;
+constexpr int k_max_bits = 15;
+
+constexpr std::uint16_t k_length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+constexpr std::uint8_t k_length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+constexpr std::uint16_t k_dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+constexpr std::uint8_t k_dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+constexpr std::uint8_t k_code_length_order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+constexpr std::uint8_t k_png_signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+
+/// \brief be32.
+std::uint32_t be32(const std::uint8_t* p) {
+    return (static_cast<std::uint32_t>(p[0]) << 24) | (static_cast<std::uint32_t>(p[1]) << 16) |
+           (static_cast<std::uint32_t>(p[2]) << 8) | static_cast<std::uint32_t>(p[3]);
+}
+
+/// \brief reverse_bits.
+std::uint32_t reverse_bits(std::uint32_t code, int length) {
+    std::uint32_t out = 0;
+    for (int i = 0; i < length; ++i) {
+        out = (out << 1) | (code & 1u);
+        code >>= 1;
+    }
+    return out;
+}
+
+/// \brief paeth.
+std::uint8_t paeth(int a, int b, int c) {
+    const int p = a + b - c;
+    const int pa = std::abs(p - a);
+    const int pb = std::abs(p - b);
+    const int pc = std::abs(p - c);
+    if (pa <= pb && pa <= pc) return static_cast<std::uint8_t>(a);
+    return static_cast<std::uint8_t>(pb <= pc ? b : c);
+}
+
+/// \brief luma.
+// stb_image's RGB to Y weights, so both decoders agree to the bit
+int luma(int r, int g, int b) {
+    return (r * 77 + g * 150 + b * 29) >> 8;
+}
+
+} // namespace
+
+/// \brief inflate_stream::huffman::build.
+bool inflate_stream::huffman::build(const std::uint8_t* lengths, int n) {
+    count.fill(0);
+    fast.fill(0);
+    for (int i = 0; i < n; ++i) ++count[lengths[i]];
+    count[0] = 0;
+    int left = 1;
+    for (int len = 1; len <= k_max_bits; ++len) {
+        left = (left << 1) - count[static_cast<std::size_t>(len)];
+        if (left < 0) return false; // over-subscribed; incomplete codes are allowed
+    }
+
+    std::array<std::uint16_t, k_max_bits + 2> offs{};
+    for (int len = 1; len <= k_max_bits; ++len) offs[static_cast<std::size_t>(len + 1)] = static_cast<std::uint16_t>(offs[static_cast<std::size_t>(len)] + count[static_cast<std::size_t>(len)]);
+    symbols.assign(offs[k_max_bits + 1], 0);
+    for (int i = 0; i < n; ++i) {
+        if (lengths[i] != 0) symbols[offs[lengths[i]]++] = static_cast<std::uint16_t>(i);
+    }
+
+    // canonical codes, bit-reversed because deflate sends them MSB first
+    std::uint32_t code = 0;
+    std::size_t index = 0;
+    for (int len = 1; len <= k_max_bits; ++len) {
+        for (int i = 0; i < count[static_cast<std::size_t>(len)]; ++i, ++code, ++index) {
+            if (len > fast_bits) continue;
+            const std::uint16_t entry = static_cast<std::uint16_t>((symbols[index] << 4) | len);
+            for (std::uint32_t f = reverse_bits(code, len); f < fast.size(); f += 1u << len) fast[f] = entry;
+        }
+        code <<= 1;
+    }
+    return true;
+}
+
+inflate_stream::inflate_stream(byte_source source, void* ctx) : source_(source), ctx_(ctx), window_(k_window, 0) {}
+
+/// \brief inflate_stream::fail.
+bool inflate_stream::fail(const char* what) {
+    if (error_.empty()) error_ = what;
+    return false;
+}
+
+/// \brief inflate_stream::need.
+// past the end of the input zero bytes are invented, so a peek near the end
+// works; consuming them is caught in bits() and decode()
+bool inflate_stream::need(int n) {
+    while (bitcnt_ < n) {
+        int b = source_(ctx_);
+        if (b < 0) {
+            b = 0;
+            ++overrun_;
+        }
+        bitbuf_ |= static_cast<std::uint64_t>(b) << bitcnt_;
+        bitcnt_ += 8;
+    }
+    return true;
+}
+
+/// \brief inflate_stream::bits.
+std::uint32_t inflate_stream::bits(int n) {
+    if (n == 0) return 0;
+    need(n);
+    const std::uint32_t v = static_cast<std::uint32_t>(bitbuf_ & ((std::uint64_t{1} << n) - 1));
+    bitbuf_ >>= n;
+    bitcnt_ -= n;
+    if (bitcnt_ < overrun_ * 8) fail("inflate: truncated data");
+    return v;
+}
+
+/// \brief inflate_stream::decode.
+int inflate_stream::decode(const huffman& h) {
+    need(k_max_bits);
+    if (const std::uint16_t e = h.fast[bitbuf_ & ((1u << huffman::fast_bits) - 1)]; e != 0) {
+        const int len = e & 15;
+        bitbuf_ >>= len;
+        bitcnt_ -= len;
+        if (bitcnt_ < overrun_ * 8) {
+            fail("inflate: truncated data");
+            return -1;
+        }
+        return e >> 4;
+    }
+    int code = 0;
+    int first = 0;
+    int index = 0;
+    for (int len = 1; len <= k_max_bits; ++len) {
+        code |= static_cast<int>((bitbuf_ >> (len - 1)) & 1u);
+        const int count = h.count[static_cast<std::size_t>(len)];
+        if (code - count < first) {
+            bitbuf_ >>= len;
+            bitcnt_ -= len;
+            if (bitcnt_ < overrun_ * 8) {
+                fail("inflate: truncated data");
+                return -1;
+            }
+            return h.symbols[static_cast<std::size_t>(index + (code - first))];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    fail("inflate: invalid code");
+    return -1;
+}
+
+/// \brief inflate_stream::read_zlib_header.
+bool inflate_stream::read_zlib_header() {
+    const std::uint32_t cmf = bits(8);
+    const std::uint32_t flg = bits(8);
+    if (!error_.empty()) return false;
+    if ((cmf & 15u) != 8 || ((cmf << 8) | flg) % 31 != 0) return fail("inflate: not a zlib stream");
+    if ((flg & 0x20u) != 0) return fail("inflate: preset dictionary not supported");
+    return true;
+}
+
+/// \brief inflate_stream::read_dynamic_tables.
+bool inflate_stream::read_dynamic_tables() {
+    const int nlen = static_cast<int>(bits(5)) + 257;
+    const int ndist = static_cast<int>(bits(5)) + 1;
+    const int ncode = static_cast<int>(bits(4)) + 4;
+    if (nlen > 286 || ndist > 30) return fail("inflate: bad table counts");
+
+    std::uint8_t lengths[286 + 30] = {};
+    for (int i = 0; i < ncode; ++i) lengths[k_code_length_order[i]] = static_cast<std::uint8_t>(bits(3));
+    huffman code_lengths;
+    if (!code_lengths.build(lengths, 19)) return fail("inflate: bad code length code");
+
+    std::fill(std::begin(lengths), std::end(lengths), std::uint8_t{0});
+    for (int i = 0; i < nlen + ndist;) {
+        const int sym = decode(code_lengths);
+        if (sym < 0) return false;
+        if (sym < 16) {
+            lengths[i++] = static_cast<std::uint8_t>(sym);
+            continue;
+        }
+        std::uint8_t value = 0;
+        int repeat = 0;
+        if (sym == 16) {
+            if (i == 0) return fail("inflate: repeat without a length");
+            value = lengths[i - 1];
+            repeat = 3 + static_cast<int>(bits(2));
+        } else if (sym == 17) {
+            repeat = 3 + static_cast<int>(bits(3));
+        } else {
+            repeat = 11 + static_cast<int>(bits(7));
+        }
+        if (i + repeat > nlen + ndist) return fail("inflate: too many lengths");
+        while (repeat-- > 0) lengths[i++] = value;
+    }
+    if (lengths[256] == 0) return fail("inflate: no end-of-block code");
+    if (!lit_.build(lengths, nlen) || !dist_.build(lengths + nlen, ndist)) return fail("inflate: bad literal or distance code");
+    return error_.empty();
+}
+
+/// \brief inflate_stream::start_block.
+bool inflate_stream::start_block() {
+    final_ = bits(1) != 0;
+    block_ = static_cast<int>(bits(2));
+    switch (block_) {
+    case 0: {
+        // stored: skip to a byte boundary, then LEN and its complement
+        bits(bitcnt_ & 7);
+        const std::uint32_t len = bits(16);
+        const std::uint32_t nlen = bits(16);
+        if ((len ^ 0xFFFFu) != nlen) return fail("inflate: stored block length mismatch");
+        stored_left_ = len;
+        break;
+    }
+    case 1: {
+        std::uint8_t lengths[288 + 30];
+        std::fill(lengths, lengths + 144, std::uint8_t{8});
+        std::fill(lengths + 144, lengths + 256, std::uint8_t{9});
+        std::fill(lengths + 256, lengths + 280, std::uint8_t{7});
+        std::fill(lengths + 280, lengths + 288, std::uint8_t{8});
+        std::fill(lengths + 288, lengths + 318, std::uint8_t{5});
+        lit_.build(lengths, 288);
+        dist_.build(lengths + 288, 30);
+        break;
+    }
+    case 2:
+        if (!read_dynamic_tables()) return false;
+        break;
+    default:
+        return fail("inflate: invalid block type");
+    }
+    return error_.empty();
+}
+
+/// \brief inflate_stream::put.
+void inflate_stream::put(std::uint8_t b) {
+    window_[pos_ & (k_window - 1)] = b;
+    ++pos_;
+}
+
+/// \brief inflate_stream::read.
+bool inflate_stream::read(std::uint8_t* dst, std::size_t n) {
+    std::size_t done = 0;
+    while (done < n) {
+        if (!error_.empty()) return false;
+        if (copy_left_ > 0) {
+            const std::uint8_t b = window_[(pos_ - copy_dist_) & (k_window - 1)];
+            put(b);
+            dst[done++] = b;
+            --copy_left_;
+            continue;
+        }
+        if (block_ < 0) {
+            if (final_) return fail("inflate: data ends early");
+            if (!start_block()) return false;
+            continue;
+        }
+        if (block_ == 0) {
+            if (stored_left_ == 0) {
+                block_ = -1;
+                continue;
+            }
+            const std::uint8_t b = static_cast<std::uint8_t>(bits(8));
+            put(b);
+            dst[done++] = b;
+            --stored_left_;
+            continue;
+        }
+
+        const int sym = decode(lit_);
+        if (sym < 0) return false;
+        if (sym < 256) {
+            put(static_cast<std::uint8_t>(sym));
+            dst[done++] = static_cast<std::uint8_t>(sym);
+        } else if (sym == 256) {
+            block_ = -1;
+        } else {
+            const int l = sym - 257;
+            if (l >= 29) return fail("inflate: invalid length code");
+            copy_left_ = k_length_base[l] + static_cast<int>(bits(k_length_extra[l]));
+            const int d = decode(dist_);
+            if (d < 0) return false;
+            if (d >= 30) return fail("inflate: invalid distance code");
+            copy_dist_ = k_dist_base[d] + bits(k_dist_extra[d]);
+            if (copy_dist_ > pos_) return fail("inflate: distance before the start");
+        }
+    }
+    return error_.empty();
+}
+
+png_row_reader::png_row_reader() : inflate_(&png_row_reader::next_idat_byte, this) {}
+
+/// \brief png_row_reader::next_idat_byte.
+// walks the concatenated IDAT chunks as one byte stream
+int png_row_reader::next_idat_byte(void* ctx) {
+    auto& self = *static_cast<png_row_reader*>(ctx);
+    while (self.chunk_left_ == 0) {
+        if (self.idat_done_) return -1;
+        std::uint8_t head[12];
+        if (!self.in_.read(reinterpret_cast<char*>(head), 12)) { // CRC of the last chunk, then the next header
+            self.idat_done_ = true;
+            return -1;
+        }
+        if (std::memcmp(head + 8, "IDAT", 4) != 0) {
+            self.idat_done_ = true;
+            return -1;
+        }
+        self.chunk_left_ = be32(head + 4);
+    }
+    const int b = self.in_.get();
+    if (b == std::char_traits<char>::eof()) {
+        self.idat_done_ = true;
+        return -1;
+    }
+    --self.chunk_left_;
+    return b;
+}
+
+/// \brief png_row_reader::open.
+bool png_row_reader::open(const std::filesystem::path& path) {
+    in_.open(path, std::ios::binary);
+    std::uint8_t sig[8];
+    if (!in_.is_open() || !in_.read(reinterpret_cast<char*>(sig), 8) || std::memcmp(sig, k_png_signature, 8) != 0) {
+        error_ = "png: not a PNG file";
+        return false;
+    }
+
+    bool have_header = false;
+    for (;;) {
+        std::uint8_t head[8];
+        if (!in_.read(reinterpret_cast<char*>(head), 8)) {
+            error_ = "png: no image data";
+            return false;
+        }
+        const std::uint32_t length = be32(head);
+        if (std::memcmp(head + 4, "IHDR", 4) == 0) {
+            std::uint8_t ihdr[13];
+            if (length != 13 || !in_.read(reinterpret_cast<char*>(ihdr), 13)) {
+                error_ = "png: bad IHDR";
+                return false;
+            }
+            const std::uint32_t width = be32(ihdr);
+            const std::uint32_t height = be32(ihdr + 4);
+            if (width > k_max_side || height > k_max_side || std::uint64_t{width} * height > k_max_pixels) {
+                error_ = "png: image too large";
+                return false;
+            }
+            width_ = static_cast<int>(width);
+            height_ = static_cast<int>(height);
+            depth_ = ihdr[8];
+            color_ = ihdr[9];
+            if (ihdr[10] != 0 || ihdr[11] != 0 || ihdr[12] != 0) {
+                error_ = "png: interlaced or unknown method";
+                return false;
+            }
+            have_header = true;
+        } else if (std::memcmp(head + 4, "PLTE", 4) == 0) {
+            // 1..256 RGB entries
+            if (length == 0 || length > 768 || length % 3 != 0) {
+                error_ = "png: bad PLTE";
+                return false;
+            }
+            palette_.resize(length);
+            if (!in_.read(reinterpret_cast<char*>(palette_.data()), static_cast<std::streamsize>(length))) {
+                error_ = "png: bad PLTE";
+                return false;
+            }
+        } else if (std::memcmp(head + 4, "IDAT", 4) == 0) {
+            chunk_left_ = length;
+            break;
+        } else {
+            in_.seekg(static_cast<std::streamoff>(length), std::ios::cur);
+        }
+        in_.seekg(4, std::ios::cur); // CRC
+    }
+
+    switch (color_) {
+    case 0: channels_ = 1; break;
+    case 2: channels_ = 3; break;
+    case 3: channels_ = 1; break;
+    case 4: channels_ = 2; break;
+    case 6: channels_ = 4; break;
+    default: channels_ = 0; break;
+    }
+    const bool depth_ok = color_ == 0 ? (depth_ == 1 || depth_ == 2 || depth_ == 4 || depth_ == 8 || depth_ == 16)
+                        : color_ == 3 ? (depth_ == 1 || depth_ == 2 || depth_ == 4 || depth_ == 8)
+                                      : (depth_ == 8 || depth_ == 16);
+    if (!have_header || channels_ == 0 || !depth_ok || width_ <= 0 || height_ <= 0 || (color_ == 3 && palette_.empty())) {
+        error_ = "png: unsupported format";
+        return false;
+    }
+
+    const std::size_t bits_per_pixel = static_cast<std::size_t>(channels_ * depth_);
+    row_bytes_ = (static_cast<std::size_t>(width_) * bits_per_pixel + 7) / 8;
+    bpp_ = std::max<std::size_t>(1, bits_per_pixel / 8);
+    prev_.assign(row_bytes_, 0);
+    cur_.assign(row_bytes_, 0);
+    if (!inflate_.read_zlib_header()) {
+        error_ = inflate_.error();
+        return false;
+    }
+    return true;
+}
+
+/// \brief png_row_reader::error.
+const std::string& png_row_reader::error() const {
+    return error_.empty() ? inflate_.error() : error_;
+}
+
+/// \brief png_row_reader::read_gray_row.
+bool png_row_reader::read_gray_row(std::uint8_t* dst) {
+    if (row_ >= height_) {
+        error_ = "png: no more rows";
+        return false;
+    }
+    std::uint8_t filter = 0;
+    if (!inflate_.read(&filter, 1) || !inflate_.read(cur_.data(), row_bytes_)) return false;
+
+    std::uint8_t* c = cur_.data();
+    const std::uint8_t* p = prev_.data();
+    const std::size_t n = row_bytes_;
+    switch (filter) {
+    case 0: break;
+    case 1:
+        for (std::size_t i = bpp_; i < n; ++i) c[i] = static_cast<std::uint8_t>(c[i] + c[i - bpp_]);
+        break;
+    case 2:
+        for (std::size_t i = 0; i < n; ++i) c[i] = static_cast<std::uint8_t>(c[i] + p[i]);
+        break;
+    case 3:
+        for (std::size_t i = 0; i < n; ++i) {
+            const int left = i >= bpp_ ? c[i - bpp_] : 0;
+            c[i] = static_cast<std::uint8_t>(c[i] + ((left + p[i]) >> 1));
+        }
+        break;
+    case 4:
+        for (std::size_t i = 0; i < n; ++i) {
+            const int left = i >= bpp_ ? c[i - bpp_] : 0;
+            const int up_left = i >= bpp_ ? p[i - bpp_] : 0;
+            c[i] = static_cast<std::uint8_t>(c[i] + paeth(left, p[i], up_left));
+        }
+        break;
+    default:
+        error_ = "png: invalid filter type";
+        return false;
+    }
+
+    if (depth_ < 8) {
+        // stb scales packed gray up to 0..255; palette indices stay indices
+        const int scale = color_ == 3 ? 1 : (depth_ == 1 ? 0xFF : depth_ == 2 ? 0x55 : 0x11);
+        const int per_byte = 8 / depth_;
+        const unsigned mask = (1u << depth_) - 1u;
+        for (int x = 0; x < width_; ++x) {
+            const int shift = 8 - depth_ * (x % per_byte + 1);
+            const int v = static_cast<int>((c[x / per_byte] >> shift) & mask);
+            if (color_ == 3) {
+                const std::size_t e = static_cast<std::size_t>(v) * 3;
+                dst[x] = e + 2 < palette_.size() ? static_cast<std::uint8_t>(luma(palette_[e], palette_[e + 1], palette_[e + 2])) : 0;
+            } else {
+                dst[x] = static_cast<std::uint8_t>(v * scale);
+            }
+        }
+    } else if (depth_ == 8) {
+        const std::size_t step = static_cast<std::size_t>(channels_);
+        for (int x = 0; x < width_; ++x) {
+            const std::uint8_t* px = c + static_cast<std::size_t>(x) * step;
+            if (color_ == 3) {
+                const std::size_t e = static_cast<std::size_t>(px[0]) * 3;
+                dst[x] = e + 2 < palette_.size() ? static_cast<std::uint8_t>(luma(palette_[e], palette_[e + 1], palette_[e + 2])) : 0;
+            } else {
+                dst[x] = channels_ >= 3 ? static_cast<std::uint8_t>(luma(px[0], px[1], px[2])) : px[0];
+            }
+        }
+    } else {
+        // stb converts 16-bit samples to gray first and drops the low byte last
+        const std::size_t step = static_cast<std::size_t>(channels_) * 2;
+        for (int x = 0; x < width_; ++x) {
+            const std::uint8_t* px = c + static_cast<std::size_t>(x) * step;
+            const int s0 = (px[0] << 8) | px[1];
+            const int gray = channels_ >= 3 ? luma(s0, (px[2] << 8) | px[3], (px[4] << 8) | px[5]) : s0;
+            dst[x] = static_cast<std::uint8_t>(gray >> 8);
+        }
+    }
+
+    prev_.swap(cur_);
+    ++row_;
+    return true;
+}
@@ -0,0 +1,604 @@
+/// \file
+/// \brief Implementation of deflate compression and PNG encoding.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/png_writer.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <queue>
+#include <thread>
+
+namespace {
+
+constexpr std::size_t k_window = 32768;
+constexpr int k_min_match = 3;
+constexpr int k_max_match = 258;
+constexpr int k_hash_bits = 15;
+constexpr std::size_t k_block_tokens = 1u << 16; // tokens per deflate block
+// below this a chunk's separately restarted LZ state costs more than a thread saves
+constexpr std::size_t k_min_parallel_chunk = std::size_t{256} << 10;
+
+constexpr std::uint16_t k_length_base[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+constexpr std::uint8_t k_length_extra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+constexpr std::uint16_t k_dist_base[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+constexpr std::uint8_t k_dist_extra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+constexpr std::uint8_t k_code_length_order[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+// literal (dist == 0) or back-reference
+struct lz_token {
+    std::uint16_t length;
+    std::uint16_t dist;
+};
+
+// search effort per level: chain links followed, a match long enough to stop
+// at, and the longest match whose inner positions still enter the hash chains
+struct lz_effort {
+    int chain;
+    int good;
+    bool lazy;
+    int max_insert;
+};
+
+/// \brief effort_for.
+lz_effort effort_for(int level) {
+    static constexpr lz_effort table[10] = {
+        {0, 0, false, 0}, {1, 8, false, 4}, {4, 16, false, 8}, {16, 32, false, 32}, {32, 32, true, k_max_match},
+        {64, 64, true, k_max_match}, {128, 128, true, k_max_match}, {256, 128, true, k_max_match},
+        {512, k_max_match, true, k_max_match}, {1024, k_max_match, true, k_max_match}
+    };
+    return table[std::clamp(level, 0, 9)];
+}
+
+/// \brief length_code.
+int length_code(int length) {
+    int c = 28;
+    while (k_length_base[c] > length) --c;
+    return c;
+}
+
+/// \brief dist_code.
+int dist_code(int dist) {
+    int c = 29;
+    while (k_dist_base[c] > dist) --c;
+    return c;
+}
+
+class bit_writer {
+public:
+    explicit bit_writer(std::vector<std::uint8_t>& out) : out_(out) {}
+
+    void put(std::uint32_t bits, int n) {
+        buf_ |= static_cast<std::uint64_t>(bits) << cnt_;
+        cnt_ += n;
+        while (cnt_ >= 8) {
+            out_.push_back(static_cast<std::uint8_t>(buf_));
+            buf_ >>= 8;
+            cnt_ -= 8;
+        }
+    }
+    void align() {
+        if (cnt_ > 0) put(0, 8 - cnt_);
+    }
+
+private:
+    std::vector<std::uint8_t>& out_;
+    std::uint64_t buf_{0};
+    int cnt_{0};
+};
+
+/// \brief huffman_lengths.
+// Huffman code lengths for `freq`, at most `limit` bits: frequencies are
+// flattened until the tree is shallow enough.
+std::vector<std::uint8_t> huffman_lengths(std::vector<std::uint32_t> freq, int limit) {
+    const std::size_t n = freq.size();
+    std::vector<std::uint8_t> lengths(n, 0);
+    for (;;) {
+        struct node {
+            std::uint64_t weight;
+            int left;
+            int right;
+        };
+        std::vector<node> nodes;
+        using entry = std::pair<std::uint64_t, int>;
+        std::priority_queue<entry, std::vector<entry>, std::greater<entry>> heap;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (freq[i] == 0) continue;
+            nodes.push_back({freq[i], -1, static_cast<int>(i)});
+            heap.push({freq[i], static_cast<int>(nodes.size() - 1)});
+        }
+        std::fill(lengths.begin(), lengths.end(), std::uint8_t{0});
+        if (nodes.empty()) return lengths;
+        if (nodes.size() == 1) {
+            lengths[static_cast<std::size_t>(nodes[0].right)] = 1;
+            return lengths;
+        }
+        while (heap.size() > 1) {
+            const entry a = heap.top();
+            heap.pop();
+            const entry b = heap.top();
+            heap.pop();
+            nodes.push_back({a.first + b.first, a.second, b.second});
+            heap.push({a.first + b.first, static_cast<int>(nodes.size() - 1)});
+        }
+        // depth of every leaf, walking down from the root
+        int max_depth = 0;
+        std::vector<std::pair<int, int>> stack{{heap.top().second, 0}};
+        while (!stack.empty()) {
+            const auto [at, depth] = stack.back();
+            stack.pop_back();
+            const node& nd = nodes[static_cast<std::size_t>(at)];
+            if (nd.left < 0) {
+                lengths[static_cast<std::size_t>(nd.right)] = static_cast<std::uint8_t>(depth);
+                max_depth = std::max(max_depth, depth);
+            } else {
+                stack.push_back({nd.left, depth + 1});
+                stack.push_back({nd.right, depth + 1});
+            }
+        }
+        if (max_depth <= limit) return lengths;
+        for (auto& f : freq) {
+            if (f != 0) f = (f >> 1) | 1u;
+        }
+    }
+}
+
+/// \brief canonical_codes.
+// codes bit-reversed, ready to be sent LSB first
+std::vector<std::uint16_t> canonical_codes(const std::vector<std::uint8_t>& lengths) {
+    std::array<std::uint16_t, 16> count{};
+    for (const auto l : lengths) ++count[l];
+    count[0] = 0;
+    std::array<std::uint16_t, 16> next{};
+    std::uint16_t code = 0;
+    for (int len = 1; len < 16; ++len) {
+        code = static_cast<std::uint16_t>((code + count[static_cast<std::size_t>(len - 1)]) << 1);
+        next[static_cast<std::size_t>(len)] = code;
+    }
+    std::vector<std::uint16_t> codes(lengths.size(), 0);
+    for (std::size_t i = 0; i < lengths.size(); ++i) {
+        const int len = lengths[i];
+        if (len == 0) continue;
+        std::uint16_t c = next[static_cast<std::size_t>(len)]++;
+        std::uint16_t r = 0;
+        for (int b = 0; b < len; ++b) {
+            r = static_cast<std::uint16_t>((r << 1) | (c & 1u));
+            c >>= 1;
+        }
+        codes[i] = r;
+    }
+    return codes;
+}
+
+struct block_codes {
+    std::vector<std::uint8_t> lit_len;
+    std::vector<std::uint8_t> dist_len;
+};
+
+/// \brief fixed_codes.
+block_codes fixed_codes() {
+    block_codes c;
+    c.lit_len.assign(288, 8);
+    std::fill(c.lit_len.begin() + 144, c.lit_len.begin() + 256, std::uint8_t{9});
+    std::fill(c.lit_len.begin() + 256, c.lit_len.begin() + 280, std::uint8_t{7});
+    c.dist_len.assign(30, 5);
+    return c;
+}
+
+/// \brief token_bits.
+// payload bits of a block under the given code lengths
+std::uint64_t token_bits(const std::vector<std::uint32_t>& lit_freq, const std::vector<std::uint32_t>& dist_freq, const block_codes& c) {
+    std::uint64_t bits = 0;
+    for (std::size_t i = 0; i < lit_freq.size(); ++i) {
+        bits += static_cast<std::uint64_t>(lit_freq[i]) * (c.lit_len[i] + (i >= 257 ? k_length_extra[i - 257] : 0));
+    }
+    for (std::size_t i = 0; i < dist_freq.size(); ++i) bits += static_cast<std::uint64_t>(dist_freq[i]) * (c.dist_len[i] + k_dist_extra[i]);
+    return bits;
+}
+
+// run-length coded code lengths of a dynamic block header
+struct header_rle {
+    std::vector<std::pair<std::uint8_t, std::uint8_t>> items; // symbol, extra bits value
+    std::vector<std::uint32_t> freq = std::vector<std::uint32_t>(19, 0);
+};
+
+/// \brief rle_lengths.
+header_rle rle_lengths(const std::vector<std::uint8_t>& all) {
+    header_rle out;
+    for (std::size_t i = 0; i < all.size();) {
+        const std::uint8_t v = all[i];
+        std::size_t run = 1;
+        while (i + run < all.size() && all[i + run] == v) ++run;
+        std::size_t left = run;
+        if (v == 0) {
+            while (left >= 11) {
+                const std::size_t r = std::min<std::size_t>(left, 138);
+                out.items.push_back({18, static_cast<std::uint8_t>(r - 11)});
+                left -= r;
+            }
+            if (left >= 3) {
+                out.items.push_back({17, static_cast<std::uint8_t>(left - 3)});
+                left = 0;
+            }
+        } else {
+            out.items.push_back({v, 0});
+            --left;
+            while (left >= 3) {
+                const std::size_t r = std::min<std::size_t>(left, 6);
+                out.items.push_back({16, static_cast<std::uint8_t>(r - 3)});
+                left -= r;
+            }
+        }
+        while (left-- > 0) out.items.push_back({v, 0});
+        i += run;
+    }
+    for (const auto& [sym, extra] : out.items) ++out.freq[sym];
+    return out;
+}
+
+class deflater {
+public:
+    // `size` is where this deflater's input ends; anything before the point
+    // run() starts from only serves as history to match against
+    deflater(const std::uint8_t* data, std::size_t size, int level) : data_(data), size_(size), effort_(effort_for(level)) {}
+
+    // Deflates data[begin, size). Unless `last`, the output ends in an empty
+    // stored block, so it is byte aligned and another run's output can follow.
+    void run(std::vector<std::uint8_t>& out, std::size_t begin, bool last) {
+        bit_writer bw(out);
+        if (effort_.chain == 0 || begin == size_) {
+            store(bw, begin, size_, last);
+            bw.align();
+            return;
+        }
+        head_.assign(std::size_t{1} << k_hash_bits, 0);
+        prev_.assign(k_window, 0);
+        for (std::size_t p = begin - std::min(begin, k_window); p < begin; ++p) insert(p);
+        std::vector<lz_token> tokens;
+        tokens.reserve(k_block_tokens);
+        std::size_t block_start = begin;
+        std::size_t pos = begin;
+        while (pos < size_) {
+            int len = 0;
+            int dist = 0;
+            find(pos, len, dist);
+            if (len >= k_min_match && effort_.lazy && pos + 1 < size_) {
+                // a longer match one byte later is worth a literal now
+                insert(pos);
+                int next_len = 0;
+                int next_dist = 0;
+                find(pos + 1, next_len, next_dist);
+                if (next_len > len) {
+                    tokens.push_back({data_[pos], 0});
+                    ++pos;
+                    len = next_len;
+                    dist = next_dist;
+                }
+                for (int i = 1; i < len; ++i) insert(pos + static_cast<std::size_t>(i));
+            } else if (len >= k_min_match) {
+                const int inserted = len <= effort_.max_insert ? len : 1;
+                for (int i = 0; i < inserted; ++i) insert(pos + static_cast<std::size_t>(i));
+            } else {
+                insert(pos);
+            }
+            if (len >= k_min_match) {
+                tokens.push_back({static_cast<std::uint16_t>(len), static_cast<std::uint16_t>(dist)});
+                pos += static_cast<std::size_t>(len);
+            } else {
+                tokens.push_back({data_[pos], 0});
+                ++pos;
+            }
+            if (tokens.size() >= k_block_tokens - 1) {
+                emit(bw, tokens, block_start, pos, last && pos >= size_);
+                tokens.clear();
+                block_start = pos;
+            }
+        }
+        if (!tokens.empty()) emit(bw, tokens, block_start, pos, last);
+        if (!last) store(bw, size_, size_, false);
+        bw.align();
+    }
+
+private:
+    std::uint32_t hash(std::size_t pos) const {
+        const std::uint32_t v = (static_cast<std::uint32_t>(data_[pos]) << 16) | (static_cast<std::uint32_t>(data_[pos + 1]) << 8) | data_[pos + 2];
+        return (v * 2654435761u) >> (32 - k_hash_bits);
+    }
+
+    void insert(std::size_t pos) {
+        if (pos + k_min_match > size_) return;
+        const std::uint32_t h = hash(pos);
+        prev_[pos & (k_window - 1)] = head_[h];
+        head_[h] = static_cast<std::uint32_t>(pos + 1);
+    }
+
+    void find(std::size_t pos, int& best_len, int& best_dist) const {
+        best_len = 0;
+        best_dist = 0;
+        if (pos + k_min_match > size_) return;
+        const int max_len = static_cast<int>(std::min<std::size_t>(k_max_match, size_ - pos));
+        std::uint32_t cand = head_[hash(pos)];
+        for (int chain = effort_.chain; cand != 0 && chain > 0; --chain) {
+            const std::size_t at = cand - 1;
+            if (at >= pos || pos - at > k_window) break;
+            if (data_[at + static_cast<std::size_t>(best_len)] == data_[pos + static_cast<std::size_t>(best_len)] || best_len == 0) {
+                int len = 0;
+                while (len < max_len && data_[at + static_cast<std::size_t>(len)] == data_[pos + static_cast<std::size_t>(len)]) ++len;
+                if (len > best_len) {
+                    best_len = len;
+                    best_dist = static_cast<int>(pos - at);
+                    if (len >= effort_.good || len == max_len) break;
+                }
+            }
+            const std::uint32_t next = prev_[at & (k_window - 1)];
+            if (next >= cand) break; // the slot was reused by a newer position
+            cand = next;
+        }
+        if (best_len < k_min_match) best_len = 0;
+    }
+
+    void store(bit_writer& bw, std::size_t from, std::size_t to, bool last) {
+        do {
+            const std::size_t n = std::min<std::size_t>(to - from, 65535);
+            const bool final_block = last && from + n == to;
+            bw.put(final_block ? 1u : 0u, 1);
+            bw.put(0, 2);
+            bw.align();
+            bw.put(static_cast<std::uint32_t>(n), 16);
+            bw.put(static_cast<std::uint32_t>(~n & 0xFFFFu), 16);
+            for (std::size_t i = 0; i < n; ++i) bw.put(data_[from + i], 8);
+            from += n;
+        } while (from < to);
+    }
+
+    void emit(bit_writer& bw, const std::vector<lz_token>& tokens, std::size_t from, std::size_t to, bool last) {
+        std::vector<std::uint32_t> lit_freq(286, 0);
+        std::vector<std::uint32_t> dist_freq(30, 0);
+        for (const auto& t : tokens) {
+            if (t.dist == 0) {
+                ++lit_freq[t.length];
+            } else {
+                ++lit_freq[static_cast<std::size_t>(257 + length_code(t.length))];
+                ++dist_freq[static_cast<std::size_t>(dist_code(t.dist))];
+            }
+        }
+        ++lit_freq[256];
+
+        block_codes dyn;
+        dyn.lit_len = huffman_lengths(lit_freq, 15);
+        dyn.dist_len = huffman_lengths(dist_freq, 15);
+        if (std::all_of(dyn.dist_len.begin(), dyn.dist_len.end(), [](std::uint8_t l) { return l == 0; })) dyn.dist_len[0] = 1;
+        int nlen = 286;
+        while (nlen > 257 && dyn.lit_len[static_cast<std::size_t>(nlen - 1)] == 0) --nlen;
+        int ndist = 30;
+        while (ndist > 1 && dyn.dist_len[static_cast<std::size_t>(ndist - 1)] == 0) --ndist;
+        std::vector<std::uint8_t> all(dyn.lit_len.begin(), dyn.lit_len.begin() + nlen);
+        all.insert(all.end(), dyn.dist_len.begin(), dyn.dist_len.begin() + ndist);
+        const header_rle rle = rle_lengths(all);
+        const std::vector<std::uint8_t> cl_len = huffman_lengths(rle.freq, 7);
+        int ncl = 19;
+        while (ncl > 4 && cl_len[k_code_length_order[ncl - 1]] == 0) --ncl;
+        std::uint64_t dyn_bits = 3 + 5 + 5 + 4 + 3 * static_cast<std::uint64_t>(ncl);
+        for (const auto& [sym, extra] : rle.items) dyn_bits += cl_len[sym] + (sym == 16 ? 2 : sym == 17 ? 3 : sym == 18 ? 7 : 0);
+        dyn_bits += token_bits(lit_freq, dist_freq, dyn);
+
+        block_codes fixed = fixed_codes();
+        std::vector<std::uint32_t> fixed_lit = lit_freq;
+        fixed_lit.resize(288, 0);
+        const std::uint64_t fixed_bits = 3 + token_bits(fixed_lit, dist_freq, fixed);
+        const std::uint64_t stored_bits = (to - from + 5 * ((to - from) / 65535 + 1)) * 8 + 7;
+
+        if (stored_bits < dyn_bits && stored_bits < fixed_bits) {
+            store(bw, from, to, last);
+            return;
+        }
+        const bool use_fixed = fixed_bits <= dyn_bits;
+        bw.put(last ? 1u : 0u, 1);
+        bw.put(use_fixed ? 1u : 2u, 2);
+        const block_codes& codes = use_fixed ? fixed : dyn;
+        if (!use_fixed) {
+            bw.put(static_cast<std::uint32_t>(nlen - 257), 5);
+            bw.put(static_cast<std::uint32_t>(ndist - 1), 5);
+            bw.put(static_cast<std::uint32_t>(ncl - 4), 4);
+            for (int i = 0; i < ncl; ++i) bw.put(cl_len[k_code_length_order[i]], 3);
+            const std::vector<std::uint16_t> cl_codes = canonical_codes(cl_len);
+            for (const auto& [sym, extra] : rle.items) {
+                bw.put(cl_codes[sym], cl_len[sym]);
+                if (sym == 16) bw.put(extra, 2);
+                else if (sym == 17) bw.put(extra, 3);
+                else if (sym == 18) bw.put(extra, 7);
+            }
+        }
+        const std::vector<std::uint16_t> lit_codes = canonical_codes(codes.lit_len);
+        const std::vector<std::uint16_t> dist_codes = canonical_codes(codes.dist_len);
+        for (const auto& t : tokens) {
+            if (t.dist == 0) {
+                bw.put(lit_codes[t.length], codes.lit_len[t.length]);
+                continue;
+            }
+            const int lc = length_code(t.length);
+            bw.put(lit_codes[static_cast<std::size_t>(257 + lc)], codes.lit_len[static_cast<std::size_t>(257 + lc)]);
+            bw.put(static_cast<std::uint32_t>(t.length - k_length_base[lc]), k_length_extra[lc]);
+            const int dc = dist_code(t.dist);
+            bw.put(dist_codes[static_cast<std::size_t>(dc)], codes.dist_len[static_cast<std::size_t>(dc)]);
+            bw.put(static_cast<std::uint32_t>(t.dist - k_dist_base[dc]), k_dist_extra[dc]);
+        }
+        bw.put(lit_codes[256], codes.lit_len[256]);
+    }
+
+    const std::uint8_t* data_;
+    std::size_t size_;
+    lz_effort effort_;
+    std::vector<std::uint32_t> head_; // position + 1 of the newest string per hash, 0 if none
+    std::vector<std::uint32_t> prev_; // older position + 1 with the same hash, by window slot
+};
+
+/// \brief adler32.
+std::uint32_t adler32(const std::uint8_t* data, std::size_t size) {
+    std::uint32_t a = 1;
+    std::uint32_t b = 0;
+    while (size > 0) {
+        // 5552 bytes is the most that cannot overflow before the modulo
+        const std::size_t n = std::min<std::size_t>(size, 5552);
+        for (std::size_t i = 0; i < n; ++i) {
+            a += data[i];
+            b += a;
+        }
+        a %= 65521;
+        b %= 65521;
+        data += n;
+        size -= n;
+    }
+    return (b << 16) | a;
+}
+
+/// \brief crc32.
+std::uint32_t crc32(const std::uint8_t* data, std::size_t size, std::uint32_t crc = 0) {
+    static const auto table = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t i = 0; i < 256; ++i) {
+            std::uint32_t c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1u) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            t[i] = c;
+        }
+        return t;
+    }();
+    crc = ~crc;
+    for (std::size_t i = 0; i < size; ++i) crc = table[(crc ^ data[i]) & 0xFFu] ^ (crc >> 8);
+    return ~crc;
+}
+
+/// \brief put_be32.
+void put_be32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    out.push_back(static_cast<std::uint8_t>(v >> 24));
+    out.push_back(static_cast<std::uint8_t>(v >> 16));
+    out.push_back(static_cast<std::uint8_t>(v >> 8));
+    out.push_back(static_cast<std::uint8_t>(v));
+}
+
+/// \brief write_chunk.
+void write_chunk(std::ofstream& out, const char* type, const std::uint8_t* data, std::size_t size) {
+    std::vector<std::uint8_t> head;
+    put_be32(head, static_cast<std::uint32_t>(size));
+    head.insert(head.end(), type, type + 4);
+    std::uint32_t crc = crc32(head.data() + 4, 4);
+    crc = crc32(data, size, crc);
+    std::vector<std::uint8_t> tail;
+    put_be32(tail, crc);
+    out.write(reinterpret_cast<const char*>(head.data()), static_cast<std::streamsize>(head.size()));
+    if (size != 0) out.write(reinterpret_cast<const char*>(data), static_cast<std::streamsize>(size));
+    out.write(reinterpret_cast<const char*>(tail.data()), 4);
+}
+
+} // namespace
+
+/// \brief zlib_compress.
+std::vector<std::uint8_t> zlib_compress(const std::uint8_t* data, std::size_t size, int level, unsigned threads) {
+    std::vector<std::uint8_t> out;
+    out.reserve(size / 4 + 64);
+    // CMF: deflate with a 32 KiB window; FLG: check bits, no dictionary
+    out.push_back(0x78);
+    out.push_back(0x01);
+
+    // Each chunk is deflated on its own, matching into the 32 KiB before it,
+    // and all but the last end byte aligned, so they concatenate in order.
+    const std::size_t chunk = std::max(k_min_parallel_chunk, threads > 1 ? (size + threads - 1) / threads : size);
+    const std::size_t chunks = size == 0 ? 1 : (size + chunk - 1) / chunk;
+    std::vector<std::vector<std::uint8_t>> parts(chunks);
+    const auto compress_chunk = [&](std::size_t i) {
+        const std::size_t begin = i * chunk;
+        const std::size_t end = std::min(size, begin + chunk);
+        deflater(data, end, level).run(parts[i], begin, i + 1 == chunks);
+    };
+    if (chunks == 1) {
+        compress_chunk(0);
+    } else {
+        std::atomic<std::size_t> next{0};
+        std::vector<std::thread> workers;
+        for (std::size_t t = 0; t < std::min<std::size_t>(threads, chunks); ++t) {
+            workers.emplace_back([&] {
+                for (std::size_t i = next++; i < chunks; i = next++) compress_chunk(i);
+            });
+        }
+        for (auto& w : workers) w.join();
+    }
+    for (const auto& part : parts) out.insert(out.end(), part.begin(), part.end());
+    put_be32(out, adler32(data, size));
+    return out;
+}
+
+/// \brief png_write.
+bool png_write(const std::filesystem::path& path, const png_image_view& image, int level, unsigned threads, std::string& error) {
+    const bool depth_ok = image.color_type == 3 ? (image.bit_depth == 1 || image.bit_depth == 2 || image.bit_depth == 4 || image.bit_depth == 8)
+                        : image.color_type == 0 ? (image.bit_depth == 1 || image.bit_depth == 2 || image.bit_depth == 4 || image.bit_depth == 8)
+                        : image.color_type == 2 && image.bit_depth == 8;
+    if (image.width <= 0 || image.height <= 0 || !image.rows || !depth_ok) {
+        error = "png: unsupported image";
+        return false;
+    }
+    const int channels = image.color_type == 2 ? 3 : 1;
+    const std::size_t row_bytes = (static_cast<std::size_t>(image.width) * static_cast<std::size_t>(channels * image.bit_depth) + 7) / 8;
+    if (image.stride < row_bytes || (image.color_type == 3 && (image.palette.empty() || image.palette.size() > (std::size_t{1} << image.bit_depth)))) {
+        error = "png: bad stride or palette";
+        return false;
+    }
+
+    std::vector<std::uint8_t> raw;
+    raw.reserve((row_bytes + 1) * static_cast<std::size_t>(image.height));
+    for (int y = 0; y < image.height; ++y) {
+        raw.push_back(0); // filter: none
+        const std::uint8_t* row = image.rows + static_cast<std::size_t>(y) * image.stride;
+        raw.insert(raw.end(), row, row + row_bytes);
+    }
+    const std::vector<std::uint8_t> idat = zlib_compress(raw.data(), raw.size(), level, threads);
+
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        error = "png: cannot open output file";
+        return false;
+    }
+    static constexpr std::uint8_t signature[8] = {0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A};
+    out.write(reinterpret_cast<const char*>(signature), 8);
+
+    std::vector<std::uint8_t> ihdr;
+    put_be32(ihdr, static_cast<std::uint32_t>(image.width));
+    put_be32(ihdr, static_cast<std::uint32_t>(image.height));
+    ihdr.push_back(static_cast<std::uint8_t>(image.bit_depth));
+    ihdr.push_back(static_cast<std::uint8_t>(image.color_type));
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    ihdr.push_back(0);
+    write_chunk(out, "IHDR", ihdr.data(), ihdr.size());
+    if (image.color_type == 3) {
+        std::vector<std::uint8_t> plte;
+        for (const auto& c : image.palette) {
+            plte.push_back(c.r);
+            plte.push_back(c.g);
+            plte.push_back(c.b);
+        }
+        write_chunk(out, "PLTE", plte.data(), plte.size());
+    }
+    write_chunk(out, "IDAT", idat.data(), idat.size());
+    write_chunk(out, "IEND", nullptr, 0);
+    if (!out.good()) {
+        error = "png: failed while writing output";
+        return false;
+    }
+    return true;
+}
@@ -11,12 +11,80 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstdint>
+#include <mutex>
+#include <vector>
 
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 namespace {
 
+// FreeType and recently opened faces live as long as the process, so a
+// resident snatch re-opens a font only when the file changed on disk.
+class face_cache {
+public:
+    ~face_cache() {
+        for (auto& e : entries_) FT_Done_Face(e.face);
+        if (library_) FT_Done_FreeType(library_);
+    }
+
+    /// \brief face_cache::acquire.
+    FT_Face acquire(const std::string& path, std::string& err) {
+        if (!library_ && FT_Init_FreeType(&library_) != 0) {
+            library_ = nullptr;
+            err = "failed to initialize FreeType";
+            return nullptr;
+        }
+
+        std::error_code ec;
+        const auto mtime = std::filesystem::last_write_time(path, ec);
+        const auto size = ec ? 0 : std::filesystem::file_size(path, ec);
+        for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+            if (it->path != path) continue;
+            if (!ec && it->mtime == mtime && it->size == size) {
+                it->used = ++tick_;
+                return it->face;
+            }
+            FT_Done_Face(it->face);
+            entries_.erase(it);
+            break;
+        }
+
+        FT_Face face = nullptr;
+        if (FT_New_Face(library_, path.c_str(), 0, &face) != 0) {
+            err = "failed to open TTF file: " + path;
+            return nullptr;
+        }
+        if (entries_.size() >= k_capacity) {
+            auto lru = std::min_element(entries_.begin(), entries_.end(),
+                                        [](const entry& a, const entry& b) { return a.used < b.used; });
+            FT_Done_Face(lru->face);
+            entries_.erase(lru);
+        }
+        entries_.push_back({path, mtime, size, face, ++tick_});
+        return face;
+    }
+
+private:
+    static constexpr std::size_t k_capacity = 8;
+
+    struct entry {
+        std::string path;
+        std::filesystem::file_time_type mtime;
+        std::uintmax_t size;
+        FT_Face face;
+        std::uint64_t used;
+    };
+
+    FT_Library library_{nullptr};
+    std::vector<entry> entries_;
+    std::uint64_t tick_{0};
+};
+
+std::mutex g_face_mutex;
+face_cache g_faces;
+
 /// \brief rasterize_glyph.
 bool rasterize_glyph(FT_Face face, int codepoint, bool proportional, extracted_glyph& out, std::string& err) {
     const int flags = FT_LOAD_RENDER | FT_LOAD_MONOCHROME | FT_LOAD_TARGET_MONO;
@@ -116,72 +184,154 @@ int ttf_extractor::choose_natural_size(void* ft_face) {
 
 /// \brief ttf_extractor::extract.
 bool ttf_extractor::extract(const ttf_extract_options& opt, extracted_font& out, std::string& err) const {
-    FT_Library library = nullptr;
-    if (FT_Init_FreeType(&library) != 0) {
-        err = "failed to initialize FreeType";
-        return false;
+    extracted_font header;
+    std::vector<extracted_glyph> glyphs;
+    const auto on_begin = [&](const extracted_font& h) {
+        glyphs.reserve(static_cast<size_t>(h.last_codepoint - h.first_codepoint + 1));
+        return true;
+    };
+    const auto on_glyph = [&](extracted_glyph& g) {
+        glyphs.push_back(std::move(g));
+        return true;
+    };
+    if (!extract_each(opt, header, on_begin, on_glyph, err)) return false;
+
+    out = std::move(header);
+    out.glyphs = std::move(glyphs);
+    out.glyph_views.reserve(out.glyphs.size());
+    for (auto& g : out.glyphs) {
+        g.view.data = g.bitmap.empty() ? nullptr : g.bitmap.data();
+        out.glyph_views.push_back(g.view);
     }
 
-    FT_Face face = nullptr;
+    out.bitmap_view.glyph_count = static_cast<int>(out.glyph_views.size());
+    out.bitmap_view.glyphs = out.glyph_views.empty() ? nullptr : out.glyph_views.data();
+    return true;
+}
+
+/// \brief ttf_extractor::open_face.
+void* ttf_extractor::open_face(const ttf_extract_options& opt, extracted_font& header, std::string& err) {
     const std::string font_path = opt.input_file.string();
-    if (FT_New_Face(library, font_path.c_str(), 0, &face) != 0) {
-        FT_Done_FreeType(library);
-        err = "failed to open TTF file: " + font_path;
-        return false;
-    }
+    FT_Face face = g_faces.acquire(font_path, err);
+    if (!face) return nullptr;
 
     const int first = (opt.first_ascii >= 0) ? opt.first_ascii : 32;
     const int last = (opt.last_ascii >= 0) ? opt.last_ascii : 126;
     if (first > last) {
-        FT_Done_Face(face);
-        FT_Done_FreeType(library);
         err = "invalid codepoint range";
-        return false;
+        return nullptr;
     }
 
     const int size = (opt.font_size > 0) ? opt.font_size : choose_natural_size(face);
     if (FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(size)) != 0) {
-        FT_Done_Face(face);
-        FT_Done_FreeType(library);
         err = "failed to set pixel size";
-        return false;
+        return nullptr;
     }
 
-    out = {};
-    out.name = (face->family_name ? face->family_name : "unknown");
+    header = {};
+    header.name = (face->family_name ? face->family_name : "unknown");
     if (face->style_name && face->style_name[0] != '\0') {
-        out.name += " ";
-        out.name += face->style_name;
+        header.name += " ";
+        header.name += face->style_name;
     }
-    out.first_codepoint = first;
-    out.last_codepoint = last;
-    out.pixel_size = size;
+    header.first_codepoint = first;
+    header.last_codepoint = last;
+    header.pixel_size = size;
+    return face;
+}
 
-    const int glyph_count = last - first + 1;
-    out.glyphs.reserve(static_cast<size_t>(glyph_count));
-    out.glyph_views.reserve(static_cast<size_t>(glyph_count));
+/// \brief ttf_extractor::extract_each.
+bool ttf_extractor::extract_each(const ttf_extract_options& opt, extracted_font& header,
+                                 const std::function<bool(const extracted_font&)>& on_begin,
+                                 const std::function<bool(extracted_glyph&)>& on_glyph, std::string& err) const {
+    // faces are shared through the cache; one extraction at a time
+    std::lock_guard<std::mutex> lock(g_face_mutex);
+    FT_Face face = static_cast<FT_Face>(open_face(opt, header, err));
+    if (!face) return false;
+    if (!on_begin(header)) {
+        if (err.empty()) err = "extraction stopped by its consumer";
+        return false;
+    }
 
-    for (int cp = first; cp <= last; ++cp) {
+    for (int cp = header.first_codepoint; cp <= header.last_codepoint; ++cp) {
         extracted_glyph g;
         if (!rasterize_glyph(face, cp, opt.proportional, g, err)) {
-            FT_Done_Face(face);
-            FT_Done_FreeType(library);
             return false;
         }
-        out.glyph_width = std::max(out.glyph_width, g.view.width);
-        out.glyph_height = std::max(out.glyph_height, g.view.height);
-        out.glyphs.push_back(std::move(g));
+        header.glyph_width = std::max(header.glyph_width, g.view.width);
+        header.glyph_height = std::max(header.glyph_height, g.view.height);
+        if (!on_glyph(g)) {
+            if (err.empty()) err = "extraction stopped by its consumer";
+            return false;
+        }
     }
+    return true;
+}
 
-    for (auto& g : out.glyphs) {
-        g.view.data = g.bitmap.empty() ? nullptr : g.bitmap.data();
-        out.glyph_views.push_back(g.view);
+ttf_lazy_font::ttf_lazy_font(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+/// \brief ttf_lazy_font::open.
+bool ttf_lazy_font::open(const ttf_extract_options& opt, extracted_font& header, std::string& err) {
+    std::lock_guard<std::mutex> lock(g_face_mutex);
+    if (!ttf_extractor::open_face(opt, header, err)) return false;
+    std::lock_guard<std::mutex> memo(mu_);
+    opt_ = opt;
+    first_ = header.first_codepoint;
+    last_ = header.last_codepoint;
+    // fixed from here on, even when the size was picked automatically
+    size_ = header.pixel_size;
+    used_.clear();
+    index_.clear();
+    rasterized_ = 0;
+    return true;
+}
+
+/// \brief ttf_lazy_font::glyph.
+bool ttf_lazy_font::glyph(int index, extracted_glyph& out, std::string& err) {
+    if (index < 0 || index >= glyph_count()) {
+        err = "glyph index out of range";
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> memo(mu_);
+        if (const auto it = index_.find(index); it != index_.end()) {
+            used_.splice(used_.begin(), used_, it->second);
+            out = it->second->second;
+            out.view.data = out.bitmap.empty() ? nullptr : out.bitmap.data();
+            return true;
+        }
     }
 
-    out.bitmap_view.glyph_count = static_cast<int>(out.glyph_views.size());
-    out.bitmap_view.glyphs = out.glyph_views.empty() ? nullptr : out.glyph_views.data();
+    extracted_glyph g;
+    {
+        // the face is shared and may have been resized by another extraction
+        std::lock_guard<std::mutex> lock(g_face_mutex);
+        FT_Face face = g_faces.acquire(opt_.input_file.string(), err);
+        if (!face) return false;
+        if (FT_Set_Pixel_Sizes(face, 0, static_cast<FT_UInt>(size_)) != 0) {
+            err = "failed to set pixel size";
+            return false;
+        }
+        if (!rasterize_glyph(face, first_ + index, opt_.proportional, g, err)) return false;
+    }
 
-    FT_Done_Face(face);
-    FT_Done_FreeType(library);
+    std::lock_guard<std::mutex> memo(mu_);
+    ++rasterized_;
+    out = g;
+    out.view.data = out.bitmap.empty() ? nullptr : out.bitmap.data();
+    // another thread may have made the same glyph meanwhile
+    if (index_.count(index) != 0) return true;
+    used_.emplace_front(index, std::move(g));
+    index_[index] = used_.begin();
+    if (used_.size() > capacity_) {
+        index_.erase(used_.back().first);
+        used_.pop_back();
+    }
     return true;
 }
+
+/// \brief ttf_lazy_font::rasterized.
+std::size_t ttf_lazy_font::rasterized() const {
+    std::lock_guard<std::mutex> memo(mu_);
+    return rasterized_;
+}
@@ -0,0 +1,306 @@
+/// \file
+/// \brief Sprite atlas exporter plugin implementation.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/bit_blit.h"
+#include "snatch/glyph_algorithms.h"
+#include "snatch/plugin.h"
+#include "snatch/plugin_util.h"
+#include "snatch/png_writer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr int k_max_atlas_side = 65535;
+
+// One glyph's trimmed box: where it sits in the atlas and how to draw it
+// from the pen position on the baseline.
+struct atlas_entry {
+    int codepoint{0};
+    atlas_rect rect;
+    int src_left{0};
+    int src_top{0};
+    int offset_x{0}; // pen x to the box's left column
+    int offset_y{0}; // baseline to the box's top row, negative above it
+    int advance{0};
+};
+
+/// \brief sanitize_c_ident.
+std::string sanitize_c_ident(std::string value) {
+    if (value.empty()) return "atlas";
+    for (char& c : value) {
+        const unsigned char u = static_cast<unsigned char>(c);
+        if (!(std::isalnum(u) || c == '_')) c = '_';
+    }
+    const unsigned char first = static_cast<unsigned char>(value.front());
+    if (!(std::isalpha(first) || value.front() == '_')) value.insert(value.begin(), '_');
+    return value;
+}
+
+/// \brief parse_range.
+// absent means `fallback`; present but outside lo..hi means nullopt
+std::optional<int> parse_range(std::optional<std::string_view> raw, int fallback, int lo, int hi) {
+    if (!raw || raw->empty()) return fallback;
+    const auto parsed = plugin_parse_int(*raw);
+    if (!parsed || *parsed < lo || *parsed > hi) return std::nullopt;
+    return *parsed;
+}
+
+/// \brief next_pow2.
+int next_pow2(int v) {
+    int p = 1;
+    while (p < v) p <<= 1;
+    return p;
+}
+
+/// \brief put_u16.
+void put_u16(std::vector<std::uint8_t>& out, int v) {
+    out.push_back(static_cast<std::uint8_t>(v & 0xFF));
+    out.push_back(static_cast<std::uint8_t>((v >> 8) & 0xFF));
+}
+
+/// \brief put_u32.
+void put_u32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    put_u16(out, static_cast<int>(v & 0xFFFFu));
+    put_u16(out, static_cast<int>(v >> 16));
+}
+
+/// \brief binary_table.
+// "SATL", u16 version (2), u32 count, u16 atlas width, u16 atlas height, then
+// per glyph u32 codepoint, u16 x, y, w, h, i16 offset_x, offset_y, u16 advance;
+// all little-endian. Version 1 had a u16 count.
+std::vector<std::uint8_t> binary_table(const std::vector<atlas_entry>& entries, int atlas_w, int atlas_h) {
+    std::vector<std::uint8_t> out{'S', 'A', 'T', 'L'};
+    put_u16(out, 2);
+    put_u32(out, static_cast<std::uint32_t>(entries.size()));
+    put_u16(out, atlas_w);
+    put_u16(out, atlas_h);
+    for (const auto& e : entries) {
+        put_u32(out, static_cast<std::uint32_t>(e.codepoint));
+        put_u16(out, e.rect.x);
+        put_u16(out, e.rect.y);
+        put_u16(out, e.rect.width);
+        put_u16(out, e.rect.height);
+        put_u16(out, static_cast<std::uint16_t>(static_cast<std::int16_t>(e.offset_x)));
+        put_u16(out, static_cast<std::uint16_t>(static_cast<std::int16_t>(e.offset_y)));
+        put_u16(out, e.advance);
+    }
+    return out;
+}
+
+/// \brief c_table.
+std::string c_table(const std::vector<atlas_entry>& entries, int atlas_w, int atlas_h, const std::string& symbol, const std::string& file_name) {
+    std::ostringstream text;
+    text << "// " << file_name << "\n";
+    text << "// Glyph rectangles of a " << atlas_w << "x" << atlas_h << " 1bpp atlas.\n";
+    text << "// offset_x is from the pen, offset_y from the baseline (negative above it).\n";
+    text << "#include <stdint.h>\n\n";
+    text << "typedef struct {\n";
+    text << "    uint32_t codepoint;\n";
+    text << "    uint16_t x, y, w, h;\n";
+    text << "    int16_t offset_x, offset_y;\n";
+    text << "    uint16_t advance;\n";
+    text << "} " << symbol << "_rect;\n\n";
+    text << "const uint16_t " << symbol << "_width = " << atlas_w << ";\n";
+    text << "const uint16_t " << symbol << "_height = " << atlas_h << ";\n";
+    text << "const uint32_t " << symbol << "_count = " << entries.size() << ";\n";
+    text << "const " << symbol << "_rect " << symbol << "_rects[" << std::max<size_t>(entries.size(), 1) << "] = {\n";
+    for (const auto& e : entries) {
+        text << "    {" << e.codepoint << ", " << e.rect.x << ", " << e.rect.y << ", " << e.rect.width << ", " << e.rect.height << ", "
+             << e.offset_x << ", " << e.offset_y << ", " << e.advance << "},\n";
+    }
+    text << "};\n";
+    return text.str();
+}
+
+/// \brief write_bytes.
+bool write_bytes(const std::filesystem::path& path, const void* data, size_t size) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) return false;
+    out.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+    return out.good();
+}
+
+/// \brief export_atlas.
+int export_atlas(
+    const snatch_font* font,
+    const char* output_path,
+    const snatch_kv* options,
+    unsigned options_count,
+    char* errbuf,
+    unsigned errbuf_len
+) {
+    const plugin_kv_view kv{options, options_count};
+
+    if (!font || !font->bitmap_font || !font->bitmap_font->glyphs) {
+        plugin_set_err(errbuf, errbuf_len, "atlas: bitmap font data missing");
+        return 10;
+    }
+    if (!output_path || output_path[0] == '\0') {
+        plugin_set_err(errbuf, errbuf_len, "atlas: output path is empty");
+        return 11;
+    }
+    const snatch_bitmap_font& bf = *font->bitmap_font;
+    if (bf.glyph_count <= 0) {
+        plugin_set_err(errbuf, errbuf_len, "atlas: no glyphs to export");
+        return 12;
+    }
+
+    const auto width_opt = parse_range(kv.get("width"), 0, 0, k_max_atlas_side);
+    const auto spacing = parse_range(kv.get("spacing"), 0, 0, 255);
+    const auto align_x = parse_range(kv.get("align_x"), 1, 1, 64);
+    if (!width_opt || !spacing || !align_x) {
+        plugin_set_err(errbuf, errbuf_len, "atlas: width must be 0..65535, spacing 0..255 and align_x 1..64");
+        return 13;
+    }
+    const bool power_of_two = plugin_parse_bool(kv.get("power_of_two"), false);
+
+    // trim every glyph to its ink
+    std::vector<atlas_entry> entries(static_cast<size_t>(bf.glyph_count));
+    std::vector<atlas_rect> boxes(entries.size());
+    long long area = 0;
+    int widest = 1;
+    for (int i = 0; i < bf.glyph_count; ++i) {
+        const snatch_glyph_bitmap& g = bf.glyphs[i];
+        atlas_entry& e = entries[static_cast<size_t>(i)];
+        e.codepoint = g.codepoint;
+        e.advance = std::clamp(g.advance_x, 0, 65535);
+        const glyph_bounds b = glyph_bitmap_analyzer::bounds(g);
+        if (b.empty) continue;
+        e.src_left = b.left;
+        e.src_top = b.top;
+        e.offset_x = g.bearing_x + b.left;
+        e.offset_y = b.top - g.bearing_y;
+        boxes[static_cast<size_t>(i)].width = b.right - b.left + 1;
+        boxes[static_cast<size_t>(i)].height = b.bottom - b.top + 1;
+        widest = std::max(widest, boxes[static_cast<size_t>(i)].width);
+        area += static_cast<long long>(boxes[static_cast<size_t>(i)].width + *spacing) * (boxes[static_cast<size_t>(i)].height + *spacing);
+    }
+
+    // Without a width, aim for a square a little larger than the ink; a
+    // multiple of 8 keeps raw rows free of padding bits.
+    int atlas_w = *width_opt;
+    if (atlas_w == 0) {
+        atlas_w = std::max(widest, static_cast<int>(std::ceil(std::sqrt(static_cast<double>(area) * 1.05))));
+        atlas_w = power_of_two ? next_pow2(atlas_w) : (atlas_w + 7) / 8 * 8;
+    }
+    if (atlas_w > k_max_atlas_side) {
+        plugin_set_err(errbuf, errbuf_len, "atlas: glyphs need an atlas wider than 65535");
+        return 13;
+    }
+
+    glyph_atlas_packer packer(atlas_w, *align_x, *spacing);
+    if (!packer.pack(boxes)) {
+        plugin_set_err(errbuf, errbuf_len, "atlas: a glyph is wider than the atlas");
+        return 15;
+    }
+    int atlas_h = std::max(packer.height(), 1);
+    if (power_of_two) atlas_h = next_pow2(atlas_h);
+    if (atlas_h > k_max_atlas_side) {
+        plugin_set_err(errbuf, errbuf_len, "atlas: glyphs need an atlas taller than 65535; raise width");
+        return 13;
+    }
+
+    const size_t stride = (static_cast<size_t>(atlas_w) + 7) / 8;
+    std::vector<std::uint8_t> bitmap(stride * static_cast<size_t>(atlas_h), 0);
+    for (size_t i = 0; i < entries.size(); ++i) {
+        atlas_entry& e = entries[i];
+        e.rect = boxes[i];
+        const snatch_glyph_bitmap& g = bf.glyphs[i];
+        for (int row = 0; row < e.rect.height; ++row) {
+            blit_row_1bpp(
+                bitmap.data() + static_cast<size_t>(e.rect.y + row) * stride,
+                atlas_w,
+                e.rect.x,
+                g.data + static_cast<size_t>(e.src_top + row) * static_cast<size_t>(g.stride_bytes),
+                e.src_left,
+                e.rect.width,
+                raster_op::copy
+            );
+        }
+    }
+
+    // .png gets a 1-bit palette image, anything else the raw rows
+    const std::filesystem::path out_path{output_path};
+    std::string ext = out_path.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (ext == ".png") {
+        png_image_view view;
+        view.width = atlas_w;
+        view.height = atlas_h;
+        view.bit_depth = 1;
+        view.color_type = 3;
+        view.rows = bitmap.data();
+        view.stride = stride;
+        view.palette = {{255, 255, 255}, {0, 0, 0}};
+        std::string error;
+        if (!png_write(out_path, view, 6, 1, error)) {
+            plugin_set_err(errbuf, errbuf_len, "atlas: " + error);
+            return 14;
+        }
+    } else if (!write_bytes(out_path, bitmap.data(), bitmap.size())) {
+        plugin_set_err(errbuf, errbuf_len, "atlas: failed to write atlas bitmap");
+        return 14;
+    }
+
+    // the table defaults to <output stem>_rects.bin beside the atlas
+    std::filesystem::path table_path = out_path.parent_path() / (out_path.stem().string() + "_rects.bin");
+    if (const auto raw = kv.get("table"); raw && !raw->empty()) table_path = std::filesystem::path(std::string(*raw));
+    std::string table_ext = table_path.extension().string();
+    std::transform(table_ext.begin(), table_ext.end(), table_ext.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    bool table_ok = false;
+    if (table_ext == ".c" || table_ext == ".h") {
+        std::string symbol = sanitize_c_ident(out_path.stem().string());
+        if (const auto v = kv.get("symbol"); v && !v->empty()) symbol = sanitize_c_ident(std::string(*v));
+        const std::string text = c_table(entries, atlas_w, atlas_h, symbol, table_path.filename().string());
+        table_ok = write_bytes(table_path, text.data(), text.size());
+    } else {
+        const std::vector<std::uint8_t> bytes = binary_table(entries, atlas_w, atlas_h);
+        table_ok = write_bytes(table_path, bytes.data(), bytes.size());
+    }
+    if (!table_ok) {
+        plugin_set_err(errbuf, errbuf_len, "atlas: failed to write rect table");
+        return 14;
+    }
+    return 0;
+}
+
+const snatch_plugin_info k_info = {
+    "atlas",
+    "Packs trimmed bitmap glyphs into one atlas with a rect table",
+    "snatch project",
+    "bin",
+    "snatch-atlas",
+    SNATCH_PLUGIN_ABI_VERSION,
+    SNATCH_PLUGIN_KIND_EXPORTER,
+    nullptr,
+    &export_atlas,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_BITMAP,
+    0,
+    SNATCH_CAP_THREAD_SAFE
+};
+
+} // namespace
+
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
+    if (!out) return 1;
+    *out = &k_info;
+    return 0;
+}
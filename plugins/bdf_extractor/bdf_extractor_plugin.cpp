@@ -0,0 +1,104 @@
+/// \file
+/// \brief BDF/PCF extractor plugin adapter for core extraction.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/plugin.h"
+#include "snatch/plugin_util.h"
+
+#include "snatch/bdf_extractor.h"
+#include "snatch/extracted_font.h"
+
+#include <optional>
+#include <string>
+
+namespace {
+
+struct bdf_extract_owner {
+    extracted_font font{};
+    snatch_font view{};
+};
+
+static bdf_extract_owner g_owner;
+
+/// \brief parse_int_kv.
+std::optional<int> parse_int_kv(const plugin_kv_view& kv, std::string_view key) {
+    if (const auto raw = kv.get(key); raw && !raw->empty()) {
+        return plugin_parse_int(*raw);
+    }
+    return std::nullopt;
+}
+
+/// \brief extract_bdf.
+// the font is drawn already: its glyphs are taken as they are, with the
+// font's own metrics
+int extract_bdf(
+    const char* input_path,
+    const snatch_kv* options,
+    unsigned options_count,
+    snatch_font* out_font,
+    char* errbuf,
+    unsigned errbuf_len
+) {
+    if (!input_path || input_path[0] == '\0') {
+        plugin_set_err(errbuf, errbuf_len, "bdf_extractor: input path is empty");
+        return 10;
+    }
+    if (!out_font) {
+        plugin_set_err(errbuf, errbuf_len, "bdf_extractor: out_font is null");
+        return 11;
+    }
+
+    const plugin_kv_view kv{options, options_count};
+    bdf_extract_options opt{};
+    opt.input_file = input_path;
+    if (const auto v = parse_int_kv(kv, "first_ascii"); v.has_value()) opt.first_ascii = *v;
+    if (const auto v = parse_int_kv(kv, "last_ascii"); v.has_value()) opt.last_ascii = *v;
+    if (opt.first_ascii >= 0 && opt.last_ascii >= 0 && opt.last_ascii < opt.first_ascii) {
+        plugin_set_err(errbuf, errbuf_len, "bdf_extractor: last_ascii is below first_ascii");
+        return 12;
+    }
+
+    bdf_extractor extractor;
+    extracted_font extracted;
+    std::string extract_err;
+    if (!extractor.extract(opt, extracted, extract_err)) {
+        plugin_set_err(errbuf, errbuf_len, std::string("bdf_extractor: ") + extract_err);
+        return 13;
+    }
+
+    g_owner.font = std::move(extracted);
+    g_owner.view = g_owner.font.as_plugin_font();
+    *out_font = g_owner.view;
+    return 0;
+}
+
+const snatch_plugin_info k_info = {
+    "bdf_extractor",
+    "Extracts bitmap glyphs from BDF and PCF fonts",
+    "snatch project",
+    "bdf",
+    "extractor",
+    SNATCH_PLUGIN_ABI_VERSION,
+    SNATCH_PLUGIN_KIND_EXTRACTOR,
+    nullptr,
+    nullptr,
+    &extract_bdf,
+    nullptr,
+    nullptr,
+    nullptr,
+    0,
+    SNATCH_PAYLOAD_BITMAP,
+    0
+};
+
+} // namespace
+
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
+    if (!out) return 1;
+    *out = &k_info;
+    return 0;
+}
@@ -0,0 +1,472 @@
+/// \file
+/// \brief Compressed binary exporter plugin implementation.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/glyph_pack.h"
+#include "snatch/plugin.h"
+#include "snatch/plugin_util.h"
+#include "snatch_unpack.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// one glyph's unpacked rows, and where they ended up
+struct pack_entry {
+    const snatch_glyph_bitmap* glyph{nullptr};
+    std::size_t same_as{0}; // itself, or the earlier entry sharing its bitmap
+    std::size_t raw_offset{0};
+    std::size_t raw_size{0};
+    std::size_t offset{0};
+    std::size_t packed_size{0};
+};
+
+// the rows a glyph points at; glyphs with equal keys share them
+struct bitmap_key {
+    const unsigned char* data{nullptr};
+    int width{0};
+    int height{0};
+    int stride_bytes{0};
+
+    bool operator==(const bitmap_key&) const = default;
+};
+
+struct bitmap_key_hash {
+    std::size_t operator()(const bitmap_key& k) const {
+        std::size_t h = std::hash<const unsigned char*>{}(k.data);
+        for (const int v : {k.width, k.height, k.stride_bytes}) h = h * 31 + static_cast<std::size_t>(v);
+        return h;
+    }
+};
+
+/// \brief parse_algorithm.
+int parse_algorithm(std::string_view name) {
+    if (name == "none") return SNATCH_PACK_NONE;
+    if (name == "rle") return SNATCH_PACK_RLE;
+    if (name == "lz") return SNATCH_PACK_LZ;
+    return -1;
+}
+
+/// \brief parse_threads.
+// threads=0 (the default) gives each thread at least 64 KiB of rows to pack
+int parse_threads(const plugin_kv_view& kv, std::size_t work) {
+    constexpr int k_max_threads = 256;
+    int requested = 0;
+    if (const auto raw = kv.get("threads"); raw && !raw->empty()) {
+        const auto parsed = plugin_parse_int(*raw);
+        if (!parsed || *parsed < 0 || *parsed > k_max_threads) return -1;
+        requested = *parsed;
+    }
+    if (requested > 0) return requested;
+    constexpr std::size_t k_bytes_per_thread = std::size_t{64} << 10;
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<int>(std::clamp<std::size_t>(work / k_bytes_per_thread, 1, hw));
+}
+
+/// \brief run_bands.
+// fn(begin, end) over `workers` contiguous slices of 0..count, the first on
+// the calling thread
+template <typename Fn>
+void run_bands(int workers, std::size_t count, const Fn& fn) {
+    const std::size_t n = std::clamp<std::size_t>(static_cast<std::size_t>(std::max(workers, 1)), 1, std::max<std::size_t>(count, 1));
+    const auto band = [&](std::size_t t) { fn(count * t / n, count * (t + 1) / n); };
+    std::vector<std::thread> threads;
+    for (std::size_t t = 1; t < n; ++t) threads.emplace_back(band, t);
+    band(0);
+    for (auto& t : threads) t.join();
+}
+
+/// \brief append_rows.
+// rows at (width + 7) / 8 bytes, the bits past the width cleared
+void append_rows(const snatch_glyph_bitmap& g, std::vector<std::uint8_t>& out) {
+    if (!g.data || g.width <= 0 || g.height <= 0 || g.stride_bytes <= 0) return;
+    const int row_bytes = (g.width + 7) / 8;
+    const auto tail = static_cast<std::uint8_t>(0xFFu << ((8 - g.width % 8) % 8));
+    for (int y = 0; y < g.height; ++y) {
+        const std::uint8_t* row = g.data + static_cast<std::size_t>(y) * static_cast<std::size_t>(g.stride_bytes);
+        out.insert(out.end(), row, row + row_bytes);
+        out.back() = static_cast<std::uint8_t>(out.back() & tail);
+    }
+}
+
+/// \brief put_u16.
+void put_u16(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    out.push_back(static_cast<std::uint8_t>(v & 0xFFu));
+    out.push_back(static_cast<std::uint8_t>((v >> 8) & 0xFFu));
+}
+
+/// \brief put_u32.
+void put_u32(std::vector<std::uint8_t>& out, std::uint32_t v) {
+    put_u16(out, v & 0xFFFFu);
+    put_u16(out, v >> 16);
+}
+
+/// \brief pack.
+std::vector<std::uint8_t> pack(int algorithm, const std::uint8_t* data, std::size_t size, unsigned threads, std::vector<std::uint32_t>* cost) {
+    if (algorithm == SNATCH_PACK_RLE) return rle_pack(data, size, cost);
+    if (algorithm == SNATCH_PACK_LZ) return lz_pack(data, size, threads, cost);
+    if (cost) cost->assign(size, 1);
+    return std::vector<std::uint8_t>(data, data + size);
+}
+
+/// \brief parse_dictionary.
+// dictionary=auto (the default) tries a few sizes and keeps the smallest
+// file; -1 when the value is out of range, -2 for auto
+long parse_dictionary(const plugin_kv_view& kv) {
+    constexpr int k_max_dictionary = 32768;
+    const std::string_view raw = kv.get("dictionary").value_or("auto");
+    if (raw == "auto") return -2;
+    const auto parsed = plugin_parse_int(raw);
+    if (!parsed || *parsed < 0 || *parsed > k_max_dictionary) return -1;
+    return *parsed;
+}
+
+/// \brief pack_random.
+// Every distinct pair of rows and metrics becomes one record: the metrics,
+// then the rows packed on their own, LZ matches reaching into the shared
+// dictionary. Sets offset and packed_size of the entries and returns the
+// glyph data.
+std::vector<std::uint8_t> pack_random(
+    int algorithm,
+    long dictionary_size,
+    int workers,
+    std::vector<pack_entry>& entries,
+    const std::vector<std::uint8_t>& raw,
+    std::vector<std::uint8_t>& dictionary
+) {
+    std::vector<std::span<const std::uint8_t>> samples;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].same_as == i && entries[i].raw_size > 0) samples.emplace_back(raw.data() + entries[i].raw_offset, entries[i].raw_size);
+    }
+    std::vector<std::size_t> capacities = {0};
+    if (algorithm == SNATCH_PACK_LZ && dictionary_size > 0) capacities = {static_cast<std::size_t>(dictionary_size)};
+    if (algorithm == SNATCH_PACK_LZ && dictionary_size == -2) {
+        // a dictionary larger than half the rows rarely pays for itself
+        for (const std::size_t c : {std::size_t{256}, std::size_t{1024}, std::size_t{4096}}) {
+            if (c <= raw.size() / 2) capacities.push_back(c);
+        }
+    }
+
+    std::vector<std::vector<std::uint8_t>> best;
+    std::size_t best_total = 0;
+    for (const std::size_t capacity : capacities) {
+        std::vector<std::uint8_t> dict = lz_train_dictionary(samples, capacity);
+        std::vector<std::vector<std::uint8_t>> packed(entries.size());
+        run_bands(workers, entries.size(), [&](std::size_t b0, std::size_t b1) {
+            for (std::size_t i = b0; i < b1; ++i) {
+                const pack_entry& e = entries[i];
+                if (e.same_as != i) continue;
+                packed[i] = algorithm == SNATCH_PACK_LZ ? lz_pack(raw.data() + e.raw_offset, e.raw_size, dict)
+                                                        : pack(algorithm, raw.data() + e.raw_offset, e.raw_size, 1, nullptr);
+            }
+        });
+        std::size_t total = dict.size();
+        for (const auto& p : packed) total += p.size();
+        if (best.empty() || total < best_total) {
+            best = std::move(packed);
+            best_total = total;
+            dictionary = std::move(dict);
+        }
+    }
+
+    constexpr std::size_t k_record = 10;
+    std::vector<std::uint8_t> data;
+    data.reserve(best_total + entries.size() * k_record);
+    // records carry metrics, so a glyph sharing another's rows shares its
+    // record only when the metrics match too; otherwise it gets a record of
+    // its own over the same packed rows
+    std::map<std::tuple<std::size_t, int, int, int>, std::size_t> records;
+    for (pack_entry& e : entries) {
+        const snatch_glyph_bitmap& g = *e.glyph;
+        const auto [record, added] = records.try_emplace(std::make_tuple(e.same_as, g.bearing_x, g.bearing_y, g.advance_x), data.size());
+        e.offset = record->second;
+        if (!added) continue;
+        put_u16(data, static_cast<std::uint32_t>(g.width));
+        put_u16(data, static_cast<std::uint32_t>(g.height));
+        put_u16(data, static_cast<std::uint16_t>(g.bearing_x));
+        put_u16(data, static_cast<std::uint16_t>(g.bearing_y));
+        put_u16(data, static_cast<std::uint16_t>(g.advance_x));
+        data.insert(data.end(), best[e.same_as].begin(), best[e.same_as].end());
+        e.packed_size = data.size() - e.offset;
+    }
+    return data;
+}
+
+/// \brief write_report.
+// one line per glyph: codepoint, unpacked bytes, packed bytes, packed/unpacked.
+// In font mode a glyph is charged for the packed bytes that produce its rows.
+bool write_report(const std::string& path, const std::vector<pack_entry>& entries, std::size_t raw_total, std::size_t packed_total) {
+    std::ofstream out(path, std::ios::out | std::ios::trunc);
+    if (!out.is_open()) return false;
+    out << "# codepoint unpacked packed ratio\n" << std::fixed << std::setprecision(3);
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        const pack_entry& e = entries[i];
+        out << e.glyph->codepoint << ' ' << e.raw_size << ' ' << e.packed_size << ' ';
+        if (e.same_as != i) out << "= " << entries[e.same_as].glyph->codepoint << '\n';
+        else out << (e.raw_size ? static_cast<double>(e.packed_size) / static_cast<double>(e.raw_size) : 1.0) << '\n';
+    }
+    out << "# total " << raw_total << ' ' << packed_total << ' '
+        << (raw_total ? static_cast<double>(packed_total) / static_cast<double>(raw_total) : 1.0) << '\n';
+    return out.good();
+}
+
+/// \brief write_file.
+int write_file(const char* output_path, const std::vector<std::uint8_t>& file, char* errbuf, unsigned errbuf_len) {
+    std::ofstream out(output_path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: cannot open output file");
+        return 16;
+    }
+    out.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+    if (!out.good()) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: failed while writing output");
+        return 17;
+    }
+    return 0;
+}
+
+/// \brief export_random.
+// the SNRA layout of snatch_unpack.h: one offset per codepoint of the range
+int export_random(
+    int algorithm,
+    long dictionary_size,
+    int workers,
+    std::vector<pack_entry>& entries,
+    const std::vector<std::uint8_t>& raw,
+    const char* output_path,
+    const std::string& report,
+    char* errbuf,
+    unsigned errbuf_len
+) {
+    // past the Unicode range the table would dwarf the glyphs
+    constexpr std::int64_t k_max_codepoint = 0x10FFFF;
+    std::int64_t first = entries.empty() ? 0 : k_max_codepoint;
+    std::int64_t last = 0;
+    for (const pack_entry& e : entries) {
+        if (e.glyph->codepoint < 0 || e.glyph->codepoint > k_max_codepoint) {
+            plugin_set_err(errbuf, errbuf_len, "compressed_bin: random mode needs codepoints in 0..0x10FFFF");
+            return 14;
+        }
+        first = std::min<std::int64_t>(first, e.glyph->codepoint);
+        last = std::max<std::int64_t>(last, e.glyph->codepoint);
+    }
+
+    std::vector<std::uint8_t> dictionary;
+    const std::vector<std::uint8_t> data = pack_random(algorithm, dictionary_size, workers, entries, raw, dictionary);
+    if (data.size() > 0xFFFFFFFEu) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: font too large (>4 GiB)");
+        return 14;
+    }
+    // every offset is below the data size, so 16 bits leave 0xFFFF free
+    const bool wide = data.size() > 0xFFFFu;
+    const std::uint32_t missing = wide ? 0xFFFFFFFFu : 0xFFFFu;
+    std::vector<std::uint32_t> offsets(static_cast<std::size_t>(last - first + 1), missing);
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        // the first glyph of a codepoint wins, as in raw_bin
+        std::uint32_t& slot = offsets[static_cast<std::size_t>(entries[i].glyph->codepoint - first)];
+        if (slot == missing) slot = static_cast<std::uint32_t>(entries[i].offset);
+    }
+
+    std::vector<std::uint8_t> file = {'S', 'N', 'R', 'A', 1, static_cast<std::uint8_t>(algorithm), static_cast<std::uint8_t>(wide ? 1 : 0), 0};
+    file.reserve(24 + offsets.size() * (wide ? 4 : 2) + dictionary.size() + data.size());
+    put_u32(file, static_cast<std::uint32_t>(first));
+    put_u32(file, static_cast<std::uint32_t>(last));
+    put_u32(file, static_cast<std::uint32_t>(dictionary.size()));
+    put_u32(file, static_cast<std::uint32_t>(data.size()));
+    for (const std::uint32_t offset : offsets) {
+        if (wide) put_u32(file, offset);
+        else put_u16(file, offset);
+    }
+    file.insert(file.end(), dictionary.begin(), dictionary.end());
+    file.insert(file.end(), data.begin(), data.end());
+
+    if (const int rc = write_file(output_path, file, errbuf, errbuf_len); rc != 0) return rc;
+    if (!report.empty() && !write_report(report, entries, raw.size(), file.size())) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: cannot write report");
+        return 18;
+    }
+    return 0;
+}
+
+/// \brief export_compressed_bin.
+int export_compressed_bin(
+    const snatch_font* font,
+    const char* output_path,
+    const snatch_kv* options,
+    unsigned options_count,
+    char* errbuf,
+    unsigned errbuf_len
+) {
+    const plugin_kv_view kv{options, options_count};
+
+    if (!font || !font->bitmap_font || (font->bitmap_font->glyph_count > 0 && !font->bitmap_font->glyphs)) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: bitmap font data missing");
+        return 10;
+    }
+    if (!output_path || output_path[0] == '\0') {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: output path is empty");
+        return 11;
+    }
+    const int algorithm = parse_algorithm(kv.get("algorithm").value_or("lz"));
+    if (algorithm < 0) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: algorithm must be none|rle|lz");
+        return 12;
+    }
+    const std::string_view mode_name = kv.get("mode").value_or("font");
+    if (mode_name != "font" && mode_name != "glyph" && mode_name != "random") {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: mode must be font|glyph|random");
+        return 13;
+    }
+    const bool per_glyph = mode_name == "glyph";
+    const bool random_access = mode_name == "random";
+    const long dictionary_size = parse_dictionary(kv);
+    if (dictionary_size == -1) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: dictionary must be auto or 0..32768");
+        return 19;
+    }
+
+    const snatch_bitmap_font& bf = *font->bitmap_font;
+    std::vector<pack_entry> entries(static_cast<std::size_t>(std::max(bf.glyph_count, 0)));
+    std::vector<std::uint8_t> raw;
+    std::unordered_map<bitmap_key, std::size_t, bitmap_key_hash> stored;
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        pack_entry& e = entries[i];
+        const snatch_glyph_bitmap& g = bf.glyphs[i];
+        e.glyph = &g;
+        if (g.width < 0 || g.width > 0xFFFF || g.height < 0 || g.height > 0xFFFF || g.bearing_x < INT16_MIN || g.bearing_x > INT16_MAX ||
+            g.bearing_y < INT16_MIN || g.bearing_y > INT16_MAX || g.advance_x < INT16_MIN || g.advance_x > INT16_MAX) {
+            plugin_set_err(errbuf, errbuf_len, "compressed_bin: glyph metrics do not fit 16 bits");
+            return 14;
+        }
+        // glyphs sharing one bitmap (see dedup_transform) are stored once
+        e.same_as = i;
+        if (g.data) {
+            const auto [first, added] = stored.try_emplace(bitmap_key{g.data, g.width, g.height, g.stride_bytes}, i);
+            e.same_as = first->second;
+            if (!added) continue;
+        }
+        e.raw_offset = raw.size();
+        append_rows(g, raw);
+        e.raw_size = raw.size() - e.raw_offset;
+    }
+    if (raw.size() > 0xFFFFFFFFu) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: font too large (>4 GiB)");
+        return 14;
+    }
+
+    const int workers = parse_threads(kv, raw.size());
+    if (workers < 0) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: threads must be 0..256");
+        return 15;
+    }
+    const std::string report = std::string(kv.get("report").value_or(""));
+
+    if (random_access) {
+        return export_random(algorithm, dictionary_size, workers, entries, raw, output_path, report, errbuf, errbuf_len);
+    }
+
+    std::vector<std::uint8_t> payload;
+    if (per_glyph) {
+        // glyphs are independent streams, packed side by side
+        std::vector<std::vector<std::uint8_t>> packed(entries.size());
+        run_bands(workers, entries.size(), [&](std::size_t b0, std::size_t b1) {
+            for (std::size_t i = b0; i < b1; ++i) {
+                const pack_entry& e = entries[i];
+                if (e.same_as == i) packed[i] = pack(algorithm, raw.data() + e.raw_offset, e.raw_size, 1, nullptr);
+            }
+        });
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            pack_entry& e = entries[i];
+            if (e.same_as != i) continue;
+            e.offset = payload.size();
+            e.packed_size = packed[i].size();
+            payload.insert(payload.end(), packed[i].begin(), packed[i].end());
+        }
+    } else {
+        std::vector<std::uint32_t> cost;
+        payload = pack(algorithm, raw.data(), raw.size(), static_cast<unsigned>(workers), report.empty() ? nullptr : &cost);
+        for (std::size_t i = 0; i < entries.size(); ++i) {
+            pack_entry& e = entries[i];
+            if (e.same_as != i) continue;
+            e.offset = e.raw_offset;
+            for (std::size_t k = 0; k < e.raw_size && !cost.empty(); ++k) e.packed_size += cost[e.raw_offset + k];
+        }
+    }
+    for (std::size_t i = 0; i < entries.size(); ++i) {
+        if (entries[i].same_as != i) entries[i].offset = entries[entries[i].same_as].offset;
+    }
+    if (payload.size() > 0xFFFFFFFFu) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: font too large (>4 GiB)");
+        return 14;
+    }
+
+    std::vector<std::uint8_t> file = {'S', 'N', 'P', 'K', 1, static_cast<std::uint8_t>(algorithm),
+                                      static_cast<std::uint8_t>(per_glyph ? SNATCH_PACK_MODE_GLYPH : SNATCH_PACK_MODE_FONT), 0};
+    file.reserve(20 + entries.size() * 20 + payload.size());
+    put_u32(file, static_cast<std::uint32_t>(entries.size()));
+    put_u32(file, static_cast<std::uint32_t>(raw.size()));
+    put_u32(file, static_cast<std::uint32_t>(payload.size()));
+    for (const pack_entry& e : entries) {
+        const snatch_glyph_bitmap& g = *e.glyph;
+        put_u32(file, static_cast<std::uint32_t>(g.codepoint));
+        put_u32(file, static_cast<std::uint32_t>(e.offset));
+        put_u16(file, static_cast<std::uint32_t>(g.width));
+        put_u16(file, static_cast<std::uint32_t>(g.height));
+        put_u16(file, static_cast<std::uint16_t>(g.bearing_x));
+        put_u16(file, static_cast<std::uint16_t>(g.bearing_y));
+        put_u16(file, static_cast<std::uint16_t>(g.advance_x));
+        put_u16(file, 0);
+    }
+    file.insert(file.end(), payload.begin(), payload.end());
+
+    if (const int rc = write_file(output_path, file, errbuf, errbuf_len); rc != 0) return rc;
+
+    if (!report.empty() && !write_report(report, entries, raw.size(), payload.size())) {
+        plugin_set_err(errbuf, errbuf_len, "compressed_bin: cannot write report");
+        return 18;
+    }
+    return 0;
+}
+
+const snatch_plugin_info k_info = {
+    "compressed_bin",
+    "Packs bitmap glyph rows with RLE or LZ for small decoders, whole font, per glyph or random access",
+    "snatch project",
+    "bin",
+    "snatch-pack",
+    SNATCH_PLUGIN_ABI_VERSION,
+    SNATCH_PLUGIN_KIND_EXPORTER,
+    nullptr,
+    &export_compressed_bin,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_BITMAP,
+    0,
+    SNATCH_CAP_THREAD_SAFE
+};
+
+} // namespace
+
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
+    if (!out) return 1;
+    *out = &k_info;
+    return 0;
+}
@@ -0,0 +1,221 @@
+/// \file
+/// \brief Reference decoder for compressed_bin output.
+///
+/// This source file implements the C decoder shipped with the compressed_bin exporter. Host tests round-trip every algorithm through it, and it is small enough to port to an 8-bit target as is.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch_unpack.h"
+
+#define SNATCH_PACK_HEADER 20u
+#define SNATCH_PACK_ENTRY 20u
+#define SNATCH_PACK_RA_HEADER 24u
+#define SNATCH_PACK_RA_RECORD 10u
+
+/// \brief get_u16.
+static uint16_t get_u16(const unsigned char *p) {
+    return (uint16_t)(p[0] | (uint16_t)p[1] << 8);
+}
+
+/// \brief get_u32.
+static uint32_t get_u32(const unsigned char *p) {
+    return (uint32_t)get_u16(p) | (uint32_t)get_u16(p + 2) << 16;
+}
+
+/// \brief get_count.
+// a nibble of 15 continues in bytes added while they are 255
+static int get_count(const unsigned char **src, const unsigned char *end, size_t *n) {
+    unsigned char b;
+    if (*n != 15) return 0;
+    do {
+        if (*src == end) return -1;
+        b = *(*src)++;
+        *n += b;
+    } while (b == 255);
+    return 0;
+}
+
+/// \brief snatch_unrle.
+long snatch_unrle(const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_size) {
+    const unsigned char *end = src + src_size;
+    unsigned char *out = dst;
+    unsigned char *out_end = dst + dst_size;
+    while (out != out_end) {
+        size_t n;
+        unsigned char c;
+        if (src == end) return -1;
+        c = *src++;
+        if (c < 128) {
+            n = (size_t)c + 1;
+            if ((size_t)(end - src) < n || (size_t)(out_end - out) < n) return -1;
+            while (n--) *out++ = *src++;
+        } else {
+            n = (size_t)c - 125;
+            if (src == end || (size_t)(out_end - out) < n) return -1;
+            c = *src++;
+            while (n--) *out++ = c;
+        }
+    }
+    return (long)(out - dst);
+}
+
+/// \brief snatch_unlz.
+long snatch_unlz(const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_size) {
+    return snatch_unlz_dict(0, 0, src, src_size, dst, dst_size);
+}
+
+/// \brief snatch_unlz_dict.
+long snatch_unlz_dict(const unsigned char *dict, size_t dict_size, const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_size) {
+    const unsigned char *end = src + src_size;
+    unsigned char *out = dst;
+    unsigned char *out_end = dst + dst_size;
+    while (out != out_end) {
+        size_t literals, length, offset, done;
+        unsigned char token;
+        if (src == end) return -1;
+        token = *src++;
+
+        literals = token >> 4;
+        if (get_count(&src, end, &literals) != 0) return -1;
+        if ((size_t)(end - src) < literals || (size_t)(out_end - out) < literals) return -1;
+        while (literals--) *out++ = *src++;
+        if (out == out_end) break;
+
+        if (end - src < 2) return -1;
+        offset = get_u16(src);
+        src += 2;
+        length = token & 15u;
+        if (get_count(&src, end, &length) != 0) return -1;
+        length += 3;
+        done = (size_t)(out - dst);
+        if (offset == 0 || offset > done + dict_size || (size_t)(out_end - out) < length) return -1;
+        // the part before the output comes from the end of the dictionary
+        for (; offset > done && length > 0; --length, ++done) *out++ = dict[dict_size - (offset - done)];
+        // byte by byte: a match may overlap the bytes it is writing
+        for (; length > 0; --length) {
+            *out = *(out - offset);
+            ++out;
+        }
+    }
+    return (long)(out - dst);
+}
+
+/// \brief snatch_pack_open.
+int snatch_pack_open(snatch_pack *pack, const unsigned char *file, size_t size) {
+    if (!pack || !file || size < SNATCH_PACK_HEADER) return -1;
+    if (file[0] != 'S' || file[1] != 'N' || file[2] != 'P' || file[3] != 'K' || file[4] != 1) return -1;
+    pack->algorithm = file[5];
+    pack->mode = file[6];
+    pack->glyph_count = get_u32(file + 8);
+    pack->unpacked_size = get_u32(file + 12);
+    pack->payload_size = get_u32(file + 16);
+    if (pack->algorithm > SNATCH_PACK_LZ || pack->mode > SNATCH_PACK_MODE_GLYPH) return -1;
+    if (pack->glyph_count > (size - SNATCH_PACK_HEADER) / SNATCH_PACK_ENTRY) return -1;
+    if (pack->payload_size > size - SNATCH_PACK_HEADER - pack->glyph_count * SNATCH_PACK_ENTRY) return -1;
+    pack->table = file + SNATCH_PACK_HEADER;
+    pack->payload = pack->table + pack->glyph_count * SNATCH_PACK_ENTRY;
+    return 0;
+}
+
+/// \brief snatch_pack_glyph_at.
+int snatch_pack_glyph_at(const snatch_pack *pack, uint32_t index, snatch_pack_glyph *glyph) {
+    const unsigned char *e;
+    if (!pack || !glyph || index >= pack->glyph_count) return -1;
+    e = pack->table + index * SNATCH_PACK_ENTRY;
+    glyph->codepoint = get_u32(e);
+    glyph->offset = get_u32(e + 4);
+    glyph->width = get_u16(e + 8);
+    glyph->height = get_u16(e + 10);
+    glyph->bearing_x = (int16_t)get_u16(e + 12);
+    glyph->bearing_y = (int16_t)get_u16(e + 14);
+    glyph->advance_x = (int16_t)get_u16(e + 16);
+    return 0;
+}
+
+/// \brief unpack.
+static long unpack(unsigned char algorithm, const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_size) {
+    size_t i;
+    switch (algorithm) {
+    case SNATCH_PACK_RLE: return snatch_unrle(src, src_size, dst, dst_size);
+    case SNATCH_PACK_LZ: return snatch_unlz(src, src_size, dst, dst_size);
+    default:
+        if (src_size < dst_size) return -1;
+        for (i = 0; i < dst_size; ++i) dst[i] = src[i];
+        return (long)dst_size;
+    }
+}
+
+/// \brief unpack_dict.
+static long unpack_dict(const snatch_pack_ra *ra, const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_size) {
+    if (ra->algorithm == SNATCH_PACK_LZ) return snatch_unlz_dict(ra->dictionary, ra->dictionary_size, src, src_size, dst, dst_size);
+    return unpack(ra->algorithm, src, src_size, dst, dst_size);
+}
+
+/// \brief snatch_pack_unpack_font.
+long snatch_pack_unpack_font(const snatch_pack *pack, unsigned char *dst, size_t dst_size) {
+    if (!pack || pack->mode != SNATCH_PACK_MODE_FONT || dst_size < pack->unpacked_size) return -1;
+    return unpack(pack->algorithm, pack->payload, pack->payload_size, dst, pack->unpacked_size);
+}
+
+/// \brief snatch_pack_unpack_glyph.
+long snatch_pack_unpack_glyph(const snatch_pack *pack, uint32_t index, unsigned char *dst, size_t dst_size) {
+    snatch_pack_glyph g;
+    size_t rows;
+    if (!pack || pack->mode != SNATCH_PACK_MODE_GLYPH || snatch_pack_glyph_at(pack, index, &g) != 0) return -1;
+    rows = (size_t)((g.width + 7u) / 8u) * g.height;
+    if (dst_size < rows || g.offset > pack->payload_size) return -1;
+    return unpack(pack->algorithm, pack->payload + g.offset, pack->payload_size - g.offset, dst, rows);
+}
+
+/// \brief snatch_ra_open.
+int snatch_ra_open(snatch_pack_ra *ra, const unsigned char *file, size_t size) {
+    uint32_t count;
+    size_t table;
+    if (!ra || !file || size < SNATCH_PACK_RA_HEADER) return -1;
+    if (file[0] != 'S' || file[1] != 'N' || file[2] != 'R' || file[3] != 'A' || file[4] != 1) return -1;
+    ra->algorithm = file[5];
+    ra->wide_offsets = (unsigned char)(file[6] & 1u);
+    ra->first = get_u32(file + 8);
+    ra->last = get_u32(file + 12);
+    ra->dictionary_size = get_u32(file + 16);
+    ra->data_size = get_u32(file + 20);
+    if (ra->algorithm > SNATCH_PACK_LZ || ra->last < ra->first) return -1;
+    count = ra->last - ra->first + 1u;
+    if (count > (size - SNATCH_PACK_RA_HEADER) / (ra->wide_offsets ? 4u : 2u)) return -1;
+    table = (size_t)count * (ra->wide_offsets ? 4u : 2u);
+    if (ra->dictionary_size > size - SNATCH_PACK_RA_HEADER - table) return -1;
+    if (ra->data_size > size - SNATCH_PACK_RA_HEADER - table - ra->dictionary_size) return -1;
+    ra->offsets = file + SNATCH_PACK_RA_HEADER;
+    ra->dictionary = ra->offsets + table;
+    ra->data = ra->dictionary + ra->dictionary_size;
+    return 0;
+}
+
+/// \brief snatch_ra_glyph.
+long snatch_ra_glyph(const snatch_pack_ra *ra, uint32_t codepoint, snatch_pack_glyph *glyph, unsigned char *dst, size_t dst_size) {
+    const unsigned char *record;
+    uint32_t offset;
+    size_t rows;
+    if (!ra || !glyph || codepoint < ra->first || codepoint > ra->last) return -1;
+    if (ra->wide_offsets) {
+        offset = get_u32(ra->offsets + (size_t)(codepoint - ra->first) * 4u);
+    } else {
+        offset = get_u16(ra->offsets + (size_t)(codepoint - ra->first) * 2u);
+        if (offset == 0xFFFFu) offset = 0xFFFFFFFFu;
+    }
+    if (offset == 0xFFFFFFFFu || offset > ra->data_size || ra->data_size - offset < SNATCH_PACK_RA_RECORD) return -1;
+
+    record = ra->data + offset;
+    glyph->codepoint = codepoint;
+    glyph->offset = offset;
+    glyph->width = get_u16(record);
+    glyph->height = get_u16(record + 2);
+    glyph->bearing_x = (int16_t)get_u16(record + 4);
+    glyph->bearing_y = (int16_t)get_u16(record + 6);
+    glyph->advance_x = (int16_t)get_u16(record + 8);
+    rows = (size_t)((glyph->width + 7u) / 8u) * glyph->height;
+    if (dst_size < rows) return -1;
+    offset += SNATCH_PACK_RA_RECORD;
+    return unpack_dict(ra, ra->data + offset, ra->data_size - offset, dst, rows);
+}
@@ -0,0 +1,124 @@
+/// \file
+/// \brief Reference decoder for compressed_bin output.
+///
+/// This header declares the C decoder shipped with the compressed_bin exporter. It needs no allocation and no tables, so the same source builds for host tools and for 8-bit targets.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#ifndef SNATCH_UNPACK_H
+#define SNATCH_UNPACK_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SNATCH_PACK_NONE 0
+#define SNATCH_PACK_RLE 1
+#define SNATCH_PACK_LZ 2
+
+#define SNATCH_PACK_MODE_FONT 0
+#define SNATCH_PACK_MODE_GLYPH 1
+
+// A compressed_bin file, little-endian:
+//
+//   0  "SNPK"
+//   4  u8  version (1)
+//   5  u8  algorithm (SNATCH_PACK_*)
+//   6  u8  mode (SNATCH_PACK_MODE_*)
+//   7  u8  0
+//   8  u32 glyph count
+//  12  u32 unpacked size
+//  16  u32 payload size
+//  20  glyph count entries of 20 bytes:
+//        u32 codepoint, u32 offset, u16 width, u16 height,
+//        i16 bearing_x, i16 bearing_y, i16 advance_x, u16 0
+//      then the payload.
+//
+// A glyph is `height` rows of (width + 7) / 8 bytes, MSB first. In font mode
+// the payload unpacks to all glyphs at once and `offset` is where a glyph
+// starts in the unpacked rows; in glyph mode every glyph is packed on its
+// own and `offset` is where its stream starts in the payload. Glyphs with
+// the same pixels may share an offset.
+typedef struct snatch_pack {
+    const unsigned char *table;
+    const unsigned char *payload;
+    uint32_t glyph_count;
+    uint32_t unpacked_size;
+    uint32_t payload_size;
+    unsigned char algorithm;
+    unsigned char mode;
+} snatch_pack;
+
+typedef struct snatch_pack_glyph {
+    uint32_t codepoint;
+    uint32_t offset;
+    uint16_t width;
+    uint16_t height;
+    int16_t bearing_x;
+    int16_t bearing_y;
+    int16_t advance_x;
+} snatch_pack_glyph;
+
+// A random-access file (mode=random), little-endian, where any glyph is
+// found through one table read and unpacked on its own:
+//
+//   0  "SNRA"
+//   4  u8  version (1)
+//   5  u8  algorithm (SNATCH_PACK_*)
+//   6  u8  flags: bit 0 set when offsets are u32, else u16
+//   7  u8  0
+//   8  u32 first codepoint
+//  12  u32 last codepoint
+//  16  u32 dictionary size
+//  20  u32 glyph data size
+//  24  one offset into the glyph data per codepoint first..last, all bits
+//      set where the font has no glyph
+//      then the dictionary, then the glyph data.
+//
+// A glyph record is u16 width, u16 height, i16 bearing_x, i16 bearing_y,
+// i16 advance_x and its packed rows. LZ matches may reach back past the
+// start of a glyph into the dictionary.
+typedef struct snatch_pack_ra {
+    const unsigned char *offsets;
+    const unsigned char *dictionary;
+    const unsigned char *data;
+    uint32_t first;
+    uint32_t last;
+    uint32_t dictionary_size;
+    uint32_t data_size;
+    unsigned char algorithm;
+    unsigned char wide_offsets;
+} snatch_pack_ra;
+
+// Each returns the bytes written to dst, or -1 when src is malformed or
+// would write past dst_size. Decoding stops once dst_size bytes are out.
+long snatch_unrle(const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_size);
+long snatch_unlz(const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_size);
+long snatch_unlz_dict(const unsigned char *dict, size_t dict_size, const unsigned char *src, size_t src_size, unsigned char *dst, size_t dst_size);
+
+// 0 on success, -1 when `file` is not a complete compressed_bin image.
+int snatch_pack_open(snatch_pack *pack, const unsigned char *file, size_t size);
+int snatch_pack_glyph_at(const snatch_pack *pack, uint32_t index, snatch_pack_glyph *glyph);
+
+// Font mode: all glyph rows; glyph mode: one glyph's rows. Both return the
+// bytes written or -1.
+long snatch_pack_unpack_font(const snatch_pack *pack, unsigned char *dst, size_t dst_size);
+long snatch_pack_unpack_glyph(const snatch_pack *pack, uint32_t index, unsigned char *dst, size_t dst_size);
+
+// 0 on success, -1 when `file` is not a complete random-access image.
+int snatch_ra_open(snatch_pack_ra *ra, const unsigned char *file, size_t size);
+
+// The rows of `codepoint` into dst and its metrics into `glyph` (whose
+// offset is the record's). Bytes written, or -1 when the font has no such
+// glyph or it does not fit.
+long snatch_ra_glyph(const snatch_pack_ra *ra, uint32_t codepoint, snatch_pack_glyph *glyph, unsigned char *dst, size_t dst_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SNATCH_UNPACK_H
@@ -0,0 +1,127 @@
+/// \file
+/// \brief Glyph deduplication transformer plugin implementation.
+///
+/// This source file implements one part of the snatch pipeline architecture. It contributes to extracting, transforming, exporting, or orchestrating bitmap data in a plugin-driven workflow.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include "snatch/glyph_cache.h"
+#include "snatch/plugin.h"
+#include "snatch/plugin_util.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+struct dedup_owner {
+    snatch_bitmap_font font{};
+    std::vector<snatch_glyph_bitmap> glyphs;
+    // every unique bitmap once, rows at the stride they came with
+    std::vector<std::uint8_t> pixels;
+};
+
+static dedup_owner g_owner;
+
+/// \brief has_pixels.
+bool has_pixels(const snatch_glyph_bitmap& g) {
+    return g.data && g.width > 0 && g.height > 0 && g.stride_bytes >= (g.width + 7) / 8;
+}
+
+/// \brief same_pixels.
+// the stored rows byte for byte, padding included: exporters write
+// stride_bytes per row, so sharing rows must not change what they write
+bool same_pixels(const snatch_glyph_bitmap& a, const snatch_glyph_bitmap& b) {
+    if (a.width != b.width || a.height != b.height || a.stride_bytes != b.stride_bytes) return false;
+    const std::size_t size = static_cast<std::size_t>(a.height) * static_cast<std::size_t>(a.stride_bytes);
+    return std::equal(a.data, a.data + size, b.data);
+}
+
+/// \brief dedup_transform.
+int dedup_transform(
+    snatch_font* font,
+    const snatch_kv* options,
+    unsigned options_count,
+    char* errbuf,
+    unsigned errbuf_len
+) {
+    (void)options;
+    (void)options_count;
+    if (!font || !font->bitmap_font || (font->bitmap_font->glyph_count > 0 && !font->bitmap_font->glyphs)) {
+        plugin_set_err(errbuf, errbuf_len, "dedup_transform: bitmap font data missing");
+        return 30;
+    }
+
+    const snatch_bitmap_font& bf = *font->bitmap_font;
+    const std::size_t count = bf.glyph_count > 0 ? static_cast<std::size_t>(bf.glyph_count) : 0u;
+
+    g_owner = {};
+    g_owner.glyphs.assign(bf.glyphs, bf.glyphs + count);
+
+    // pixel hash -> glyphs already kept under it; a hit is compared in full
+    // so a collision only costs a comparison, never a wrong glyph
+    std::unordered_map<std::uint64_t, std::vector<std::size_t>> kept;
+    kept.reserve(count);
+    std::vector<std::size_t> canonical(count);
+    std::vector<std::size_t> offset(count, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        canonical[i] = i;
+        const snatch_glyph_bitmap& g = bf.glyphs[i];
+        if (!has_pixels(g)) continue;
+
+        auto& bucket = kept[glyph_pixels_hash(g)];
+        for (const std::size_t k : bucket) {
+            if (same_pixels(bf.glyphs[k], g)) {
+                canonical[i] = k;
+                break;
+            }
+        }
+        if (canonical[i] != i) continue;
+        bucket.push_back(i);
+
+        offset[i] = g_owner.pixels.size();
+        g_owner.pixels.insert(g_owner.pixels.end(), g.data, g.data + static_cast<std::size_t>(g.height) * static_cast<std::size_t>(g.stride_bytes));
+    }
+
+    // pointers only once the storage has stopped growing
+    for (std::size_t i = 0; i < count; ++i) {
+        snatch_glyph_bitmap& g = g_owner.glyphs[i];
+        if (!has_pixels(g)) continue;
+        g.data = g_owner.pixels.data() + offset[canonical[i]];
+    }
+
+    g_owner.font.glyph_count = static_cast<int>(count);
+    g_owner.font.glyphs = g_owner.glyphs.empty() ? nullptr : g_owner.glyphs.data();
+    font->bitmap_font = &g_owner.font;
+    return 0;
+}
+
+const snatch_plugin_info k_info = {
+    "dedup_transform",
+    "Shares one bitmap between glyphs with identical pixels so exporters emit each once",
+    "snatch project",
+    "bitmap",
+    "dedup",
+    SNATCH_PLUGIN_ABI_VERSION,
+    SNATCH_PLUGIN_KIND_TRANSFORMER,
+    &dedup_transform,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_BITMAP,
+    SNATCH_PAYLOAD_BITMAP,
+    0
+};
+
+} // namespace
+
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
+    if (!out) return 1;
+    *out = &k_info;
+    return 0;
+}
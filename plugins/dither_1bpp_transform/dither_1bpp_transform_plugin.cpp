@@ -11,7 +11,14 @@
 #include "snatch_plugins/image_passthrough_data.h"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
 #include <cstdint>
+#include <limits>
+#include <random>
+#include <string_view>
+#include <thread>
 #include <vector>
 
 namespace {
@@ -37,10 +44,315 @@ int parse_threshold(const plugin_kv_view& kv, char* errbuf, unsigned errbuf_len)
     return 128;
 }
 
-/// \brief add_error.
-void add_error(std::vector<float>& buf, int w, int h, int x, int y, float value) {
-    if (x < 0 || x >= w || y < 0 || y >= h) return;
-    buf[static_cast<std::size_t>(y * w + x)] += value;
+enum class dither_mode { floyd_steinberg, atkinson, sierra_lite, bayer, blue_noise };
+
+/// \brief parse_mode.
+bool parse_mode(const plugin_kv_view& kv, dither_mode& mode) {
+    const std::string_view raw = kv.get("mode").value_or("floyd-steinberg");
+    if (raw == "floyd-steinberg" || raw.empty()) mode = dither_mode::floyd_steinberg;
+    else if (raw == "atkinson") mode = dither_mode::atkinson;
+    else if (raw == "sierra-lite") mode = dither_mode::sierra_lite;
+    else if (raw == "bayer") mode = dither_mode::bayer;
+    else if (raw == "blue-noise") mode = dither_mode::blue_noise;
+    else return false;
+    return true;
+}
+
+struct diffusion_tap {
+    int dx;
+    int dy;
+    int weight;
+};
+
+// weights are over 2^shift; Atkinson drops 2/8 of the error on purpose
+struct floyd_steinberg_kernel {
+    static constexpr int shift = 4;
+    static constexpr std::array<diffusion_tap, 4> taps{{{1, 0, 7}, {-1, 1, 3}, {0, 1, 5}, {1, 1, 1}}};
+};
+struct atkinson_kernel {
+    static constexpr int shift = 3;
+    static constexpr std::array<diffusion_tap, 6> taps{{{1, 0, 1}, {2, 0, 1}, {-1, 1, 1}, {0, 1, 1}, {1, 1, 1}, {0, 2, 1}}};
+};
+struct sierra_lite_kernel {
+    static constexpr int shift = 2;
+    static constexpr std::array<diffusion_tap, 3> taps{{{1, 0, 2}, {-1, 1, 1}, {0, 1, 1}}};
+};
+
+constexpr int k_pad = 2; // columns either side of a row buffer, taps reach at most 2 away
+constexpr int k_rows = 3; // rows a kernel reaches, including the current one
+
+/// \brief set_ink.
+inline void set_ink(std::uint8_t* row, int x) {
+    row[x >> 3] = static_cast<std::uint8_t>(row[x >> 3] | (0x80u >> (x & 7)));
+}
+
+/// \brief diffuse_span.
+// Error is kept in integer numerators over 2^shift, in rolling rows padded so
+// the per-pixel loop needs no bounds checks; whatever falls into the padding
+// is dropped, as at the image edges.
+template <typename Kernel>
+void diffuse_span(const std::uint8_t* in, int threshold, std::int32_t* const* rows, std::uint8_t* ink, int x0, int x1) {
+    constexpr std::int32_t half = (1 << Kernel::shift) >> 1;
+    for (int x = x0; x < x1; ++x) {
+        const std::int32_t v = in[x] + ((rows[0][x] + half) >> Kernel::shift);
+        const std::int32_t e = v >= threshold ? v - 255 : v;
+        if (v < threshold) set_ink(ink, x);
+        for (const auto& t : Kernel::taps) rows[t.dy][x + t.dx] += e * t.weight;
+    }
+}
+
+/// \brief diffuse_row.
+// one row of the serial path; `err` holds k_rows padded rows, rolled by y
+template <typename Kernel>
+void diffuse_row(const std::uint8_t* in, int w, int y, int threshold, std::vector<std::int32_t>& err, std::uint8_t* ink) {
+    const std::size_t row_len = static_cast<std::size_t>(w + 2 * k_pad);
+    std::int32_t* rows[k_rows];
+    for (int r = 0; r < k_rows; ++r) rows[r] = err.data() + row_len * static_cast<std::size_t>((y + r) % k_rows) + k_pad;
+    diffuse_span<Kernel>(in, threshold, rows, ink, 0, w);
+    // this row becomes the one two below; start it clean
+    std::fill(rows[0] - k_pad, rows[0] - k_pad + row_len, 0);
+}
+
+/// \brief diffuse.
+template <typename Kernel>
+void diffuse(const snatch_image_passthrough_data& src, int threshold, std::uint8_t* out, int out_stride) {
+    const int w = src.width;
+    std::vector<std::int32_t> err(static_cast<std::size_t>(w + 2 * k_pad) * k_rows, 0);
+    for (int y = 0; y < src.height; ++y) {
+        diffuse_row<Kernel>(src.pixels + static_cast<std::size_t>(y) * src.stride, w, y, threshold, err,
+                            out + static_cast<std::size_t>(y) * static_cast<std::size_t>(out_stride));
+    }
+}
+
+constexpr int k_span = 64; // pixels between progress updates in a wavefront
+// A row stays this many pixels behind the one above: far enough that the
+// columns the two touch (x - 1 .. x + 2) never overlap and that everything
+// diffused into a pixel has landed before it is read.
+constexpr int k_lag = k_pad + 2;
+constexpr int k_row_done = std::numeric_limits<int>::max();
+
+/// \brief diffuse_wavefront.
+// Rows are dealt round-robin to the workers, each trailing the row above by
+// k_lag pixels. The error sums are the serial ones added in another order,
+// and integer addition does not care, so the output is bit-identical.
+template <typename Kernel>
+void diffuse_wavefront(const snatch_image_passthrough_data& src, int threshold, std::uint8_t* out, int out_stride, int workers) {
+    const int w = src.width;
+    const int h = src.height;
+    const std::size_t row_len = static_cast<std::size_t>(w + 2 * k_pad);
+    // rows in flight plus the two below the last of them; a buffer is reused
+    // only once the row owning it is done and cleared
+    const int ring = workers + k_rows - 1;
+    std::vector<std::int32_t> err(row_len * static_cast<std::size_t>(ring), 0);
+    std::vector<std::atomic<int>> progress(static_cast<std::size_t>(h));
+    for (auto& p : progress) p.store(0, std::memory_order_relaxed);
+
+    const auto run = [&](int first) {
+        for (int y = first; y < h; y += workers) {
+            std::int32_t* rows[k_rows];
+            for (int r = 0; r < k_rows; ++r) rows[r] = err.data() + row_len * static_cast<std::size_t>((y + r) % ring) + k_pad;
+            const std::uint8_t* in = src.pixels + static_cast<std::size_t>(y) * src.stride;
+            std::uint8_t* ink = out + static_cast<std::size_t>(y) * static_cast<std::size_t>(out_stride);
+            auto& done = progress[static_cast<std::size_t>(y)];
+            for (int x0 = 0; x0 < w; x0 += k_span) {
+                const int x1 = std::min(w, x0 + k_span);
+                if (y > 0) {
+                    const int need = x1 == w ? k_row_done : x1 + k_lag;
+                    const auto& above = progress[static_cast<std::size_t>(y - 1)];
+                    while (above.load(std::memory_order_acquire) < need) std::this_thread::yield();
+                }
+                diffuse_span<Kernel>(in, threshold, rows, ink, x0, x1);
+                if (x1 < w) done.store(x1, std::memory_order_release);
+            }
+            std::fill(rows[0] - k_pad, rows[0] - k_pad + row_len, 0);
+            done.store(k_row_done, std::memory_order_release);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < workers; ++t) threads.emplace_back(run, t);
+    run(0);
+    for (auto& t : threads) t.join();
+}
+
+/// \brief diffuse_with.
+template <typename Kernel>
+void diffuse_with(const snatch_image_passthrough_data& src, int threshold, std::uint8_t* out, int out_stride, int workers) {
+    workers = std::min(workers, static_cast<int>(src.height));
+    if (workers <= 1) diffuse<Kernel>(src, threshold, out, out_stride);
+    else diffuse_wavefront<Kernel>(src, threshold, out, out_stride, workers);
+}
+
+constexpr int k_bayer_size = 8;
+constexpr int k_noise_size = 32;
+
+/// \brief bayer_matrix.
+const std::array<std::uint8_t, k_bayer_size * k_bayer_size>& bayer_matrix() {
+    static const auto m = [] {
+        std::array<std::uint8_t, k_bayer_size * k_bayer_size> out{};
+        for (int y = 0; y < k_bayer_size; ++y) {
+            for (int x = 0; x < k_bayer_size; ++x) {
+                // interleave the bits of x ^ y and y, lowest bits most significant
+                int rank = 0;
+                for (int bit = 0; bit < 3; ++bit) {
+                    rank = (rank << 2) | ((((x ^ y) >> bit) & 1) << 1) | ((y >> bit) & 1);
+                }
+                out[static_cast<std::size_t>(y * k_bayer_size + x)] = static_cast<std::uint8_t>(rank * 4 + 2);
+            }
+        }
+        return out;
+    }();
+    return m;
+}
+
+/// \brief blue_noise_matrix.
+// void-and-cluster (Ulichney) on a torus, built once; ranks scaled to 0..255
+const std::array<std::uint8_t, k_noise_size * k_noise_size>& blue_noise_matrix() {
+    static const auto m = [] {
+        constexpr int n = k_noise_size;
+        constexpr int cells = n * n;
+        std::array<float, cells> gauss{};
+        for (int dy = 0; dy < n; ++dy) {
+            for (int dx = 0; dx < n; ++dx) {
+                const int wx = std::min(dx, n - dx);
+                const int wy = std::min(dy, n - dy);
+                gauss[static_cast<std::size_t>(dy * n + dx)] = std::exp(-static_cast<float>(wx * wx + wy * wy) / (2.0f * 1.5f * 1.5f));
+            }
+        }
+        std::vector<char> on(cells, 0);
+        std::vector<float> energy(cells, 0.0f);
+        const auto toggle = [&](int c, bool set) {
+            on[static_cast<std::size_t>(c)] = set ? 1 : 0;
+            const int cx = c % n;
+            const int cy = c / n;
+            const float sign = set ? 1.0f : -1.0f;
+            for (int y = 0; y < n; ++y) {
+                for (int x = 0; x < n; ++x) {
+                    const int dx = (x - cx + n) % n;
+                    const int dy = (y - cy + n) % n;
+                    energy[static_cast<std::size_t>(y * n + x)] += sign * gauss[static_cast<std::size_t>(dy * n + dx)];
+                }
+            }
+        };
+        const auto extreme = [&](bool ones, bool highest) {
+            int best = -1;
+            for (int c = 0; c < cells; ++c) {
+                if ((on[static_cast<std::size_t>(c)] != 0) != ones) continue;
+                if (best < 0 || (highest ? energy[static_cast<std::size_t>(c)] > energy[static_cast<std::size_t>(best)]
+                                         : energy[static_cast<std::size_t>(c)] < energy[static_cast<std::size_t>(best)])) {
+                    best = c;
+                }
+            }
+            return best;
+        };
+
+        // initial pattern: a tenth of the cells, spread until stable
+        std::mt19937 rng(1);
+        const int initial = cells / 10;
+        for (int placed = 0; placed < initial;) {
+            const int c = static_cast<int>(rng() % cells);
+            if (on[static_cast<std::size_t>(c)] == 0) {
+                toggle(c, true);
+                ++placed;
+            }
+        }
+        for (int guard = 0; guard < cells; ++guard) {
+            const int cluster = extreme(true, true);
+            toggle(cluster, false);
+            const int sparsest = extreme(false, false);
+            toggle(sparsest, true);
+            if (sparsest == cluster) break;
+        }
+
+        std::vector<int> rank(cells, 0);
+        const std::vector<char> prototype = on;
+        const std::vector<float> prototype_energy = energy;
+        for (int r = initial - 1; r >= 0; --r) {
+            const int cluster = extreme(true, true);
+            toggle(cluster, false);
+            rank[static_cast<std::size_t>(cluster)] = r;
+        }
+        on = prototype;
+        energy = prototype_energy;
+        for (int r = initial; r < cells; ++r) {
+            const int sparsest = extreme(false, false);
+            toggle(sparsest, true);
+            rank[static_cast<std::size_t>(sparsest)] = r;
+        }
+
+        std::array<std::uint8_t, cells> out{};
+        for (int c = 0; c < cells; ++c) {
+            out[static_cast<std::size_t>(c)] = static_cast<std::uint8_t>((rank[static_cast<std::size_t>(c)] * 256 + 128) / cells);
+        }
+        return out;
+    }();
+    return m;
+}
+
+/// \brief ordered_row.
+// each pixel is compared with a tiled threshold map, so rows are independent;
+// `limits` is scratch space for one row
+template <int Size>
+void ordered_row(const std::uint8_t* in, int w, int y, const std::uint8_t* map, int bias, std::uint8_t* ink, std::uint8_t* limits) {
+    const std::uint8_t* tile_row = map + (y % Size) * Size;
+    for (int x = 0; x < w; ++x) limits[x] = static_cast<std::uint8_t>(std::clamp(tile_row[x % Size] + bias, 0, 255));
+    int x = 0;
+    for (; x + 8 <= w; x += 8) {
+        unsigned byte = 0;
+        for (int b = 0; b < 8; ++b) byte |= static_cast<unsigned>(in[x + b] <= limits[x + b]) << (7 - b);
+        ink[x >> 3] = static_cast<std::uint8_t>(byte);
+    }
+    for (; x < w; ++x) {
+        if (in[x] <= limits[x]) set_ink(ink, x);
+    }
+}
+
+/// \brief ordered_rows.
+template <int Size>
+void ordered_rows(const snatch_image_passthrough_data& src, const std::uint8_t* map, int bias, std::uint8_t* out, int out_stride,
+                  int y0, int y1) {
+    std::vector<std::uint8_t> limits(static_cast<std::size_t>(src.width));
+    for (int y = y0; y < y1; ++y) {
+        ordered_row<Size>(src.pixels + static_cast<std::size_t>(y) * src.stride, src.width, y, map, bias,
+                          out + static_cast<std::size_t>(y) * static_cast<std::size_t>(out_stride), limits.data());
+    }
+}
+
+/// \brief ordered.
+template <int Size>
+void ordered(const snatch_image_passthrough_data& src, const std::uint8_t* map, int threshold, std::uint8_t* out, int out_stride,
+             int threads) {
+    const int h = src.height;
+    const int bias = threshold - 128;
+    const int bands = std::min(threads, h);
+    if (bands <= 1) {
+        ordered_rows<Size>(src, map, bias, out, out_stride, 0, h);
+        return;
+    }
+    std::vector<std::thread> workers;
+    for (int b = 0; b < bands; ++b) {
+        const int y0 = h * b / bands;
+        const int y1 = h * (b + 1) / bands;
+        workers.emplace_back([&, y0, y1] { ordered_rows<Size>(src, map, bias, out, out_stride, y0, y1); });
+    }
+    for (auto& t : workers) t.join();
+}
+
+/// \brief parse_threads.
+// threads=0 (the default) sizes the pool from the image: small images are not
+// worth a thread. Every mode gives the same bits for any thread count.
+int parse_threads(const plugin_kv_view& kv, const snatch_image_passthrough_data& src) {
+    constexpr int k_max_threads = 256;
+    int requested = 0;
+    if (const auto raw = kv.get("threads"); raw && !raw->empty()) {
+        const auto parsed = plugin_parse_int(*raw);
+        if (!parsed || *parsed < 0 || *parsed > k_max_threads) return -1;
+        requested = *parsed;
+    }
+    if (requested > 0) return requested;
+    constexpr std::size_t k_pixels_per_thread = std::size_t{1} << 18;
+    const std::size_t pixels = static_cast<std::size_t>(src.width) * static_cast<std::size_t>(src.height);
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<int>(std::clamp<std::size_t>(pixels / k_pixels_per_thread, 1, hw));
 }
 
 /// \brief dither_1bpp_transform.
@@ -70,40 +382,40 @@ int dither_1bpp_transform(
     const int threshold = parse_threshold(kv, errbuf, errbuf_len);
     if (threshold < 0) return 13;
 
+    dither_mode mode{};
+    if (!parse_mode(kv, mode)) {
+        plugin_set_err(errbuf, errbuf_len, "dither_1bpp_transform: mode must be floyd-steinberg|atkinson|sierra-lite|bayer|blue-noise");
+        return 14;
+    }
+
+    const int workers = parse_threads(kv, *src);
+    if (workers < 0) {
+        plugin_set_err(errbuf, errbuf_len, "dither_1bpp_transform: threads must be 0..256");
+        return 15;
+    }
+
     const int w = src->width;
     const int h = src->height;
     const int stride = (w + 7) / 8;
 
-    std::vector<float> work(static_cast<std::size_t>(w * h), 0.0f);
-    for (int y = 0; y < h; ++y) {
-        const auto* row = src->pixels + static_cast<std::size_t>(y * src->stride);
-        for (int x = 0; x < w; ++x) {
-            work[static_cast<std::size_t>(y * w + x)] = static_cast<float>(row[x]);
-        }
-    }
-
     g_owner.bitmap.assign(static_cast<std::size_t>(stride * h), 0);
-
-    for (int y = 0; y < h; ++y) {
-        for (int x = 0; x < w; ++x) {
-            const std::size_t idx = static_cast<std::size_t>(y * w + x);
-            const float old_px = work[idx];
-            const float new_px = (old_px >= static_cast<float>(threshold)) ? 255.0f : 0.0f;
-            const float err = old_px - new_px;
-
-            if (new_px < 128.0f) {
-                const int byte_index = x / 8;
-                const int bit_index = 7 - (x % 8);
-                auto& out = g_owner.bitmap[static_cast<std::size_t>(y * stride + byte_index)];
-                out = static_cast<std::uint8_t>(out | (1u << bit_index));
-            }
-
-            // Floyd-Steinberg error diffusion
-            add_error(work, w, h, x + 1, y,     err * (7.0f / 16.0f));
-            add_error(work, w, h, x - 1, y + 1, err * (3.0f / 16.0f));
-            add_error(work, w, h, x,     y + 1, err * (5.0f / 16.0f));
-            add_error(work, w, h, x + 1, y + 1, err * (1.0f / 16.0f));
-        }
+    std::uint8_t* out = g_owner.bitmap.data();
+    switch (mode) {
+    case dither_mode::floyd_steinberg:
+        diffuse_with<floyd_steinberg_kernel>(*src, threshold, out, stride, workers);
+        break;
+    case dither_mode::atkinson:
+        diffuse_with<atkinson_kernel>(*src, threshold, out, stride, workers);
+        break;
+    case dither_mode::sierra_lite:
+        diffuse_with<sierra_lite_kernel>(*src, threshold, out, stride, workers);
+        break;
+    case dither_mode::bayer:
+        ordered<k_bayer_size>(*src, bayer_matrix().data(), threshold, out, stride, workers);
+        break;
+    case dither_mode::blue_noise:
+        ordered<k_noise_size>(*src, blue_noise_matrix().data(), threshold, out, stride, workers);
+        break;
     }
 
     g_owner.glyph = {};
@@ -130,9 +442,148 @@ int dither_1bpp_transform(
     return 0;
 }
 
+// A stream gets the image in bands (see image_passthrough_data.h) and sends
+// each on dithered as a 1bpp band with the same codepoint. The diffusion rows
+// carry the error across band seams, so the bits match the whole-image path
+// while only one band and three error rows are held.
+struct dither_stream {
+    snatch_glyph_sink downstream{};
+    char* errbuf{nullptr};
+    unsigned errbuf_len{0};
+    dither_mode mode{};
+    int threshold{128};
+    int width{0};
+    int next_row{0};
+    std::vector<std::int32_t> err;
+    std::vector<std::uint8_t> limits;
+    std::vector<std::uint8_t> band;
+};
+
+/// \brief dither_stream_row.
+void dither_stream_row(dither_stream& s, const std::uint8_t* in, int y, std::uint8_t* ink) {
+    const int w = s.width;
+    switch (s.mode) {
+    case dither_mode::floyd_steinberg:
+        diffuse_row<floyd_steinberg_kernel>(in, w, y, s.threshold, s.err, ink);
+        break;
+    case dither_mode::atkinson:
+        diffuse_row<atkinson_kernel>(in, w, y, s.threshold, s.err, ink);
+        break;
+    case dither_mode::sierra_lite:
+        diffuse_row<sierra_lite_kernel>(in, w, y, s.threshold, s.err, ink);
+        break;
+    case dither_mode::bayer:
+        ordered_row<k_bayer_size>(in, w, y, bayer_matrix().data(), s.threshold - 128, ink, s.limits.data());
+        break;
+    case dither_mode::blue_noise:
+        ordered_row<k_noise_size>(in, w, y, blue_noise_matrix().data(), s.threshold - 128, ink, s.limits.data());
+        break;
+    }
+}
+
+/// \brief dither_stream_begin.
+int dither_stream_begin(void* ctx, const snatch_font* header) {
+    auto& s = *static_cast<dither_stream*>(ctx);
+    const auto* view = static_cast<const snatch_image_passthrough_data*>(header->user_data);
+    if (!view || view->magic != SNATCH_IMAGE_PASSTHROUGH_MAGIC || view->version != SNATCH_IMAGE_PASSTHROUGH_VERSION) {
+        plugin_set_err(s.errbuf, s.errbuf_len, "dither_1bpp_transform: incompatible user_data payload");
+        return 11;
+    }
+    if (view->pixels || view->width == 0 || view->height == 0) {
+        plugin_set_err(s.errbuf, s.errbuf_len, "dither_1bpp_transform: stream does not carry image bands");
+        return 12;
+    }
+    s.width = view->width;
+    s.err.assign(static_cast<std::size_t>(s.width + 2 * k_pad) * k_rows, 0);
+    s.limits.assign(static_cast<std::size_t>(s.width), 0);
+
+    snatch_font out = *header;
+    out.bitmap_font = nullptr;
+    out.user_data = nullptr;
+    return s.downstream.begin(s.downstream.ctx, &out);
+}
+
+/// \brief dither_stream_glyph.
+int dither_stream_glyph(void* ctx, const snatch_glyph_bitmap* glyph) {
+    auto& s = *static_cast<dither_stream*>(ctx);
+    if (glyph->width != s.width || glyph->height <= 0 || glyph->stride_bytes < glyph->width || !glyph->data) {
+        plugin_set_err(s.errbuf, s.errbuf_len, "dither_1bpp_transform: invalid source image band");
+        return 12;
+    }
+    if (glyph->bearing_y != s.next_row) {
+        plugin_set_err(s.errbuf, s.errbuf_len, "dither_1bpp_transform: image bands must arrive top to bottom");
+        return 16;
+    }
+
+    const int stride = (s.width + 7) / 8;
+    s.band.assign(static_cast<std::size_t>(stride) * static_cast<std::size_t>(glyph->height), 0);
+    for (int r = 0; r < glyph->height; ++r) {
+        dither_stream_row(s, glyph->data + static_cast<std::size_t>(r) * static_cast<std::size_t>(glyph->stride_bytes), s.next_row + r,
+                          s.band.data() + static_cast<std::size_t>(r) * static_cast<std::size_t>(stride));
+    }
+    s.next_row += glyph->height;
+
+    snatch_glyph_bitmap out = *glyph;
+    out.stride_bytes = stride;
+    out.data = s.band.data();
+    return s.downstream.glyph(s.downstream.ctx, &out);
+}
+
+/// \brief dither_stream_end.
+int dither_stream_end(void* ctx, const snatch_font* summary) {
+    auto& s = *static_cast<dither_stream*>(ctx);
+    snatch_font out = *summary;
+    out.bitmap_font = nullptr;
+    out.user_data = nullptr;
+    return s.downstream.end(s.downstream.ctx, &out);
+}
+
+/// \brief dither_stream_close.
+void dither_stream_close(void* ctx) {
+    delete static_cast<dither_stream*>(ctx);
+}
+
+/// \brief stream_dither_1bpp_transform.
+// bands are dithered on the calling thread; threads= applies to whole images
+int stream_dither_1bpp_transform(
+    const snatch_kv* options,
+    unsigned options_count,
+    const snatch_glyph_sink* downstream,
+    snatch_glyph_sink* out_sink,
+    char* errbuf,
+    unsigned errbuf_len
+) {
+    if (!downstream || !out_sink) {
+        plugin_set_err(errbuf, errbuf_len, "dither_1bpp_transform: sink is null");
+        return 10;
+    }
+    const plugin_kv_view kv{options, options_count};
+    const int threshold = parse_threshold(kv, errbuf, errbuf_len);
+    if (threshold < 0) return 13;
+    dither_mode mode{};
+    if (!parse_mode(kv, mode)) {
+        plugin_set_err(errbuf, errbuf_len, "dither_1bpp_transform: mode must be floyd-steinberg|atkinson|sierra-lite|bayer|blue-noise");
+        return 14;
+    }
+
+    auto* s = new dither_stream;
+    s->downstream = *downstream;
+    s->errbuf = errbuf;
+    s->errbuf_len = errbuf_len;
+    s->mode = mode;
+    s->threshold = threshold;
+
+    out_sink->ctx = s;
+    out_sink->begin = &dither_stream_begin;
+    out_sink->glyph = &dither_stream_glyph;
+    out_sink->end = &dither_stream_end;
+    out_sink->close = &dither_stream_close;
+    return 0;
+}
+
 const snatch_plugin_info k_info = {
     "dither_1bpp_transform",
-    "Converts grayscale passthrough image to 1bpp bitmap with Floyd-Steinberg dithering",
+    "Converts grayscale passthrough image to 1bpp bitmap by error diffusion or ordered dithering",
     "snatch project",
     "bitmap",
     "dither-1bpp",
@@ -140,12 +591,18 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_KIND_TRANSFORMER,
     &dither_1bpp_transform,
     nullptr,
-    nullptr
+    nullptr,
+    &stream_dither_1bpp_transform,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_IMAGE,
+    SNATCH_PAYLOAD_BITMAP,
+    0
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
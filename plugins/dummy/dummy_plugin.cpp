@@ -71,12 +71,19 @@ const snatch_plugin_info k_dummy_info = {
     SNATCH_PLUGIN_ABI_VERSION,
     SNATCH_PLUGIN_KIND_EXPORTER,
     nullptr,
-    &dummy_export_font
+    &dummy_export_font,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    0,
+    0,
+    SNATCH_CAP_THREAD_SAFE
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_dummy_info;
     return 0;
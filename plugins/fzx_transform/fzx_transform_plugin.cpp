@@ -163,12 +163,19 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_ABI_VERSION,
     SNATCH_PLUGIN_KIND_TRANSFORMER,
     &fzx_transform,
-    nullptr
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_BITMAP,
+    SNATCH_PAYLOAD_BITMAP | SNATCH_PAYLOAD_FZX,
+    0
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
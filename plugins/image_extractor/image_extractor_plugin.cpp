@@ -93,6 +93,8 @@ int extract_image(
     if (const auto v = parse_int_kv(kv, "padding_right"); v.has_value()) opt.padding.right = *v;
     if (const auto v = parse_int_kv(kv, "padding_bottom"); v.has_value()) opt.padding.bottom = *v;
 
+    if (const auto v = kv.get("cache_file"); v && !v->empty()) opt.cache_file = std::string(*v);
+
     opt.inverse = plugin_parse_bool(kv.get("inverse"), false);
     opt.proportional = parse_proportional(kv, false, errbuf, errbuf_len);
     if (errbuf && errbuf[0] != '\0') return 12;
@@ -137,12 +139,18 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_KIND_EXTRACTOR,
     nullptr,
     nullptr,
-    &extract_image
+    &extract_image,
+    nullptr,
+    nullptr,
+    nullptr,
+    0,
+    SNATCH_PAYLOAD_BITMAP,
+    0
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
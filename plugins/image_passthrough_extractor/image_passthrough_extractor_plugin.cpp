@@ -8,10 +8,16 @@
 
 #include "snatch/plugin.h"
 #include "snatch/plugin_util.h"
+#include "snatch/png_reader.h"
 #include "snatch_plugins/image_passthrough_data.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <utility>
 #include <vector>
 
 extern "C" {
@@ -28,6 +34,14 @@ struct image_passthrough_owner {
 
 static image_passthrough_owner g_owner;
 
+// stream headers must stay valid as long as whole-font output would; they
+// hold only the image size and never change, so streams of the same size
+// share one and a resident snatch keeps one per size it has seen
+static std::mutex g_stream_views_mu;
+static std::map<std::pair<std::uint16_t, std::uint16_t>, snatch_image_passthrough_data> g_stream_views;
+
+constexpr int k_default_tile_rows = 256;
+
 /// \brief extract_image_passthrough.
 int extract_image_passthrough(
     const char* input_path,
@@ -48,17 +62,29 @@ int extract_image_passthrough(
 
     int width = 0;
     int height = 0;
-    int channels = 0;
-    unsigned char* gray = stbi_load(input_path, &width, &height, &channels, 1);
-    if (!gray || width <= 0 || height <= 0) {
-        if (gray) stbi_image_free(gray);
-        plugin_set_err(errbuf, errbuf_len, "image_passthrough_extractor: failed to load image");
-        return 12;
+    // PNGs go through the same decoder as streams, so both give the same gray
+    if (png_row_reader png; png.open(input_path)) {
+        width = png.width();
+        height = png.height();
+        g_owner.pixels.resize(static_cast<std::size_t>(width) * static_cast<std::size_t>(height));
+        for (int y = 0; y < height; ++y) {
+            if (!png.read_gray_row(g_owner.pixels.data() + static_cast<std::size_t>(y) * static_cast<std::size_t>(width))) {
+                plugin_set_err(errbuf, errbuf_len, "image_passthrough_extractor: " + png.error());
+                return 14;
+            }
+        }
+    } else {
+        int channels = 0;
+        unsigned char* gray = stbi_load(input_path, &width, &height, &channels, 1);
+        if (!gray || width <= 0 || height <= 0) {
+            if (gray) stbi_image_free(gray);
+            plugin_set_err(errbuf, errbuf_len, "image_passthrough_extractor: failed to load image");
+            return 12;
+        }
+        g_owner.pixels.assign(gray, gray + static_cast<std::size_t>(width * height));
+        stbi_image_free(gray);
     }
 
-    g_owner.pixels.assign(gray, gray + static_cast<std::size_t>(width * height));
-    stbi_image_free(gray);
-
     g_owner.view = {};
     g_owner.view.magic = SNATCH_IMAGE_PASSTHROUGH_MAGIC;
     g_owner.view.version = SNATCH_IMAGE_PASSTHROUGH_VERSION;
@@ -81,6 +107,104 @@ int extract_image_passthrough(
     return 0;
 }
 
+/// \brief stream_extract_image_passthrough.
+// Pushes the image as bands of tile_rows rows. PNGs are decoded a row at a
+// time, so only one band is ever held; other formats are loaded whole first.
+int stream_extract_image_passthrough(
+    const char* input_path,
+    const snatch_kv* options,
+    unsigned options_count,
+    const snatch_glyph_sink* sink,
+    char* errbuf,
+    unsigned errbuf_len
+) {
+    if (!input_path || input_path[0] == '\0') {
+        plugin_set_err(errbuf, errbuf_len, "image_passthrough_extractor: input path is empty");
+        return 10;
+    }
+    if (!sink) {
+        plugin_set_err(errbuf, errbuf_len, "image_passthrough_extractor: sink is null");
+        return 11;
+    }
+
+    const plugin_kv_view kv{options, options_count};
+    int tile_rows = k_default_tile_rows;
+    if (const auto raw = kv.get("tile_rows"); raw && !raw->empty()) {
+        const auto parsed = plugin_parse_int(*raw);
+        if (!parsed || *parsed < 1 || *parsed > 65535) {
+            plugin_set_err(errbuf, errbuf_len, "image_passthrough_extractor: tile_rows must be 1..65535");
+            return 13;
+        }
+        tile_rows = *parsed;
+    }
+
+    png_row_reader png;
+    std::unique_ptr<unsigned char, void (*)(void*)> whole{nullptr, &stbi_image_free};
+    int width = 0;
+    int height = 0;
+    if (png.open(input_path)) {
+        width = png.width();
+        height = png.height();
+    } else {
+        int channels = 0;
+        whole.reset(stbi_load(input_path, &width, &height, &channels, 1));
+        if (!whole || width <= 0 || height <= 0) {
+            plugin_set_err(errbuf, errbuf_len, "image_passthrough_extractor: failed to load image");
+            return 12;
+        }
+    }
+    tile_rows = std::min(tile_rows, height);
+
+    const snatch_image_passthrough_data* view = nullptr;
+    {
+        const std::lock_guard lock(g_stream_views_mu);
+        const auto size = std::make_pair(static_cast<std::uint16_t>(width), static_cast<std::uint16_t>(height));
+        const auto [it, inserted] = g_stream_views.try_emplace(size);
+        // other streams may be reading an existing header, so only a new one is written
+        if (inserted) {
+            it->second.width = size.first;
+            it->second.height = size.second;
+        }
+        view = &it->second;
+    }
+
+    snatch_font header{};
+    header.name = "image-passthrough";
+    header.glyph_width = width;
+    header.glyph_height = tile_rows;
+    header.first_codepoint = 0;
+    header.last_codepoint = (height + tile_rows - 1) / tile_rows - 1;
+    header.user_data = view;
+    if (const int rc = sink->begin(sink->ctx, &header); rc != 0) return rc;
+
+    std::vector<std::uint8_t> band(whole ? 0 : static_cast<std::size_t>(width) * static_cast<std::size_t>(tile_rows));
+    for (int y0 = 0, index = 0; y0 < height; y0 += tile_rows, ++index) {
+        const int rows = std::min(tile_rows, height - y0);
+        const std::uint8_t* data = nullptr;
+        if (whole) {
+            data = whole.get() + static_cast<std::size_t>(y0) * static_cast<std::size_t>(width);
+        } else {
+            for (int r = 0; r < rows; ++r) {
+                if (!png.read_gray_row(band.data() + static_cast<std::size_t>(r) * static_cast<std::size_t>(width))) {
+                    plugin_set_err(errbuf, errbuf_len, "image_passthrough_extractor: " + png.error());
+                    return 14;
+                }
+            }
+            data = band.data();
+        }
+        snatch_glyph_bitmap glyph{};
+        glyph.codepoint = index;
+        glyph.width = width;
+        glyph.height = rows;
+        glyph.bearing_y = y0;
+        glyph.advance_x = width;
+        glyph.stride_bytes = width;
+        glyph.data = data;
+        if (const int rc = sink->glyph(sink->ctx, &glyph); rc != 0) return rc;
+    }
+    return sink->end(sink->ctx, &header);
+}
+
 const snatch_plugin_info k_info = {
     "image_passthrough_extractor",
     "Loads image as grayscale passthrough data in user_data",
@@ -91,12 +215,18 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_KIND_EXTRACTOR,
     nullptr,
     nullptr,
-    &extract_image_passthrough
+    &extract_image_passthrough,
+    nullptr,
+    nullptr,
+    &stream_extract_image_passthrough,
+    0,
+    SNATCH_PAYLOAD_IMAGE,
+    0
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
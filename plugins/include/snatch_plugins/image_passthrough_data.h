@@ -13,6 +13,10 @@
 constexpr std::uint32_t SNATCH_IMAGE_PASSTHROUGH_MAGIC = 0x49505448u; // "IPTH"
 constexpr std::uint16_t SNATCH_IMAGE_PASSTHROUGH_VERSION = 1u;
 
+// In a glyph stream the image arrives in bands instead: the header's
+// user_data has width and height but no pixels, and each glyph is a band of
+// whole rows, top to bottom, as 8-bit gray with stride_bytes per row. Its
+// codepoint is the band index and bearing_y the first row it holds.
 struct snatch_image_passthrough_data {
     std::uint32_t magic{SNATCH_IMAGE_PASSTHROUGH_MAGIC};
     std::uint16_t version{SNATCH_IMAGE_PASSTHROUGH_VERSION};
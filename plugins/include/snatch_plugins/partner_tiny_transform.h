@@ -24,6 +24,13 @@ struct snatch_partner_tiny_glyph {
     const std::uint8_t* data{nullptr};       // pointer to encoded tiny glyph payload
 };
 
+// Glyphs drawn from one shared bitmap (see dedup_transform) share `data`;
+// exporters write their record once and point both offsets at it.
+inline bool snatch_partner_tiny_same_record(const snatch_partner_tiny_glyph& a, const snatch_partner_tiny_glyph& b) {
+    return a.data && a.data == b.data && a.data_size == b.data_size && a.width_minus_one == b.width_minus_one &&
+           a.height_minus_one == b.height_minus_one;
+}
+
 struct snatch_partner_tiny_data {
     std::uint32_t magic{SNATCH_PARTNER_TINY_MAGIC};
     std::uint16_t version{SNATCH_PARTNER_TINY_VERSION};
@@ -198,12 +198,25 @@ export_state export_partner_asm_impl(
         (letter_spacing & 0x0F)
     );
 
+    // each glyph's record, or the earlier record it aliases in the offset table
+    std::vector<std::size_t> record(static_cast<std::size_t>(transformed->glyph_count));
     std::vector<std::uint16_t> offsets;
     offsets.reserve(static_cast<std::size_t>(transformed->glyph_count));
 
     std::uint32_t offset = 5u + static_cast<std::uint32_t>(transformed->glyph_count * 2u);
     for (std::size_t i = 0; i < transformed->glyph_count; ++i) {
         const auto& glyph = transformed->glyphs[i];
+        record[i] = i;
+        for (std::size_t j = 0; j < i && glyph.data; ++j) {
+            if (record[j] == j && snatch_partner_tiny_same_record(transformed->glyphs[j], glyph)) {
+                record[i] = j;
+                break;
+            }
+        }
+        if (record[i] != i) {
+            offsets.push_back(offsets[record[i]]);
+            continue;
+        }
         if (offset > 0xFFFFu) return {17, "partner_asm: font too large (>64KiB)"};
         offsets.push_back(static_cast<std::uint16_t>(offset));
         offset += 4u + static_cast<std::uint32_t>(glyph.data_size);
@@ -240,6 +253,11 @@ export_state export_partner_asm_impl(
         const auto& glyph = transformed->glyphs[i];
         const int codepoint = first_ascii + static_cast<int>(i);
 
+        if (record[i] != i) {
+            out << kIndent << ";; ascii " << codepoint << ": " << glyph_label_for_comment(codepoint)
+                << " (same as ascii " << first_ascii + static_cast<int>(record[i]) << ")\n";
+            continue;
+        }
         out << kIndent << ";; ascii " << codepoint << ": " << glyph_label_for_comment(codepoint) << '\n';
         write_db_value(out, static_cast<std::uint8_t>(kGlyphClassTiny << 5u), "class(bits 5-7)");
         write_db_value(out, glyph.width_minus_one, "width");
@@ -305,12 +323,19 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_ABI_VERSION,
     SNATCH_PLUGIN_KIND_EXPORTER,
     nullptr,
-    &export_partner_asm
+    &export_partner_asm,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_PARTNER_TINY,
+    0,
+    SNATCH_CAP_THREAD_SAFE
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
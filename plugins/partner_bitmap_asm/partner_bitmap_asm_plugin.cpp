@@ -6,6 +6,7 @@
 /// Copyright (c) 2026 Tomaz Stih
 /// SPDX-License-Identifier: GPL-2.0-only
 
+#include "snatch/bit_blit.h"
 #include "snatch/plugin.h"
 #include "snatch/plugin_util.h"
 
@@ -18,6 +19,7 @@
 #include <sstream>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 namespace {
@@ -41,13 +43,6 @@ struct export_state {
     [[nodiscard]] bool ok() const { return code == 0; }
 };
 
-/// \brief bit_is_set.
-bool bit_is_set(const unsigned char* row, int x) {
-    const int byte_index = x / 8;
-    const int bit_index = 7 - (x % 8);
-    return (row[byte_index] & (1u << bit_index)) != 0;
-}
-
 /// \brief find_glyph_by_codepoint.
 const snatch_glyph_bitmap* find_glyph_by_codepoint(const snatch_bitmap_font& bf, int codepoint) {
     for (int i = 0; i < bf.glyph_count; ++i) {
@@ -113,6 +108,13 @@ void write_dw_line(std::ostream& os, const std::vector<std::uint16_t>& values, s
     os << '\n';
 }
 
+/// \brief same_record.
+// glyphs sharing one bitmap (see dedup_transform) pack to the same bytes
+bool same_record(const snatch_glyph_bitmap* a, const snatch_glyph_bitmap* b) {
+    return a && b && a->data && a->data == b->data && a->width == b->width && a->height == b->height &&
+           a->stride_bytes == b->stride_bytes && a->bearing_y == b->bearing_y;
+}
+
 /// \brief pack_glyph_rows.
 glyph_blob pack_glyph_rows(
     const snatch_glyph_bitmap* glyph,
@@ -138,20 +140,8 @@ glyph_blob pack_glyph_rows(
     }
 
     // Align all glyphs to a common baseline across the exported font cell.
-    const int y_offset = max_bearing_y - glyph->bearing_y;
-
-    for (int y = 0; y < glyph->height; ++y) {
-        const int dst_y = y + y_offset;
-        if (dst_y < 0 || dst_y >= cell_height) continue;
-        const auto* src_row = glyph->data + static_cast<std::size_t>(y * glyph->stride_bytes);
-        for (int x = 0; x < glyph->width && x < glyph_width; ++x) {
-            if (!bit_is_set(src_row, x)) continue;
-            const int byte_index = x / 8;
-            const int bit_index = 7 - (x % 8);
-            auto& dst = out.payload[static_cast<std::size_t>(dst_y * out.bytes_per_row + byte_index)];
-            dst = static_cast<std::uint8_t>(dst | (1u << bit_index));
-        }
-    }
+    const bitmap_1bpp cell{out.payload.data(), glyph_width, cell_height, static_cast<std::size_t>(out.bytes_per_row)};
+    blit_1bpp(cell, 0, max_bearing_y - glyph->bearing_y, glyph_view_1bpp(*glyph), raster_op::copy);
 
     out.payload_size = static_cast<std::uint16_t>(out.payload.size());
     return out;
@@ -245,10 +235,25 @@ export_state export_partner_bitmap_asm_impl(
 
     const int fixed_cell_width = std::max(1, max_w);
 
+    // each glyph's record, or the earlier record it aliases in the offset table
+    std::vector<std::size_t> record(glyph_ptrs.size());
     for (std::size_t i = 0; i < glyph_ptrs.size(); ++i) {
         const int cp = first_ascii + static_cast<int>(i);
         const auto* g = glyph_ptrs[i];
         const int cell_width = proportional ? std::max(0, g ? g->width : 0) : fixed_cell_width;
+        record[i] = i;
+        for (std::size_t j = 0; j < i && g && g->data; ++j) {
+            if (record[j] == j && same_record(glyph_ptrs[j], g)) {
+                record[i] = j;
+                break;
+            }
+        }
+        if (record[i] != i) {
+            glyph_blob alias{};
+            alias.codepoint = cp;
+            glyphs.push_back(std::move(alias));
+            continue;
+        }
         glyphs.push_back(pack_glyph_rows(g, cp, cell_width, max_h, max_bearing_y));
         if (glyphs.back().payload_size > 255) {
             return {17, "partner_bitmap_asm: glyph payload too large for 1-byte length"};
@@ -258,10 +263,14 @@ export_state export_partner_bitmap_asm_impl(
     std::vector<std::uint16_t> offsets;
     offsets.reserve(glyphs.size());
     std::uint32_t offset = 5u + static_cast<std::uint32_t>(glyphs.size() * 2u);
-    for (const auto& g : glyphs) {
+    for (std::size_t i = 0; i < glyphs.size(); ++i) {
+        if (record[i] != i) {
+            offsets.push_back(offsets[record[i]]);
+            continue;
+        }
         if (offset > 0xFFFFu) return {14, "partner_bitmap_asm: font too large (>64KiB)"};
         offsets.push_back(static_cast<std::uint16_t>(offset));
-        offset += 4u + static_cast<std::uint32_t>(g.payload_size);
+        offset += 4u + static_cast<std::uint32_t>(glyphs[i].payload_size);
     }
 
     std::ostringstream out;
@@ -291,7 +300,13 @@ export_state export_partner_bitmap_asm_impl(
     }
     out << '\n';
 
-    for (const auto& g : glyphs) {
+    for (std::size_t i = 0; i < glyphs.size(); ++i) {
+        const auto& g = glyphs[i];
+        if (record[i] != i) {
+            out << kIndent << ";; ascii " << g.codepoint << ": " << glyph_label_for_comment(g.codepoint)
+                << " (same as ascii " << glyphs[record[i]].codepoint << ")\n";
+            continue;
+        }
         out << kIndent << ";; ascii " << g.codepoint << ": " << glyph_label_for_comment(g.codepoint) << '\n';
         write_db_value(out, static_cast<std::uint8_t>(kGlyphClassBitmap << 5u), "class(bits 5-7)");
         write_db_value(out, g.width, "width");
@@ -347,12 +362,19 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_ABI_VERSION,
     SNATCH_PLUGIN_KIND_EXPORTER,
     nullptr,
-    &export_partner_bitmap_asm
+    &export_partner_bitmap_asm,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_BITMAP,
+    0,
+    SNATCH_CAP_THREAD_SAFE
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
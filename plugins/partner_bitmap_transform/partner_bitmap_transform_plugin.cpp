@@ -7,6 +7,7 @@
 /// SPDX-License-Identifier: GPL-2.0-only
 
 #include "snatch_plugins/partner_bitmap_transform.h"
+#include "snatch/bit_blit.h"
 #include "snatch/plugin.h"
 #include "snatch/plugin_util.h"
 
@@ -29,13 +30,6 @@ struct partner_bitmap_owner {
 
 partner_bitmap_owner g_owner;
 
-/// \brief bit_is_set.
-bool bit_is_set(const unsigned char* row, int x) {
-    const int byte_index = x / 8;
-    const int bit_index = 7 - (x % 8);
-    return (row[byte_index] & (1u << bit_index)) != 0;
-}
-
 /// \brief find_glyph_by_codepoint.
 const snatch_glyph_bitmap* find_glyph_by_codepoint(const snatch_bitmap_font& bf, int codepoint) {
     for (int i = 0; i < bf.glyph_count; ++i) {
@@ -50,6 +44,13 @@ void append_u16_le(std::vector<std::uint8_t>& out, std::uint16_t value) {
     out.push_back(static_cast<std::uint8_t>((value >> 8u) & 0xFFu));
 }
 
+/// \brief same_record.
+// glyphs sharing one bitmap (see dedup_transform) pack to the same bytes
+bool same_record(const snatch_glyph_bitmap* a, const snatch_glyph_bitmap* b) {
+    return a && b && a->data && a->data == b->data && a->width == b->width && a->height == b->height &&
+           a->stride_bytes == b->stride_bytes && a->bearing_y == b->bearing_y;
+}
+
 /// \brief pack_glyph_rows.
 glyph_blob pack_glyph_rows(
     const snatch_glyph_bitmap* glyph,
@@ -73,20 +74,8 @@ glyph_blob pack_glyph_rows(
         return out;
     }
 
-    const int y_offset = max_bearing_y - glyph->bearing_y;
-    for (int y = 0; y < glyph->height; ++y) {
-        const int dst_y = y + y_offset;
-        if (dst_y < 0 || dst_y >= cell_height) continue;
-
-        const auto* src_row = glyph->data + static_cast<std::size_t>(y * glyph->stride_bytes);
-        for (int x = 0; x < glyph->width && x < cell_width; ++x) {
-            if (!bit_is_set(src_row, x)) continue;
-            const int byte_index = x / 8;
-            const int bit_index = 7 - (x % 8);
-            auto& dst = out.payload[static_cast<std::size_t>(dst_y * bytes_per_row + byte_index)];
-            dst = static_cast<std::uint8_t>(dst | (1u << bit_index));
-        }
-    }
+    const bitmap_1bpp cell{out.payload.data(), cell_width, cell_height, static_cast<std::size_t>(bytes_per_row)};
+    blit_1bpp(cell, 0, max_bearing_y - glyph->bearing_y, glyph_view_1bpp(*glyph), raster_op::copy);
 
     return out;
 }
@@ -177,10 +166,24 @@ int partner_bitmap_transform(
     const int max_h = std::max(1, max_bearing_y - min_descender);
     const int fixed_cell_width = std::max(1, max_w);
 
+    // each glyph's record, or the earlier record it aliases in the offset table
+    std::vector<std::size_t> record(glyph_ptrs.size());
     std::vector<glyph_blob> glyphs;
     glyphs.reserve(glyph_ptrs.size());
-    for (const auto* g : glyph_ptrs) {
+    for (std::size_t i = 0; i < glyph_ptrs.size(); ++i) {
+        const auto* g = glyph_ptrs[i];
         const int cell_width = proportional ? std::max(0, g ? g->width : 0) : fixed_cell_width;
+        record[i] = i;
+        for (std::size_t j = 0; j < i && g && g->data; ++j) {
+            if (record[j] == j && same_record(glyph_ptrs[j], g)) {
+                record[i] = j;
+                break;
+            }
+        }
+        if (record[i] != i) {
+            glyphs.emplace_back();
+            continue;
+        }
         glyphs.push_back(pack_glyph_rows(g, cell_width, max_h, max_bearing_y));
         if (glyphs.back().payload.size() > 255) {
             plugin_set_err(errbuf, errbuf_len, "partner_bitmap_transform: glyph payload too large for Partner format");
@@ -191,13 +194,17 @@ int partner_bitmap_transform(
     std::vector<std::uint16_t> offsets;
     offsets.reserve(glyphs.size());
     std::uint32_t offset = 5u + static_cast<std::uint32_t>(glyphs.size() * 2u);
-    for (const auto& glyph : glyphs) {
+    for (std::size_t i = 0; i < glyphs.size(); ++i) {
+        if (record[i] != i) {
+            offsets.push_back(offsets[record[i]]);
+            continue;
+        }
         if (offset > 0xFFFFu) {
             plugin_set_err(errbuf, errbuf_len, "partner_bitmap_transform: serialized font too large (>64KiB)");
             return 36;
         }
         offsets.push_back(static_cast<std::uint16_t>(offset));
-        offset += 4u + static_cast<std::uint32_t>(glyph.payload.size());
+        offset += 4u + static_cast<std::uint32_t>(glyphs[i].payload.size());
     }
 
     g_owner = {};
@@ -213,7 +220,9 @@ int partner_bitmap_transform(
         append_u16_le(g_owner.bytes, off);
     }
 
-    for (const auto& glyph : glyphs) {
+    for (std::size_t i = 0; i < glyphs.size(); ++i) {
+        if (record[i] != i) continue;
+        const auto& glyph = glyphs[i];
         g_owner.bytes.push_back(0); // class(bits 5-7) for bitmap
         g_owner.bytes.push_back(glyph.width);
         g_owner.bytes.push_back(glyph.height);
@@ -238,12 +247,19 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_ABI_VERSION,
     SNATCH_PLUGIN_KIND_TRANSFORMER,
     &partner_bitmap_transform,
-    nullptr
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_BITMAP,
+    SNATCH_PAYLOAD_BITMAP | SNATCH_PAYLOAD_PARTNER_BITMAP,
+    0
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
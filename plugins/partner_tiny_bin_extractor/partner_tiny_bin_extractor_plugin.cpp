@@ -90,12 +90,18 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_KIND_EXTRACTOR,
     nullptr,
     nullptr,
-    &extract_tiny_bin
+    &extract_tiny_bin,
+    nullptr,
+    nullptr,
+    nullptr,
+    0,
+    SNATCH_PAYLOAD_PARTNER_TINY_BIN,
+    0
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
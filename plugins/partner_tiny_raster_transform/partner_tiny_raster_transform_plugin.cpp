@@ -218,12 +218,18 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_KIND_TRANSFORMER,
     &transform_partner_tiny_raster,
     nullptr,
-    nullptr
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_PARTNER_TINY_BIN,
+    SNATCH_PAYLOAD_BITMAP | SNATCH_PAYLOAD_KEEPS_INPUT,
+    0
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
@@ -7,12 +7,19 @@
 /// SPDX-License-Identifier: GPL-2.0-only
 
 #include "snatch/glyph_algorithms.h"
+#include "snatch/glyph_cache.h"
 #include "snatch_plugins/partner_tiny_transform.h"
 #include "snatch/plugin.h"
 #include "snatch/plugin_util.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace {
@@ -29,6 +36,8 @@ struct tiny_move {
 struct glyph_owner {
     snatch_partner_tiny_glyph view{};
     std::vector<std::uint8_t> bytes;
+    // earlier glyph drawn from the same bitmap, whose bytes this one shares
+    std::ptrdiff_t same_as{-1};
 };
 
 struct partner_tiny_owner {
@@ -39,6 +48,18 @@ struct partner_tiny_owner {
 
 static partner_tiny_owner g_owner;
 
+// glyph content hash -> encoded move stream, kept between calls so a
+// re-run only routes glyphs whose bitmap changed
+static glyph_cache g_memo;
+static std::filesystem::path g_memo_file;
+
+// the same routes shared by every font, run and process of this user, keyed
+// by glyph pixels; merged back into the file when a run routed anything new
+static glyph_cache g_routes;
+static std::filesystem::path g_routes_file;
+static std::filesystem::file_time_type g_routes_stamp;
+constexpr std::size_t k_route_cache_entries = 1u << 16;
+
 /// \brief u8_clamp.
 constexpr std::uint8_t u8_clamp(int v) {
     return static_cast<std::uint8_t>(std::clamp(v, 0, 255));
@@ -82,10 +103,58 @@ void append_none_steps(std::vector<tiny_move>& out, int dx, int dy) {
     }
 }
 
-/// \brief vectorize_glyph.
-std::vector<tiny_move> vectorize_glyph(
+/// \brief append_stroke.
+// Partner draws a coloured move as a line including both ends, so one move
+// covers up to four pixels of a row, column or diagonal.
+void append_stroke(std::vector<tiny_move>& out, const glyph_stroke& stroke) {
+    const int dx = stroke.to.x - stroke.from.x;
+    const int dy = stroke.to.y - stroke.from.y;
+    const int ux = (dx > 0) - (dx < 0);
+    const int uy = (dy > 0) - (dy < 0);
+    int steps = std::max(std::abs(dx), std::abs(dy));
+    if (steps == 0) {
+        out.push_back({0, 0, kColorFore});
+        return;
+    }
+    while (steps > 0) {
+        const int n = std::min(steps, 3);
+        out.push_back({ux * n, uy * n, kColorFore});
+        steps -= n;
+    }
+}
+
+/// \brief vectorize_strokes.
+std::vector<tiny_move> vectorize_strokes(
+    const snatch_glyph_bitmap& glyph,
+    bool optimize_route,
+    std::chrono::milliseconds budget,
+    int& origin_x,
+    int& origin_y
+) {
+    std::vector<tiny_move> moves;
+    const glyph_stroke_planner planner;
+    std::vector<glyph_stroke> strokes = glyph_stroke_planner::cover(glyph, kColorFore);
+    if (strokes.empty()) return moves;
+    if (optimize_route) strokes = planner.route(std::move(strokes), budget);
+
+    origin_x = strokes.front().from.x;
+    origin_y = strokes.front().from.y;
+    int cx = origin_x;
+    int cy = origin_y;
+    for (const auto& stroke : strokes) {
+        append_none_steps(moves, stroke.from.x - cx, stroke.from.y - cy);
+        append_stroke(moves, stroke);
+        cx = stroke.to.x;
+        cy = stroke.to.y;
+    }
+    return moves;
+}
+
+/// \brief vectorize_dots.
+std::vector<tiny_move> vectorize_dots(
     const snatch_glyph_bitmap& glyph,
     bool optimize_route,
+    std::chrono::milliseconds budget,
     int& origin_x,
     int& origin_y
 ) {
@@ -93,9 +162,9 @@ std::vector<tiny_move> vectorize_glyph(
     std::vector<glyph_pixel> points = glyph_bitmap_analyzer::foreground_pixels(glyph, 1);
     if (points.empty()) return moves;
 
-    if (optimize_route && points.size() >= 4) {
-        glyph_route_optimizer optimizer;
-        points = optimizer.tsp_2opt(points);
+    if (optimize_route) {
+        const glyph_route_optimizer optimizer;
+        points = optimizer.shortest(points, budget);
     }
 
     origin_x = points.front().x;
@@ -148,6 +217,52 @@ int partner_tiny_transform(
 
     const plugin_kv_view kv{options, options_count};
     const bool optimize_route = plugin_parse_bool(kv.get("optimize"), true);
+    const std::string_view encoding = kv.get("encoding").value_or("strokes");
+    if (encoding != "strokes" && encoding != "dots") {
+        plugin_set_err(errbuf, errbuf_len, "partner_tiny_transform: encoding must be strokes|dots");
+        return 34;
+    }
+    const bool strokes = encoding == "strokes";
+    // extra search time per glyph too large to be solved exactly
+    int budget_ms = 0;
+    if (const auto raw = kv.get("route_budget_ms"); raw && !raw->empty()) {
+        const auto v = plugin_parse_int(*raw);
+        if (!v || *v < 0 || *v > 60000) {
+            plugin_set_err(errbuf, errbuf_len, "partner_tiny_transform: route_budget_ms must be 0..60000");
+            return 35;
+        }
+        budget_ms = *v;
+    }
+    const std::chrono::milliseconds budget{budget_ms};
+    const std::filesystem::path cache_file = std::string(kv.get("cache_file").value_or(""));
+    const bool route_cache = plugin_parse_bool(kv.get("route_cache"), true);
+
+    // bump the leading byte when the encoding changes
+    const std::uint8_t settings[5] = {4, static_cast<std::uint8_t>(optimize_route ? 1 : 0), static_cast<std::uint8_t>(strokes ? 1 : 0),
+                                      static_cast<std::uint8_t>(budget_ms & 0xFF), static_cast<std::uint8_t>(budget_ms >> 8)};
+    const auto model = glyph_route_cost_model{}.parameters();
+    const std::uint64_t memo_tag = glyph_hash_bytes(model.data(), sizeof(model), glyph_hash_bytes(settings, sizeof(settings)));
+    if (!cache_file.empty() && (cache_file != g_memo_file || g_memo.tag() != memo_tag)) {
+        g_memo.load(cache_file, memo_tag);
+        g_memo_file = cache_file;
+    } else if (g_memo.tag() != memo_tag) {
+        g_memo.reset(memo_tag);
+    }
+
+    std::filesystem::path routes_file;
+    if (const auto dir = snatch_user_cache_dir(); route_cache && !dir.empty()) {
+        char name[40];
+        std::snprintf(name, sizeof(name), "tiny-routes-%016llx", static_cast<unsigned long long>(memo_tag));
+        routes_file = dir / name;
+        std::error_code ec;
+        const auto stamp = std::filesystem::last_write_time(routes_file, ec);
+        // another process may have added routes since this one last looked
+        if (routes_file != g_routes_file || (!ec && stamp != g_routes_stamp)) {
+            g_routes.load(routes_file, memo_tag);
+            g_routes_file = routes_file;
+            g_routes_stamp = ec ? std::filesystem::file_time_type{} : stamp;
+        }
+    }
 
     const snatch_bitmap_font& bf = *font->bitmap_font;
     const int first = font->first_codepoint;
@@ -159,11 +274,14 @@ int partner_tiny_transform(
     int max_width = std::max(1, font->glyph_width);
     int max_height = std::max(1, font->glyph_height);
 
+    std::vector<const snatch_glyph_bitmap*> sources;
+    sources.reserve(g_owner.glyphs.capacity());
     for (int cp = first; cp <= last; ++cp) {
         glyph_owner owner{};
         owner.view.codepoint = static_cast<std::uint16_t>(cp);
 
         const snatch_glyph_bitmap* glyph = find_glyph_by_codepoint(bf, cp);
+        sources.push_back(glyph);
         const int gw = glyph ? std::max(1, glyph->width) : std::max(1, font->glyph_width);
         const int gh = glyph ? std::max(1, glyph->height) : std::max(1, font->glyph_height);
 
@@ -173,10 +291,32 @@ int partner_tiny_transform(
         owner.view.width_minus_one = u8_clamp(gw - 1);
         owner.view.height_minus_one = u8_clamp(gh - 1);
 
-        if (glyph && glyph->data && glyph->width > 0 && glyph->height > 0) {
+        // a bitmap shared with an earlier glyph is routed once, not hashed again
+        for (std::size_t j = 0; j + 1 < sources.size() && glyph && glyph->data; ++j) {
+            const snatch_glyph_bitmap* other = sources[j];
+            if (g_owner.glyphs[j].same_as < 0 && other && other->data == glyph->data && other->width == glyph->width &&
+                other->height == glyph->height && other->stride_bytes == glyph->stride_bytes) {
+                owner.same_as = static_cast<std::ptrdiff_t>(j);
+                break;
+            }
+        }
+        if (owner.same_as >= 0) {
+            owner.view.data_size = g_owner.glyphs[static_cast<std::size_t>(owner.same_as)].view.data_size;
+            g_owner.glyphs.push_back(std::move(owner));
+            continue;
+        }
+
+        const std::uint64_t memo_key = glyph ? glyph_pixels_hash(*glyph) : 0;
+        if (const auto* hit = glyph ? g_memo.find(memo_key) : nullptr) {
+            owner.bytes = *hit;
+        } else if (const auto* shared = (glyph && !routes_file.empty()) ? g_routes.find(memo_key) : nullptr) {
+            owner.bytes = *shared;
+            g_memo.put(memo_key, owner.bytes);
+        } else if (glyph && glyph->data && glyph->width > 0 && glyph->height > 0) {
             int origin_x = 0;
             int origin_y = 0;
-            const std::vector<tiny_move> tiny = vectorize_glyph(*glyph, optimize_route, origin_x, origin_y);
+            const std::vector<tiny_move> tiny = strokes ? vectorize_strokes(*glyph, optimize_route, budget, origin_x, origin_y)
+                                                        : vectorize_dots(*glyph, optimize_route, budget, origin_x, origin_y);
             if (!tiny.empty()) {
                 if (tiny.size() > 255) {
                     plugin_set_err(errbuf, errbuf_len, "partner_tiny_transform: glyph has more than 255 moves");
@@ -193,7 +333,9 @@ int partner_tiny_transform(
                 for (const auto& move : tiny) {
                     owner.bytes.push_back(encode_tiny_move(move));
                 }
-            } 
+            }
+            g_memo.put(memo_key, owner.bytes);
+            if (!routes_file.empty()) g_routes.put(memo_key, owner.bytes);
         }
 
         owner.view.data_size = static_cast<std::uint16_t>(owner.bytes.size());
@@ -204,7 +346,8 @@ int partner_tiny_transform(
     g_owner.glyph_views.clear();
     g_owner.glyph_views.reserve(g_owner.glyphs.size());
     for (auto& glyph : g_owner.glyphs) {
-        glyph.view.data = glyph.bytes.empty() ? nullptr : glyph.bytes.data();
+        const auto& bytes = glyph.same_as < 0 ? glyph.bytes : g_owner.glyphs[static_cast<std::size_t>(glyph.same_as)].bytes;
+        glyph.view.data = bytes.empty() ? nullptr : bytes.data();
         g_owner.glyph_views.push_back(glyph.view);
     }
 
@@ -215,6 +358,11 @@ int partner_tiny_transform(
     g_owner.view.max_height_minus_one = u8_clamp(max_height - 1);
     g_owner.view.glyphs = g_owner.glyph_views.empty() ? nullptr : g_owner.glyph_views.data();
 
+    // a cache that cannot be written only costs the next run its reuse
+    if (!cache_file.empty()) g_memo.save(cache_file);
+    if (!routes_file.empty() && g_routes.fresh() != 0) g_routes.merge_into(routes_file, k_route_cache_entries);
+    g_memo.prune();
+
     font->user_data = &g_owner.view;
     return 0;
 }
@@ -229,12 +377,18 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_KIND_TRANSFORMER,
     &partner_tiny_transform,
     nullptr,
-    nullptr
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_BITMAP,
+    SNATCH_PAYLOAD_BITMAP | SNATCH_PAYLOAD_PARTNER_TINY,
+    0
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
@@ -6,19 +6,20 @@
 /// Copyright (c) 2026 Tomaz Stih
 /// SPDX-License-Identifier: GPL-2.0-only
 
+#include "snatch/bit_blit.h"
 #include "snatch/plugin.h"
 #include "snatch/plugin_util.h"
+#include "snatch/png_writer.h"
 
 #include <algorithm>
 #include <cmath>
 #include <cstdint>
 #include <array>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
-extern "C" {
-#include <stb_image_write.h>
-}
-
 namespace {
 
 /// \brief parse_positive.
@@ -46,42 +47,119 @@ inline void set_rgb_pixel(
     const std::array<unsigned char, 3>& color
 ) {
     if (x < 0 || x >= image_w || y < 0 || y >= image_h) return;
-    const size_t i = static_cast<size_t>((y * image_w + x) * 3);
+    const size_t i = (static_cast<size_t>(y) * static_cast<size_t>(image_w) + static_cast<size_t>(x)) * 3;
     img[i + 0] = color[0];
     img[i + 1] = color[1];
     img[i + 2] = color[2];
 }
 
-/// \brief draw_glyph.
-void draw_glyph(
-    std::vector<unsigned char>& img,
-    int image_w,
-    int image_h,
-    int dst_x,
-    int dst_y,
-    const snatch_glyph_bitmap& g
-) {
-    if (!g.data || g.width <= 0 || g.height <= 0 || g.stride_bytes <= 0) return;
-    for (int y = 0; y < g.height; ++y) {
-        const unsigned char* row = g.data + static_cast<size_t>(y * g.stride_bytes);
-        const int yy = dst_y + y;
-        if (yy < 0 || yy >= image_h) continue;
-        for (int x = 0; x < g.width; ++x) {
-            const int xx = dst_x + x;
-            if (xx < 0 || xx >= image_w) continue;
-            if (bit_is_set(row, x)) {
-                const size_t i = static_cast<size_t>((yy * image_w + xx) * 3);
-                img[i + 0] = 0;
-                img[i + 1] = 0;
-                img[i + 2] = 0;
-            }
+// Palette canvas packed the way PNG stores it: index 0 is the white paper,
+// 1 the black ink and 2 the grid colour when it is neither of those.
+struct indexed_canvas {
+    int width{0};
+    int height{0};
+    int bits{1};
+    size_t stride{0};
+    std::vector<std::uint8_t> pixels;
+
+    void set(int x, int y, int index) {
+        if (x < 0 || x >= width || y < 0 || y >= height) return;
+        const size_t bit = static_cast<size_t>(x) * static_cast<size_t>(bits);
+        std::uint8_t& b = pixels[static_cast<size_t>(y) * stride + bit / 8];
+        const int shift = 8 - bits - static_cast<int>(bit % 8);
+        const auto mask = static_cast<std::uint8_t>(((1u << bits) - 1u) << shift);
+        b = static_cast<std::uint8_t>((b & ~mask) | ((static_cast<unsigned>(index) << shift) & mask));
+    }
+
+    // every pixel of row y set to `index`, padding bits included
+    void fill_row(int y, int index) {
+        if (y < 0 || y >= height) return;
+        std::uint8_t pattern = 0;
+        for (int i = 0; i < 8; i += bits) pattern = static_cast<std::uint8_t>((pattern << bits) | index);
+        std::fill_n(pixels.begin() + static_cast<std::ptrdiff_t>(static_cast<size_t>(y) * stride), stride, pattern);
+    }
+};
+
+/// \brief spread_2bpp.
+// one 1bpp byte as two 2bpp bytes, each set bit becoming index 1
+std::array<std::uint16_t, 256> spread_2bpp() {
+    std::array<std::uint16_t, 256> t{};
+    for (unsigned v = 0; v < 256; ++v) {
+        std::uint16_t w = 0;
+        for (int b = 0; b < 8; ++b) {
+            if (v & (1u << b)) w = static_cast<std::uint16_t>(w | (1u << (2 * b)));
+        }
+        t[v] = w;
+    }
+    return t;
+}
+
+/// \brief widen_rows.
+// rows y0..y1 of the 1-bit ink layer re-packed at 2 bits per pixel into
+// `out`, ink keeping index 1
+void widen_rows(const indexed_canvas& ink, indexed_canvas& out, int y0, int y1) {
+    static const std::array<std::uint16_t, 256> spread = spread_2bpp();
+    for (int y = y0; y < y1; ++y) {
+        const std::uint8_t* src = ink.pixels.data() + static_cast<size_t>(y) * ink.stride;
+        std::uint8_t* dst = out.pixels.data() + static_cast<size_t>(y) * out.stride;
+        for (size_t i = 0; i < out.stride; ++i) {
+            const std::uint16_t w = spread[src[i / 2]];
+            dst[i] = static_cast<std::uint8_t>(i % 2 == 0 ? w >> 8 : w);
         }
     }
 }
 
+/// \brief parse_threads.
+// threads=0 (the default) sizes the pool from the image: small sheets are
+// not worth a thread
+int parse_threads(const plugin_kv_view& kv, int image_w, int image_h) {
+    constexpr int k_max_threads = 256;
+    int requested = 0;
+    if (const auto raw = kv.get("threads"); raw && !raw->empty()) {
+        const auto parsed = plugin_parse_int(*raw);
+        if (!parsed || *parsed < 0 || *parsed > k_max_threads) return -1;
+        requested = *parsed;
+    }
+    if (requested > 0) return requested;
+    constexpr size_t k_pixels_per_thread = size_t{1} << 20;
+    const size_t pixels = static_cast<size_t>(image_w) * static_cast<size_t>(image_h);
+    const unsigned hw = std::max(1u, std::thread::hardware_concurrency());
+    return static_cast<int>(std::clamp<size_t>(pixels / k_pixels_per_thread, 1, hw));
+}
+
+/// \brief run_bands.
+// fn(begin, end) over `workers` contiguous slices of 0..count, the first on
+// the calling thread
+template <typename Fn>
+void run_bands(int workers, int count, const Fn& fn) {
+    workers = std::clamp(workers, 1, std::max(count, 1));
+    const auto band = [&](int t) { fn(count * t / workers, count * (t + 1) / workers); };
+    std::vector<std::thread> threads;
+    for (int t = 1; t < workers; ++t) threads.emplace_back(band, t);
+    band(0);
+    for (auto& t : threads) t.join();
+}
+
+/// \brief fetch_glyphs.
+// the first `count` glyphs of a lazy font, each made now; false when one fails
+bool fetch_glyphs(const snatch_glyph_source& source, int count, std::vector<snatch_glyph_bitmap>& glyphs,
+                  std::vector<std::vector<unsigned char>>& rows) {
+    glyphs.assign(static_cast<std::size_t>(count), snatch_glyph_bitmap{});
+    rows.assign(static_cast<std::size_t>(count), {});
+    for (int i = 0; i < count; ++i) {
+        auto& g = glyphs[static_cast<std::size_t>(i)];
+        auto& r = rows[static_cast<std::size_t>(i)];
+        const long size = source.glyph(source.ctx, i, &g, nullptr, 0);
+        if (size < 0) return false;
+        r.resize(static_cast<std::size_t>(size));
+        if (size > 0 && source.glyph(source.ctx, i, &g, r.data(), r.size()) != size) return false;
+    }
+    return true;
+}
+
 } // namespace
 
-extern "C" int snatch_plugin_get(const snatch_plugin_info** out);
+extern "C" int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out);
 
 /// \brief export_png_grid.
 static int export_png_grid(
@@ -94,7 +172,7 @@ static int export_png_grid(
 ) {
     const plugin_kv_view kv{options, options_count};
 
-    if (!font || !font->bitmap_font || !font->bitmap_font->glyphs) {
+    if (!font || !font->bitmap_font || (!font->bitmap_font->glyphs && !font->bitmap_font->source)) {
         plugin_set_err(errbuf, errbuf_len, "png: bitmap font data missing");
         return 10;
     }
@@ -123,6 +201,24 @@ static int export_png_grid(
         }
         grid_color = *parsed;
     }
+    bool indexed = false;
+    if (const auto format = kv.get("pixel_format"); format && !format->empty()) {
+        if (*format == "indexed") {
+            indexed = true;
+        } else if (*format != "rgb") {
+            plugin_set_err(errbuf, errbuf_len, "png: invalid pixel_format; expected rgb or indexed");
+            return 16;
+        }
+    }
+    int compression = 6;
+    if (const auto raw = kv.get("compression"); raw && !raw->empty()) {
+        const auto parsed = plugin_parse_int(*raw);
+        if (!parsed || *parsed < 0 || *parsed > 9) {
+            plugin_set_err(errbuf, errbuf_len, "png: compression must be 0..9");
+            return 18;
+        }
+        compression = *parsed;
+    }
     if (padding <= 0) padding = 0;
     if (grid_thickness <= 0) grid_thickness = 0;
     if (cols <= 0 && rows <= 0) {
@@ -134,13 +230,27 @@ static int export_png_grid(
         rows = static_cast<int>(std::ceil(static_cast<double>(glyph_count) / cols));
     }
 
+    // a grid of fixed rows and columns shows the first rows * columns glyphs,
+    // and only those are made or measured
+    const int shown = static_cast<int>(std::min<long long>(glyph_count, static_cast<long long>(rows) * cols));
+    const snatch_glyph_bitmap* glyphs = bf.glyphs;
+    std::vector<snatch_glyph_bitmap> fetched;
+    std::vector<std::vector<unsigned char>> fetched_rows;
+    if (!glyphs) {
+        if (!fetch_glyphs(*bf.source, shown, fetched, fetched_rows)) {
+            plugin_set_err(errbuf, errbuf_len, "png: cannot make a glyph of the font");
+            return 10;
+        }
+        glyphs = fetched.data();
+    }
+
     int max_bearing_y = 0;
     int min_descender = 0;
     int cell_w = std::max(font->glyph_width, 1);
-    for (int i = 0; i < glyph_count; ++i) {
-        cell_w = std::max(cell_w, bf.glyphs[i].width);
-        max_bearing_y = std::max(max_bearing_y, bf.glyphs[i].bearing_y);
-        min_descender = std::min(min_descender, bf.glyphs[i].bearing_y - bf.glyphs[i].height);
+    for (int i = 0; i < shown; ++i) {
+        cell_w = std::max(cell_w, glyphs[i].width);
+        max_bearing_y = std::max(max_bearing_y, glyphs[i].bearing_y);
+        min_descender = std::min(min_descender, glyphs[i].bearing_y - glyphs[i].height);
     }
     const int cell_h = std::max(1, max_bearing_y - min_descender);
 
@@ -154,40 +264,96 @@ static int export_png_grid(
         return 13;
     }
 
-    std::vector<unsigned char> image(static_cast<size_t>(image_w * image_h * 3), 255); // white background
-
-    for (int i = 0; i < glyph_count; ++i) {
-        const int gx = (i % cols) * draw_w + padding;
-        const int gy = (i / cols) * draw_h + padding;
-        const int baseline_y = gy + max_bearing_y;
-        const int draw_x = gx;
-        const int draw_y = baseline_y - bf.glyphs[i].bearing_y;
-        draw_glyph(image, image_w, image_h, draw_x, draw_y, bf.glyphs[i]);
+    const int workers = parse_threads(kv, image_w, image_h);
+    if (workers < 0) {
+        plugin_set_err(errbuf, errbuf_len, "png: threads must be 0..256");
+        return 17;
     }
 
-    if (grid_thickness > 0) {
-        for (int c = 0; c <= cols; ++c) {
-            const int x0 = c * draw_w;
-            for (int t = 0; t < grid_thickness; ++t) {
-                const int x = x0 + t;
-                for (int y = 0; y < image_h; ++y) {
-                    set_rgb_pixel(image, image_w, image_h, x, y, grid_color);
-                }
-            }
+    // Glyphs are composed into a 1-bit ink layer whatever the output format.
+    // A glyph never leaves its cell, so each row of cells owns its own
+    // canvas rows and rows of cells can be drawn concurrently.
+    indexed_canvas ink;
+    ink.width = image_w;
+    ink.height = image_h;
+    ink.stride = (static_cast<size_t>(image_w) + 7) / 8;
+    ink.pixels.assign(ink.stride * static_cast<size_t>(image_h), 0);
+    const bitmap_1bpp ink_view{ink.pixels.data(), image_w, image_h, ink.stride};
+    run_bands(workers, rows, [&](int r0, int r1) {
+        for (int i = r0 * cols; i < std::min(shown, r1 * cols); ++i) {
+            const int gx = (i % cols) * draw_w + padding;
+            const int gy = (i / cols) * draw_h + padding;
+            const int baseline_y = gy + max_bearing_y;
+            blit_1bpp(ink_view, gx, baseline_y - glyphs[i].bearing_y, glyph_view_1bpp(glyphs[i]), raster_op::bit_or);
         }
-        for (int r = 0; r <= rows; ++r) {
-            const int y0 = r * draw_h;
-            for (int t = 0; t < grid_thickness; ++t) {
-                const int y = y0 + t;
+    });
+
+    // Grid lines start every draw_w / draw_h pixels and are drawn over the ink.
+    const auto grid_row = [&](int y) { return grid_thickness > 0 && y % draw_h < grid_thickness; };
+    const auto for_grid_columns = [&](const auto& put) {
+        if (grid_thickness <= 0) return;
+        for (int x0 = 0; x0 < image_w; x0 += draw_w) {
+            for (int x = x0; x < std::min(image_w, x0 + grid_thickness); ++x) put(x);
+        }
+    };
+
+    png_image_view view;
+    view.width = image_w;
+    view.height = image_h;
+    std::vector<unsigned char> image;
+    indexed_canvas canvas;
+    if (indexed) {
+        // A black or white grid fits the 1-bit palette; any other colour
+        // needs a third entry and so 2 bits per pixel.
+        const bool grid_white = grid_color == std::array<unsigned char, 3>{255, 255, 255};
+        const bool grid_black = grid_color == std::array<unsigned char, 3>{0, 0, 0};
+        const int grid_index = grid_white ? 0 : grid_black ? 1 : 2;
+        if (grid_thickness > 0 && grid_index == 2) {
+            canvas.width = image_w;
+            canvas.height = image_h;
+            canvas.bits = 2;
+            canvas.stride = (static_cast<size_t>(image_w) * 2 + 7) / 8;
+            canvas.pixels.assign(canvas.stride * static_cast<size_t>(image_h), 0);
+        } else {
+            canvas = std::move(ink);
+        }
+        run_bands(workers, image_h, [&](int y0, int y1) {
+            if (canvas.bits == 2) widen_rows(ink, canvas, y0, y1);
+            for (int y = y0; y < y1; ++y) {
+                if (grid_row(y)) canvas.fill_row(y, grid_index);
+                else for_grid_columns([&](int x) { canvas.set(x, y, grid_index); });
+            }
+        });
+        view.bit_depth = canvas.bits;
+        view.color_type = 3;
+        view.rows = canvas.pixels.data();
+        view.stride = canvas.stride;
+        view.palette = {{255, 255, 255}, {0, 0, 0}};
+        if (canvas.bits == 2) view.palette.push_back({grid_color[0], grid_color[1], grid_color[2]});
+    } else {
+        image.assign(static_cast<size_t>(image_w) * static_cast<size_t>(image_h) * 3, 255); // white background
+        run_bands(workers, image_h, [&](int y0, int y1) {
+            for (int y = y0; y < y1; ++y) {
+                if (grid_row(y)) {
+                    for (int x = 0; x < image_w; ++x) set_rgb_pixel(image, image_w, image_h, x, y, grid_color);
+                    continue;
+                }
+                const unsigned char* row = ink.pixels.data() + static_cast<size_t>(y) * ink.stride;
                 for (int x = 0; x < image_w; ++x) {
-                    set_rgb_pixel(image, image_w, image_h, x, y, grid_color);
+                    if (bit_is_set(row, x)) set_rgb_pixel(image, image_w, image_h, x, y, {0, 0, 0});
                 }
+                for_grid_columns([&](int x) { set_rgb_pixel(image, image_w, image_h, x, y, grid_color); });
             }
-        }
+        });
+        view.bit_depth = 8;
+        view.color_type = 2;
+        view.rows = image.data();
+        view.stride = static_cast<size_t>(image_w) * 3;
     }
 
-    if (stbi_write_png(output_path, image_w, image_h, 3, image.data(), image_w * 3) == 0) {
-        plugin_set_err(errbuf, errbuf_len, "png: failed to write png");
+    std::string error;
+    if (!png_write(output_path, view, compression, static_cast<unsigned>(workers), error)) {
+        plugin_set_err(errbuf, errbuf_len, error);
         return 14;
     }
     return 0;
@@ -202,10 +368,17 @@ static const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_ABI_VERSION,
     SNATCH_PLUGIN_KIND_EXPORTER,
     nullptr,
-    &export_png_grid
+    &export_png_grid,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_BITMAP,
+    0,
+    SNATCH_CAP_THREAD_SAFE | SNATCH_CAP_LAZY_GLYPHS
 };
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
@@ -14,7 +14,10 @@
 #include <algorithm>
 #include <cstddef>
 #include <cstdint>
+#include <deque>
 #include <fstream>
+#include <map>
+#include <string>
 #include <vector>
 
 namespace {
@@ -99,11 +102,24 @@ std::vector<std::uint8_t> serialize_partner_tiny(
     out.push_back(static_cast<std::uint8_t>(first));
     out.push_back(static_cast<std::uint8_t>(last));
 
+    // each glyph's record, or the earlier record it aliases in the offset table
+    std::vector<std::size_t> record(glyph_count);
     std::vector<std::uint16_t> offsets;
     offsets.reserve(glyph_count);
     std::uint32_t offset = 5u + static_cast<std::uint32_t>(glyph_count * 2u);
     for (std::size_t i = 0; i < glyph_count; ++i) {
         const auto& g = tiny->glyphs[i];
+        record[i] = i;
+        for (std::size_t j = 0; j < i && g.data; ++j) {
+            if (record[j] == j && snatch_partner_tiny_same_record(tiny->glyphs[j], g)) {
+                record[i] = j;
+                break;
+            }
+        }
+        if (record[i] != i) {
+            offsets.push_back(offsets[record[i]]);
+            continue;
+        }
         if (offset > 0xFFFFu) {
             plugin_set_err(errbuf, errbuf_len, "raw_bin: partner tiny stream too large (>64KiB)");
             return {};
@@ -119,6 +135,7 @@ std::vector<std::uint8_t> serialize_partner_tiny(
 
     constexpr std::uint8_t kGlyphClassTinyBits = 1u << 5u;
     for (std::size_t i = 0; i < glyph_count; ++i) {
+        if (record[i] != i) continue;
         const auto& g = tiny->glyphs[i];
         if (g.data_size > 257u) {
             plugin_set_err(errbuf, errbuf_len, "raw_bin: partner tiny glyph has more than 255 moves");
@@ -145,6 +162,16 @@ const snatch_glyph_bitmap* find_glyph_by_codepoint(const snatch_bitmap_font& bf,
     return nullptr;
 }
 
+/// \brief append_rows.
+void append_rows(const snatch_glyph_bitmap& glyph, std::vector<std::uint8_t>& out) {
+    if (!glyph.data || glyph.stride_bytes <= 0) return;
+    const int rows_to_copy = std::max(0, glyph.height);
+    for (int y = 0; y < rows_to_copy; ++y) {
+        const auto* src_row = glyph.data + static_cast<std::size_t>(y * glyph.stride_bytes);
+        out.insert(out.end(), src_row, src_row + glyph.stride_bytes);
+    }
+}
+
 /// \brief export_raw_bin.
 int export_raw_bin(
     const snatch_font* font,
@@ -186,14 +213,7 @@ int export_raw_bin(
         packed.reserve(static_cast<std::size_t>(bf.glyph_count) * static_cast<std::size_t>(std::max(font->glyph_height, 1)));
 
         for (int cp = first; cp <= last; ++cp) {
-            const snatch_glyph_bitmap* glyph = find_glyph_by_codepoint(bf, cp);
-            if (!glyph || !glyph->data || glyph->stride_bytes <= 0) continue;
-
-            const int rows_to_copy = std::max(0, glyph->height);
-            for (int y = 0; y < rows_to_copy; ++y) {
-                const auto* src_row = glyph->data + static_cast<std::size_t>(y * glyph->stride_bytes);
-                packed.insert(packed.end(), src_row, src_row + glyph->stride_bytes);
-            }
+            if (const snatch_glyph_bitmap* glyph = find_glyph_by_codepoint(bf, cp)) append_rows(*glyph, packed);
         }
     }
 
@@ -211,6 +231,144 @@ int export_raw_bin(
     return 0;
 }
 
+// Streaming export writes each glyph's rows as soon as it is next in
+// codepoint order; early arrivals wait in `pending`. Fonts carrying partner
+// user_data are still serialized as a whole at end().
+struct raw_bin_stream {
+    std::string output_path;
+    std::deque<std::string> option_storage;
+    std::vector<snatch_kv> options;
+    char* errbuf{nullptr};
+    unsigned errbuf_len{0};
+
+    std::ofstream out;
+    snatch_font header{};
+    bool whole{false};
+    int next{0};
+    int last{-1};
+    std::map<int, std::vector<std::uint8_t>> pending;
+};
+
+/// \brief write_bytes.
+int write_bytes(raw_bin_stream& s, const std::vector<std::uint8_t>& bytes) {
+    s.out.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+    if (!s.out.good()) {
+        plugin_set_err(s.errbuf, s.errbuf_len, "raw_bin: failed while writing output");
+        return 14;
+    }
+    return 0;
+}
+
+/// \brief stream_begin.
+int stream_begin(void* ctx, const snatch_font* header) {
+    auto& s = *static_cast<raw_bin_stream*>(ctx);
+    s.header = *header;
+    s.whole = partner_tiny_data_from_user_data(header) || partner_data_from_user_data(header);
+    if (!s.whole) {
+        if (header->first_codepoint < 0 || header->last_codepoint < header->first_codepoint || header->last_codepoint > 0x10FFFF) {
+            plugin_set_err(s.errbuf, s.errbuf_len, "raw_bin: invalid codepoint range");
+            return 12;
+        }
+        s.next = header->first_codepoint;
+        s.last = header->last_codepoint;
+    }
+    s.out.open(s.output_path, std::ios::binary | std::ios::trunc);
+    if (!s.out.is_open()) {
+        plugin_set_err(s.errbuf, s.errbuf_len, "raw_bin: cannot open output file");
+        return 13;
+    }
+    return 0;
+}
+
+/// \brief stream_glyph.
+int stream_glyph(void* ctx, const snatch_glyph_bitmap* glyph) {
+    auto& s = *static_cast<raw_bin_stream*>(ctx);
+    // like the whole-font path, the first glyph of a codepoint wins
+    if (s.whole || glyph->codepoint < s.next || glyph->codepoint > s.last) return 0;
+    std::vector<std::uint8_t> rows;
+    append_rows(*glyph, rows);
+    if (glyph->codepoint != s.next) {
+        s.pending.emplace(glyph->codepoint, std::move(rows));
+        return 0;
+    }
+    if (const int rc = write_bytes(s, rows); rc != 0) return rc;
+    ++s.next;
+    for (auto it = s.pending.begin(); it != s.pending.end() && it->first == s.next; it = s.pending.erase(it)) {
+        if (const int rc = write_bytes(s, it->second); rc != 0) return rc;
+        ++s.next;
+    }
+    return 0;
+}
+
+/// \brief stream_end.
+int stream_end(void* ctx, const snatch_font* summary) {
+    auto& s = *static_cast<raw_bin_stream*>(ctx);
+    if (s.whole) {
+        std::vector<std::uint8_t> packed;
+        if (const auto* tiny = partner_tiny_data_from_user_data(&s.header)) {
+            const plugin_kv_view kv{s.options.data(), static_cast<unsigned>(s.options.size())};
+            packed = serialize_partner_tiny(summary, tiny, kv, s.errbuf, s.errbuf_len);
+            if (packed.empty()) return 15;
+        } else if (const auto* partner = partner_data_from_user_data(&s.header)) {
+            packed.assign(partner->bytes, partner->bytes + partner->size);
+        }
+        return write_bytes(s, packed);
+    }
+    // codepoints that never arrived are skipped, as in the whole-font path
+    for (const auto& [cp, rows] : s.pending) {
+        if (const int rc = write_bytes(s, rows); rc != 0) return rc;
+    }
+    s.pending.clear();
+    s.out.flush();
+    if (!s.out.good()) {
+        plugin_set_err(s.errbuf, s.errbuf_len, "raw_bin: failed while writing output");
+        return 14;
+    }
+    return 0;
+}
+
+/// \brief stream_close.
+void stream_close(void* ctx) {
+    delete static_cast<raw_bin_stream*>(ctx);
+}
+
+/// \brief stream_export_raw_bin.
+int stream_export_raw_bin(
+    const char* output_path,
+    const snatch_kv* options,
+    unsigned options_count,
+    snatch_glyph_sink* out_sink,
+    char* errbuf,
+    unsigned errbuf_len
+) {
+    if (!output_path || output_path[0] == '\0') {
+        plugin_set_err(errbuf, errbuf_len, "raw_bin: output path is empty");
+        return 11;
+    }
+    if (!out_sink) {
+        plugin_set_err(errbuf, errbuf_len, "raw_bin: out_sink is null");
+        return 10;
+    }
+
+    auto* s = new raw_bin_stream;
+    s->output_path = output_path;
+    for (unsigned i = 0; i < options_count; ++i) {
+        if (!options[i].key || !options[i].value) continue;
+        const char* key = s->option_storage.emplace_back(options[i].key).c_str();
+        const char* value = s->option_storage.emplace_back(options[i].value).c_str();
+        s->options.push_back({key, value});
+    }
+    s->errbuf = errbuf;
+    s->errbuf_len = errbuf_len;
+
+    out_sink->ctx = s;
+    out_sink->begin = &stream_begin;
+    out_sink->glyph = &stream_glyph;
+    out_sink->end = &stream_end;
+    out_sink->close = &stream_close;
+    return 0;
+}
+
 const snatch_plugin_info k_info = {
     "raw_bin",
     "Exports continuous raw glyph bitmap bytes (.bin)",
@@ -221,12 +379,18 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_KIND_EXPORTER,
     nullptr,
     &export_raw_bin,
-    nullptr
+    nullptr,
+    nullptr,
+    &stream_export_raw_bin,
+    nullptr,
+    SNATCH_PAYLOAD_BITMAP | SNATCH_PAYLOAD_PARTNER_BITMAP | SNATCH_PAYLOAD_PARTNER_TINY,
+    0,
+    SNATCH_CAP_THREAD_SAFE
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
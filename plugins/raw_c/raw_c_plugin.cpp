@@ -7,6 +7,7 @@
 /// SPDX-License-Identifier: GPL-2.0-only
 
 #include "snatch_plugins/partner_bitmap_transform.h"
+#include "snatch/bit_blit.h"
 #include "snatch/plugin.h"
 #include "snatch/plugin_util.h"
 
@@ -33,13 +34,6 @@ const snatch_partner_bitmap_data* partner_data_from_user_data(const snatch_font*
     return data;
 }
 
-/// \brief bit_is_set.
-bool bit_is_set(const unsigned char* row, int x) {
-    const int byte_index = x / 8;
-    const int bit_index = 7 - (x % 8);
-    return (row[byte_index] & (1u << bit_index)) != 0;
-}
-
 /// \brief find_glyph_by_codepoint.
 const snatch_glyph_bitmap* find_glyph_by_codepoint(const snatch_bitmap_font& bf, int codepoint) {
     for (int i = 0; i < bf.glyph_count; ++i) {
@@ -130,20 +124,10 @@ int export_raw_c(
             const std::size_t glyph_index = static_cast<std::size_t>(cp - first);
             const std::size_t glyph_base = glyph_index * glyph_bytes;
             const snatch_glyph_bitmap* glyph = find_glyph_by_codepoint(bf, cp);
-            if (!glyph || !glyph->data || glyph->stride_bytes <= 0) continue;
-
-            const int rows_to_copy = std::min(*rows, glyph->height);
-            const int cols_to_copy = std::min(max_width_bits, glyph->width);
-            for (int y = 0; y < rows_to_copy; ++y) {
-                const auto* src_row = glyph->data + static_cast<std::size_t>(y * glyph->stride_bytes);
-                auto* dst_row = packed.data() + glyph_base + static_cast<std::size_t>(y * (*bytes_per_row));
-                for (int x = 0; x < cols_to_copy; ++x) {
-                    if (!bit_is_set(src_row, x)) continue;
-                    const int byte_index = x / 8;
-                    const int bit_index = 7 - (x % 8);
-                    dst_row[byte_index] = static_cast<std::uint8_t>(dst_row[byte_index] | (1u << bit_index));
-                }
-            }
+            if (!glyph) continue;
+
+            const bitmap_1bpp cell{packed.data() + glyph_base, max_width_bits, *rows, static_cast<std::size_t>(*bytes_per_row)};
+            blit_1bpp(cell, 0, 0, glyph_view_1bpp(*glyph), raster_op::copy);
         }
     }
 
@@ -205,12 +189,19 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_ABI_VERSION,
     SNATCH_PLUGIN_KIND_EXPORTER,
     nullptr,
-    &export_raw_c
+    &export_raw_c,
+    nullptr,
+    nullptr,
+    nullptr,
+    nullptr,
+    SNATCH_PAYLOAD_BITMAP | SNATCH_PAYLOAD_PARTNER_BITMAP,
+    0,
+    SNATCH_CAP_THREAD_SAFE
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
@@ -12,6 +12,8 @@
 #include "snatch/extracted_font.h"
 #include "snatch/ttf_extractor.h"
 
+#include <algorithm>
+#include <memory>
 #include <optional>
 #include <string>
 
@@ -20,6 +22,10 @@ namespace {
 struct ttf_extract_owner {
     extracted_font font{};
     snatch_font view{};
+    // lazy=true: glyphs come from here instead of font.glyphs
+    std::unique_ptr<ttf_lazy_font> lazy;
+    snatch_glyph_source source{};
+    snatch_bitmap_font lazy_view{};
 };
 
 static ttf_extract_owner g_owner;
@@ -43,27 +49,16 @@ bool parse_proportional(const plugin_kv_view& kv, bool fallback, char* errbuf, u
     return plugin_parse_bool(kv.get("proportional"), fallback);
 }
 
-/// \brief extract_ttf.
-int extract_ttf(
-    const char* input_path,
-    const snatch_kv* options,
-    unsigned options_count,
-    snatch_font* out_font,
-    char* errbuf,
-    unsigned errbuf_len
-) {
+/// \brief parse_options.
+int parse_options(const char* input_path, const snatch_kv* options, unsigned options_count,
+                  ttf_extract_options& opt, char* errbuf, unsigned errbuf_len) {
     if (!input_path || input_path[0] == '\0') {
         plugin_set_err(errbuf, errbuf_len, "ttf_extractor: input path is empty");
         return 10;
     }
-    if (!out_font) {
-        plugin_set_err(errbuf, errbuf_len, "ttf_extractor: out_font is null");
-        return 11;
-    }
 
     const plugin_kv_view kv{options, options_count};
 
-    ttf_extract_options opt{};
     opt.input_file = input_path;
 
     if (const auto v = parse_int_kv(kv, "first_ascii"); v.has_value()) opt.first_ascii = *v;
@@ -72,6 +67,74 @@ int extract_ttf(
 
     opt.proportional = parse_proportional(kv, false, errbuf, errbuf_len);
     if (errbuf && errbuf[0] != '\0') return 12;
+    return 0;
+}
+
+/// \brief lazy_glyph.
+long lazy_glyph(void* ctx, int index, snatch_glyph_bitmap* out, unsigned char* buf, unsigned long buf_size) {
+    auto& lazy = *static_cast<ttf_lazy_font*>(ctx);
+    extracted_glyph g;
+    std::string err;
+    if (!out || !lazy.glyph(index, g, err)) return -1;
+    *out = g.view;
+    out->data = nullptr;
+    if (g.bitmap.size() <= buf_size && buf && !g.bitmap.empty()) {
+        std::copy(g.bitmap.begin(), g.bitmap.end(), buf);
+        out->data = buf;
+    }
+    return static_cast<long>(g.bitmap.size());
+}
+
+/// \brief extract_lazy.
+// lazy=true: only the header is read now, each glyph is rasterized when a
+// consumer first asks for it; cache=N glyphs are kept
+int extract_lazy(const ttf_extract_options& opt, const plugin_kv_view& kv, snatch_font* out_font, char* errbuf, unsigned errbuf_len) {
+    int capacity = 1024;
+    if (const auto raw = kv.get("cache"); raw && !raw->empty()) {
+        const auto parsed = plugin_parse_int(*raw);
+        if (!parsed || *parsed < 1) {
+            plugin_set_err(errbuf, errbuf_len, "ttf_extractor: cache must be a positive glyph count");
+            return 12;
+        }
+        capacity = *parsed;
+    }
+
+    auto lazy = std::make_unique<ttf_lazy_font>(static_cast<std::size_t>(capacity));
+    extracted_font header;
+    std::string extract_err;
+    if (!lazy->open(opt, header, extract_err)) {
+        plugin_set_err(errbuf, errbuf_len, std::string("ttf_extractor: ") + extract_err);
+        return 13;
+    }
+
+    g_owner.font = std::move(header);
+    g_owner.lazy = std::move(lazy);
+    g_owner.source = {g_owner.lazy.get(), &lazy_glyph};
+    g_owner.lazy_view = {g_owner.lazy->glyph_count(), nullptr, &g_owner.source};
+    g_owner.view = g_owner.font.as_plugin_font();
+    g_owner.view.bitmap_font = &g_owner.lazy_view;
+    *out_font = g_owner.view;
+    return 0;
+}
+
+/// \brief extract_ttf.
+int extract_ttf(
+    const char* input_path,
+    const snatch_kv* options,
+    unsigned options_count,
+    snatch_font* out_font,
+    char* errbuf,
+    unsigned errbuf_len
+) {
+    ttf_extract_options opt{};
+    if (const int rc = parse_options(input_path, options, options_count, opt, errbuf, errbuf_len); rc != 0) return rc;
+    if (!out_font) {
+        plugin_set_err(errbuf, errbuf_len, "ttf_extractor: out_font is null");
+        return 11;
+    }
+
+    const plugin_kv_view kv{options, options_count};
+    if (plugin_parse_bool(kv.get("lazy"), false)) return extract_lazy(opt, kv, out_font, errbuf, errbuf_len);
 
     ttf_extractor extractor;
     extracted_font extracted;
@@ -82,11 +145,59 @@ int extract_ttf(
     }
 
     g_owner.font = std::move(extracted);
+    g_owner.lazy.reset();
     g_owner.view = g_owner.font.as_plugin_font();
     *out_font = g_owner.view;
     return 0;
 }
 
+/// \brief stream_header.
+snatch_font stream_header(const extracted_font& header) {
+    snatch_font f = header.as_plugin_font();
+    f.bitmap_font = nullptr;
+    return f;
+}
+
+/// \brief stream_extract_ttf.
+// hands each glyph to the sink as soon as it is rasterized; nothing is kept
+int stream_extract_ttf(
+    const char* input_path,
+    const snatch_kv* options,
+    unsigned options_count,
+    const snatch_glyph_sink* sink,
+    char* errbuf,
+    unsigned errbuf_len
+) {
+    ttf_extract_options opt{};
+    if (const int rc = parse_options(input_path, options, options_count, opt, errbuf, errbuf_len); rc != 0) return rc;
+    if (!sink) {
+        plugin_set_err(errbuf, errbuf_len, "ttf_extractor: sink is null");
+        return 11;
+    }
+
+    int sink_rc = 0;
+    const auto on_begin = [&](const extracted_font& header) {
+        const snatch_font f = stream_header(header);
+        sink_rc = sink->begin(sink->ctx, &f);
+        return sink_rc == 0;
+    };
+    const auto on_glyph = [&](extracted_glyph& g) {
+        sink_rc = sink->glyph(sink->ctx, &g.view);
+        return sink_rc == 0;
+    };
+
+    ttf_extractor extractor;
+    extracted_font header;
+    std::string extract_err;
+    if (!extractor.extract_each(opt, header, on_begin, on_glyph, extract_err)) {
+        if (sink_rc != 0) return sink_rc;
+        plugin_set_err(errbuf, errbuf_len, std::string("ttf_extractor: ") + extract_err);
+        return 13;
+    }
+    const snatch_font summary = stream_header(header);
+    return sink->end(sink->ctx, &summary);
+}
+
 const snatch_plugin_info k_info = {
     "ttf_extractor",
     "Extracts bitmap glyphs from TTF input",
@@ -97,12 +208,18 @@ const snatch_plugin_info k_info = {
     SNATCH_PLUGIN_KIND_EXTRACTOR,
     nullptr,
     nullptr,
-    &extract_ttf
+    &extract_ttf,
+    nullptr,
+    nullptr,
+    &stream_extract_ttf,
+    0,
+    SNATCH_PAYLOAD_BITMAP,
+    0
 };
 
 } // namespace
 
-extern "C" SNATCH_PLUGIN_API int snatch_plugin_get(const snatch_plugin_info** out) {
+extern "C" SNATCH_PLUGIN_API int SNATCH_PLUGIN_ENTRY(const snatch_plugin_info** out) {
     if (!out) return 1;
     *out = &k_info;
     return 0;
@@ -11,44 +11,24 @@
 #include <vector>
 #include <cstdlib>
 #include <string>
-#include <sstream>
-#include <array>
 #include <cctype>
 #include <algorithm>
-#include <optional>
-#include <string_view>
+#include <fstream>
+#include <sstream>
 #include "snatch/cli_parser.h"
+#include "snatch/job_server.h"
+#include "snatch/kv_params.h"
 #include "snatch/options.h"
+#include "snatch/pipeline.h"
+#include "snatch/pipeline_watch.h"
 #include "snatch/plugin.h"
 #include "snatch/plugin_manager.h"
 
-/// \brief parse_kv_pairs.
-static std::vector<std::array<std::string, 2>> parse_kv_pairs(const std::string& raw) {
-    std::vector<std::array<std::string, 2>> pairs;
-    if (raw.empty()) return pairs;
-
-    std::stringstream ss(raw);
-    std::string token;
-    while (std::getline(ss, token, ',')) {
-        const auto is_space = [](unsigned char c) { return std::isspace(c) != 0; };
-        while (!token.empty() && is_space(static_cast<unsigned char>(token.front()))) token.erase(token.begin());
-        while (!token.empty() && is_space(static_cast<unsigned char>(token.back()))) token.pop_back();
-        if (token.empty()) continue;
-        const auto eq = token.find('=');
-        if (eq == std::string::npos) {
-            pairs.push_back({token, ""});
-        } else {
-            std::string key = token.substr(0, eq);
-            std::string value = token.substr(eq + 1);
-            while (!key.empty() && is_space(static_cast<unsigned char>(key.front()))) key.erase(key.begin());
-            while (!key.empty() && is_space(static_cast<unsigned char>(key.back()))) key.pop_back();
-            while (!value.empty() && is_space(static_cast<unsigned char>(value.front()))) value.erase(value.begin());
-            while (!value.empty() && is_space(static_cast<unsigned char>(value.back()))) value.pop_back();
-            pairs.push_back({std::move(key), std::move(value)});
-        }
-    }
-    return pairs;
-}
+#ifdef SNATCH_STATIC_PLUGINS
+// generated by plugins/CMakeLists.txt
+extern const builtin_plugin snatch_builtin_plugins[];
+extern const std::size_t snatch_builtin_plugin_count;
+#endif
 
 /// \brief print_kv_pairs.
 static void print_kv_pairs(const char* label, const std::string& raw) {
@@ -70,17 +50,15 @@ static void print_options(const snatch_options& opt) {
     std::cout << "  transformer: " << (opt.transformer.empty() ? "(none)" : opt.transformer) << "\n";
     std::cout << "  transformer params: " << (opt.transformer_parameters.empty() ? "(none)" : opt.transformer_parameters) << "\n";
     print_kv_pairs("transformer params", opt.transformer_parameters);
-    std::cout << "  exporter: " << (opt.exporter.empty() ? "(none)" : opt.exporter) << "\n";
-    std::cout << "  exporter params: " << (opt.exporter_parameters.empty() ? "(none)" : opt.exporter_parameters) << "\n";
-    print_kv_pairs("exporter params", opt.exporter_parameters);
-}
-
-/// \brief trim_copy.
-static std::string trim_copy(std::string s) {
-    const auto is_space = [](unsigned char c) { return std::isspace(c) != 0; };
-    while (!s.empty() && is_space(static_cast<unsigned char>(s.front()))) s.erase(s.begin());
-    while (!s.empty() && is_space(static_cast<unsigned char>(s.back()))) s.pop_back();
-    return s;
+    if (opt.exporters.empty()) {
+        std::cout << "  exporter: (none)\n";
+        std::cout << "  exporter params: (none)\n";
+    }
+    for (const auto& e : opt.exporters) {
+        std::cout << "  exporter: " << (e.exporter.empty() ? "(none)" : e.exporter) << "\n";
+        std::cout << "  exporter params: " << (e.exporter_parameters.empty() ? "(none)" : e.exporter_parameters) << "\n";
+        print_kv_pairs("exporter params", e.exporter_parameters);
+    }
 }
 
 /// \brief to_lower_copy.
@@ -105,14 +83,6 @@ struct extractor_resolution {
     std::string error;
 };
 
-/// \brief find_kv_value.
-static std::optional<std::string> find_kv_value(const std::string& raw, std::string_view key) {
-    for (const auto& pair : parse_kv_pairs(raw)) {
-        if (pair[0] == key) return pair[1];
-    }
-    return std::nullopt;
-}
-
 /// \brief resolve_extractor_plugin.
 static extractor_resolution resolve_extractor_plugin(const snatch_options& opt, const std::string& input_path) {
     extractor_resolution out{};
@@ -128,6 +98,10 @@ static extractor_resolution resolve_extractor_plugin(const snatch_options& opt,
         out.plugin_name = "ttf_extractor";
         return out;
     }
+    if (ext == ".bdf" || ext == ".pcf") {
+        out.plugin_name = "bdf_extractor";
+        return out;
+    }
     if (ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".gif" ||
         ext == ".tga" || ext == ".webp") {
         out.plugin_name = "image_extractor";
@@ -140,10 +114,10 @@ static extractor_resolution resolve_extractor_plugin(const snatch_options& opt,
 }
 
 /// \brief resolve_exporter_plugin.
-static exporter_resolution resolve_exporter_plugin(const snatch_options& opt) {
+static exporter_resolution resolve_exporter_plugin(const std::string& requested) {
     exporter_resolution out{};
-    if (opt.exporter.empty() || !is_export_type_token(opt.exporter)) {
-        const std::string exporter = to_lower_copy(opt.exporter);
+    if (requested.empty() || !is_export_type_token(requested)) {
+        const std::string exporter = to_lower_copy(requested);
         if (exporter == "partner_asm") {
             out.plugin_name = "partner_sdcc_asm_tiny";
         } else if (exporter == "partner_bitmap_asm") {
@@ -153,12 +127,12 @@ static exporter_resolution resolve_exporter_plugin(const snatch_options& opt) {
         } else if (exporter == "partner-sdcc-asm-bitmap" || exporter == "partner_bitmap_asm_sdcc") {
             out.plugin_name = "partner_sdcc_asm_bitmap";
         } else {
-            out.plugin_name = opt.exporter; // already concrete plugin name (or empty)
+            out.plugin_name = requested; // already concrete plugin name (or empty)
         }
         return out;
     }
 
-    const std::string type = to_lower_copy(opt.exporter);
+    const std::string type = to_lower_copy(requested);
     if (type == "asm") {
         out.error =
             "exporter 'asm' is ambiguous; use concrete exporter name: "
@@ -180,49 +154,118 @@ static exporter_resolution resolve_exporter_plugin(const snatch_options& opt) {
     return out;
 }
 
-/// \brief add_kv.
-static void add_kv(
-    std::vector<std::array<std::string, 2>>& storage,
-    std::vector<snatch_kv>& out,
-    std::string key,
-    std::string value
-) {
-    storage.push_back({std::move(key), std::move(value)});
-    auto& pair = storage.back();
-    out.push_back({pair[0].c_str(), pair[1].c_str()});
+/// \brief plugin_search_dirs.
+static std::vector<std::filesystem::path> plugin_search_dirs(const snatch_options& opt) {
+    std::vector<std::filesystem::path> plugin_dirs;
+    if (!opt.plugin_dir.empty()) {
+        plugin_dirs.push_back(opt.plugin_dir);
+    }
+
+    if (const char* env_plugin_dir = std::getenv("SNATCH_PLUGIN_DIR");
+        env_plugin_dir && env_plugin_dir[0] != '\0') {
+        plugin_dirs.emplace_back(env_plugin_dir);
+    }
+
+#ifdef SNATCH_DEFAULT_PLUGIN_DIR
+    plugin_dirs.emplace_back(SNATCH_DEFAULT_PLUGIN_DIR);
+#else
+    plugin_dirs.emplace_back("/usr/libexec/snatch/plugins");
+#endif
+
+    if (const char* home = std::getenv("HOME"); home && home[0] != '\0') {
+        plugin_dirs.emplace_back(std::filesystem::path(home) / ".local/lib/snatch/plugins");
+    }
+    return plugin_dirs;
 }
 
-/// \brief append_kv_params.
-static void append_kv_params(
-    const std::string& raw,
-    std::vector<std::array<std::string, 2>>& storage,
-    std::vector<snatch_kv>& out,
-    std::initializer_list<std::string_view> skip_keys = {}
-) {
-    if (raw.empty()) return;
-    std::stringstream ss(raw);
-    std::string token;
-    while (std::getline(ss, token, ',')) {
-        token = trim_copy(token);
-        if (token.empty()) continue;
-        const auto eq = token.find('=');
-        if (eq == std::string::npos) {
-            bool skip = false;
-            for (const auto& k : skip_keys) {
-                if (token == k) { skip = true; break; }
-            }
-            if (skip) continue;
-            add_kv(storage, out, token, "");
-            continue;
-        }
-        auto key = trim_copy(token.substr(0, eq));
-        bool skip = false;
-        for (const auto& k : skip_keys) {
-            if (key == k) { skip = true; break; }
+/// \brief print_plugins.
+static void print_plugins(const plugin_manager& pm) {
+    std::cout << "  plugins loaded: " << pm.plugins().size() << "\n";
+    for (const auto& p : pm.plugins()) {
+        const char* name = !p.name.empty() ? p.name.c_str() : "(unnamed)";
+        const char* kind = "(unknown)";
+        const char* format = "(n/a)";
+        const char* standard = "(n/a)";
+        if (p.kind == SNATCH_PLUGIN_KIND_EXPORTER) kind = "exporter";
+        else if (p.kind == SNATCH_PLUGIN_KIND_TRANSFORMER) kind = "transformer";
+        else if (p.kind == SNATCH_PLUGIN_KIND_EXTRACTOR) kind = "extractor";
+        if (p.kind == SNATCH_PLUGIN_KIND_EXPORTER) {
+            format = !p.format.empty() ? p.format.c_str() : "(unspecified)";
+            standard = !p.standard.empty() ? p.standard.c_str() : "(unspecified)";
         }
-        if (skip) continue;
-        add_kv(storage, out, std::move(key), trim_copy(token.substr(eq + 1)));
+        std::cout << "    - " << name << " (" << kind << ", format=" << format << ", standard=" << standard << ") ["
+                  << p.path.string() << "]\n";
+    }
+}
+
+/// \brief run_pipeline_file.
+static int run_pipeline_file(const snatch_options& opt) {
+    pipeline_graph graph;
+    std::string err;
+    if (!pipeline_graph::load(opt.pipeline_file, graph, err) || !graph.validate(err)) {
+        std::cerr << "error: " << err << "\n";
+        return 3;
+    }
+
+    plugin_manager pm;
+    pm.load_named_from_dirs_in_order(plugin_search_dirs(opt), graph.plugin_names());
+    std::cout << "snatch pipeline: " << opt.pipeline_file.string() << " (" << graph.nodes().size() << " nodes)\n";
+    print_plugins(pm);
+    if (!pipeline_plugins_available(graph, pm, err)) {
+        std::cerr << "error: " << err << "\n";
+        return 3;
+    }
+
+    if (opt.watch) return watch_pipeline(pm, std::move(graph), {opt.jobs, 100, opt.pipeline_file, &std::cout, &std::cerr});
+    pipeline_executor executor{pm};
+    return executor.run(graph, {opt.jobs, &std::cout, &std::cerr}).exit_code();
+}
+
+/// \brief run_server.
+static int run_server(const snatch_options& opt) {
+    plugin_manager pm;
+    pm.load_from_dirs_in_order(plugin_search_dirs(opt));
+    std::cout << "snatch server: " << opt.serve_socket.string() << "\n";
+    print_plugins(pm);
+    if (pm.plugins().empty()) {
+        std::cerr << "error: no plugins found in search path\n";
+        return 3;
+    }
+
+    job_server server{pm, opt.jobs};
+    std::string err;
+    if (!server.open(opt.serve_socket, err)) {
+        std::cerr << "error: " << err << "\n";
+        return 3;
+    }
+    std::cout.flush();
+    server.run(&std::cout);
+    return 0;
+}
+
+/// \brief run_client.
+static int run_client(const snatch_options& opt) {
+    if (opt.shutdown_server) return request_server_shutdown(opt.client_socket, std::cerr);
+
+    std::ifstream in{opt.pipeline_file};
+    if (!in.is_open()) {
+        std::cerr << "error: cannot open pipeline file: " << opt.pipeline_file.string() << "\n";
+        return 3;
     }
+    std::ostringstream text;
+    text << in.rdbuf();
+    return submit_pipeline_job(opt.client_socket, text.str(), std::cout, std::cerr);
+}
+
+/// \brief run_index_plugins.
+static int run_index_plugins(const snatch_options& opt) {
+    plugin_manager pm;
+    if (!pm.write_installed_index(opt.plugin_dir)) {
+        std::cerr << "error: cannot index plugins in " << opt.plugin_dir.string() << "\n";
+        return 3;
+    }
+    std::cout << "snatch: indexed " << pm.plugins().size() << " plugins in " << opt.plugin_dir.string() << "\n";
+    return 0;
 }
 
 /// \brief main.
@@ -232,6 +275,15 @@ int main(int argc, const char** argv) {
     int rc = parser.parse(argc, argv, opt);
     if (rc) return rc;
 
+#ifdef SNATCH_STATIC_PLUGINS
+    plugin_manager::set_builtin_plugins(snatch_builtin_plugins, snatch_builtin_plugin_count);
+#endif
+
+    if (opt.index_plugins) return run_index_plugins(opt);
+    if (!opt.serve_socket.empty()) return run_server(opt);
+    if (!opt.client_socket.empty()) return run_client(opt);
+    if (!opt.pipeline_file.empty()) return run_pipeline_file(opt);
+
     const auto input_path_opt = find_kv_value(opt.extractor_parameters, "input");
     if (!input_path_opt || input_path_opt->empty()) {
         std::cerr << "error: extractor input path is required in --extractor-parameters (input=...)\n";
@@ -239,12 +291,30 @@ int main(int argc, const char** argv) {
     }
     const std::string input_path = *input_path_opt;
 
-    const auto output_path_opt = find_kv_value(opt.exporter_parameters, "output");
-    if (!output_path_opt || output_path_opt->empty()) {
-        std::cerr << "error: exporter output path is required in --exporter-parameters (output=...)\n";
-        return 3;
+    std::vector<snatch_exporter_options> exporter_specs = opt.exporters;
+    if (exporter_specs.empty()) exporter_specs.push_back({opt.exporter, opt.exporter_parameters});
+
+    std::vector<std::string> output_paths;
+    std::vector<exporter_resolution> exporters_resolved;
+    for (const auto& spec : exporter_specs) {
+        const auto output_path_opt = find_kv_value(spec.exporter_parameters, "output");
+        if (!output_path_opt || output_path_opt->empty()) {
+            std::cerr << "error: exporter output path is required in --exporter-parameters (output=...)\n";
+            return 3;
+        }
+        if (std::find(output_paths.begin(), output_paths.end(), *output_path_opt) != output_paths.end()) {
+            std::cerr << "error: exporter output path used more than once: " << *output_path_opt << "\n";
+            return 3;
+        }
+        output_paths.push_back(*output_path_opt);
+
+        exporter_resolution resolved = resolve_exporter_plugin(spec.exporter);
+        if (!resolved.error.empty()) {
+            std::cerr << "error: " << resolved.error << "\n";
+            return 3;
+        }
+        exporters_resolved.push_back(std::move(resolved));
     }
-    const std::string output_path = *output_path_opt;
 
     const extractor_resolution extractor_resolved = resolve_extractor_plugin(opt, input_path);
     if (!extractor_resolved.error.empty()) {
@@ -253,33 +323,8 @@ int main(int argc, const char** argv) {
     }
     const std::string extractor_plugin_name = extractor_resolved.plugin_name;
 
-    const exporter_resolution resolved = resolve_exporter_plugin(opt);
-    if (!resolved.error.empty()) {
-        std::cerr << "error: " << resolved.error << "\n";
-        return 3;
-    }
-    const std::string exporter_plugin_name = resolved.plugin_name;
-
     plugin_manager pm;
-    std::vector<std::filesystem::path> plugin_dirs;
-    if (!opt.plugin_dir.empty()) {
-        plugin_dirs.push_back(opt.plugin_dir);
-    }
-
-    if (const char* env_plugin_dir = std::getenv("SNATCH_PLUGIN_DIR");
-        env_plugin_dir && env_plugin_dir[0] != '\0') {
-        plugin_dirs.emplace_back(env_plugin_dir);
-    }
-
-#ifdef SNATCH_DEFAULT_PLUGIN_DIR
-    plugin_dirs.emplace_back(SNATCH_DEFAULT_PLUGIN_DIR);
-#else
-    plugin_dirs.emplace_back("/usr/libexec/snatch/plugins");
-#endif
-
-    if (const char* home = std::getenv("HOME"); home && home[0] != '\0') {
-        plugin_dirs.emplace_back(std::filesystem::path(home) / ".local/lib/snatch/plugins");
-    }
+    const std::vector<std::filesystem::path> plugin_dirs = plugin_search_dirs(opt);
 
     std::vector<std::string> requested_plugins;
     if (!extractor_plugin_name.empty()) {
@@ -288,9 +333,11 @@ int main(int argc, const char** argv) {
     if (!opt.transformer.empty()) {
         requested_plugins.push_back(opt.transformer);
     }
-    if (!exporter_plugin_name.empty() &&
-        std::find(requested_plugins.begin(), requested_plugins.end(), exporter_plugin_name) == requested_plugins.end()) {
-        requested_plugins.push_back(exporter_plugin_name);
+    for (const auto& resolved : exporters_resolved) {
+        if (!resolved.plugin_name.empty() &&
+            std::find(requested_plugins.begin(), requested_plugins.end(), resolved.plugin_name) == requested_plugins.end()) {
+            requested_plugins.push_back(resolved.plugin_name);
+        }
     }
 
     if (!requested_plugins.empty()) {
@@ -300,31 +347,19 @@ int main(int argc, const char** argv) {
     }
     print_options(opt);
     std::cout << "  input (extractor): " << input_path << "\n";
-    std::cout << "  output (exporter): " << output_path << "\n";
+    for (const auto& output_path : output_paths) {
+        std::cout << "  output (exporter): " << output_path << "\n";
+    }
     if (!opt.extractor.empty() && extractor_plugin_name != opt.extractor) {
         std::cout << "  extractor resolved plugin: " << extractor_plugin_name << "\n";
     }
-    if (!opt.exporter.empty() && exporter_plugin_name != opt.exporter) {
-        std::cout << "  exporter resolved plugin: " << exporter_plugin_name << "\n";
-    }
-    std::cout << "  plugins loaded: " << pm.plugins().size() << "\n";
-    for (const auto& p : pm.plugins()) {
-        const char* name = (p.info && p.info->name) ? p.info->name : "(unnamed)";
-        const char* kind = "(unknown)";
-        const char* format = "(n/a)";
-        const char* standard = "(n/a)";
-        if (p.info) {
-            if (p.info->kind == SNATCH_PLUGIN_KIND_EXPORTER) kind = "exporter";
-            else if (p.info->kind == SNATCH_PLUGIN_KIND_TRANSFORMER) kind = "transformer";
-            else if (p.info->kind == SNATCH_PLUGIN_KIND_EXTRACTOR) kind = "extractor";
-            if (p.info->kind == SNATCH_PLUGIN_KIND_EXPORTER) {
-                format = (p.info->format && p.info->format[0] != '\0') ? p.info->format : "(unspecified)";
-                standard = (p.info->standard && p.info->standard[0] != '\0') ? p.info->standard : "(unspecified)";
-            }
+    for (std::size_t i = 0; i < exporter_specs.size(); ++i) {
+        const std::string& requested = exporter_specs[i].exporter;
+        if (!requested.empty() && exporters_resolved[i].plugin_name != requested) {
+            std::cout << "  exporter resolved plugin: " << exporters_resolved[i].plugin_name << "\n";
         }
-        std::cout << "    - " << name << " (" << kind << ", format=" << format << ", standard=" << standard << ") ["
-                  << p.path.string() << "]\n";
     }
+    print_plugins(pm);
 
     if (pm.plugins().empty()) {
         std::cerr << "error: no plugins found in search path\n";
@@ -339,7 +374,7 @@ int main(int argc, const char** argv) {
             return 3;
         }
     } else {
-        extractor = pm.find_first_by_kind(SNATCH_PLUGIN_KIND_EXTRACTOR);
+        extractor = pm.find_best(SNATCH_PLUGIN_KIND_EXTRACTOR, 0);
         if (!extractor) {
             std::cerr << "error: no extractor plugins found in search path\n";
             return 3;
@@ -355,92 +390,48 @@ int main(int argc, const char** argv) {
         }
     }
 
-    const loaded_plugin* plugin = nullptr;
-    if (!exporter_plugin_name.empty()) {
-        plugin = pm.find_by_name_and_kind(exporter_plugin_name, SNATCH_PLUGIN_KIND_EXPORTER);
-        if (!plugin) {
-            std::cerr << "error: exporter plugin not found: " << exporter_plugin_name << "\n";
-            return 3;
-        }
-    } else {
-        plugin = pm.find_first_by_kind(SNATCH_PLUGIN_KIND_EXPORTER);
-        if (!plugin) {
-            std::cerr << "error: no exporter plugins found in search path\n";
-            return 3;
+    // an exporter picked by capability has to take what reaches it
+    unsigned payload = extractor->produces;
+    if (transformer) payload = plugin_output_payload(*transformer, payload);
+
+    std::vector<const loaded_plugin*> exporters;
+    for (const auto& resolved : exporters_resolved) {
+        const loaded_plugin* exporter = nullptr;
+        if (!resolved.plugin_name.empty()) {
+            exporter = pm.find_by_name_and_kind(resolved.plugin_name, SNATCH_PLUGIN_KIND_EXPORTER);
+            if (!exporter) {
+                std::cerr << "error: exporter plugin not found: " << resolved.plugin_name << "\n";
+                return 3;
+            }
+        } else {
+            exporter = pm.find_best(SNATCH_PLUGIN_KIND_EXPORTER, payload);
+            if (!exporter) {
+                std::cerr << "error: no exporter plugin accepts " << plugin_payload_names(payload) << "\n";
+                return 3;
+            }
         }
+        exporters.push_back(exporter);
     }
 
-    std::vector<std::array<std::string, 2>> extract_kv_storage;
-    std::vector<snatch_kv> extract_options;
-    extract_kv_storage.reserve(16);
-    extract_options.reserve(16);
-    append_kv_params(opt.extractor_parameters, extract_kv_storage, extract_options, {"input"});
-
-    snatch_font plugin_font{};
-    char errbuf[512] = {0};
-    const int extract_rc = extractor->info->extract_font(
-        input_path.c_str(),
-        extract_options.empty() ? nullptr : extract_options.data(),
-        static_cast<unsigned>(extract_options.size()),
-        &plugin_font,
-        errbuf,
-        static_cast<unsigned>(sizeof(errbuf))
-    );
-    if (extract_rc != 0) {
-        std::cerr << "error: extractor failed (" << extract_rc << ")";
-        if (errbuf[0] != '\0') std::cerr << ": " << errbuf;
-        std::cerr << "\n";
-        return 4;
-    }
-    std::cout << "  extracted with plugin: " << (extractor->info && extractor->info->name ? extractor->info->name : "(unknown)") << "\n";
-
-    std::vector<std::array<std::string, 2>> export_kv_storage;
-    std::vector<snatch_kv> export_options;
-    export_kv_storage.reserve(16);
-    export_options.reserve(16);
-
-    append_kv_params(opt.exporter_parameters, export_kv_storage, export_options, {"output"});
+    // the stage options describe a linear graph: extract -> [transform] -> export1..N
+    pipeline_graph graph;
+    std::string err;
+    graph.add({"extract", pipeline_stage::extractor, extractor->info->name, "", opt.extractor_parameters}, err);
+    std::string tail = "extract";
     if (transformer) {
-        std::vector<std::array<std::string, 2>> transform_kv_storage;
-        std::vector<snatch_kv> transform_options;
-        transform_kv_storage.reserve(16);
-        transform_options.reserve(16);
-        append_kv_params(opt.transformer_parameters, transform_kv_storage, transform_options);
-
-        const int transform_rc = transformer->info->transform_font(
-            &plugin_font,
-            transform_options.empty() ? nullptr : transform_options.data(),
-            static_cast<unsigned>(transform_options.size()),
-            errbuf,
-            static_cast<unsigned>(sizeof(errbuf))
-        );
-        if (transform_rc != 0) {
-            std::cerr << "error: transformer failed (" << transform_rc << ")";
-            if (errbuf[0] != '\0') std::cerr << ": " << errbuf;
-            std::cerr << "\n";
-            return 5;
-        }
-        std::cout << "  transformed with plugin: " << (transformer->info && transformer->info->name ? transformer->info->name : "(unknown)") << "\n";
-    }
-
-    errbuf[0] = '\0';
-    const int export_rc = plugin->info->export_font(
-        &plugin_font,
-        output_path.c_str(),
-        export_options.empty() ? nullptr : export_options.data(),
-        static_cast<unsigned>(export_options.size()),
-        errbuf,
-        static_cast<unsigned>(sizeof(errbuf))
-    );
-    if (export_rc != 0) {
-        std::cerr << "error: exporter failed (" << export_rc << ")";
-        if (errbuf[0] != '\0') std::cerr << ": " << errbuf;
-        std::cerr << "\n";
-        return 5;
-    }
-
-    std::cout << "  exported with plugin: " << (plugin->info && plugin->info->name ? plugin->info->name : "(unknown)") << "\n";
-    const int extracted_glyphs = (plugin_font.bitmap_font && plugin_font.bitmap_font->glyphs) ? plugin_font.bitmap_font->glyph_count : 0;
-    std::cout << "  extracted glyphs: " << extracted_glyphs << " at " << plugin_font.pixel_size << "ppem\n";
-    return 0;
+        graph.add({"transform", pipeline_stage::transformer, transformer->info->name, tail, opt.transformer_parameters}, err);
+        tail = "transform";
+    }
+    for (std::size_t i = 0; i < exporters.size(); ++i) {
+        graph.add({"export" + std::to_string(i + 1), pipeline_stage::exporter, exporters[i]->info->name, tail,
+                   exporter_specs[i].exporter_parameters}, err);
+    }
+    if (!graph.validate(err) || !pipeline_plugins_available(graph, pm, err)) {
+        std::cerr << "error: " << err << "\n";
+        return 3;
+    }
+
+    if (opt.watch) return watch_pipeline(pm, std::move(graph), {opt.jobs, 100, {}, &std::cout, &std::cerr});
+    pipeline_executor executor{pm};
+    return executor.run(graph, {opt.jobs, &std::cout, &std::cerr}).exit_code();
 }
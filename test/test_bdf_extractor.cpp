@@ -0,0 +1,318 @@
+/// \file
+/// \brief Unit tests for BDF and PCF bitmap font extraction.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "snatch/bdf_extractor.h"
+
+namespace {
+
+// three glyphs: a blank, one above the baseline and one two bytes wide whose
+// rows carry bits past its width; the unencoded glyph is not reachable
+const char* const k_bdf = R"(STARTFONT 2.1
+COMMENT made for the snatch tests
+FONT -misc-tiny-medium-r-normal--8-80-75-75-c-80-iso10646-1
+SIZE 8 75 75
+FONTBOUNDINGBOX 10 8 0 -2
+STARTPROPERTIES 3
+FAMILY_NAME "Tiny"
+WEIGHT_NAME "Medium"
+PIXEL_SIZE 8
+ENDPROPERTIES
+CHARS 4
+STARTCHAR A
+ENCODING 65
+SWIDTH 500 0
+DWIDTH 6 0
+BBX 5 3 0 1
+BITMAP
+20
+50
+F8
+ENDCHAR
+STARTCHAR wide
+ENCODING 300
+DWIDTH 11 0
+BBX 10 2 -1 -2
+BITMAP
+FFFF
+8040
+ENDCHAR
+STARTCHAR space
+ENCODING 32
+DWIDTH 4 0
+BBX 0 0 0 0
+BITMAP
+ENDCHAR
+STARTCHAR unencoded
+ENCODING -1
+BBX 1 1 0 0
+BITMAP
+80
+ENDCHAR
+ENDFONT
+)";
+
+struct pcf_glyph {
+    int codepoint;
+    int left, right, advance, ascent, descent;
+    std::vector<unsigned char> rows; // MSB first, (right - left + 7) / 8 bytes each
+};
+
+// the glyphs of k_bdf in PCF terms
+const std::vector<pcf_glyph> k_pcf_glyphs = {
+    {32, 0, 0, 4, 0, 0, {}},
+    {65, 0, 5, 6, 4, -1, {0x20, 0x50, 0xF8}},
+    {300, -1, 9, 11, 0, 2, {0xFF, 0xC0, 0x80, 0x40}},
+};
+
+// A PCF table in the byte order its format names.
+struct pcf_out {
+    std::uint32_t format;
+    std::vector<unsigned char> bytes;
+
+    explicit pcf_out(std::uint32_t f) : format(f) {
+        for (int i = 0; i < 4; ++i) bytes.push_back(static_cast<unsigned char>(f >> (8 * i)));
+    }
+    void u8(unsigned v) { bytes.push_back(static_cast<unsigned char>(v)); }
+    void u16(unsigned v) {
+        const bool msb = format & 4;
+        u8(msb ? v >> 8 : v);
+        u8(msb ? v : v >> 8);
+    }
+    void i32(std::int32_t v) {
+        const auto u = static_cast<std::uint32_t>(v);
+        const bool msb = format & 4;
+        u16(msb ? u >> 16 : u & 0xFFFF);
+        u16(msb ? u & 0xFFFF : u >> 16);
+    }
+};
+
+/// \brief reverse_bits.
+unsigned char reverse_bits(unsigned char b) {
+    unsigned char r = 0;
+    for (int i = 0; i < 8; ++i) r = static_cast<unsigned char>(r | ((b >> i) & 1) << (7 - i));
+    return r;
+}
+
+/// \brief pcf_font.
+// a PCF of k_pcf_glyphs; `format` sets byte and bit order, row padding and
+// scan unit of every table
+std::vector<unsigned char> pcf_font(std::uint32_t format, bool compressed_metrics) {
+    std::vector<pcf_out> tables;
+
+    pcf_out props(format & 0xC);
+    const std::string strings = std::string("FAMILY_NAME\0Tiny\0WEIGHT_NAME\0Medium\0PIXEL_SIZE\0", 47);
+    props.i32(3);
+    const std::int32_t entries[3][3] = {{0, 1, 12}, {17, 1, 29}, {36, 0, 8}};
+    for (const auto& e : entries) {
+        props.i32(e[0]);
+        props.u8(static_cast<unsigned>(e[1]));
+        props.i32(e[2]);
+    }
+    props.u8(0); // 27 bytes of entries padded to 28
+    props.i32(static_cast<std::int32_t>(strings.size()));
+    for (const char c : strings) props.u8(static_cast<unsigned char>(c));
+    tables.push_back(props);
+
+    pcf_out metrics((format & 0xC) | (compressed_metrics ? 0x100 : 0));
+    if (compressed_metrics) {
+        metrics.u16(static_cast<unsigned>(k_pcf_glyphs.size()));
+    } else {
+        metrics.i32(static_cast<std::int32_t>(k_pcf_glyphs.size()));
+    }
+    for (const pcf_glyph& g : k_pcf_glyphs) {
+        for (const int v : {g.left, g.right, g.advance, g.ascent, g.descent}) {
+            if (compressed_metrics) metrics.u8(static_cast<unsigned>(v + 0x80));
+            else metrics.u16(static_cast<unsigned>(v) & 0xFFFF);
+        }
+        if (!compressed_metrics) metrics.u16(0);
+    }
+    tables.push_back(metrics);
+
+    pcf_out bitmaps(format);
+    const std::size_t pad = std::size_t{1} << (format & 3);
+    const std::size_t unit = std::size_t{1} << ((format >> 4) & 3);
+    std::vector<unsigned char> data;
+    std::vector<std::int32_t> offsets;
+    for (const pcf_glyph& g : k_pcf_glyphs) {
+        offsets.push_back(static_cast<std::int32_t>(data.size()));
+        const std::size_t stride = static_cast<std::size_t>(g.right - g.left + 7) / 8;
+        const std::size_t padded = (stride + pad - 1) / pad * pad;
+        for (std::size_t y = 0; y < g.rows.size() / std::max<std::size_t>(stride, 1); ++y) {
+            std::vector<unsigned char> row(padded, 0);
+            std::copy_n(g.rows.begin() + static_cast<std::ptrdiff_t>(y * stride), stride, row.begin());
+            if (!(format & 8)) std::transform(row.begin(), row.end(), row.begin(), reverse_bits);
+            if (!(format & 4) != !(format & 8)) {
+                for (std::size_t i = 0; i + unit <= row.size(); i += unit) std::reverse(row.begin() + static_cast<std::ptrdiff_t>(i), row.begin() + static_cast<std::ptrdiff_t>(i + unit));
+            }
+            data.insert(data.end(), row.begin(), row.end());
+        }
+    }
+    bitmaps.i32(static_cast<std::int32_t>(offsets.size()));
+    for (const std::int32_t o : offsets) bitmaps.i32(o);
+    for (std::uint32_t p = 0; p < 4; ++p) bitmaps.i32(p == (format & 3) ? static_cast<std::int32_t>(data.size()) : 0);
+    for (const unsigned char b : data) bitmaps.u8(b);
+    tables.push_back(bitmaps);
+
+    // byte1 0..1, byte2 0..255
+    pcf_out encodings(format & 0xC);
+    for (const unsigned v : {0u, 255u, 0u, 1u, 0u}) encodings.u16(v);
+    for (int cp = 0; cp < 512; ++cp) {
+        const auto it = std::find_if(k_pcf_glyphs.begin(), k_pcf_glyphs.end(), [&](const pcf_glyph& g) { return g.codepoint == cp; });
+        encodings.u16(it == k_pcf_glyphs.end() ? 0xFFFF : static_cast<unsigned>(it - k_pcf_glyphs.begin()));
+    }
+    tables.push_back(encodings);
+
+    const std::uint32_t types[] = {1u << 0, 1u << 2, 1u << 3, 1u << 5};
+    std::vector<unsigned char> file = {1, 'f', 'c', 'p'};
+    const auto le32 = [&](std::uint32_t v) {
+        for (int i = 0; i < 4; ++i) file.push_back(static_cast<unsigned char>(v >> (8 * i)));
+    };
+    le32(static_cast<std::uint32_t>(tables.size()));
+    std::uint32_t offset = 8 + 16 * static_cast<std::uint32_t>(tables.size());
+    for (std::size_t i = 0; i < tables.size(); ++i) {
+        le32(types[i]);
+        le32(tables[i].format);
+        le32(static_cast<std::uint32_t>(tables[i].bytes.size()));
+        le32(offset);
+        offset += static_cast<std::uint32_t>(tables[i].bytes.size());
+    }
+    for (const pcf_out& t : tables) file.insert(file.end(), t.bytes.begin(), t.bytes.end());
+    return file;
+}
+
+/// \brief write_font.
+std::filesystem::path write_font(const std::string& name, const std::string& bytes) {
+    const std::filesystem::path p = std::filesystem::temp_directory_path() / name;
+    std::ofstream(p, std::ios::binary) << bytes;
+    return p;
+}
+
+/// \brief rows_of.
+std::vector<unsigned char> rows_of(const snatch_glyph_bitmap& g) {
+    if (!g.data) return {};
+    return {g.data, g.data + static_cast<std::size_t>(g.stride_bytes) * static_cast<std::size_t>(g.height)};
+}
+
+} // namespace
+
+TEST(bdf_extractor, reads_bdf_glyphs_as_drawn) {
+    bdf_extract_options opt;
+    opt.input_file = write_font("snatch_tiny.bdf", k_bdf);
+    extracted_font font;
+    std::string err;
+    ASSERT_TRUE(bdf_extractor{}.extract(opt, font, err)) << err;
+
+    EXPECT_EQ(font.name, "Tiny Medium");
+    EXPECT_EQ(font.pixel_size, 8);
+    EXPECT_EQ(font.first_codepoint, 32);
+    EXPECT_EQ(font.last_codepoint, 300);
+    EXPECT_EQ(font.glyph_width, 10);
+    EXPECT_EQ(font.glyph_height, 3);
+    ASSERT_EQ(font.bitmap_view.glyph_count, 3);
+
+    const snatch_glyph_bitmap& space = font.bitmap_view.glyphs[0];
+    EXPECT_EQ(space.codepoint, 32);
+    EXPECT_EQ(space.advance_x, 4);
+    EXPECT_EQ(space.data, nullptr);
+
+    const snatch_glyph_bitmap& a = font.bitmap_view.glyphs[1];
+    EXPECT_EQ(a.codepoint, 65);
+    EXPECT_EQ(a.width, 5);
+    EXPECT_EQ(a.height, 3);
+    EXPECT_EQ(a.bearing_x, 0);
+    EXPECT_EQ(a.bearing_y, 4);
+    EXPECT_EQ(a.advance_x, 6);
+    EXPECT_EQ(rows_of(a), (std::vector<unsigned char>{0x20, 0x50, 0xF8}));
+
+    // bits past the width are dropped
+    const snatch_glyph_bitmap& wide = font.bitmap_view.glyphs[2];
+    EXPECT_EQ(wide.codepoint, 300);
+    EXPECT_EQ(wide.stride_bytes, 2);
+    EXPECT_EQ(wide.bearing_x, -1);
+    EXPECT_EQ(wide.bearing_y, 0);
+    EXPECT_EQ(rows_of(wide), (std::vector<unsigned char>{0xFF, 0xC0, 0x80, 0x40}));
+
+    opt.first_ascii = 33;
+    opt.last_ascii = 255;
+    ASSERT_TRUE(bdf_extractor{}.extract(opt, font, err)) << err;
+    ASSERT_EQ(font.bitmap_view.glyph_count, 1);
+    EXPECT_EQ(font.first_codepoint, 65);
+    EXPECT_EQ(font.last_codepoint, 65);
+}
+
+TEST(bdf_extractor, pcf_of_any_layout_matches_bdf) {
+    bdf_extract_options opt;
+    opt.input_file = write_font("snatch_tiny.bdf", k_bdf);
+    extracted_font want;
+    std::string err;
+    ASSERT_TRUE(bdf_extractor{}.extract(opt, want, err)) << err;
+
+    // MSB bytes and bits unpadded; LSB padded to 4; LSB bytes of MSB bits in
+    // 4-byte scan units; MSB bytes of LSB bits in 2-byte units
+    for (const std::uint32_t format : {0xCu, 0x2u, 0x8u | 0x2u | 0x20u, 0x4u | 0x1u | 0x10u}) {
+        for (const bool compressed : {false, true}) {
+            const std::vector<unsigned char> pcf = pcf_font(format, compressed);
+            opt.input_file = write_font("snatch_tiny.pcf", std::string(pcf.begin(), pcf.end()));
+            extracted_font got;
+            ASSERT_TRUE(bdf_extractor{}.extract(opt, got, err)) << err << " format " << format;
+            EXPECT_EQ(got.name, want.name);
+            EXPECT_EQ(got.pixel_size, want.pixel_size);
+            ASSERT_EQ(got.bitmap_view.glyph_count, want.bitmap_view.glyph_count);
+            for (int i = 0; i < got.bitmap_view.glyph_count; ++i) {
+                const snatch_glyph_bitmap& g = got.bitmap_view.glyphs[i];
+                const snatch_glyph_bitmap& w = want.bitmap_view.glyphs[i];
+                EXPECT_EQ(g.codepoint, w.codepoint);
+                EXPECT_EQ(g.width, w.width);
+                EXPECT_EQ(g.height, w.height);
+                EXPECT_EQ(g.bearing_x, w.bearing_x);
+                EXPECT_EQ(g.bearing_y, w.bearing_y);
+                EXPECT_EQ(g.advance_x, w.advance_x);
+                EXPECT_EQ(rows_of(g), rows_of(w)) << "format " << format << " glyph " << w.codepoint;
+            }
+        }
+    }
+}
+
+TEST(bdf_extractor, rejects_what_it_cannot_read) {
+    bdf_extract_options opt;
+    extracted_font font;
+    std::string err;
+
+    opt.input_file = write_font("snatch_tiny.pcf.gz", std::string("\x1f\x8b\x08\x00", 4));
+    EXPECT_FALSE(bdf_extractor{}.extract(opt, font, err));
+    EXPECT_NE(err.find("decompress"), std::string::npos) << err;
+
+    opt.input_file = write_font("snatch_not_a_font.bdf", "hello\n");
+    EXPECT_FALSE(bdf_extractor{}.extract(opt, font, err));
+    EXPECT_NE(err.find("not a BDF or PCF font"), std::string::npos) << err;
+
+    std::string bad = k_bdf;
+    bad.replace(bad.find("F8\n"), 3, "G8\n");
+    opt.input_file = write_font("snatch_bad_row.bdf", bad);
+    EXPECT_FALSE(bdf_extractor{}.extract(opt, font, err));
+    EXPECT_NE(err.find("line 20"), std::string::npos) << err;
+
+    // a table pointing past the end of the file
+    std::vector<unsigned char> pcf = pcf_font(0xC, false);
+    pcf.resize(pcf.size() - 100);
+    opt.input_file = write_font("snatch_cut.pcf", std::string(pcf.begin(), pcf.end()));
+    EXPECT_FALSE(bdf_extractor{}.extract(opt, font, err));
+
+    opt.input_file = std::filesystem::temp_directory_path() / "snatch_missing.bdf";
+    std::filesystem::remove(opt.input_file);
+    EXPECT_FALSE(bdf_extractor{}.extract(opt, font, err));
+}
@@ -0,0 +1,90 @@
+/// \file
+/// \brief Unit tests for 1bpp bitmap blitting.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "snatch/bit_blit.h"
+
+namespace {
+
+/// \brief get_px.
+bool get_px(const std::vector<std::uint8_t>& row, int x) {
+    return (row[static_cast<std::size_t>(x / 8)] >> (7 - x % 8)) & 1u;
+}
+
+/// \brief put_px.
+void put_px(std::vector<std::uint8_t>& row, int x, bool v) {
+    const auto bit = static_cast<std::uint8_t>(1u << (7 - x % 8));
+    auto& b = row[static_cast<std::size_t>(x / 8)];
+    b = static_cast<std::uint8_t>(v ? b | bit : b & ~bit);
+}
+
+/// \brief reference_row.
+// the same blit one pixel at a time
+void reference_row(std::vector<std::uint8_t>& dst, int dst_width, int dst_x, const std::vector<std::uint8_t>& src, int src_x, int width, raster_op op) {
+    for (int i = 0; i < width; ++i) {
+        const int x = dst_x + i;
+        if (x < 0 || x >= dst_width) continue;
+        const bool s = get_px(src, src_x + i);
+        const bool d = get_px(dst, x);
+        bool v = s;
+        if (op == raster_op::bit_or) v = d || s;
+        else if (op == raster_op::bit_and) v = d && s;
+        else if (op == raster_op::bit_xor) v = d != s;
+        put_px(dst, x, v);
+    }
+}
+
+} // namespace
+
+TEST(bit_blit, rows_match_a_pixel_by_pixel_reference) {
+    std::mt19937 rng(43);
+    const raster_op ops[] = {raster_op::copy, raster_op::bit_or, raster_op::bit_and, raster_op::bit_xor};
+    for (int trial = 0; trial < 4000; ++trial) {
+        const int dst_width = 1 + static_cast<int>(rng() % 200);
+        const int src_width = 1 + static_cast<int>(rng() % 200);
+        std::vector<std::uint8_t> dst(static_cast<std::size_t>((dst_width + 7) / 8));
+        std::vector<std::uint8_t> src(static_cast<std::size_t>((src_width + 7) / 8));
+        for (auto& b : dst) b = static_cast<std::uint8_t>(rng());
+        for (auto& b : src) b = static_cast<std::uint8_t>(rng());
+        const int src_x = static_cast<int>(rng() % static_cast<unsigned>(src_width));
+        const int width = 1 + static_cast<int>(rng() % static_cast<unsigned>(src_width - src_x));
+        // lands partly off either edge now and then
+        const int dst_x = static_cast<int>(rng() % static_cast<unsigned>(dst_width + 40)) - 20;
+        const raster_op op = ops[trial % 4];
+
+        std::vector<std::uint8_t> expected = dst;
+        reference_row(expected, dst_width, dst_x, src, src_x, width, op);
+        blit_row_1bpp(dst.data(), dst_width, dst_x, src.data(), src_x, width, op);
+        ASSERT_EQ(dst, expected) << "trial " << trial << " dst_x " << dst_x << " src_x " << src_x << " width " << width;
+    }
+}
+
+TEST(bit_blit, rectangles_clip_to_the_destination) {
+    // 11x5 source of all ink onto a 20x6 canvas, hanging off the top left
+    std::vector<std::uint8_t> src(2 * 5, 0xFF);
+    std::vector<std::uint8_t> canvas(3 * 6, 0);
+    const bitmap_1bpp dst{canvas.data(), 20, 6, 3};
+    blit_1bpp(dst, -3, -2, {src.data(), 11, 5, 2}, raster_op::copy);
+    for (int y = 0; y < 6; ++y) {
+        std::vector<std::uint8_t> row(canvas.begin() + y * 3, canvas.begin() + y * 3 + 3);
+        for (int x = 0; x < 24; ++x) {
+            EXPECT_EQ(get_px(row, x), y < 3 && x < 8) << x << "," << y;
+        }
+    }
+
+    // and off the bottom right: nothing past the last row is touched
+    std::vector<std::uint8_t> guarded(3 * 6 + 4, 0);
+    blit_1bpp({guarded.data(), 20, 6, 3}, 15, 4, {src.data(), 11, 5, 2}, raster_op::bit_or);
+    EXPECT_EQ(guarded[17], 0xF0); // pixels 16..19, the padding bits stay clear
+    EXPECT_EQ(guarded[18], 0);
+}
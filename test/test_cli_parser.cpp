@@ -98,3 +98,34 @@ TEST(cli_parser, positional_input_is_rejected) {
     const int rc = p.parse(argc, argv, opt);
     EXPECT_NE(rc, 0);
 }
+
+TEST(cli_parser, repeated_exporters_form_ordered_pairs) {
+    cli_parser p;
+    snatch_options opt;
+
+    argv_builder b;
+    b.arg("snatch")
+     .arg("--extractor-parameters").arg("input=font.ttf")
+     .arg("--exporter").arg("raw_bin")
+     .arg("--exporter-parameters").arg("output=out/font.bin")
+     .arg("--exporter-parameters").arg("output=out/font.c,symbol=f")
+     .arg("--exporter").arg("raw_c")
+     .arg("--exporter").arg("png")
+     .arg("--exporter-parameters").arg("output=out/font.png")
+     .arg("--jobs").arg("2");
+
+    auto [argc, argv] = b.finalize();
+    const int rc = p.parse(argc, argv, opt);
+    ASSERT_EQ(rc, 0);
+
+    ASSERT_EQ(opt.exporters.size(), 3u);
+    EXPECT_EQ(opt.exporters[0].exporter, "raw_bin");
+    EXPECT_EQ(opt.exporters[0].exporter_parameters, "output=out/font.bin");
+    EXPECT_EQ(opt.exporters[1].exporter, "raw_c");
+    EXPECT_EQ(opt.exporters[1].exporter_parameters, "output=out/font.c,symbol=f");
+    EXPECT_EQ(opt.exporters[2].exporter, "png");
+    EXPECT_EQ(opt.exporters[2].exporter_parameters, "output=out/font.png");
+    EXPECT_EQ(opt.exporter, "raw_bin");
+    EXPECT_EQ(opt.exporter_parameters, "output=out/font.bin");
+    EXPECT_EQ(opt.jobs, 2);
+}
@@ -8,6 +8,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
 #include "snatch/glyph_algorithms.h"
 
 namespace {
@@ -63,3 +69,131 @@ TEST(glyph_algorithms, tsp2opt_reduces_route_cost) {
     EXPECT_LE(after, before);
     EXPECT_LT(after, before);
 }
+
+TEST(glyph_algorithms, stroke_cover_draws_exactly_the_foreground) {
+    // a box with one diagonal and a stray pixel
+    const int width = 7;
+    const int height = 6;
+    const int stride = 1;
+    std::vector<unsigned char> bits(static_cast<size_t>(stride * height), 0);
+    for (int i = 0; i < 5; ++i) {
+        set_bit(bits, stride, i, 0);
+        set_bit(bits, stride, i, 4);
+        set_bit(bits, stride, 0, i);
+        set_bit(bits, stride, 4, i);
+        set_bit(bits, stride, i, i);
+    }
+    set_bit(bits, stride, 6, 5);
+
+    snatch_glyph_bitmap glyph{};
+    glyph.width = width;
+    glyph.height = height;
+    glyph.stride_bytes = stride;
+    glyph.data = bits.data();
+
+    const auto strokes = glyph_stroke_planner::cover(glyph);
+    std::vector<unsigned char> drawn(bits.size(), 0);
+    for (const auto& s : strokes) {
+        const int dx = (s.to.x > s.from.x) - (s.to.x < s.from.x);
+        const int dy = (s.to.y > s.from.y) - (s.to.y < s.from.y);
+        const int steps = std::max(std::abs(s.to.x - s.from.x), std::abs(s.to.y - s.from.y));
+        ASSERT_TRUE(s.from.x + dx * steps == s.to.x && s.from.y + dy * steps == s.to.y);
+        for (int i = 0; i <= steps; ++i) set_bit(drawn, stride, s.from.x + dx * i, s.from.y + dy * i);
+    }
+    EXPECT_EQ(drawn, bits);
+    EXPECT_EQ(strokes.size(), 6u); // four sides, the diagonal and the stray dot
+
+    const glyph_stroke_planner planner;
+    const auto routed = planner.route(strokes);
+    ASSERT_EQ(routed.size(), strokes.size());
+    EXPECT_LE(planner.travel_cost(routed), planner.travel_cost(strokes));
+}
+
+TEST(glyph_algorithms, small_routes_are_solved_exactly) {
+    std::vector<glyph_pixel> points = {
+        {0, 0, 1, false}, {6, 1, 1, false}, {1, 5, 1, false}, {3, 3, 1, false},
+        {7, 6, 1, false}, {2, 1, 1, false}, {5, 4, 1, false}
+    };
+    glyph_route_cost_model cost_model;
+    const auto pairwise = [&](const std::vector<glyph_pixel>& route) {
+        int sum = 0;
+        int dx = 0;
+        int dy = 0;
+        for (size_t i = 1; i < route.size(); ++i) sum += cost_model.transition_cost(route[i - 1], route[i], dx, dy);
+        return sum;
+    };
+
+    std::vector<int> order(points.size());
+    for (size_t i = 0; i < order.size(); ++i) order[i] = static_cast<int>(i);
+    int optimum = -1;
+    do {
+        std::vector<glyph_pixel> route;
+        for (const int i : order) route.push_back(points[static_cast<size_t>(i)]);
+        const int c = pairwise(route);
+        if (optimum < 0 || c < optimum) optimum = c;
+    } while (std::next_permutation(order.begin(), order.end()));
+
+    const glyph_route_optimizer optimizer(cost_model);
+    const auto best = optimizer.shortest(points);
+    ASSERT_EQ(best.size(), points.size());
+    EXPECT_EQ(pairwise(best), optimum);
+}
+
+TEST(glyph_algorithms, budgeted_search_never_loses_to_local_search) {
+    std::vector<glyph_pixel> points;
+    for (int i = 0; i < 40; ++i) points.push_back({(i * 7) % 23, (i * 11) % 17, 1, false});
+    std::vector<glyph_stroke> dots;
+    for (const auto& p : points) dots.push_back({p, p});
+
+    const glyph_stroke_planner planner;
+    const auto local = planner.route(dots);
+    const auto searched = planner.route(dots, std::chrono::milliseconds(20));
+    ASSERT_EQ(searched.size(), dots.size());
+    EXPECT_LE(planner.travel_cost(searched), planner.travel_cost(local));
+}
+
+TEST(glyph_algorithms, atlas_packer_places_many_boxes_without_overlap) {
+    std::mt19937 rng(45);
+    std::vector<atlas_rect> boxes(30000);
+    long long area = 0;
+    for (auto& b : boxes) {
+        b.width = 1 + static_cast<int>(rng() % 16);
+        b.height = 1 + static_cast<int>(rng() % 20);
+        area += static_cast<long long>(b.width + 1) * (b.height + 1);
+    }
+    boxes[7] = {0, 0, 0, 5}; // empty boxes are left alone
+
+    constexpr int width = 1024;
+    glyph_atlas_packer packer(width, 2, 1);
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(packer.pack(boxes));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+    // paint every box, spacing included, into an occupancy grid
+    std::vector<unsigned char> used(static_cast<size_t>(width) * static_cast<size_t>(packer.height() + 1), 0);
+    for (size_t i = 0; i < boxes.size(); ++i) {
+        const auto& b = boxes[i];
+        if (b.width == 0) continue;
+        ASSERT_EQ(b.x % 2, 0) << i;
+        ASSERT_GE(b.y, 0) << i;
+        ASSERT_LE(b.x + b.width, width) << i;
+        ASSERT_LE(b.y + b.height, packer.height()) << i;
+        for (int y = b.y; y < b.y + b.height + 1; ++y) {
+            for (int x = b.x; x < std::min(width, b.x + b.width + 1); ++x) {
+                auto& cell = used[static_cast<size_t>(y) * width + static_cast<size_t>(x)];
+                ASSERT_EQ(cell, 0) << "box " << i << " overlaps at " << x << "," << y;
+                cell = 1;
+            }
+        }
+    }
+    EXPECT_EQ(boxes[7].x, 0);
+    EXPECT_EQ(boxes[7].y, 0);
+    // skyline packing of sorted boxes should waste well under a third
+    EXPECT_LT(static_cast<long long>(width) * packer.height(), area * 3 / 2);
+}
+
+TEST(glyph_algorithms, atlas_packer_rejects_boxes_wider_than_the_strip) {
+    std::vector<atlas_rect> boxes{{0, 0, 8, 8}, {0, 0, 17, 2}};
+    glyph_atlas_packer packer(16);
+    EXPECT_FALSE(packer.pack(boxes));
+}
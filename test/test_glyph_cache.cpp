@@ -0,0 +1,114 @@
+/// \file
+/// \brief Unit tests for glyph hashing and the persistent glyph cache.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+
+#include "snatch/glyph_cache.h"
+
+namespace fs = std::filesystem;
+
+TEST(glyph_cache, bitmap_hash_ignores_stride_padding) {
+    unsigned char a[2] = {0xA0, 0x40};
+    unsigned char b[2] = {0xA7, 0x5F}; // same 3 leading bits, different padding
+    snatch_glyph_bitmap glyph{};
+    glyph.width = 3;
+    glyph.height = 2;
+    glyph.stride_bytes = 1;
+    glyph.advance_x = 3;
+
+    glyph.data = a;
+    const std::uint64_t ha = glyph_bitmap_hash(glyph);
+    glyph.data = b;
+    EXPECT_EQ(glyph_bitmap_hash(glyph), ha);
+
+    b[1] = 0x20;
+    EXPECT_NE(glyph_bitmap_hash(glyph), ha);
+    b[1] = 0x40;
+    glyph.advance_x = 4;
+    EXPECT_NE(glyph_bitmap_hash(glyph), ha);
+}
+
+TEST(glyph_cache, saves_used_entries_and_checks_tag) {
+    const fs::path path = fs::temp_directory_path() / "snatch_glyph_cache_test.bin";
+    fs::remove(path);
+
+    glyph_cache cache;
+    EXPECT_FALSE(cache.load(path, 7));
+    cache.put(1, {1, 2, 3});
+    cache.put(2, {});
+    ASSERT_TRUE(cache.save(path));
+
+    glyph_cache loaded;
+    ASSERT_TRUE(loaded.load(path, 7));
+    EXPECT_EQ(loaded.size(), 2u);
+    const auto* v = loaded.find(1);
+    ASSERT_NE(v, nullptr);
+    EXPECT_EQ(*v, (std::vector<std::uint8_t>{1, 2, 3}));
+    EXPECT_EQ(loaded.hits(), 1u);
+
+    // only the entry looked up survives the next save
+    ASSERT_TRUE(loaded.save(path));
+    ASSERT_TRUE(loaded.load(path, 7));
+    EXPECT_EQ(loaded.size(), 1u);
+    EXPECT_EQ(loaded.find(2), nullptr);
+
+    EXPECT_FALSE(loaded.load(path, 8));
+    EXPECT_EQ(loaded.size(), 0u);
+    EXPECT_EQ(loaded.tag(), 8u);
+    fs::remove(path);
+}
+
+TEST(glyph_cache, merge_keeps_entries_from_other_writers) {
+    const fs::path path = fs::temp_directory_path() / "snatch_glyph_cache_shared" / "routes";
+    fs::remove_all(path.parent_path());
+
+    glyph_cache first;
+    first.reset(7);
+    first.put(1, {1});
+    ASSERT_TRUE(first.merge_into(path, 16));
+    EXPECT_EQ(first.fresh(), 0u);
+
+    // a second process that never saw entry 1
+    glyph_cache second;
+    second.reset(7);
+    second.put(2, {2, 2});
+    ASSERT_TRUE(second.merge_into(path, 16));
+
+    glyph_cache shared;
+    ASSERT_TRUE(shared.load(path, 7));
+    EXPECT_EQ(shared.size(), 2u);
+    ASSERT_NE(shared.find(1), nullptr);
+    ASSERT_NE(shared.find(2), nullptr);
+    EXPECT_EQ(shared.find(2)->size(), 2u);
+
+    // past the limit the file's own entries go first
+    glyph_cache third;
+    third.reset(7);
+    third.put(3, {3});
+    ASSERT_TRUE(third.merge_into(path, 2));
+    ASSERT_TRUE(shared.load(path, 7));
+    EXPECT_EQ(shared.size(), 2u);
+    EXPECT_NE(shared.find(3), nullptr);
+    fs::remove_all(path.parent_path());
+}
+
+TEST(glyph_cache, pixels_hash_ignores_metrics) {
+    unsigned char bits[2] = {0xA0, 0x40};
+    snatch_glyph_bitmap glyph{};
+    glyph.width = 3;
+    glyph.height = 2;
+    glyph.stride_bytes = 1;
+    glyph.data = bits;
+    const std::uint64_t h = glyph_pixels_hash(glyph);
+    glyph.bearing_y = 5;
+    glyph.advance_x = 4;
+    EXPECT_EQ(glyph_pixels_hash(glyph), h);
+    EXPECT_NE(glyph_bitmap_hash(glyph), h);
+}
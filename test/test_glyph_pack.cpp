@@ -0,0 +1,135 @@
+/// \file
+/// \brief Unit tests for glyph row compression and the reference decoder.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <span>
+#include <vector>
+
+#include "snatch/glyph_pack.h"
+#include "snatch_unpack.h"
+
+namespace {
+
+/// \brief glyph_rows.
+// 8x16 glyphs of blank rows, strokes repeated between glyphs and some noise,
+// plus a long empty stretch
+std::vector<std::uint8_t> glyph_rows(std::size_t glyphs, unsigned seed) {
+    std::mt19937 rng(seed);
+    const std::uint8_t strokes[] = {0x18, 0x3C, 0x66, 0x7E, 0xC3, 0xFF, 0x81};
+    std::vector<std::uint8_t> data;
+    for (std::size_t g = 0; g < glyphs; ++g) {
+        for (int y = 0; y < 16; ++y) {
+            const unsigned r = rng() % 10;
+            data.push_back(y < 2 || y > 13 || r < 3 ? 0 : r < 9 ? strokes[(g + y) % 7] : static_cast<std::uint8_t>(rng()));
+        }
+    }
+    data.insert(data.begin() + static_cast<std::ptrdiff_t>(data.size() / 2), 5000, 0);
+    return data;
+}
+
+/// \brief unpack_with.
+std::vector<std::uint8_t> unpack_with(bool lz, const std::vector<std::uint8_t>& packed, std::size_t size) {
+    std::vector<std::uint8_t> out(size);
+    const long n = lz ? snatch_unlz(packed.data(), packed.size(), out.data(), out.size())
+                      : snatch_unrle(packed.data(), packed.size(), out.data(), out.size());
+    if (n != static_cast<long>(size)) out.clear();
+    return out;
+}
+
+} // namespace
+
+TEST(glyph_pack, rle_and_lz_round_trip_through_the_c_decoder) {
+    std::mt19937 rng(47);
+    std::vector<std::vector<std::uint8_t>> inputs = {{}, {7}, {1, 1}, {0, 0, 0}, std::vector<std::uint8_t>(1000, 0xAA), glyph_rows(300, 1)};
+    std::vector<std::uint8_t> noise(3000);
+    for (auto& b : noise) b = static_cast<std::uint8_t>(rng());
+    inputs.push_back(noise);
+
+    for (const auto& data : inputs) {
+        for (const bool lz : {false, true}) {
+            std::vector<std::uint32_t> cost;
+            const std::vector<std::uint8_t> packed = lz ? lz_pack(data.data(), data.size(), 1, &cost) : rle_pack(data.data(), data.size(), &cost);
+            EXPECT_EQ(unpack_with(lz, packed, data.size()), data) << (lz ? "lz" : "rle") << " of " << data.size();
+            ASSERT_EQ(cost.size(), data.size());
+            EXPECT_EQ(std::accumulate(cost.begin(), cost.end(), std::size_t{0}), packed.size());
+        }
+    }
+
+    const std::vector<std::uint8_t> rows = glyph_rows(300, 1);
+    const std::size_t rle = rle_pack(rows.data(), rows.size()).size();
+    const std::size_t lz = lz_pack(rows.data(), rows.size()).size();
+    EXPECT_LT(rle, rows.size() / 2);
+    EXPECT_LT(lz, rle);
+}
+
+TEST(glyph_pack, lz_output_does_not_depend_on_threads) {
+    const std::vector<std::uint8_t> rows = glyph_rows(40000, 2);
+    ASSERT_GT(rows.size(), std::size_t{4} << 16);
+    const std::vector<std::uint8_t> serial = lz_pack(rows.data(), rows.size(), 1);
+    EXPECT_EQ(lz_pack(rows.data(), rows.size(), 3), serial);
+    EXPECT_EQ(unpack_with(true, serial, rows.size()), rows);
+}
+
+TEST(glyph_pack, decoders_reject_damaged_streams) {
+    const std::vector<std::uint8_t> rows = glyph_rows(50, 3);
+    for (const bool lz : {false, true}) {
+        std::vector<std::uint8_t> packed = lz ? lz_pack(rows.data(), rows.size()) : rle_pack(rows.data(), rows.size());
+        std::vector<std::uint8_t> out(rows.size());
+        // cut short, or asked for more than the stream holds
+        EXPECT_EQ(lz ? snatch_unlz(packed.data(), packed.size() - 1, out.data(), out.size())
+                     : snatch_unrle(packed.data(), packed.size() - 1, out.data(), out.size()), -1);
+        out.resize(rows.size() + 1);
+        EXPECT_EQ(lz ? snatch_unlz(packed.data(), packed.size(), out.data(), out.size())
+                     : snatch_unrle(packed.data(), packed.size(), out.data(), out.size()), -1);
+    }
+    // a match reaching back before the output
+    const std::uint8_t bad[] = {0x10, 'a', 0x02, 0x00};
+    std::uint8_t out[8];
+    EXPECT_EQ(snatch_unlz(bad, sizeof(bad), out, sizeof(out)), -1);
+}
+
+TEST(glyph_pack, a_trained_dictionary_shrinks_small_glyphs) {
+    // 16-byte glyphs that share strokes but hardly repeat inside themselves
+    const std::vector<std::uint8_t> rows = glyph_rows(400, 4);
+    std::vector<std::span<const std::uint8_t>> samples;
+    for (std::size_t at = 0; at + 16 <= rows.size(); at += 16) samples.emplace_back(rows.data() + at, 16);
+
+    const std::vector<std::uint8_t> dictionary = lz_train_dictionary(samples, 512);
+    ASSERT_FALSE(dictionary.empty());
+    EXPECT_LE(dictionary.size(), 512u);
+    EXPECT_TRUE(lz_train_dictionary(samples, 0).empty());
+
+    std::size_t plain = 0;
+    std::size_t trained = dictionary.size();
+    for (const auto& sample : samples) {
+        plain += lz_pack(sample.data(), sample.size()).size();
+        std::vector<std::uint32_t> cost;
+        const std::vector<std::uint8_t> packed = lz_pack(sample.data(), sample.size(), dictionary, &cost);
+        trained += packed.size();
+        EXPECT_EQ(std::accumulate(cost.begin(), cost.end(), std::size_t{0}), packed.size());
+
+        std::vector<std::uint8_t> out(sample.size());
+        ASSERT_EQ(snatch_unlz_dict(dictionary.data(), dictionary.size(), packed.data(), packed.size(), out.data(), out.size()), 16);
+        EXPECT_TRUE(std::equal(out.begin(), out.end(), sample.begin()));
+    }
+    EXPECT_LT(trained, plain);
+
+    // a match may reach into the dictionary, but not past its start
+    const std::uint8_t dict[] = {'a', 'b', 'c'};
+    const std::uint8_t reach[] = {0x00, 0x03, 0x00};
+    std::uint8_t out[3];
+    EXPECT_EQ(snatch_unlz_dict(dict, sizeof(dict), reach, sizeof(reach), out, sizeof(out)), 3);
+    EXPECT_EQ(out[2], 'c');
+    const std::uint8_t past[] = {0x00, 0x04, 0x00};
+    EXPECT_EQ(snatch_unlz_dict(dict, sizeof(dict), past, sizeof(past), out, sizeof(out)), -1);
+}
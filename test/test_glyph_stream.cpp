@@ -0,0 +1,240 @@
+/// \file
+/// \brief Streaming plugin ABI, host stream adapters and stream group tests.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <snatch/glyph_stream.h>
+#include <snatch/pipeline.h>
+#include <snatch/plugin.h>
+#include <snatch/plugin_manager.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// stream-only transformer that inverts every bitmap byte
+struct invert_stream {
+    snatch_glyph_sink down{};
+    std::vector<unsigned char> bits;
+};
+
+/// \brief invert_begin.
+int invert_begin(void* ctx, const snatch_font* header) {
+    const auto& s = *static_cast<invert_stream*>(ctx);
+    return s.down.begin(s.down.ctx, header);
+}
+
+/// \brief invert_glyph.
+int invert_glyph(void* ctx, const snatch_glyph_bitmap* glyph) {
+    auto& s = *static_cast<invert_stream*>(ctx);
+    snatch_glyph_bitmap g = *glyph;
+    s.bits.assign(glyph->data, glyph->data + glyph->stride_bytes * glyph->height);
+    for (auto& b : s.bits) b = static_cast<unsigned char>(~b);
+    g.data = s.bits.empty() ? nullptr : s.bits.data();
+    return s.down.glyph(s.down.ctx, &g);
+}
+
+/// \brief invert_end.
+int invert_end(void* ctx, const snatch_font* summary) {
+    const auto& s = *static_cast<invert_stream*>(ctx);
+    return s.down.end(s.down.ctx, summary);
+}
+
+/// \brief invert_close.
+void invert_close(void* ctx) {
+    delete static_cast<invert_stream*>(ctx);
+}
+
+/// \brief invert_open.
+int invert_open(const snatch_kv*, unsigned, const snatch_glyph_sink* downstream, snatch_glyph_sink* out_sink, char*, unsigned) {
+    auto* s = new invert_stream;
+    s->down = *downstream;
+    *out_sink = {s, invert_begin, invert_glyph, invert_end, invert_close};
+    return 0;
+}
+
+/// \brief invert_info.
+snatch_plugin_info invert_info() {
+    snatch_plugin_info info{};
+    info.name = "invert_stream";
+    info.description = "test stream transformer";
+    info.author = "snatch tests";
+    info.format = "";
+    info.standard = "";
+    info.abi_version = SNATCH_PLUGIN_ABI_VERSION;
+    info.kind = SNATCH_PLUGIN_KIND_TRANSFORMER;
+    info.stream_transform = invert_open;
+    return info;
+}
+
+const snatch_plugin_info k_invert_info = invert_info();
+
+/// \brief invert_get.
+int invert_get(const snatch_plugin_info** out) {
+    *out = &k_invert_info;
+    return 0;
+}
+
+/// \brief count_glyph.
+int count_glyph(void* ctx, const snatch_glyph_bitmap*) {
+    ++*static_cast<int*>(ctx);
+    return 0;
+}
+
+/// \brief fail_glyph.
+int fail_glyph(void*, const snatch_glyph_bitmap*) {
+    return 7;
+}
+
+/// \brief ok_font.
+int ok_font(void*, const snatch_font*) {
+    return 0;
+}
+
+/// \brief read_file.
+std::string read_file(const fs::path& p) {
+    std::ifstream in(p, std::ios::binary);
+    std::ostringstream ss;
+    ss << in.rdbuf();
+    return ss.str();
+}
+
+/// \brief sample_font.
+extracted_font sample_font() {
+    extracted_font f;
+    f.name = "sample";
+    f.first_codepoint = 65;
+    f.last_codepoint = 67;
+    f.glyph_width = 8;
+    f.glyph_height = 2;
+    for (int cp = 65; cp <= 67; ++cp) {
+        extracted_glyph g;
+        g.view.codepoint = cp;
+        g.view.width = 8;
+        g.view.height = 2;
+        g.view.stride_bytes = 1;
+        g.bitmap = {static_cast<unsigned char>(cp), static_cast<unsigned char>(cp + 1)};
+        f.glyphs.push_back(std::move(g));
+    }
+    for (auto& g : f.glyphs) {
+        g.view.data = g.bitmap.data();
+        f.glyph_views.push_back(g.view);
+    }
+    f.bitmap_view.glyph_count = static_cast<int>(f.glyph_views.size());
+    f.bitmap_view.glyphs = f.glyph_views.data();
+    return f;
+}
+
+/// \brief run_graph.
+pipeline_report run_graph(const plugin_manager& pm, const std::string& text, pipeline_cache* cache) {
+    pipeline_graph g;
+    std::string err;
+    EXPECT_TRUE(pipeline_graph::parse(text, g, err)) << err;
+    EXPECT_TRUE(pipeline_plugins_available(g, pm, err)) << err;
+    const pipeline_run_options run{2, nullptr, nullptr, cache};
+    return pipeline_executor{pm}.run(g, run);
+}
+
+} // namespace
+
+TEST(glyph_stream, collector_rebuilds_the_fed_font) {
+    const extracted_font src = sample_font();
+    glyph_collector collector;
+    ASSERT_EQ(feed_font(src.as_plugin_font(), collector.sink()), 0);
+
+    const snatch_font out = collector.font();
+    EXPECT_STREQ(out.name, "sample");
+    EXPECT_EQ(out.first_codepoint, 65);
+    ASSERT_NE(out.bitmap_font, nullptr);
+    ASSERT_EQ(out.bitmap_font->glyph_count, 3);
+    EXPECT_EQ(out.bitmap_font->glyphs[2].codepoint, 67);
+    EXPECT_EQ(out.bitmap_font->glyphs[2].data[1], 68);
+    EXPECT_NE(out.bitmap_font->glyphs[2].data, src.glyphs[2].bitmap.data());
+}
+
+TEST(glyph_stream, tee_drops_a_failing_branch_and_keeps_the_rest) {
+    int seen = 0;
+    glyph_tee tee;
+    tee.add({&seen, ok_font, count_glyph, ok_font, nullptr});
+    tee.add({nullptr, ok_font, fail_glyph, ok_font, nullptr});
+
+    const extracted_font src = sample_font();
+    EXPECT_EQ(feed_font(src.as_plugin_font(), tee.sink()), 0);
+    EXPECT_EQ(seen, 3);
+    EXPECT_FALSE(tee.branches()[0].dead);
+    EXPECT_TRUE(tee.branches()[1].failed);
+    EXPECT_EQ(tee.branches()[1].rc, 7);
+}
+
+TEST(glyph_stream, queue_hands_glyphs_to_another_thread_in_order) {
+    glyph_collector collector;
+    glyph_queue queue{collector.sink(), 1};
+    std::thread consumer([&queue]() { queue.pump(); });
+    const extracted_font src = sample_font();
+    EXPECT_EQ(feed_font(src.as_plugin_font(), queue.sink()), 0);
+    queue.finish();
+    consumer.join();
+
+    EXPECT_EQ(queue.glyphs(), 3);
+    const snatch_font out = collector.font();
+    ASSERT_EQ(out.bitmap_font->glyph_count, 3);
+    for (int i = 0; i < 3; ++i) EXPECT_EQ(out.bitmap_font->glyphs[i].codepoint, 65 + i);
+}
+
+TEST(glyph_stream, queue_byte_limit_still_passes_glyphs_bigger_than_it) {
+    glyph_collector collector;
+    glyph_queue queue{collector.sink(), 64, 1};
+    std::thread consumer([&queue]() { queue.pump(); });
+    const extracted_font src = sample_font();
+    EXPECT_EQ(feed_font(src.as_plugin_font(), queue.sink()), 0);
+    queue.finish();
+    consumer.join();
+
+    const snatch_font out = collector.font();
+    ASSERT_EQ(out.bitmap_font->glyph_count, 3);
+    for (int i = 0; i < 3; ++i) EXPECT_EQ(out.bitmap_font->glyphs[i].codepoint, 65 + i);
+}
+
+TEST(glyph_stream, streamed_group_matches_whole_font_run) {
+    const builtin_plugin table[] = {{"invert_stream", invert_get}};
+    plugin_manager::set_builtin_plugins(table, 1);
+    plugin_manager pm;
+    pm.load_named_from_dirs_in_order({SNATCH_PLUGIN_DIR_PATH}, {"ttf_extractor", "invert_stream", "raw_bin"});
+
+    const fs::path tmp = fs::temp_directory_path();
+    const auto graph_text = [&](const std::string& tag) {
+        const std::string font = (fs::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string();
+        return "extractor   font ttf_extractor -    input=" + font + ",first_ascii=65,last_ascii=70,font_size=16\n" +
+               "exporter    raw  raw_bin       font output=" + (tmp / ("snatch_stream_raw_" + tag + ".bin")).string() + "\n" +
+               "transformer inv  invert_stream font\n" +
+               "exporter    neg  raw_bin       inv  output=" + (tmp / ("snatch_stream_neg_" + tag + ".bin")).string() + "\n";
+    };
+
+    // no cache: the whole graph streams
+    ASSERT_TRUE(run_graph(pm, graph_text("s"), nullptr).ok());
+    // with a cache nodes run one by one, adapting the stream-only transformer
+    pipeline_cache cache;
+    ASSERT_TRUE(run_graph(pm, graph_text("w"), &cache).ok());
+
+    const std::string raw = read_file(tmp / "snatch_stream_raw_s.bin");
+    const std::string neg = read_file(tmp / "snatch_stream_neg_s.bin");
+    ASSERT_FALSE(raw.empty());
+    EXPECT_EQ(raw, read_file(tmp / "snatch_stream_raw_w.bin"));
+    EXPECT_EQ(neg, read_file(tmp / "snatch_stream_neg_w.bin"));
+    ASSERT_EQ(neg.size(), raw.size());
+    EXPECT_EQ(static_cast<unsigned char>(neg[0]), static_cast<unsigned char>(~raw[0]));
+
+    plugin_manager::set_builtin_plugins(nullptr, 0);
+}
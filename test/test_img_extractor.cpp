@@ -30,3 +30,39 @@ TEST(img_extractor, extracts_single_cell_from_image) {
     ASSERT_EQ(out.glyphs.size(), 1u);
     EXPECT_GE(out.glyphs[0].view.height, 1);
 }
+
+TEST(img_extractor, cache_file_reuses_unchanged_cells) {
+    const std::filesystem::path cache = std::filesystem::temp_directory_path() / "snatch_img_extractor_cache.bin";
+    std::filesystem::remove(cache);
+
+    image_extract_options opt;
+    opt.input_file = std::string(TEST_DATA_DIR) + "/12x16.png";
+    opt.columns = 1;
+    opt.rows = 1;
+    opt.first_ascii = 65;
+    opt.last_ascii = 65;
+    opt.proportional = true;
+    opt.cache_file = cache;
+
+    img_extractor ex;
+    extracted_font first;
+    extracted_font second;
+    std::string err;
+    image_extract_stats stats;
+    ASSERT_TRUE(ex.extract(opt, first, err, &stats)) << err;
+    EXPECT_EQ(stats.cells, 1);
+    EXPECT_EQ(stats.reused_cells, 0);
+
+    ASSERT_TRUE(ex.extract(opt, second, err, &stats)) << err;
+    EXPECT_EQ(stats.reused_cells, 1);
+    ASSERT_EQ(second.glyphs.size(), 1u);
+    EXPECT_EQ(second.glyphs[0].view.width, first.glyphs[0].view.width);
+    EXPECT_EQ(second.glyphs[0].view.stride_bytes, first.glyphs[0].view.stride_bytes);
+    EXPECT_EQ(second.glyphs[0].bitmap, first.glyphs[0].bitmap);
+
+    // a different binarization invalidates the whole cache
+    opt.inverse = true;
+    ASSERT_TRUE(ex.extract(opt, second, err, &stats)) << err;
+    EXPECT_EQ(stats.reused_cells, 0);
+    std::filesystem::remove(cache);
+}
@@ -0,0 +1,157 @@
+/// \file
+/// \brief Resident job server round-trip tests.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <snatch/job_server.h>
+#include <snatch/plugin_manager.h>
+
+namespace {
+
+/// \brief connect_silent.
+// connects and sends half a request, then neither finishes it nor hangs up
+int connect_silent(const std::filesystem::path& sock) {
+    const int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, sock.c_str(), sizeof(addr.sun_path) - 1);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) return -1;
+    const char partial[] = "snatch-job 1\n";
+    if (::send(fd, partial, sizeof(partial) - 1, MSG_NOSIGNAL) < 0) return -1;
+    return fd;
+}
+
+/// \brief read_response.
+std::string read_response(int fd) {
+    std::string r;
+    char buf[256];
+    for (ssize_t n; (n = ::recv(fd, buf, sizeof(buf), 0)) > 0;) r.append(buf, static_cast<std::size_t>(n));
+    return r;
+}
+
+/// \brief test_socket.
+std::filesystem::path test_socket(const char* name) {
+    return std::filesystem::temp_directory_path() / ("snatch_" + std::string(name) + "_" + std::to_string(::getpid()) + ".sock");
+}
+
+} // namespace
+
+TEST(job_server, rejects_malformed_requests) {
+    plugin_manager pm;
+    job_server server{pm, 1};
+    bool shutdown = false;
+
+    EXPECT_EQ(server.handle("hello\n", shutdown).rfind("snatch-result 1 3 ", 0), 0u);
+    const std::string bad_graph = server.handle("snatch-job 1\n\nextractor f x -\n", shutdown);
+    EXPECT_EQ(bad_graph.rfind("snatch-result 1 3 ", 0), 0u) << bad_graph;
+    EXPECT_NE(bad_graph.find("input="), std::string::npos) << bad_graph;
+    const std::string missing = server.handle("snatch-job 1\n\nextractor f nope - input=a\nexporter o raw_bin f output=o\n", shutdown);
+    EXPECT_NE(missing.find("plugin not found: nope"), std::string::npos) << missing;
+    EXPECT_FALSE(shutdown);
+}
+
+TEST(job_server, serves_jobs_until_shutdown) {
+    plugin_manager pm;
+    pm.load_from_dir(SNATCH_PLUGIN_DIR_PATH);
+    ASSERT_FALSE(pm.plugins().empty());
+
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path sock = tmp / ("snatch_test_" + std::to_string(::getpid()) + ".sock");
+    const std::filesystem::path out = tmp / "snatch_served.bin";
+    std::filesystem::remove(out);
+
+    job_server server{pm, 2};
+    std::string err;
+    ASSERT_TRUE(server.open(sock, err)) << err;
+    std::thread serving([&]() { server.run(); });
+
+    const std::string pipeline =
+        "extractor font ttf_extractor - input=" +
+        (std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string() + ",first_ascii=65,last_ascii=67,font_size=16\n" +
+        "exporter  bin  raw_bin       font output=" + out.string() + "\n";
+
+    // the second job hits the already loaded plugins and cached face
+    for (int i = 0; i < 2; ++i) {
+        std::ostringstream job_out;
+        std::ostringstream job_err;
+        EXPECT_EQ(submit_pipeline_job(sock, pipeline, job_out, job_err), 0) << job_err.str();
+        EXPECT_NE(job_out.str().find("exported with plugin: raw_bin"), std::string::npos) << job_out.str();
+    }
+    EXPECT_GT(std::filesystem::file_size(out), 0u);
+
+    std::ostringstream stop_err;
+    EXPECT_EQ(request_server_shutdown(sock, stop_err), 0) << stop_err.str();
+    serving.join();
+
+    std::ostringstream late_out;
+    std::ostringstream late_err;
+    EXPECT_EQ(submit_pipeline_job(sock, pipeline, late_out, late_err), 3);
+}
+
+TEST(job_server, silent_clients_time_out) {
+    plugin_manager pm;
+    const std::filesystem::path sock = test_socket("silent");
+    job_server server{pm, 1};
+    server.set_client_timeout(std::chrono::milliseconds(200));
+    std::string err;
+    ASSERT_TRUE(server.open(sock, err)) << err;
+    std::thread serving([&]() { server.run(); });
+
+    const int silent = connect_silent(sock);
+    ASSERT_GE(silent, 0);
+    const std::string response = read_response(silent);
+    ::close(silent);
+    EXPECT_EQ(response.rfind("snatch-result 1 3 ", 0), 0u) << response;
+    EXPECT_NE(response.find("timed out"), std::string::npos) << response;
+
+    // the server went on to the next client
+    std::ostringstream stop_err;
+    EXPECT_EQ(request_server_shutdown(sock, stop_err), 0) << stop_err.str();
+    serving.join();
+}
+
+TEST(job_server, stop_signal_ends_a_silent_client) {
+    plugin_manager pm;
+    const std::filesystem::path sock = test_socket("signal");
+    job_server server{pm, 1};
+    server.set_client_timeout(std::chrono::seconds(30));
+    std::string err;
+    ASSERT_TRUE(server.open(sock, err)) << err;
+    std::thread serving([&]() { server.run(); });
+
+    // an answered job means run() has installed its signal handlers
+    std::ostringstream job_out;
+    std::ostringstream job_err;
+    EXPECT_EQ(submit_pipeline_job(sock, "", job_out, job_err), 3);
+
+    const int silent = connect_silent(sock);
+    ASSERT_GE(silent, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    const auto start = std::chrono::steady_clock::now();
+    ::pthread_kill(serving.native_handle(), SIGTERM);
+    const std::string response = read_response(silent);
+    serving.join();
+    ::close(silent);
+
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_EQ(response.rfind("snatch-result 1 3 ", 0), 0u) << response;
+    EXPECT_FALSE(std::filesystem::exists(sock));
+}
@@ -0,0 +1,97 @@
+/// \file
+/// \brief Unit tests for pipeline graph parsing and validation.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <snatch/pipeline.h>
+
+TEST(pipeline_graph, parses_nodes_comments_and_color_parameters) {
+    const std::string text =
+        "# shared extraction, two branches\n"
+        "extractor   font ttf_extractor          -    input=a.ttf,font_size=16\n"
+        "\n"
+        "transformer tiny partner_tiny_transform font\n"
+        "exporter    asm  partner_sdcc_asm_tiny  tiny output=out/tiny.s\n"
+        "exporter    img  png                    font output=out/font.png,fore_color=#000000\n";
+
+    pipeline_graph g;
+    std::string err;
+    ASSERT_TRUE(pipeline_graph::parse(text, g, err)) << err;
+    ASSERT_EQ(g.nodes().size(), 4u);
+    EXPECT_EQ(g.nodes()[0].stage, pipeline_stage::extractor);
+    EXPECT_TRUE(g.nodes()[0].input.empty());
+    EXPECT_EQ(g.nodes()[0].parameters, "input=a.ttf,font_size=16");
+    EXPECT_EQ(g.nodes()[1].input, "font");
+    EXPECT_TRUE(g.nodes()[1].parameters.empty());
+    EXPECT_EQ(g.nodes()[3].parameters, "output=out/font.png,fore_color=#000000");
+    EXPECT_TRUE(g.validate(err)) << err;
+
+    pipeline_graph again;
+    ASSERT_TRUE(pipeline_graph::parse(g.to_text(), again, err)) << err;
+    EXPECT_EQ(again.to_text(), g.to_text());
+    EXPECT_EQ(g.plugin_names().size(), 4u);
+}
+
+TEST(pipeline_graph, parse_rejects_malformed_lines) {
+    pipeline_graph g;
+    std::string err;
+    EXPECT_FALSE(pipeline_graph::parse("filter x y -\n", g, err));
+    EXPECT_NE(err.find("line 1"), std::string::npos) << err;
+    EXPECT_FALSE(pipeline_graph::parse("extractor a ttf_extractor - input=a.ttf\nexporter b\n", g, err));
+    EXPECT_NE(err.find("line 2"), std::string::npos) << err;
+    EXPECT_FALSE(pipeline_graph::parse("extractor a p - input=x\nextractor a p - input=y\n", g, err));
+    EXPECT_NE(err.find("duplicate node id"), std::string::npos) << err;
+}
+
+TEST(pipeline_graph, validate_rejects_bad_wiring) {
+    const auto invalid = [](const std::string& text) {
+        pipeline_graph g;
+        std::string err;
+        EXPECT_TRUE(pipeline_graph::parse(text, g, err)) << err;
+        EXPECT_FALSE(g.validate(err)) << text;
+        return err;
+    };
+
+    EXPECT_NE(invalid("extractor f e -\n").find("input="), std::string::npos);
+    EXPECT_NE(invalid("extractor f e - input=a\nexporter o x f\n").find("output="), std::string::npos);
+    EXPECT_NE(invalid("extractor f e - input=a\nexporter o x g output=o\n").find("unknown node"), std::string::npos);
+    EXPECT_NE(invalid("extractor f e - input=a\nexporter o x f output=o\nexporter p y o output=p\n").find("cannot read exporter"),
+              std::string::npos);
+    EXPECT_NE(invalid("extractor f e - input=a\nexporter o x f output=o\nexporter p y f output=o\n").find("another exporter"),
+              std::string::npos);
+    EXPECT_NE(invalid("extractor f e - input=a\ntransformer a t b\ntransformer b u a\n").find("cycle"), std::string::npos);
+    EXPECT_NE(invalid("extractor f e - input=a\ntransformer a t f\ntransformer b t a\n").find("used twice"), std::string::npos);
+    EXPECT_NE(invalid("extractor f e - input=a\n"
+                      "transformer a1 t f\ntransformer a2 u a1\n"
+                      "transformer b1 u f\ntransformer b2 t b1\n").find("opposite orders"),
+              std::string::npos);
+}
+
+TEST(pipeline_graph, same_plugin_on_sibling_branches_is_valid) {
+    pipeline_graph g;
+    std::string err;
+    ASSERT_TRUE(pipeline_graph::parse(
+        "extractor f e - input=a\n"
+        "transformer a t f size=1\n"
+        "transformer b t f size=2\n"
+        "exporter oa x a output=a\n"
+        "exporter ob x b output=b\n", g, err)) << err;
+    EXPECT_TRUE(g.validate(err)) << err;
+}
+
+TEST(pipeline_report, exit_code_reflects_failed_stage) {
+    pipeline_report r;
+    EXPECT_EQ(r.exit_code(), 0);
+    r.nodes.push_back({"e", pipeline_stage::exporter, true, 7, "boom"});
+    EXPECT_EQ(r.exit_code(), 5);
+    EXPECT_FALSE(r.ok());
+    r.nodes.push_back({"f", pipeline_stage::extractor, true, 2, "missing"});
+    EXPECT_EQ(r.exit_code(), 4);
+}
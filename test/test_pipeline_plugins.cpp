@@ -8,16 +8,24 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
+#include <chrono>
 #include <cstdio>
+#include <cstdlib>
 #include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <string>
+#include <vector>
 #ifndef _WIN32
 #include <sys/wait.h>
+#include <unistd.h>
 #endif
 
+#include "snatch/png_reader.h"
+#include "snatch_unpack.h"
+
 namespace {
 
 struct cmd_result {
@@ -25,8 +33,31 @@ struct cmd_result {
     std::string output;
 };
 
+#ifndef _WIN32
+/// \brief hermetic_cache_home.
+// points the snatch runs of this process at a cache of their own, so route and
+// glyph caches left in ~/.cache/snatch by other runs cannot change results
+struct hermetic_cache_home {
+    std::filesystem::path dir;
+
+    hermetic_cache_home() : dir(std::filesystem::temp_directory_path() / ("snatch_test_cache_" + std::to_string(::getpid()))) {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+        std::filesystem::create_directories(dir, ec);
+        ::setenv("XDG_CACHE_HOME", dir.c_str(), 1);
+    }
+    ~hermetic_cache_home() {
+        std::error_code ec;
+        std::filesystem::remove_all(dir, ec);
+    }
+};
+#endif
+
 /// \brief run_command_capture.
 cmd_result run_command_capture(const std::string& cmd) {
+#ifndef _WIN32
+    static const hermetic_cache_home cache_home;
+#endif
     cmd_result res;
     const std::string full = cmd + " 2>&1";
     FILE* pipe = popen(full.c_str(), "r");
@@ -70,6 +101,18 @@ std::string read_file(const std::filesystem::path& p) {
     return ss.str();
 }
 
+/// \brief read_gray_png.
+// every row of a PNG as 8-bit gray, empty if it does not decode
+std::vector<std::uint8_t> read_gray_png(const std::filesystem::path& p) {
+    png_row_reader reader;
+    if (!reader.open(p)) return {};
+    std::vector<std::uint8_t> pixels(static_cast<size_t>(reader.width()) * static_cast<size_t>(reader.height()));
+    for (int y = 0; y < reader.height(); ++y) {
+        if (!reader.read_gray_row(pixels.data() + static_cast<size_t>(y) * static_cast<size_t>(reader.width()))) return {};
+    }
+    return pixels;
+}
+
 } // namespace
 
 TEST(pipeline_plugins, ttf_extractor_is_used_end_to_end) {
@@ -91,6 +134,71 @@ TEST(pipeline_plugins, ttf_extractor_is_used_end_to_end) {
     EXPECT_GT(std::filesystem::file_size(out), 0u);
 }
 
+TEST(pipeline_plugins, lazy_ttf_extraction_makes_only_what_is_exported) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const auto run = [&](const std::string& extract, const std::string& exporter, const std::string& params) {
+        const std::filesystem::path out = tmp / ("snatch_lazy_" + exporter + ".out");
+        std::filesystem::remove(out);
+        const std::string cmd =
+            std::string(SNATCH_BIN_PATH) +
+            " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+            " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "pixel-unicode-regular.ttf").string() + ",font_size=16," + extract + "\"" +
+            " --exporter " + exporter +
+            " --exporter-parameters \"output=" + out.string() + params + "\"";
+        const auto res = run_command_capture(cmd);
+        EXPECT_EQ(res.exit_code, 0) << res.output;
+        return std::make_pair(res.output, read_file(out));
+    };
+
+    // a sheet of 4x8 cells shows the first 32 glyphs of the whole BMP
+    const auto eager_png = run("first_ascii=32,last_ascii=63", "png", ",rows=4,columns=8");
+    const auto lazy_png = run("first_ascii=32,last_ascii=65535,lazy=true", "png", ",rows=4,columns=8");
+    EXPECT_FALSE(eager_png.second.empty());
+    EXPECT_EQ(lazy_png.second, eager_png.second);
+    EXPECT_NE(lazy_png.first.find("extracted glyphs: 65504"), std::string::npos) << lazy_png.first;
+
+    // stages that do not read glyphs on demand get them all made up front
+    const auto eager_bin = run("first_ascii=32,last_ascii=255", "compressed_bin", ",algorithm=none");
+    const auto lazy_bin = run("first_ascii=32,last_ascii=255,lazy=true,cache=16", "compressed_bin", ",algorithm=none");
+    EXPECT_FALSE(eager_bin.second.empty());
+    EXPECT_EQ(lazy_bin.second, eager_bin.second);
+}
+
+TEST(pipeline_plugins, bdf_input_infers_the_bdf_extractor) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path font = tmp / "snatch_pipeline.bdf";
+    std::ofstream(font) << "STARTFONT 2.1\nFONTBOUNDINGBOX 8 8 0 0\nCHARS 2\n"
+                           "STARTCHAR A\nENCODING 65\nDWIDTH 6 0\nBBX 5 2 0 0\nBITMAP\n70\n88\nENDCHAR\n"
+                           "STARTCHAR B\nENCODING 66\nDWIDTH 7 0\nBBX 6 1 1 2\nBITMAP\nFC\nENDCHAR\nENDFONT\n";
+    const std::filesystem::path out = tmp / "snatch_pipeline_bdf.bin";
+    std::filesystem::remove(out);
+
+    const std::string cmd =
+        std::string(SNATCH_BIN_PATH) +
+        " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --extractor-parameters \"input=" + font.string() + "\"" +
+        " --exporter compressed_bin" +
+        " --exporter-parameters \"output=" + out.string() + ",algorithm=none,mode=glyph\"";
+    const auto res = run_command_capture(cmd);
+    ASSERT_EQ(res.exit_code, 0) << res.output;
+
+    const std::string text = read_file(out);
+    const std::vector<unsigned char> file(text.begin(), text.end());
+    snatch_pack pack;
+    ASSERT_EQ(snatch_pack_open(&pack, file.data(), file.size()), 0);
+    ASSERT_EQ(pack.glyph_count, 2u);
+    snatch_pack_glyph b;
+    ASSERT_EQ(snatch_pack_glyph_at(&pack, 1, &b), 0);
+    EXPECT_EQ(b.codepoint, 66u);
+    EXPECT_EQ(b.width, 6);
+    EXPECT_EQ(b.bearing_x, 1);
+    EXPECT_EQ(b.bearing_y, 3);
+    EXPECT_EQ(b.advance_x, 7);
+    unsigned char rows[1];
+    ASSERT_EQ(snatch_pack_unpack_glyph(&pack, 1, rows, sizeof(rows)), 1);
+    EXPECT_EQ(rows[0], 0xFC);
+}
+
 TEST(pipeline_plugins, image_extractor_is_used_end_to_end) {
     const std::filesystem::path out = std::filesystem::temp_directory_path() / "snatch_image_pipeline.bin";
     std::filesystem::remove(out);
@@ -157,6 +265,160 @@ TEST(pipeline_plugins, image_passthrough_dither_png_concept) {
     EXPECT_GT(std::filesystem::file_size(out), 0u);
 }
 
+TEST(pipeline_plugins, dither_modes_produce_the_same_sized_bitmap) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const auto dither = [&](const std::string& mode) {
+        const std::filesystem::path out = tmp / ("snatch_dither_" + mode + ".bin");
+        std::filesystem::remove(out);
+        const std::string cmd =
+            std::string(SNATCH_BIN_PATH) +
+            " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+            " --extractor image_passthrough_extractor" +
+            " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "tut.png").string() + "\"" +
+            " --transformer dither_1bpp_transform" +
+            " --transformer-parameters \"mode=" + mode + "\"" +
+            " --exporter raw_bin" +
+            " --exporter-parameters \"output=" + out.string() + "\"";
+        const auto res = run_command_capture(cmd);
+        EXPECT_EQ(res.exit_code, 0) << mode << ": " << res.output;
+        return read_file(out);
+    };
+
+    const std::string fs = dither("floyd-steinberg");
+    ASSERT_FALSE(fs.empty());
+    for (const char* mode : {"atkinson", "sierra-lite", "bayer", "blue-noise"}) {
+        const std::string other = dither(mode);
+        EXPECT_EQ(other.size(), fs.size()) << mode;
+        EXPECT_NE(other, fs) << mode;
+    }
+}
+
+TEST(pipeline_plugins, dither_threads_do_not_change_the_bitmap) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const auto dither = [&](const std::string& mode, int threads) {
+        const std::filesystem::path out = tmp / ("snatch_dither_" + mode + "_t" + std::to_string(threads) + ".bin");
+        std::filesystem::remove(out);
+        const std::string cmd =
+            std::string(SNATCH_BIN_PATH) +
+            " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+            " --extractor image_passthrough_extractor" +
+            " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "tut.png").string() + "\"" +
+            " --transformer dither_1bpp_transform" +
+            " --transformer-parameters \"mode=" + mode + ",threads=" + std::to_string(threads) + "\"" +
+            " --exporter raw_bin" +
+            " --exporter-parameters \"output=" + out.string() + "\"" +
+            // png does not stream, so the whole image is dithered at once
+            " --exporter png" +
+            " --exporter-parameters \"output=" + (tmp / "snatch_dither_threads.png").string() + ",columns=1,rows=1,padding=0,grid_thickness=0\"";
+        const auto res = run_command_capture(cmd);
+        EXPECT_EQ(res.exit_code, 0) << mode << ": " << res.output;
+        return read_file(out);
+    };
+
+    for (const char* mode : {"floyd-steinberg", "atkinson", "sierra-lite", "bayer"}) {
+        const std::string serial = dither(mode, 1);
+        ASSERT_FALSE(serial.empty()) << mode;
+        for (const int threads : {2, 3, 8}) EXPECT_EQ(dither(mode, threads), serial) << mode << " threads=" << threads;
+    }
+}
+
+TEST(pipeline_plugins, dither_streams_the_image_in_bands) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::string input = (std::filesystem::path(TEST_DATA_DIR) / "tut.png").string();
+    for (const char* mode : {"floyd-steinberg", "atkinson", "blue-noise"}) {
+        const std::filesystem::path whole = tmp / (std::string("snatch_dither_whole_") + mode + ".bin");
+        const std::filesystem::path banded = tmp / (std::string("snatch_dither_banded_") + mode + ".bin");
+        const std::filesystem::path png_out = tmp / (std::string("snatch_dither_whole_") + mode + ".png");
+        std::filesystem::remove(whole);
+        std::filesystem::remove(banded);
+        const std::string common =
+            std::string(SNATCH_BIN_PATH) +
+            " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+            " --extractor image_passthrough_extractor" +
+            " --extractor-parameters \"input=" + input + ",tile_rows=37\"" +
+            " --transformer dither_1bpp_transform" +
+            " --transformer-parameters \"mode=" + mode + "\"";
+
+        // png does not stream, so this run dithers the whole image at once
+        const auto res_whole = run_command_capture(common +
+            " --exporter raw_bin --exporter-parameters \"output=" + whole.string() + "\"" +
+            " --exporter png --exporter-parameters \"output=" + png_out.string() + ",columns=1,rows=1,padding=0,grid_thickness=0\"");
+        ASSERT_EQ(res_whole.exit_code, 0) << res_whole.output;
+        const auto res_banded = run_command_capture(common + " --exporter raw_bin --exporter-parameters \"output=" + banded.string() + "\"");
+        ASSERT_EQ(res_banded.exit_code, 0) << res_banded.output;
+
+        const std::string expected = read_file(whole);
+        ASSERT_EQ(expected.size(), static_cast<std::size_t>((1462 + 7) / 8 * 1032)) << mode;
+        EXPECT_EQ(read_file(banded), expected) << mode;
+    }
+}
+
+TEST(pipeline_plugins, mismatched_payload_fails_before_running) {
+    const std::filesystem::path out = std::filesystem::temp_directory_path() / "snatch_passthrough_undithered.png";
+    std::filesystem::remove(out);
+
+    const std::string cmd =
+        std::string(SNATCH_BIN_PATH) +
+        " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --extractor image_passthrough_extractor" +
+        " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "tut.png").string() + "\"" +
+        " --exporter png" +
+        " --exporter-parameters \"output=" + out.string() + "\"";
+
+    const auto res = run_command_capture(cmd);
+    EXPECT_EQ(res.exit_code, 3) << res.output;
+    EXPECT_NE(res.output.find("accepts bitmap but 'extract' (image_passthrough_extractor) produces image"), std::string::npos)
+        << res.output;
+    EXPECT_EQ(res.output.find("extracted with plugin"), std::string::npos) << res.output;
+    EXPECT_FALSE(std::filesystem::exists(out));
+}
+
+TEST(pipeline_plugins, one_extraction_fans_out_to_multiple_exporters) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path bin_out = tmp / "snatch_fanout.bin";
+    const std::filesystem::path c_out = tmp / "snatch_fanout.c";
+    const std::filesystem::path asm_out = tmp / "snatch_fanout.s";
+    std::filesystem::remove(bin_out);
+    std::filesystem::remove(c_out);
+    std::filesystem::remove(asm_out);
+
+    const std::string cmd =
+        std::string(SNATCH_BIN_PATH) +
+        " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string() + ",first_ascii=65,last_ascii=67,font_size=16\"" +
+        " --transformer partner_bitmap_transform" +
+        " --transformer-parameters \"font_mode=proportional,space_width=3,letter_spacing=2\"" +
+        " --exporter raw_bin --exporter-parameters \"output=" + bin_out.string() + "\"" +
+        " --exporter raw_c --exporter-parameters \"output=" + c_out.string() + ",symbol=fanout_font\"" +
+        " --exporter partner_sdcc_asm_bitmap --exporter-parameters \"output=" + asm_out.string() + ",proportional=true,space_width=3\"";
+
+    const auto res = run_command_capture(cmd);
+    ASSERT_EQ(res.exit_code, 0) << res.output;
+    EXPECT_NE(res.output.find("exported with plugin: raw_bin"), std::string::npos) << res.output;
+    EXPECT_NE(res.output.find("exported with plugin: raw_c"), std::string::npos) << res.output;
+    EXPECT_NE(res.output.find("exported with plugin: partner_sdcc_asm_bitmap"), std::string::npos) << res.output;
+    ASSERT_TRUE(std::filesystem::exists(bin_out));
+    ASSERT_TRUE(std::filesystem::exists(c_out));
+    ASSERT_TRUE(std::filesystem::exists(asm_out));
+    EXPECT_GT(std::filesystem::file_size(bin_out), 0u);
+    EXPECT_NE(read_file(c_out).find("const uint8_t fanout_font[]"), std::string::npos);
+}
+
+TEST(pipeline_plugins, duplicate_exporter_output_is_error) {
+    const std::filesystem::path out = std::filesystem::temp_directory_path() / "snatch_fanout_dup.bin";
+
+    const std::string cmd =
+        std::string(SNATCH_BIN_PATH) +
+        " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "12x16.png").string() + ",columns=16,rows=6,first_ascii=32,last_ascii=33\"" +
+        " --exporter raw_bin --exporter-parameters \"output=" + out.string() + "\"" +
+        " --exporter raw_c --exporter-parameters \"output=" + out.string() + "\"";
+
+    const auto res = run_command_capture(cmd);
+    EXPECT_NE(res.exit_code, 0);
+    EXPECT_NE(res.output.find("used more than once"), std::string::npos) << res.output;
+}
+
 TEST(pipeline_plugins, missing_extractor_input_parameter_is_error) {
     const std::filesystem::path out = std::filesystem::temp_directory_path() / "snatch_missing_input.bin";
     std::filesystem::remove(out);
@@ -223,6 +485,482 @@ TEST(pipeline_plugins, partner_tiny_bin_roundtrip_to_png_grid) {
     EXPECT_GT(std::filesystem::file_size(png_out), 0u);
 }
 
+TEST(pipeline_plugins, png_indexed_grid_matches_rgb_grid) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    // odd padding puts glyphs off byte boundaries; a coloured grid needs the 2-bit palette
+    const char* grids[] = {"grid_thickness=0", "grid_thickness=1", "grid_thickness=2,grid_color=#FF0000"};
+    const int depths[] = {1, 1, 2};
+    for (int i = 0; i < 3; ++i) {
+        std::uintmax_t sizes[2] = {0, 0};
+        std::vector<std::uint8_t> gray[2];
+        for (int indexed = 0; indexed < 2; ++indexed) {
+            const std::filesystem::path out = tmp / ("snatch_png_grid_" + std::to_string(i) + (indexed ? "_indexed.png" : "_rgb.png"));
+            std::filesystem::remove(out);
+            const std::string cmd =
+                std::string(SNATCH_BIN_PATH) +
+                " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+                " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string() + ",first_ascii=33,last_ascii=126,font_size=16\"" +
+                " --exporter png" +
+                " --exporter-parameters \"output=" + out.string() + ",columns=13,padding=3," + grids[i] +
+                (indexed ? ",pixel_format=indexed" : "") + "\"";
+            const auto res = run_command_capture(cmd);
+            ASSERT_EQ(res.exit_code, 0) << res.output;
+            sizes[indexed] = std::filesystem::file_size(out);
+            gray[indexed] = read_gray_png(out);
+            ASSERT_FALSE(gray[indexed].empty()) << out;
+            if (indexed) {
+                const std::string bytes = read_file(out);
+                ASSERT_GT(bytes.size(), 26u);
+                EXPECT_EQ(static_cast<int>(bytes[24]), depths[i]) << grids[i]; // IHDR bit depth
+                EXPECT_EQ(static_cast<int>(bytes[25]), 3) << grids[i];         // palette colour type
+            }
+        }
+        EXPECT_EQ(gray[1], gray[0]) << grids[i];
+        EXPECT_LT(sizes[1], sizes[0]) << grids[i];
+    }
+}
+
+TEST(pipeline_plugins, png_threads_and_compression_keep_the_pixels) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const auto render = [&](const std::string& format, const std::string& extra, const char* tag) {
+        const std::filesystem::path out = tmp / ("snatch_png_parallel_" + format + "_" + tag + ".png");
+        std::filesystem::remove(out);
+        const std::string cmd =
+            std::string(SNATCH_BIN_PATH) +
+            " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+            " --extractor image_passthrough_extractor" +
+            " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "tut.png").string() + "\"" +
+            " --transformer dither_1bpp_transform" +
+            " --exporter png" +
+            " --exporter-parameters \"output=" + out.string() + ",columns=1,rows=1,padding=0,grid_thickness=0,pixel_format=" + format + extra + "\"";
+        const auto res = run_command_capture(cmd);
+        EXPECT_EQ(res.exit_code, 0) << res.output;
+        return read_gray_png(out);
+    };
+    for (const char* format : {"rgb", "indexed"}) {
+        const std::vector<std::uint8_t> serial = render(format, ",threads=1", "serial");
+        ASSERT_FALSE(serial.empty()) << format;
+        EXPECT_EQ(render(format, ",threads=4,compression=1", "fast"), serial) << format;
+    }
+}
+
+TEST(pipeline_plugins, atlas_packs_every_inked_pixel_once) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path atlas = tmp / "snatch_atlas.png";
+    const std::filesystem::path table = tmp / "snatch_atlas_rects.bin";
+    const std::filesystem::path c_table = tmp / "snatch_atlas_rects.c";
+    const std::filesystem::path grid = tmp / "snatch_atlas_reference.png";
+    for (const auto& p : {atlas, table, c_table, grid}) std::filesystem::remove(p);
+    const std::string cmd =
+        std::string(SNATCH_BIN_PATH) +
+        " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string() + ",first_ascii=32,last_ascii=126,font_size=24\"" +
+        " --exporter atlas --exporter-parameters \"output=" + atlas.string() + ",spacing=1\"" +
+        " --exporter atlas --exporter-parameters \"output=" + (tmp / "snatch_atlas_c.bin").string() + ",table=" + c_table.string() + ",symbol=demo,align_x=8\"" +
+        " --exporter png --exporter-parameters \"output=" + grid.string() + ",grid_thickness=0\"";
+    const auto res = run_command_capture(cmd);
+    ASSERT_EQ(res.exit_code, 0) << res.output;
+
+    const std::string bytes = read_file(table);
+    ASSERT_GE(bytes.size(), 14u);
+    ASSERT_EQ(bytes.substr(0, 4), "SATL");
+    const auto u16 = [&](size_t at) { return static_cast<int>(static_cast<unsigned char>(bytes[at]) | (static_cast<unsigned char>(bytes[at + 1]) << 8)); };
+    EXPECT_EQ(u16(4), 2);
+    const int count = u16(6) | u16(8) << 16;
+    const int atlas_w = u16(10);
+    const int atlas_h = u16(12);
+    ASSERT_EQ(count, 95);
+    ASSERT_EQ(bytes.size(), 14u + static_cast<size_t>(count) * 18u);
+
+    const std::vector<std::uint8_t> packed = read_gray_png(atlas);
+    ASSERT_EQ(packed.size(), static_cast<size_t>(atlas_w) * static_cast<size_t>(atlas_h));
+    std::vector<int> owner(packed.size(), -1);
+    size_t inked_in_rects = 0;
+    for (int i = 0; i < count; ++i) {
+        const size_t at = 14 + static_cast<size_t>(i) * 18;
+        const int x = u16(at + 4);
+        const int y = u16(at + 6);
+        const int w = u16(at + 8);
+        const int h = u16(at + 10);
+        ASSERT_LE(x + w, atlas_w) << i;
+        ASSERT_LE(y + h, atlas_h) << i;
+        for (int yy = y; yy < y + h; ++yy) {
+            for (int xx = x; xx < x + w; ++xx) {
+                const size_t p = static_cast<size_t>(yy) * static_cast<size_t>(atlas_w) + static_cast<size_t>(xx);
+                ASSERT_EQ(owner[p], -1) << "glyphs " << owner[p] << " and " << i << " overlap";
+                owner[p] = i;
+                if (packed[p] == 0) ++inked_in_rects;
+            }
+        }
+    }
+    const auto inked = [](const std::vector<std::uint8_t>& px) { return static_cast<size_t>(std::count(px.begin(), px.end(), std::uint8_t{0})); };
+    EXPECT_EQ(inked(packed), inked_in_rects);
+    EXPECT_EQ(inked(packed), inked(read_gray_png(grid)));
+
+    const std::string c_text = read_file(c_table);
+    EXPECT_NE(c_text.find("const demo_rect demo_rects[95]"), std::string::npos) << c_text.substr(0, 400);
+
+    // counts past 16 bits
+    const auto big = run_command_capture(std::string(SNATCH_BIN_PATH) + " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "pixel-unicode-regular.ttf").string() + ",first_ascii=32,last_ascii=70000,font_size=16\"" +
+        " --exporter atlas --exporter-parameters \"output=" + (tmp / "snatch_atlas_big.bin").string() + ",table=" + table.string() + "\"" +
+        " --exporter atlas --exporter-parameters \"output=" + (tmp / "snatch_atlas_big_c.bin").string() + ",table=" + c_table.string() + ",symbol=big\"");
+    ASSERT_EQ(big.exit_code, 0) << big.output;
+    const std::string big_bytes = read_file(table);
+    ASSERT_GE(big_bytes.size(), 14u);
+    const std::uint32_t big_count = static_cast<unsigned char>(big_bytes[6]) | static_cast<unsigned char>(big_bytes[7]) << 8 |
+                                    static_cast<unsigned char>(big_bytes[8]) << 16 | static_cast<std::uint32_t>(static_cast<unsigned char>(big_bytes[9])) << 24;
+    EXPECT_EQ(big_count, 69969u);
+    EXPECT_EQ(big_bytes.size(), 14u + big_count * 18u);
+    EXPECT_NE(read_file(c_table).find("const uint32_t big_count = 69969;"), std::string::npos);
+}
+
+TEST(pipeline_plugins, compressed_bin_unpacks_to_the_stored_rows) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path report = tmp / "snatch_packed_report.txt";
+    const auto encode = [&](const std::string& params) {
+        const std::filesystem::path out = tmp / "snatch_packed.bin";
+        std::filesystem::remove(out);
+        const std::string cmd =
+            std::string(SNATCH_BIN_PATH) +
+            " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+            " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "pixel-unicode-regular.ttf").string() + ",first_ascii=32,last_ascii=255,font_size=16\"" +
+            " --exporter compressed_bin" +
+            " --exporter-parameters \"output=" + out.string() + "," + params + "\"";
+        const auto res = run_command_capture(cmd);
+        EXPECT_EQ(res.exit_code, 0) << res.output;
+        const std::string text = read_file(out);
+        return std::vector<unsigned char>(text.begin(), text.end());
+    };
+    // every glyph's rows, whichever way the file stores them
+    const auto glyph_rows = [](const std::vector<unsigned char>& file) {
+        std::vector<std::vector<unsigned char>> rows;
+        snatch_pack pack;
+        if (snatch_pack_open(&pack, file.data(), file.size()) != 0) return rows;
+        std::vector<unsigned char> font(pack.unpacked_size);
+        if (pack.mode == SNATCH_PACK_MODE_FONT && snatch_pack_unpack_font(&pack, font.data(), font.size()) != static_cast<long>(font.size())) return rows;
+        for (std::uint32_t i = 0; i < pack.glyph_count; ++i) {
+            snatch_pack_glyph g;
+            EXPECT_EQ(snatch_pack_glyph_at(&pack, i, &g), 0);
+            std::vector<unsigned char> r(static_cast<std::size_t>((g.width + 7) / 8) * g.height);
+            if (pack.mode == SNATCH_PACK_MODE_FONT) {
+                if (g.offset + r.size() > font.size()) return std::vector<std::vector<unsigned char>>{};
+                std::copy_n(font.begin() + g.offset, r.size(), r.begin());
+            } else {
+                EXPECT_EQ(snatch_pack_unpack_glyph(&pack, i, r.data(), r.size()), static_cast<long>(r.size())) << i;
+            }
+            rows.push_back(r);
+        }
+        return rows;
+    };
+
+    const std::vector<unsigned char> stored = encode("algorithm=none");
+    const auto expected = glyph_rows(stored);
+    ASSERT_EQ(expected.size(), 224u);
+    for (const std::string params : {"algorithm=rle", "algorithm=lz,threads=2", "algorithm=rle,mode=glyph", "algorithm=lz,mode=glyph"}) {
+        const std::vector<unsigned char> packed = encode(params);
+        EXPECT_LT(packed.size(), stored.size()) << params;
+        EXPECT_EQ(glyph_rows(packed), expected) << params;
+    }
+
+    std::filesystem::remove(report);
+    encode("report=" + report.string());
+    const std::string text = read_file(report);
+    EXPECT_NE(text.find("\n65 "), std::string::npos) << text;
+    EXPECT_NE(text.find("# total "), std::string::npos) << text;
+
+    const auto res = run_command_capture(std::string(SNATCH_BIN_PATH) + " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "pixel-unicode-regular.ttf").string() + ",first_ascii=65,last_ascii=70,font_size=16\"" +
+        " --exporter compressed_bin --exporter-parameters \"output=" + (tmp / "snatch_packed_bad.bin").string() + ",algorithm=zx7\"");
+    EXPECT_NE(res.exit_code, 0);
+    EXPECT_NE(res.output.find("algorithm must be none|rle|lz"), std::string::npos) << res.output;
+}
+
+TEST(pipeline_plugins, compressed_bin_random_mode_finds_each_glyph_alone) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const auto encode = [&](const std::string& params) {
+        const std::filesystem::path out = tmp / "snatch_packed_ra.bin";
+        std::filesystem::remove(out);
+        const std::string cmd =
+            std::string(SNATCH_BIN_PATH) +
+            " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+            " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "pixel-unicode-regular.ttf").string() + ",first_ascii=32,last_ascii=255,font_size=16\"" +
+            " --exporter compressed_bin" +
+            " --exporter-parameters \"output=" + out.string() + "," + params + "\"";
+        const auto res = run_command_capture(cmd);
+        EXPECT_EQ(res.exit_code, 0) << res.output;
+        const std::string text = read_file(out);
+        return std::vector<unsigned char>(text.begin(), text.end());
+    };
+
+    const std::vector<unsigned char> stored = encode("algorithm=none,mode=glyph");
+    snatch_pack pack;
+    ASSERT_EQ(snatch_pack_open(&pack, stored.data(), stored.size()), 0);
+    ASSERT_EQ(pack.glyph_count, 224u);
+    for (const std::string params : {"algorithm=none,mode=random", "algorithm=rle,mode=random", "algorithm=lz,mode=random,dictionary=0",
+                                     "algorithm=lz,mode=random,threads=3"}) {
+        const std::vector<unsigned char> file = encode(params);
+        snatch_pack_ra ra;
+        ASSERT_EQ(snatch_ra_open(&ra, file.data(), file.size()), 0) << params;
+        for (std::uint32_t i = 0; i < pack.glyph_count; ++i) {
+            snatch_pack_glyph want;
+            snatch_pack_glyph got;
+            ASSERT_EQ(snatch_pack_glyph_at(&pack, i, &want), 0);
+            const std::size_t size = static_cast<std::size_t>((want.width + 7) / 8) * want.height;
+            std::vector<unsigned char> expected(size);
+            std::vector<unsigned char> rows(size);
+            ASSERT_EQ(snatch_pack_unpack_glyph(&pack, i, expected.data(), expected.size()), static_cast<long>(size));
+            EXPECT_EQ(snatch_ra_glyph(&ra, want.codepoint, &got, rows.data(), rows.size()), static_cast<long>(size)) << params << ' ' << want.codepoint;
+            EXPECT_EQ(rows, expected) << params << ' ' << want.codepoint;
+            EXPECT_EQ(got.width, want.width);
+            EXPECT_EQ(got.height, want.height);
+            EXPECT_EQ(got.bearing_x, want.bearing_x);
+            EXPECT_EQ(got.bearing_y, want.bearing_y);
+            EXPECT_EQ(got.advance_x, want.advance_x);
+        }
+        std::uint8_t sink[64];
+        snatch_pack_glyph g;
+        EXPECT_EQ(snatch_ra_glyph(&ra, ra.last + 1, &g, sink, sizeof(sink)), -1);
+    }
+
+    // the offset table costs 2 bytes a glyph, the glyph table 20
+    const std::size_t glyph_lz = encode("algorithm=lz,mode=glyph").size();
+    const std::size_t plain_lz = encode("algorithm=lz,mode=random,dictionary=0").size();
+    const std::size_t trained_lz = encode("algorithm=lz,mode=random").size();
+    EXPECT_LT(plain_lz, glyph_lz);
+    EXPECT_LE(trained_lz, plain_lz);
+
+    const auto res = run_command_capture(std::string(SNATCH_BIN_PATH) + " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "pixel-unicode-regular.ttf").string() + ",first_ascii=65,last_ascii=70,font_size=16\"" +
+        " --exporter compressed_bin --exporter-parameters \"output=" + (tmp / "snatch_packed_bad.bin").string() + ",mode=random,dictionary=99999\"");
+    EXPECT_NE(res.exit_code, 0);
+    EXPECT_NE(res.output.find("dictionary must be auto or 0..32768"), std::string::npos) << res.output;
+}
+
+// Bytes saved versus decode cost of each random-access packing. Run with
+//   snatch_tests --gtest_also_run_disabled_tests --gtest_filter='*compressed_bin_random_mode_benchmark'
+TEST(pipeline_plugins, DISABLED_compressed_bin_random_mode_benchmark) {
+    const std::filesystem::path out = std::filesystem::temp_directory_path() / "snatch_packed_bench.bin";
+    const auto encode = [&](const std::string& params) {
+        std::filesystem::remove(out);
+        const auto res = run_command_capture(std::string(SNATCH_BIN_PATH) + " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+            " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "pixel-unicode-regular.ttf").string() +
+            ",first_ascii=32,last_ascii=255,font_size=16\"" +
+            " --exporter compressed_bin --exporter-parameters \"output=" + out.string() + "," + params + "\"");
+        EXPECT_EQ(res.exit_code, 0) << res.output;
+        const std::string text = read_file(out);
+        return std::vector<unsigned char>(text.begin(), text.end());
+    };
+
+    std::printf("%-38s %8s %8s %12s\n", "pixel-unicode 32..255 16px", "bytes", "saved", "ns/glyph");
+    std::size_t stored = 0;
+    for (const char* params : {"algorithm=none,mode=random", "algorithm=rle,mode=random",
+                               "algorithm=lz,mode=random,dictionary=0", "algorithm=lz,mode=random"}) {
+        const std::vector<unsigned char> file = encode(params);
+        snatch_pack_ra ra;
+        ASSERT_EQ(snatch_ra_open(&ra, file.data(), file.size()), 0) << params;
+        if (stored == 0) stored = file.size();
+
+        // every glyph of the font, over and over for about 200 ms
+        unsigned char rows[4096];
+        snatch_pack_glyph glyph;
+        std::size_t decoded = 0;
+        unsigned long checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        auto elapsed = std::chrono::steady_clock::duration::zero();
+        while (elapsed < std::chrono::milliseconds(200)) {
+            for (std::uint32_t cp = ra.first; cp <= ra.last; ++cp) {
+                const long n = snatch_ra_glyph(&ra, cp, &glyph, rows, sizeof(rows));
+                if (n < 0) continue;
+                checksum += static_cast<unsigned long>(n) + rows[0];
+                ++decoded;
+            }
+            elapsed = std::chrono::steady_clock::now() - start;
+        }
+        ASSERT_GT(decoded, 0u);
+        ASSERT_NE(checksum, 0u);
+        const double ns = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(decoded);
+        std::printf("%-38s %8zu %8ld %12.1f\n", params, file.size(),
+                    static_cast<long>(stored) - static_cast<long>(file.size()), ns);
+    }
+    std::filesystem::remove(out);
+}
+
+TEST(pipeline_plugins, compressed_bin_random_mode_keeps_metrics_of_shared_bitmaps) {
+    // A, B and C are drawn alike; B sits elsewhere and advances further
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path font = tmp / "snatch_shared_rows.bdf";
+    std::ofstream(font) << "STARTFONT 2.1\nFONTBOUNDINGBOX 8 8 0 0\nCHARS 3\n"
+                           "STARTCHAR A\nENCODING 65\nDWIDTH 8 0\nBBX 6 2 0 2\nBITMAP\n78\nCC\nENDCHAR\n"
+                           "STARTCHAR B\nENCODING 66\nDWIDTH 12 0\nBBX 6 2 2 3\nBITMAP\n78\nCC\nENDCHAR\n"
+                           "STARTCHAR C\nENCODING 67\nDWIDTH 8 0\nBBX 6 2 0 2\nBITMAP\n78\nCC\nENDCHAR\nENDFONT\n";
+    const std::filesystem::path graph = tmp / "snatch_shared_rows.pipeline";
+    const std::filesystem::path out = tmp / "snatch_shared_rows.bin";
+    std::filesystem::remove(out);
+    {
+        std::ofstream g(graph);
+        g << "extractor   font bdf_extractor - input=" << font.string() << "\n"
+          << "transformer d    dedup_transform font\n"
+          << "exporter    b    compressed_bin d output=" << out.string() << ",algorithm=none,mode=random\n";
+    }
+    const auto res = run_command_capture(std::string(SNATCH_BIN_PATH) + " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) + " --pipeline " + q(graph));
+    ASSERT_EQ(res.exit_code, 0) << res.output;
+
+    const std::string text = read_file(out);
+    const std::vector<unsigned char> file(text.begin(), text.end());
+    snatch_pack_ra ra;
+    ASSERT_EQ(snatch_ra_open(&ra, file.data(), file.size()), 0);
+    snatch_pack_glyph glyphs[3];
+    for (std::uint32_t cp = 'A'; cp <= 'C'; ++cp) {
+        unsigned char rows[2];
+        ASSERT_EQ(snatch_ra_glyph(&ra, cp, &glyphs[cp - 'A'], rows, sizeof(rows)), 2);
+        EXPECT_EQ(rows[0], 0x78);
+        EXPECT_EQ(rows[1], 0xCC);
+    }
+    EXPECT_EQ(glyphs[0].advance_x, 8);
+    EXPECT_EQ(glyphs[1].advance_x, 12);
+    EXPECT_EQ(glyphs[1].bearing_x, 2);
+    EXPECT_EQ(glyphs[1].bearing_y, 5);
+    EXPECT_EQ(glyphs[2].bearing_y, 4);
+    // equal metrics still share one record
+    EXPECT_EQ(glyphs[2].offset, glyphs[0].offset);
+    EXPECT_NE(glyphs[1].offset, glyphs[0].offset);
+}
+
+TEST(pipeline_plugins, png_rejects_an_unknown_pixel_format) {
+    const std::string cmd =
+        std::string(SNATCH_BIN_PATH) +
+        " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string() + ",first_ascii=65,last_ascii=67,font_size=16\"" +
+        " --exporter png" +
+        " --exporter-parameters \"output=" + (std::filesystem::temp_directory_path() / "snatch_png_bad_format.png").string() + ",pixel_format=cmyk\"";
+    const auto res = run_command_capture(cmd);
+    EXPECT_NE(res.exit_code, 0);
+    EXPECT_NE(res.output.find("invalid pixel_format"), std::string::npos) << res.output;
+}
+
+TEST(pipeline_plugins, partner_tiny_strokes_are_shorter_than_dots) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const auto encode = [&](const std::string& encoding) {
+        const std::filesystem::path out = tmp / ("snatch_partner_tiny_" + encoding + ".bin");
+        std::filesystem::remove(out);
+        const std::string cmd =
+            std::string(SNATCH_BIN_PATH) +
+            " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+            " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string() + ",first_ascii=65,last_ascii=90,font_size=16\"" +
+            " --transformer partner_tiny_transform" +
+            " --transformer-parameters \"encoding=" + encoding + "\"" +
+            " --exporter raw_bin" +
+            " --exporter-parameters \"output=" + out.string() + "\"";
+        const auto res = run_command_capture(cmd);
+        EXPECT_EQ(res.exit_code, 0) << res.output;
+        return std::filesystem::exists(out) ? std::filesystem::file_size(out) : 0u;
+    };
+
+    const auto dots = encode("dots");
+    const auto strokes = encode("strokes");
+    ASSERT_GT(strokes, 0u);
+    EXPECT_LT(strokes, dots);
+}
+
+TEST(pipeline_plugins, partner_tiny_routes_are_shared_between_runs) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path cache_home = tmp / "snatch_route_cache_home";
+    std::filesystem::remove_all(cache_home);
+    const auto encode = [&](const std::string& name) {
+        const std::filesystem::path out = tmp / name;
+        std::filesystem::remove(out);
+        const std::string cmd =
+            "XDG_CACHE_HOME=" + q(cache_home) + " " + std::string(SNATCH_BIN_PATH) +
+            " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+            " --extractor-parameters \"input=" + (std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string() + ",first_ascii=65,last_ascii=70,font_size=16\"" +
+            " --transformer partner_tiny_transform" +
+            " --exporter raw_bin" +
+            " --exporter-parameters \"output=" + out.string() + "\"";
+        const auto res = run_command_capture(cmd);
+        EXPECT_EQ(res.exit_code, 0) << res.output;
+        return read_file(out);
+    };
+
+    const std::string cold = encode("snatch_route_cache_cold.bin");
+    bool cached = false;
+    for (const auto& e : std::filesystem::directory_iterator(cache_home / "snatch")) {
+        cached = cached || e.path().filename().string().rfind("tiny-routes-", 0) == 0;
+    }
+    EXPECT_TRUE(cached);
+    ASSERT_FALSE(cold.empty());
+    EXPECT_EQ(encode("snatch_route_cache_warm.bin"), cold);
+    std::filesystem::remove_all(cache_home);
+}
+
+TEST(pipeline_plugins, dedup_emits_each_distinct_glyph_once) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    // the glyph record an offset table entry points at; byte 3 counts payload
+    // bytes (bitmap) or moves after a two byte origin (tiny)
+    const auto record = [](const std::string& bin, std::size_t i, bool tiny) {
+        const std::size_t off = static_cast<unsigned char>(bin[5u + i * 2u]) |
+                                static_cast<std::size_t>(static_cast<unsigned char>(bin[6u + i * 2u])) << 8u;
+        if (off + 4u > bin.size()) return std::string{};
+        const std::size_t n = static_cast<unsigned char>(bin[off + 3u]);
+        return bin.substr(off, 4u + n + (tiny && n > 0 ? 2u : 0u));
+    };
+    const auto encode = [&](const std::string& transformer, bool dedup) {
+        const std::filesystem::path graph = tmp / "snatch_dedup.pipeline";
+        const std::filesystem::path out = tmp / ("snatch_dedup_" + transformer + (dedup ? "_on.bin" : "_off.bin"));
+        std::filesystem::remove(out);
+        {
+            std::ofstream g(graph);
+            g << "extractor   font ttf_extractor - input="
+              << (std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string()
+              << ",first_ascii=32,last_ascii=127,font_size=16\n";
+            if (dedup) g << "transformer d dedup_transform font\n";
+            g << "transformer t " << transformer << " " << (dedup ? "d" : "font") << "\n"
+              << "exporter    b raw_bin t output=" << out.string() << "\n";
+        }
+        const auto res = run_command_capture(std::string(SNATCH_BIN_PATH) + " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) + " --pipeline " + q(graph));
+        EXPECT_EQ(res.exit_code, 0) << res.output;
+        return read_file(out);
+    };
+
+    for (const std::string transformer : {"partner_bitmap_transform", "partner_tiny_transform"}) {
+        const std::string plain = encode(transformer, false);
+        const std::string shared = encode(transformer, true);
+        ASSERT_GT(plain.size(), 5u + 96u * 2u) << transformer;
+        ASSERT_GT(shared.size(), 5u + 96u * 2u) << transformer;
+        EXPECT_LT(shared.size(), plain.size()) << transformer;
+        EXPECT_EQ(shared.substr(0, 5), plain.substr(0, 5)) << transformer;
+        for (std::size_t i = 0; i < 96; ++i) {
+            const bool tiny = transformer == "partner_tiny_transform";
+            EXPECT_EQ(record(shared, i, tiny), record(plain, i, tiny)) << transformer << " glyph " << i;
+        }
+    }
+}
+
+TEST(pipeline_plugins, dedup_keeps_the_raw_bin_layout) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const auto encode = [&](bool dedup) {
+        const std::filesystem::path graph = tmp / "snatch_dedup_layout.pipeline";
+        const std::filesystem::path out = tmp / (dedup ? "snatch_dedup_layout_on.bin" : "snatch_dedup_layout_off.bin");
+        std::filesystem::remove(out);
+        {
+            std::ofstream g(graph);
+            g << "extractor   font ttf_extractor - input="
+              << (std::filesystem::path(TEST_DATA_DIR) / "kubasta.ttf").string()
+              << ",first_ascii=32,last_ascii=1000,font_size=16\n";
+            if (dedup) g << "transformer d dedup_transform font\n";
+            g << "exporter    b raw_bin " << (dedup ? "d" : "font") << " output=" << out.string() << "\n";
+        }
+        const auto res = run_command_capture(std::string(SNATCH_BIN_PATH) + " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) + " --pipeline " + q(graph));
+        EXPECT_EQ(res.exit_code, 0) << res.output;
+        return read_file(out);
+    };
+
+    // raw_bin writes stride_bytes per row of every glyph, shared or not
+    const std::string plain = encode(false);
+    ASSERT_FALSE(plain.empty());
+    EXPECT_TRUE(encode(true) == plain);
+}
+
 TEST(pipeline_plugins, partner_tiny_invalid_spacing_parameters_fail) {
     const std::filesystem::path tiny_bin = std::filesystem::temp_directory_path() / "snatch_partner_tiny_invalid_spacing.bin";
     std::filesystem::remove(tiny_bin);
@@ -239,3 +977,70 @@ TEST(pipeline_plugins, partner_tiny_invalid_spacing_parameters_fail) {
     EXPECT_NE(res.exit_code, 0);
     EXPECT_NE(res.output.find("space_width must be 0..7"), std::string::npos) << res.output;
 }
+
+TEST(pipeline_plugins, pipeline_file_runs_shared_dag) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path graph = tmp / "snatch_dag.pipeline";
+    const std::filesystem::path bin_out = tmp / "snatch_dag.bin";
+    const std::filesystem::path c_out = tmp / "snatch_dag.c";
+    const std::filesystem::path asm_out = tmp / "snatch_dag.s";
+    std::filesystem::remove(bin_out);
+    std::filesystem::remove(c_out);
+    std::filesystem::remove(asm_out);
+
+    {
+        std::ofstream g(graph);
+        g << "# one extraction feeding a raw branch and a transformed branch\n"
+          << "extractor   font ttf_extractor            -    input="
+          << (std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string()
+          << ",first_ascii=65,last_ascii=67,font_size=16\n"
+          << "exporter    raw  raw_bin                  font output=" << bin_out.string() << "\n"
+          << "transformer prop partner_bitmap_transform font font_mode=proportional,space_width=3\n"
+          << "exporter    c    raw_c                    prop output=" << c_out.string() << ",symbol=dag_font\n"
+          << "exporter    asm  partner_sdcc_asm_bitmap  prop output=" << asm_out.string() << ",proportional=true,space_width=3\n";
+    }
+
+    const std::string cmd =
+        std::string(SNATCH_BIN_PATH) +
+        " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --pipeline " + q(graph) + " --jobs 3";
+
+    const auto res = run_command_capture(cmd);
+    ASSERT_EQ(res.exit_code, 0) << res.output;
+    EXPECT_NE(res.output.find("extracted with plugin: ttf_extractor"), std::string::npos) << res.output;
+    EXPECT_NE(res.output.find("transformed with plugin: partner_bitmap_transform"), std::string::npos) << res.output;
+    ASSERT_TRUE(std::filesystem::exists(bin_out));
+    ASSERT_TRUE(std::filesystem::exists(asm_out));
+    EXPECT_GT(std::filesystem::file_size(bin_out), 0u);
+    EXPECT_NE(read_file(c_out).find("const uint8_t dag_font[]"), std::string::npos);
+}
+
+TEST(pipeline_plugins, pipeline_file_failure_skips_branch) {
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path graph = tmp / "snatch_dag_fail.pipeline";
+    const std::filesystem::path bin_out = tmp / "snatch_dag_fail.bin";
+    const std::filesystem::path c_out = tmp / "snatch_dag_fail.c";
+    std::filesystem::remove(bin_out);
+    std::filesystem::remove(c_out);
+
+    {
+        std::ofstream g(graph);
+        g << "extractor   font ttf_extractor            -    input="
+          << (std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf").string()
+          << ",first_ascii=65,last_ascii=67,font_size=16\n"
+          << "exporter    raw  raw_bin                  font output=" << bin_out.string() << "\n"
+          << "transformer bad  partner_bitmap_transform font font_mode=proportional,space_width=9\n"
+          << "exporter    c    raw_c                    bad  output=" << c_out.string() << "\n";
+    }
+
+    const std::string cmd =
+        std::string(SNATCH_BIN_PATH) +
+        " --plugin-dir " + q(SNATCH_PLUGIN_DIR_PATH) +
+        " --pipeline " + q(graph);
+
+    const auto res = run_command_capture(cmd);
+    EXPECT_EQ(res.exit_code, 5) << res.output;
+    EXPECT_NE(res.output.find("transformer 'bad' failed"), std::string::npos) << res.output;
+    EXPECT_TRUE(std::filesystem::exists(bin_out)) << res.output;
+    EXPECT_FALSE(std::filesystem::exists(c_out)) << res.output;
+}
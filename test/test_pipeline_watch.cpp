@@ -0,0 +1,104 @@
+/// \file
+/// \brief Incremental re-run and file watcher tests.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+#include <snatch/pipeline.h>
+#include <snatch/pipeline_watch.h>
+#include <snatch/plugin_manager.h>
+
+namespace {
+
+/// \brief cached_ids.
+std::string cached_ids(const pipeline_report& r) {
+    std::string ids;
+    for (const auto& n : r.nodes) {
+        if (n.cached) ids += n.id + " ";
+    }
+    return ids;
+}
+
+} // namespace
+
+TEST(pipeline_cache, reruns_only_nodes_downstream_of_a_change) {
+    plugin_manager pm;
+    pm.load_from_dir(SNATCH_PLUGIN_DIR_PATH);
+
+    const std::filesystem::path tmp = std::filesystem::temp_directory_path();
+    const std::filesystem::path font = tmp / "snatch_watch_font.ttf";
+    std::filesystem::copy_file(std::filesystem::path(TEST_DATA_DIR) / "flappybirdy-regular.ttf", font,
+                               std::filesystem::copy_options::overwrite_existing);
+
+    const auto graph_text = [&](const std::string& symbol) {
+        return "extractor   font ttf_extractor            -    input=" + font.string() + ",first_ascii=65,last_ascii=67,font_size=16\n" +
+               "transformer prop partner_bitmap_transform font font_mode=proportional,space_width=3\n" +
+               "exporter    bin  raw_bin                  prop output=" + (tmp / "snatch_watch.bin").string() + "\n" +
+               "exporter    c    raw_c                    prop output=" + (tmp / "snatch_watch.c").string() + ",symbol=" + symbol + "\n";
+    };
+    pipeline_graph g;
+    std::string err;
+    ASSERT_TRUE(pipeline_graph::parse(graph_text("one"), g, err)) << err;
+    ASSERT_TRUE(pipeline_plugins_available(g, pm, err)) << err;
+
+    pipeline_cache cache;
+    const pipeline_executor executor{pm};
+    const pipeline_run_options run{1, nullptr, nullptr, &cache};
+
+    auto r = executor.run(g, run);
+    ASSERT_TRUE(r.ok());
+    EXPECT_EQ(cached_ids(r), "");
+
+    r = executor.run(g, run);
+    ASSERT_TRUE(r.ok());
+    EXPECT_EQ(cached_ids(r), "font prop bin c ");
+
+    // exporter parameters only: upstream results are reused
+    ASSERT_TRUE(pipeline_graph::parse(graph_text("two"), g, err)) << err;
+    r = executor.run(g, run);
+    ASSERT_TRUE(r.ok());
+    EXPECT_EQ(cached_ids(r), "font prop bin ");
+    std::ifstream c_file(tmp / "snatch_watch.c");
+    const std::string c_text{std::istreambuf_iterator<char>(c_file), {}};
+    EXPECT_NE(c_text.find("two[]"), std::string::npos);
+
+    // a touched input invalidates the whole branch
+    std::filesystem::last_write_time(font, std::filesystem::last_write_time(font) + std::chrono::seconds(2));
+    r = executor.run(g, run);
+    ASSERT_TRUE(r.ok());
+    EXPECT_EQ(cached_ids(r), "");
+}
+
+TEST(file_watcher, reports_watched_file_and_ignores_siblings) {
+    const std::filesystem::path dir = std::filesystem::temp_directory_path() / "snatch_watch_dir";
+    std::filesystem::create_directories(dir);
+    const std::filesystem::path watched = dir / "sheet.png";
+    std::ofstream(watched) << "a";
+
+    file_watcher w;
+    std::string err;
+    ASSERT_TRUE(w.watch({watched}, err)) << err;
+
+    std::ofstream(dir / "other.png") << "b";
+    EXPECT_TRUE(w.wait(20, 200).empty());
+
+    std::thread writer([&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        std::ofstream(watched) << "c";
+        std::ofstream(watched) << "d"; // a second save inside the debounce window
+    });
+    const auto changed = w.wait(50, 5000);
+    writer.join();
+    ASSERT_EQ(changed.size(), 1u);
+    EXPECT_EQ(changed.front(), std::filesystem::absolute(watched).lexically_normal());
+}
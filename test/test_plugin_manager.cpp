@@ -0,0 +1,293 @@
+/// \file
+/// \brief Plugin discovery and metadata index tests.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <snatch/plugin.h>
+#include <snatch/plugin_manager.h>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+/// \brief fake_export.
+int fake_export(const snatch_font*, const char*, const snatch_kv*, unsigned, char*, unsigned) {
+    return 0;
+}
+
+/// \brief exporter_info.
+snatch_plugin_info exporter_info(const char* name, const char* description) {
+    snatch_plugin_info info{};
+    info.name = name;
+    info.description = description;
+    info.author = "snatch tests";
+    info.format = "txt";
+    info.standard = "test";
+    info.abi_version = SNATCH_PLUGIN_ABI_VERSION;
+    info.kind = SNATCH_PLUGIN_KIND_EXPORTER;
+    info.export_font = fake_export;
+    return info;
+}
+
+const snatch_plugin_info k_fake_info = exporter_info("fake_builtin", "test exporter");
+
+/// \brief fake_get.
+int fake_get(const snatch_plugin_info** out) {
+    *out = &k_fake_info;
+    return 0;
+}
+
+/// \brief fast_info.
+snatch_plugin_info fast_info() {
+    snatch_plugin_info info = exporter_info("fast_builtin", "test vectorized exporter");
+    info.accepts = SNATCH_PAYLOAD_BITMAP;
+    info.capabilities = SNATCH_CAP_SIMD | SNATCH_CAP_THREAD_SAFE;
+    return info;
+}
+
+const snatch_plugin_info k_fast_info = fast_info();
+
+/// \brief fast_get.
+int fast_get(const snatch_plugin_info** out) {
+    *out = &k_fast_info;
+    return 0;
+}
+
+/// \brief legacy_info.
+// an ABI 5 exporter: no stream entry points, no payloads, no capabilities
+snatch_plugin_info legacy_info() {
+    snatch_plugin_info info = exporter_info("legacy_builtin", "test exporter from before ABI 7");
+    info.abi_version = 5;
+    // past the ABI 5 fields; the host must not read it
+    info.capabilities = SNATCH_CAP_THREAD_SAFE;
+    return info;
+}
+
+const snatch_plugin_info k_legacy_info = legacy_info();
+
+/// \brief scoped_cache_home.
+// points the user cache at an empty directory for one test
+struct scoped_cache_home {
+    fs::path dir;
+    std::string saved;
+    bool had{false};
+
+    explicit scoped_cache_home(const fs::path& d) : dir(d) {
+        if (const char* v = std::getenv("XDG_CACHE_HOME")) {
+            had = true;
+            saved = v;
+        }
+        fs::remove_all(dir);
+        ::setenv("XDG_CACHE_HOME", dir.c_str(), 1);
+    }
+    ~scoped_cache_home() {
+        if (had) ::setenv("XDG_CACHE_HOME", saved.c_str(), 1);
+        else ::unsetenv("XDG_CACHE_HOME");
+        fs::remove_all(dir);
+    }
+
+    /// \brief index_file.
+    // the single plugin index in the cache, or an empty path
+    fs::path index_file() const {
+        std::error_code ec;
+        for (const auto& e : fs::directory_iterator(dir / "snatch", ec)) {
+            if (e.path().filename().string().rfind("plugin-index-", 0) == 0) return e.path();
+        }
+        return {};
+    }
+};
+
+/// \brief legacy_get.
+int legacy_get(const snatch_plugin_info** out) {
+    *out = &k_legacy_info;
+    return 0;
+}
+
+} // namespace
+
+TEST(plugin_manager, index_answers_discovery_without_loading) {
+    const scoped_cache_home cache{fs::temp_directory_path() / "snatch_plugin_index_cache"};
+    const fs::path dir = fs::temp_directory_path() / "snatch_plugin_index_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    fs::copy_file(fs::path(SNATCH_PLUGIN_DIR_PATH) / "raw_bin.so", dir / "raw_bin.so");
+    fs::copy_file(fs::path(SNATCH_PLUGIN_DIR_PATH) / "ttf_extractor.so", dir / "ttf_extractor.so");
+
+    {
+        // first scan loads everything and writes the index
+        plugin_manager pm;
+        pm.load_from_dir(dir);
+        ASSERT_EQ(pm.plugins().size(), 2u);
+        for (const auto& p : pm.plugins()) EXPECT_NE(p.info, nullptr);
+    }
+    // the plugin directory itself is left alone
+    EXPECT_FALSE(fs::exists(dir / ".snatch-plugin-index"));
+    const fs::path index_file = cache.index_file();
+    ASSERT_FALSE(index_file.empty());
+
+    {
+        plugin_manager pm;
+        pm.load_from_dir(dir);
+        ASSERT_EQ(pm.plugins().size(), 2u);
+        for (const auto& p : pm.plugins()) {
+            EXPECT_EQ(p.info, nullptr) << p.name;
+            EXPECT_EQ(p.abi_version, static_cast<unsigned>(SNATCH_PLUGIN_ABI_VERSION)) << p.name;
+            if (p.name == "raw_bin") {
+                EXPECT_EQ(p.kind, SNATCH_PLUGIN_KIND_EXPORTER);
+                EXPECT_EQ(p.format, "bin");
+                EXPECT_EQ(p.accepts, SNATCH_PAYLOAD_BITMAP | SNATCH_PAYLOAD_PARTNER_BITMAP | SNATCH_PAYLOAD_PARTNER_TINY);
+                EXPECT_EQ(p.capabilities, SNATCH_CAP_THREAD_SAFE | SNATCH_CAP_STREAMING);
+            } else {
+                EXPECT_EQ(p.produces, SNATCH_PAYLOAD_BITMAP);
+            }
+        }
+
+        // only the plugin asked for is opened
+        const loaded_plugin* raw = pm.find_by_name_and_kind("raw_bin", SNATCH_PLUGIN_KIND_EXPORTER);
+        ASSERT_NE(raw, nullptr);
+        ASSERT_NE(raw->info, nullptr);
+        EXPECT_NE(raw->info->export_font, nullptr);
+        for (const auto& p : pm.plugins()) {
+            if (p.name == "ttf_extractor") {
+                EXPECT_EQ(p.info, nullptr);
+            }
+        }
+        EXPECT_EQ(pm.find_by_name_and_kind("raw_bin", SNATCH_PLUGIN_KIND_EXTRACTOR), nullptr);
+        const loaded_plugin* extractor = pm.find_first_by_kind(SNATCH_PLUGIN_KIND_EXTRACTOR);
+        ASSERT_NE(extractor, nullptr);
+        EXPECT_EQ(extractor->name, "ttf_extractor");
+        EXPECT_EQ(pm.find_first_by_kind(SNATCH_PLUGIN_KIND_TRANSFORMER), nullptr);
+        EXPECT_EQ(pm.find_by_name("missing"), nullptr);
+    }
+
+    // a stale entry is re-read from the plugin, a removed one dropped
+    {
+        std::ofstream touch(dir / "raw_bin.so", std::ios::app | std::ios::binary);
+        touch << '\0';
+    }
+    fs::remove(dir / "ttf_extractor.so");
+    {
+        plugin_manager pm;
+        pm.load_from_dir(dir);
+        ASSERT_EQ(pm.plugins().size(), 1u);
+        EXPECT_NE(pm.plugins()[0].info, nullptr);
+    }
+    std::ifstream index(index_file);
+    const std::string text{std::istreambuf_iterator<char>(index), std::istreambuf_iterator<char>()};
+    EXPECT_EQ(text.find("ttf_extractor"), std::string::npos);
+    EXPECT_NE(text.find("raw_bin"), std::string::npos);
+    fs::remove_all(dir);
+}
+
+TEST(plugin_manager, installed_index_is_used_until_the_cache_has_one) {
+    const scoped_cache_home cache{fs::temp_directory_path() / "snatch_installed_index_cache"};
+    const fs::path dir = fs::temp_directory_path() / "snatch_installed_index_test";
+    fs::remove_all(dir);
+    fs::create_directories(dir);
+    fs::copy_file(fs::path(SNATCH_PLUGIN_DIR_PATH) / "raw_bin.so", dir / "raw_bin.so");
+
+    {
+        plugin_manager pm;
+        ASSERT_TRUE(pm.write_installed_index(dir));
+    }
+    ASSERT_TRUE(fs::exists(dir / ".snatch-plugin-index"));
+    std::ifstream index(dir / ".snatch-plugin-index");
+    std::string header, line;
+    std::getline(index, header);
+    std::getline(index, line);
+    EXPECT_EQ(header, "snatch-plugin-index 4 " + std::to_string(SNATCH_PLUGIN_ABI_VERSION));
+    EXPECT_EQ(line.rfind("raw_bin.so\t", 0), 0u) << line;
+
+    {
+        // a current installed index needs neither loading nor a cache copy
+        plugin_manager pm;
+        pm.load_from_dir(dir);
+        ASSERT_EQ(pm.plugins().size(), 1u);
+        EXPECT_EQ(pm.plugins()[0].info, nullptr);
+        EXPECT_EQ(pm.plugins()[0].abi_version, static_cast<unsigned>(SNATCH_PLUGIN_ABI_VERSION));
+        EXPECT_TRUE(cache.index_file().empty());
+    }
+
+    // a rebuilt plugin is indexed in the cache, not in the plugin directory
+    {
+        std::ofstream touch(dir / "raw_bin.so", std::ios::app | std::ios::binary);
+        touch << '\0';
+    }
+    const auto installed_size = fs::file_size(dir / ".snatch-plugin-index");
+    const auto installed_time = fs::last_write_time(dir / ".snatch-plugin-index");
+    {
+        plugin_manager pm;
+        pm.load_from_dir(dir);
+        ASSERT_EQ(pm.plugins().size(), 1u);
+        EXPECT_NE(pm.plugins()[0].info, nullptr);
+    }
+    EXPECT_FALSE(cache.index_file().empty());
+    EXPECT_EQ(fs::file_size(dir / ".snatch-plugin-index"), installed_size);
+    EXPECT_EQ(fs::last_write_time(dir / ".snatch-plugin-index"), installed_time);
+    fs::remove_all(dir);
+}
+
+TEST(plugin_manager, builtin_plugins_are_found_before_directories) {
+    const builtin_plugin table[] = {{"fake_builtin", fake_get}};
+    plugin_manager::set_builtin_plugins(table, 1);
+
+    plugin_manager pm;
+    pm.load_named_from_dirs_in_order({SNATCH_PLUGIN_DIR_PATH}, {"fake_builtin", "raw_bin"});
+    ASSERT_EQ(pm.plugins().size(), 2u);
+    const loaded_plugin* fake = pm.find_by_name_and_kind("fake_builtin", SNATCH_PLUGIN_KIND_EXPORTER);
+    ASSERT_NE(fake, nullptr);
+    EXPECT_EQ(fake->info, &k_fake_info);
+    EXPECT_EQ(fake->handle, nullptr);
+    EXPECT_NE(pm.find_by_name("raw_bin"), nullptr);
+
+    // unnamed discovery of a static build sees only what is built in
+    pm.load_from_dirs_in_order({SNATCH_PLUGIN_DIR_PATH});
+    ASSERT_EQ(pm.plugins().size(), 1u);
+    EXPECT_EQ(pm.plugins()[0].name, "fake_builtin");
+
+    plugin_manager::set_builtin_plugins(nullptr, 0);
+}
+
+TEST(plugin_manager, find_best_ranks_capabilities_among_accepting_plugins) {
+    const builtin_plugin table[] = {{"fake_builtin", fake_get}, {"fast_builtin", fast_get}};
+    plugin_manager::set_builtin_plugins(table, 2);
+
+    plugin_manager pm;
+    pm.load_named_from_dirs_in_order({SNATCH_PLUGIN_DIR_PATH}, {"fake_builtin", "fast_builtin", "png"});
+    const loaded_plugin* best = pm.find_best(SNATCH_PLUGIN_KIND_EXPORTER, SNATCH_PAYLOAD_BITMAP);
+    ASSERT_NE(best, nullptr);
+    EXPECT_EQ(best->name, "fast_builtin");
+    EXPECT_EQ(pm.find_best(SNATCH_PLUGIN_KIND_EXPORTER, SNATCH_PAYLOAD_BITMAP, "png")->name, "png");
+
+    // only the undeclared exporter takes a payload nobody asked for
+    best = pm.find_best(SNATCH_PLUGIN_KIND_EXPORTER, SNATCH_PAYLOAD_IMAGE);
+    ASSERT_NE(best, nullptr);
+    EXPECT_EQ(best->name, "fake_builtin");
+    EXPECT_EQ(pm.find_best(SNATCH_PLUGIN_KIND_EXPORTER, SNATCH_PAYLOAD_IMAGE, "png"), nullptr);
+    EXPECT_EQ(plugin_payload_names(SNATCH_PAYLOAD_BITMAP | SNATCH_PAYLOAD_FZX), "bitmap|fzx");
+
+    plugin_manager::set_builtin_plugins(nullptr, 0);
+}
+
+TEST(plugin_manager, legacy_exporters_are_not_taken_for_thread_safe) {
+    const builtin_plugin table[] = {{"legacy_builtin", legacy_get}};
+    plugin_manager::set_builtin_plugins(table, 1);
+
+    plugin_manager pm;
+    pm.load_named_from_dirs_in_order({SNATCH_PLUGIN_DIR_PATH}, {"legacy_builtin"});
+    const loaded_plugin* legacy = pm.find_by_name_and_kind("legacy_builtin", SNATCH_PLUGIN_KIND_EXPORTER);
+    ASSERT_NE(legacy, nullptr);
+    EXPECT_EQ(legacy->capabilities, 0u);
+
+    plugin_manager::set_builtin_plugins(nullptr, 0);
+}
@@ -0,0 +1,120 @@
+/// \file
+/// \brief Unit tests for incremental PNG decoding.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "snatch/png_reader.h"
+
+extern "C" {
+#include <stb_image.h>
+}
+
+TEST(png_reader, rows_match_stb_image) {
+    // 1- and 2-bit palettes and 8-bit RGB
+    for (const char* name : {"8x16_z1.png", "12x16.png", "Dangen_charset_4x12.png", "X-windows8x16font.png"}) {
+        const std::filesystem::path path = std::filesystem::path(TEST_DATA_DIR) / name;
+        int w = 0;
+        int h = 0;
+        int channels = 0;
+        unsigned char* expected = stbi_load(path.string().c_str(), &w, &h, &channels, 1);
+        ASSERT_NE(expected, nullptr) << name;
+
+        png_row_reader reader;
+        ASSERT_TRUE(reader.open(path)) << name << ": " << reader.error();
+        ASSERT_EQ(reader.width(), w) << name;
+        ASSERT_EQ(reader.height(), h) << name;
+        std::vector<std::uint8_t> row(static_cast<std::size_t>(w));
+        int mismatched_rows = 0;
+        for (int y = 0; y < h; ++y) {
+            ASSERT_TRUE(reader.read_gray_row(row.data())) << name << " row " << y << ": " << reader.error();
+            if (!std::equal(row.begin(), row.end(), expected + static_cast<std::size_t>(y) * static_cast<std::size_t>(w))) ++mismatched_rows;
+        }
+        EXPECT_EQ(mismatched_rows, 0) << name;
+        EXPECT_FALSE(reader.read_gray_row(row.data())) << name;
+        stbi_image_free(expected);
+    }
+}
+
+TEST(png_reader, decodes_every_row_of_a_large_image) {
+    png_row_reader reader;
+    ASSERT_TRUE(reader.open(std::filesystem::path(TEST_DATA_DIR) / "tut.png")) << reader.error();
+    ASSERT_EQ(reader.width(), 1462);
+    ASSERT_EQ(reader.height(), 1032);
+    std::vector<std::uint8_t> row(static_cast<std::size_t>(reader.width()));
+    std::size_t dark = 0;
+    for (int y = 0; y < reader.height(); ++y) {
+        ASSERT_TRUE(reader.read_gray_row(row.data())) << "row " << y << ": " << reader.error();
+        dark += static_cast<std::size_t>(std::count_if(row.begin(), row.end(), [](std::uint8_t v) { return v < 128; }));
+    }
+    EXPECT_GT(dark, 0u);
+    EXPECT_LT(dark, static_cast<std::size_t>(reader.width()) * static_cast<std::size_t>(reader.height()));
+}
+
+TEST(png_reader, truncated_data_is_an_error) {
+    const std::filesystem::path src = std::filesystem::path(TEST_DATA_DIR) / "tut.png";
+    const std::filesystem::path cut = std::filesystem::temp_directory_path() / "snatch_truncated.png";
+    {
+        std::ifstream in(src, std::ios::binary);
+        std::vector<char> bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+        bytes.resize(bytes.size() / 2);
+        std::ofstream out(cut, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    png_row_reader reader;
+    ASSERT_TRUE(reader.open(cut)) << reader.error();
+    std::vector<std::uint8_t> row(static_cast<std::size_t>(reader.width()));
+    int y = 0;
+    while (y < reader.height() && reader.read_gray_row(row.data())) ++y;
+    EXPECT_LT(y, reader.height());
+    EXPECT_FALSE(reader.error().empty());
+}
+
+TEST(png_reader, oversized_headers_are_refused_before_allocating) {
+    // CRCs are not checked, so zeros do
+    const auto chunk = [](std::string& png, const char* type, const std::vector<std::uint8_t>& data) {
+        const auto n = static_cast<std::uint32_t>(data.size());
+        for (const int shift : {24, 16, 8, 0}) png.push_back(static_cast<char>(n >> shift));
+        png.append(type, 4);
+        png.append(data.begin(), data.end());
+        png.append(4, '\0');
+    };
+    const auto ihdr = [](std::uint32_t w, std::uint32_t h, std::uint8_t color) {
+        std::vector<std::uint8_t> d;
+        for (const std::uint32_t v : {w, h}) {
+            for (const int shift : {24, 16, 8, 0}) d.push_back(static_cast<std::uint8_t>(v >> shift));
+        }
+        d.insert(d.end(), {8, color, 0, 0, 0});
+        return d;
+    };
+    const auto open = [&](const std::vector<std::uint8_t>& header, std::size_t palette_size) {
+        std::string png("\x89PNG\r\n\x1a\n", 8);
+        chunk(png, "IHDR", header);
+        if (palette_size > 0) chunk(png, "PLTE", std::vector<std::uint8_t>(palette_size, 0));
+        chunk(png, "IDAT", {0x78, 0x9C});
+        const std::filesystem::path path = std::filesystem::temp_directory_path() / "snatch_crafted.png";
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << png;
+        png_row_reader reader;
+        reader.open(path);
+        return reader.error();
+    };
+
+    EXPECT_EQ(open(ihdr(16, 16, 3), 48), "");
+    EXPECT_EQ(open(ihdr(0x7FFFFFFF, 1, 0), 0), "png: image too large");
+    EXPECT_EQ(open(ihdr(65535, 65535, 0), 0), "png: image too large");
+    EXPECT_EQ(open(ihdr(16, 16, 3), 769), "png: bad PLTE");
+    EXPECT_EQ(open(ihdr(16, 16, 3), 47), "png: bad PLTE");
+}
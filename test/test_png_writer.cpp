@@ -0,0 +1,227 @@
+/// \file
+/// \brief Unit tests for deflate compression and PNG encoding.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "snatch/png_reader.h"
+#include "snatch/png_writer.h"
+
+extern "C" {
+#include <stb_image.h>
+}
+
+namespace {
+
+struct byte_cursor {
+    const std::vector<std::uint8_t>* bytes;
+    std::size_t pos;
+};
+
+/// \brief next_byte.
+int next_byte(void* ctx) {
+    auto* c = static_cast<byte_cursor*>(ctx);
+    return c->pos < c->bytes->size() ? (*c->bytes)[c->pos++] : -1;
+}
+
+/// \brief sample_data.
+// long runs, repeats at every distance class, and incompressible noise
+std::vector<std::uint8_t> sample_data() {
+    std::vector<std::uint8_t> data;
+    std::mt19937 rng(7);
+    for (int block = 0; block < 40; ++block) {
+        const int kind = block % 4;
+        const std::size_t n = 1000 + rng() % 9000;
+        for (std::size_t i = 0; i < n; ++i) {
+            if (kind == 0) data.push_back(0);
+            else if (kind == 1) data.push_back(static_cast<std::uint8_t>(rng()));
+            else if (kind == 2) data.push_back(static_cast<std::uint8_t>("snatch glyph "[i % 13]));
+            else data.push_back(data.size() > 20000 ? data[data.size() - 20000 + i % 7] : static_cast<std::uint8_t>(i));
+        }
+    }
+    return data;
+}
+
+/// \brief stb_inflate.
+// a decoder that shares no code with ours, so a mistake made on both sides
+// still shows
+std::vector<std::uint8_t> stb_inflate(const std::vector<std::uint8_t>& z) {
+    int size = 0;
+    char* out = stbi_zlib_decode_malloc(reinterpret_cast<const char*>(z.data()), static_cast<int>(z.size()), &size);
+    if (!out) return {};
+    std::vector<std::uint8_t> bytes(out, out + size);
+    std::free(out);
+    return bytes;
+}
+
+/// \brief stb_load_rgb.
+std::vector<std::uint8_t> stb_load_rgb(const std::filesystem::path& path, int& width, int& height) {
+    std::ifstream in(path, std::ios::binary);
+    const std::vector<unsigned char> file{std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+    int channels = 0;
+    unsigned char* rgb = stbi_load_from_memory(file.data(), static_cast<int>(file.size()), &width, &height, &channels, 3);
+    if (!rgb) return {};
+    std::vector<std::uint8_t> pixels(rgb, rgb + static_cast<std::size_t>(width) * static_cast<std::size_t>(height) * 3);
+    stbi_image_free(rgb);
+    return pixels;
+}
+
+} // namespace
+
+TEST(png_writer, zlib_streams_inflate_back_at_every_level) {
+    const std::vector<std::uint8_t> data = sample_data();
+    for (const int level : {0, 1, 6, 9}) {
+        const std::vector<std::uint8_t> z = zlib_compress(data.data(), data.size(), level);
+        byte_cursor cursor{&z, 0};
+        inflate_stream inflate(&next_byte, &cursor);
+        ASSERT_TRUE(inflate.read_zlib_header()) << "level " << level;
+        std::vector<std::uint8_t> back(data.size());
+        ASSERT_TRUE(inflate.read(back.data(), back.size())) << "level " << level << ": " << inflate.error();
+        EXPECT_EQ(back, data) << "level " << level;
+        EXPECT_EQ(stb_inflate(z), data) << "level " << level;
+        if (level > 0) {
+            EXPECT_LT(z.size(), data.size() * 3 / 4) << "level " << level;
+        }
+    }
+
+    const std::vector<std::uint8_t> empty = zlib_compress(nullptr, 0, 6);
+    byte_cursor cursor{&empty, 0};
+    inflate_stream inflate(&next_byte, &cursor);
+    EXPECT_TRUE(inflate.read_zlib_header());
+    int empty_size = -1;
+    char* empty_out = stbi_zlib_decode_malloc(reinterpret_cast<const char*>(empty.data()), static_cast<int>(empty.size()), &empty_size);
+    EXPECT_NE(empty_out, nullptr);
+    EXPECT_EQ(empty_size, 0);
+    std::free(empty_out);
+}
+
+TEST(png_writer, parallel_blocks_join_into_one_stream) {
+    std::vector<std::uint8_t> data;
+    while (data.size() < (std::size_t{3} << 20)) {
+        const std::vector<std::uint8_t> more = sample_data();
+        data.insert(data.end(), more.begin(), more.end());
+    }
+    const std::vector<std::uint8_t> serial = zlib_compress(data.data(), data.size(), 6, 1);
+    for (const int level : {0, 1, 6}) {
+        const std::vector<std::uint8_t> z = zlib_compress(data.data(), data.size(), level, 5);
+        byte_cursor cursor{&z, 0};
+        inflate_stream inflate(&next_byte, &cursor);
+        ASSERT_TRUE(inflate.read_zlib_header()) << "level " << level;
+        std::vector<std::uint8_t> back(data.size());
+        ASSERT_TRUE(inflate.read(back.data(), back.size())) << "level " << level << ": " << inflate.error();
+        EXPECT_EQ(back, data) << "level " << level;
+        // the join through empty stored blocks is what other decoders could reject
+        EXPECT_EQ(stb_inflate(z), data) << "level " << level;
+        if (level == 6) {
+            EXPECT_LT(z.size(), serial.size() + serial.size() / 50);
+        }
+    }
+
+    // an RGB image over three parallel chunks, read by stb_image
+    constexpr int w = 512;
+    constexpr int h = 400;
+    std::vector<std::uint8_t> pixels(static_cast<std::size_t>(w) * h * 3);
+    std::mt19937 rng(11);
+    for (std::size_t i = 0; i < pixels.size(); ++i) {
+        pixels[i] = static_cast<std::uint8_t>(i % 1536 < 768 ? (i / 3) % 251 : rng());
+    }
+    png_image_view view;
+    view.width = w;
+    view.height = h;
+    view.rows = pixels.data();
+    view.stride = static_cast<std::size_t>(w) * 3;
+    const std::filesystem::path out = std::filesystem::temp_directory_path() / "snatch_png_writer_parallel.png";
+    std::string error;
+    ASSERT_TRUE(png_write(out, view, 6, 4, error)) << error;
+    int stb_w = 0;
+    int stb_h = 0;
+    EXPECT_EQ(stb_load_rgb(out, stb_w, stb_h), pixels);
+    EXPECT_EQ(stb_w, w);
+    EXPECT_EQ(stb_h, h);
+}
+
+TEST(png_writer, palette_images_decode_to_their_colours) {
+    // 37 pixels wide so rows end mid-byte at both depths
+    constexpr int w = 37;
+    constexpr int h = 9;
+    for (const int depth : {1, 2}) {
+        const std::size_t stride = (static_cast<std::size_t>(w * depth) + 7) / 8;
+        std::vector<std::uint8_t> pixels(stride * h, 0);
+        std::vector<int> index(static_cast<std::size_t>(w * h));
+        for (int y = 0; y < h; ++y) {
+            for (int x = 0; x < w; ++x) {
+                const int v = (x * 3 + y * 5) % (1 << depth);
+                index[static_cast<std::size_t>(y * w + x)] = v;
+                const int bit = x * depth;
+                pixels[static_cast<std::size_t>(y) * stride + static_cast<std::size_t>(bit / 8)] |= static_cast<std::uint8_t>(v << (8 - depth - bit % 8));
+            }
+        }
+        png_image_view view;
+        view.width = w;
+        view.height = h;
+        view.bit_depth = depth;
+        view.color_type = 3;
+        view.rows = pixels.data();
+        view.stride = stride;
+        view.palette = {{255, 255, 255}, {0, 0, 0}, {255, 0, 0}, {0, 0, 255}};
+        view.palette.resize(std::size_t{1} << depth);
+        const std::uint8_t gray[4] = {255, 0, 76, 28}; // stb's luma of each entry
+
+        const std::filesystem::path out = std::filesystem::temp_directory_path() / ("snatch_png_writer_" + std::to_string(depth) + ".png");
+        std::string error;
+        ASSERT_TRUE(png_write(out, view, 6, 1, error)) << error;
+
+        png_row_reader reader;
+        ASSERT_TRUE(reader.open(out)) << reader.error();
+        ASSERT_EQ(reader.width(), w);
+        ASSERT_EQ(reader.height(), h);
+        std::vector<std::uint8_t> row(w);
+        for (int y = 0; y < h; ++y) {
+            ASSERT_TRUE(reader.read_gray_row(row.data())) << reader.error();
+            for (int x = 0; x < w; ++x) {
+                EXPECT_EQ(row[static_cast<std::size_t>(x)], gray[index[static_cast<std::size_t>(y * w + x)]]) << depth << "bpp at " << x << "," << y;
+            }
+        }
+
+        int stb_w = 0;
+        int stb_h = 0;
+        const std::vector<std::uint8_t> rgb = stb_load_rgb(out, stb_w, stb_h);
+        ASSERT_FALSE(rgb.empty()) << depth << "bpp";
+        ASSERT_EQ(stb_w, w);
+        ASSERT_EQ(stb_h, h);
+        for (std::size_t i = 0; i < index.size(); ++i) {
+            const png_rgb& c = view.palette[static_cast<std::size_t>(index[i])];
+            EXPECT_EQ(rgb[i * 3], c.r) << depth << "bpp at pixel " << i;
+            EXPECT_EQ(rgb[i * 3 + 1], c.g) << depth << "bpp at pixel " << i;
+            EXPECT_EQ(rgb[i * 3 + 2], c.b) << depth << "bpp at pixel " << i;
+        }
+    }
+}
+
+TEST(png_writer, rejects_palettes_larger_than_the_depth) {
+    const std::uint8_t pixels[1] = {0};
+    png_image_view view;
+    view.width = 1;
+    view.height = 1;
+    view.bit_depth = 1;
+    view.color_type = 3;
+    view.rows = pixels;
+    view.stride = 1;
+    view.palette = {{0, 0, 0}, {1, 1, 1}, {2, 2, 2}};
+    std::string error;
+    EXPECT_FALSE(png_write(std::filesystem::temp_directory_path() / "snatch_png_writer_bad.png", view, 6, 1, error));
+    EXPECT_FALSE(error.empty());
+}
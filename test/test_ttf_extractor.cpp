@@ -0,0 +1,54 @@
+/// \file
+/// \brief Unit tests for TTF extraction and glyphs rasterized on demand.
+///
+/// This test source validates behavior of core parsing, extraction, transformation, and export flows. It helps ensure regressions are caught early for the plugin-driven pipeline.
+///
+/// Copyright (c) 2026 Tomaz Stih
+/// SPDX-License-Identifier: GPL-2.0-only
+
+#include <gtest/gtest.h>
+
+#include "snatch/ttf_extractor.h"
+
+TEST(ttf_extractor, lazy_font_rasterizes_on_first_use_and_keeps_recent_glyphs) {
+    ttf_extract_options opt;
+    opt.input_file = std::string(TEST_DATA_DIR) + "/flappybirdy-regular.ttf";
+    opt.first_ascii = 32;
+    opt.last_ascii = 0xFFFF;
+    opt.font_size = 16;
+
+    ttf_lazy_font lazy{4};
+    extracted_font header;
+    std::string err;
+    ASSERT_TRUE(lazy.open(opt, header, err)) << err;
+    EXPECT_EQ(lazy.glyph_count(), 0xFFFF - 32 + 1);
+    EXPECT_EQ(header.pixel_size, 16);
+    EXPECT_EQ(lazy.rasterized(), 0u);
+
+    opt.last_ascii = 127;
+    extracted_font eager;
+    ASSERT_TRUE(ttf_extractor{}.extract(opt, eager, err)) << err;
+
+    // the same rows as whole-font extraction, made once while they stay recent
+    for (const int cp : {'A', 'A', 'b', 'A'}) {
+        extracted_glyph g;
+        ASSERT_TRUE(lazy.glyph(cp - 32, g, err)) << err;
+        const extracted_glyph& want = eager.glyphs[static_cast<std::size_t>(cp - 32)];
+        EXPECT_EQ(g.view.codepoint, cp);
+        EXPECT_EQ(g.view.width, want.view.width);
+        EXPECT_EQ(g.view.bearing_y, want.view.bearing_y);
+        EXPECT_EQ(g.bitmap, want.bitmap);
+        EXPECT_EQ(g.view.data, g.bitmap.empty() ? nullptr : g.bitmap.data());
+    }
+    EXPECT_EQ(lazy.rasterized(), 2u);
+
+    // four more push 'A' out
+    for (const int cp : {'0', '1', '2', '3', 'A'}) {
+        extracted_glyph g;
+        ASSERT_TRUE(lazy.glyph(cp - 32, g, err)) << err;
+    }
+    EXPECT_EQ(lazy.rasterized(), 7u);
+
+    extracted_glyph g;
+    EXPECT_FALSE(lazy.glyph(lazy.glyph_count(), g, err));
+}